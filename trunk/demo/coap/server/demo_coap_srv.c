@@ -85,6 +85,9 @@ extern resource_t
   res_temp,
   res_toggle,
   res_led_toggle;
+#if STATS_CONF_ENABLE
+extern resource_t res_stats;
+#endif /* STATS_CONF_ENABLE */
 
 /*==============================================================================
  	 	 	 	 	 	 	 	 API FUNCTIONS
@@ -111,6 +114,9 @@ int8_t demo_coapInit(void)
 	rest_activate_resource(&res_toggle, "actuators/LED");
 	rest_activate_resource(&res_led_toggle, "actuators/LED_toggle");
 	rest_activate_resource(&res_rf_info, "status/rf_info");
+#if STATS_CONF_ENABLE
+	rest_activate_resource(&res_stats, "status/stats");
+#endif /* STATS_CONF_ENABLE */
 
 	return 1;
 }
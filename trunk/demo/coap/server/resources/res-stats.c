@@ -0,0 +1,90 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *      Statistics resource
+ *
+ *      GET returns the snapshot of the statistics registry (see stats.h),
+ *      GET ?schema the description of the snapshot. Both are sent
+ *      blockwise if they do not fit into a single message.
+ */
+
+#include <string.h>
+#include "er-coap.h"
+#include "emb6.h"
+#include "stats.h"
+
+#if STATS_CONF_ENABLE
+static void res_get_handler(void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
+
+RESOURCE(res_stats,
+         "title=\"Statistics\";rt=\"Data\"",
+         res_get_handler,
+         NULL,
+         NULL,
+         NULL);
+
+static void
+res_get_handler(void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  const char *query = NULL;
+  uint16_t len;
+
+  if(preferred_size > REST_MAX_CHUNK_SIZE) {
+    preferred_size = REST_MAX_CHUNK_SIZE;
+  }
+
+  if((REST.get_query(request, &query) == 6) && (strncmp(query, "schema", 6) == 0)) {
+    REST.set_header_content_type(response, REST.type.TEXT_PLAIN);
+    len = stats_schema((char *)buffer, preferred_size, *offset);
+  } else {
+    REST.set_header_content_type(response, REST.type.APPLICATION_OCTET_STREAM);
+    len = stats_snapshot(buffer, preferred_size, *offset);
+  }
+  REST.set_response_payload(response, buffer, len);
+
+  /* The representation is complete with the first short block */
+  *offset += len;
+  if(len < preferred_size) {
+    *offset = -1;
+  }
+}
+#endif /* STATS_CONF_ENABLE */
@@ -96,6 +96,14 @@
 #include "slip.h"
 #endif
 
+#if DEMO_USE_TUNBR
+#include "demo_tunbr.h"
+#endif
+
+#if DEMO_USE_MACLOAD
+#include "demo_mac_load.h"
+#endif
+
 #if UIP_CONF_IPV6_RPL
 #include "rpl.h"
 #endif
@@ -163,6 +171,14 @@ static uint8_t loc_demoAppsConf(s_ns_t* pst_netStack)
 	demo_mqttConf(pst_netStack);
 	#endif
 
+    #if DEMO_USE_TUNBR
+    demo_tunbrConf(pst_netStack);
+    #endif
+
+    #if DEMO_USE_MACLOAD
+    demo_macLoadConf(pst_netStack);
+    #endif
+
     if (pst_netStack == NULL)
     	return 0;
     else
@@ -202,6 +218,18 @@ static uint8_t loc_demoAppsInit(void)
 	}
 	#endif
 
+	#if DEMO_USE_TUNBR
+	if (!demo_tunbrInit()) {
+		return 0;
+	}
+	#endif
+
+	#if DEMO_USE_MACLOAD
+	if (!demo_macLoadInit()) {
+		return 0;
+	}
+	#endif
+
 	return 1;
 }
 
@@ -217,7 +245,12 @@ void loc_emb6_running_led_toggle(c_event_t c_event, p_data_t p_data)
 /*==============================================================================
  main()
 ==============================================================================*/
+#if NATIVE_CONF_SIM
+/* Every simulated node runs this function, see target/mcu/native/sim.h */
+int sim_nodeMain(void)
+#else
 int main(void)
+#endif
 {
     s_ns_t st_netstack;
 
@@ -253,7 +286,7 @@ int main(void)
 		etimer_set(&led_et, 1 * bsp_get(E_BSP_GET_TRES), loc_emb6_running_led_toggle);
 
 		/* call process function with delay in us */
-		emb6_process(500);  /* default: 500 us delay */
+		emb6_process(0);  /* default: sleep until next timer or event */
 	}
 	printf("Program failed.");
 	return 0;
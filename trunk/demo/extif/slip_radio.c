@@ -47,6 +47,7 @@
 #include "cmd.h"
 #include "slip_radio.h"
 #include "packetutils.h"
+#include "stats.h"
 
 #ifdef SLIP_RADIO_CONF_SENSORS
 extern const struct slip_radio_sensors SLIP_RADIO_CONF_SENSORS;
@@ -151,6 +152,21 @@ slip_radio_cmd_handler(const uint8_t *data, int len)
       cmd_send(uip_buf, uip_len);
       return 1;
     }
+#if STATS_CONF_ENABLE
+    if(data[1] == 'T' && (len == 2 || len == 4)) {
+      /* statistics snapshot, an optional offset of two bytes selects
+         the part of a snapshot that does not fit into a single reply */
+      uint16_t offset = 0;
+      if(len == 4) {
+        offset = ((uint16_t)data[2] << 8) | data[3];
+      }
+      uip_buf[0] = '!';
+      uip_buf[1] = 'T';
+      uip_len = 2 + stats_snapshot(&uip_buf[2], UIP_BUFSIZE - 2, offset);
+      cmd_send(uip_buf, uip_len);
+      return 1;
+    }
+#endif /* STATS_CONF_ENABLE */
   }
   return 0;
 }
@@ -0,0 +1,504 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * 	 \addtogroup embetter6
+ * 	 @{
+ * 	 \addtogroup demo
+ * 	 @{
+ * 	 \addtogroup demo_mac_load
+ * 	 @{
+*/
+/*! \file   demo_mac_load.c
+
+ \brief  Goodput of a high MAC under load
+
+         Every datagram starts with a sequence number of the sender. The
+         sink keeps the highest sequence number and the received datagrams
+         of every sender, the offered load is the sum of the sequence
+         numbers. A sender which never reached the sink is not counted,
+         the load printed is the offered load of a single sender. Senders
+         start at a random offset, so that they do not send in lock step.
+
+         The sequence number is followed by the simulation time of the
+         send call, all nodes share the clock of the simulator and the sink
+         computes the latency of every datagram from it.
+
+         With a relay, every sender has a host route to the sink through
+         the relay and the relay one to the sink, the sink does not route.
+
+ \version 0.0.1
+ */
+/*============================================================================*/
+
+/*==============================================================================
+ INCLUDE FILES
+ =============================================================================*/
+
+#include "emb6.h"
+#include "emb6_conf.h"
+#include "bsp.h"
+#include "demo_mac_load.h"
+#include "etimer.h"
+#include "evproc.h"
+#include "tcpip.h"
+#include "uip.h"
+#include "uip-ds6.h"
+#include "uip-udp-packet.h"
+#include "random.h"
+#include "queuebuf.h"
+#include "contikimac.h"
+#include "tsch.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*==============================================================================
+ 	 	 	 	 	 	 	 	 MACROS
+ =============================================================================*/
+#if !NATIVE_SIM
+#error "The MAC load scenario runs in the simulator of the native target only"
+#endif
+
+#if MACLOAD_PAYLOAD < 12
+#error "MACLOAD_PAYLOAD must hold the sequence number and the send time"
+#endif
+
+#define 	UIP_IP_BUF   			((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+/*==============================================================================
+ 	 	 	 	 	 	 STRUCTURES AND OTHER TYPEDEFS
+ =============================================================================*/
+/** Datagrams of a sender seen by the sink */
+typedef struct
+{
+	uint32_t						l_maxSeq;
+	uint32_t						l_rx;
+}st_macLoadSender_t;
+
+/*==============================================================================
+ 	 	 	 	 	 LOCAL VARIABLE DECLARATIONS
+ =============================================================================*/
+static	struct uip_udp_conn *		pst_conn;
+static	struct etimer				st_et;
+/** Send interval in ticks */
+static	clock_time_t				l_interval;
+/** Sequence number of the next datagram of a sender */
+static	uint32_t					l_seq;
+/** Reports printed by the sink */
+static	uint32_t					l_reports;
+/** Latencies of the datagrams received by the sink in microseconds */
+static	uint64_t					ll_latSum;
+static	uint64_t					ll_latMax;
+/** Simulation time and radio on time when the sink started */
+static	uint64_t					ll_start;
+static	uint64_t					ll_startOn;
+static	st_macLoadSender_t			gst_sender[MACLOAD_MAX_NODES + 1];
+
+/*==============================================================================
+ 	 	 	 	 	 	 LOCAL FUNCTION PROTOTYPES
+ =============================================================================*/
+static	void	_macload_send(c_event_t c_event, p_data_t p_data);
+static	void	_macload_report(c_event_t c_event, p_data_t p_data);
+static	void	_macload_rx(c_event_t c_event, p_data_t p_data);
+static	void	_macload_relayReport(c_event_t c_event, p_data_t p_data);
+
+/*==============================================================================
+ 	 	 	 	 	 	 	 LOCAL FUNCTIONS
+ =============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Name of the selected high MAC */
+/*----------------------------------------------------------------------------*/
+static const char * _macload_macName(void)
+{
+	const char *		pc_mac = getenv(MACLOAD_MAC_ENV);
+
+	if ((pc_mac != NULL) && (strcmp(pc_mac, "nullmac") == 0))
+		return "nullmac";
+	if ((pc_mac != NULL) && (strcmp(pc_mac, "tsch") == 0))
+		return "tsch";
+	return "csma";
+} /* _macload_macName() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Name of the selected low MAC */
+/*----------------------------------------------------------------------------*/
+static const char * _macload_rdcName(void)
+{
+	const char *		pc_rdc = getenv(MACLOAD_RDC_ENV);
+
+	/* TSCH needs its own low MAC */
+	if (strcmp(_macload_macName(), "tsch") == 0)
+		return "tschrdc";
+	if ((pc_rdc != NULL) && (strcmp(pc_rdc, "contikimac") == 0))
+		return "contikimac";
+	return "sicslowmac";
+} /* _macload_rdcName() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Name of the selected TSCH scheduler */
+/*----------------------------------------------------------------------------*/
+static const char * _macload_schedName(void)
+{
+	const char *		pc_sched = getenv(MACLOAD_TSCH_SCHED_ENV);
+
+	if ((pc_sched != NULL) && (strcmp(pc_sched, "autonomous") == 0))
+		return "autonomous";
+	return "minimal";
+} /* _macload_schedName() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Channel check rate of contikimac, 0 for the default */
+/*----------------------------------------------------------------------------*/
+static uint16_t _macload_ccr(void)
+{
+	const char *		pc_ccr = getenv(MACLOAD_CCR_ENV);
+
+	if (pc_ccr == NULL)
+		return 0;
+	return (uint16_t)strtoul(pc_ccr, NULL, 0);
+} /* _macload_ccr() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Node id of the relay, 0 without a relay */
+/*----------------------------------------------------------------------------*/
+static uint16_t _macload_relay(void)
+{
+	const char *		pc_relay = getenv(MACLOAD_RELAY_ENV);
+	unsigned long		l_relay;
+
+	if (pc_relay == NULL)
+		return 0;
+	l_relay = strtoul(pc_relay, NULL, 0);
+	/* The sink can not relay */
+	if ((l_relay == MACLOAD_SINK) || (l_relay > MACLOAD_MAX_NODES))
+		return 0;
+	return (uint16_t)l_relay;
+} /* _macload_relay() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Addresses of a node, which differs from this node in the node
+ *          id only
+ *
+ *  \param  i_node      Node id
+ *  \param  i_prefix    First 16 bits of the prefix, 0xfe80 for the link
+ *                      local address
+ *  \param  pst_ip      Returns the IPv6 address
+ *  \param  pst_ll      Returns the link layer address
+ */
+/*----------------------------------------------------------------------------*/
+static void _macload_nodeAddr(uint16_t i_node, uint16_t i_prefix,
+							  uip_ipaddr_t * pst_ip, uip_lladdr_t * pst_ll)
+{
+	memcpy(pst_ll, &uip_lladdr, sizeof(*pst_ll));
+	pst_ll->addr[6] = (uint8_t)(i_node >> 8);
+	pst_ll->addr[7] = (uint8_t)(i_node);
+	uip_ip6addr(pst_ip, i_prefix, 0, 0, 0, 0, 0, 0, 0);
+	uip_ds6_set_addr_iid(pst_ip, pst_ll);
+} /* _macload_nodeAddr() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Host route to the sink through a neighbor
+ *
+ *  \return 0 - error, 1 - success
+ */
+/*----------------------------------------------------------------------------*/
+static uint8_t _macload_route(uip_ipaddr_t * pst_sink, uint16_t i_via)
+{
+	uip_ipaddr_t		un_via;
+	uip_lladdr_t		un_viaLl;
+
+	_macload_nodeAddr(i_via, 0xfe80, &un_via, &un_viaLl);
+	if (uip_ds6_nbr_add(&un_via, &un_viaLl, 1, NBR_REACHABLE) == NULL)
+		return 0;
+	return uip_ds6_route_add(pst_sink, 128, &un_via) != NULL;
+} /* _macload_route() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Send a datagram to the sink, called by the send timer */
+/*----------------------------------------------------------------------------*/
+static void _macload_send(c_event_t c_event, p_data_t p_data)
+{
+	uint8_t				pc_buf[MACLOAD_PAYLOAD];
+	uint64_t			ll_now;
+	int					i;
+
+	if (!etimer_expired(&st_et))
+		return;
+	if (l_seq == 0) {
+		/* The first expiry was the random start offset */
+		etimer_set(&st_et, l_interval, _macload_send);
+	} else {
+		etimer_reset(&st_et);
+	}
+	/* A TSCH node can not send before it joined */
+	if ((strcmp(_macload_macName(), "tsch") == 0) && !tsch_is_associated())
+		return;
+
+	l_seq++;
+	memset(pc_buf, 0, sizeof(pc_buf));
+	pc_buf[0] = (uint8_t)(l_seq >> 24);
+	pc_buf[1] = (uint8_t)(l_seq >> 16);
+	pc_buf[2] = (uint8_t)(l_seq >> 8);
+	pc_buf[3] = (uint8_t)(l_seq);
+	ll_now = sim_getTimeUs();
+	for (i = 0; i < 8; i++)
+		pc_buf[4 + i] = (uint8_t)(ll_now >> (56 - 8 * i));
+	uip_udp_packet_send(pst_conn, pc_buf, sizeof(pc_buf));
+} /* _macload_send() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Count a datagram received by the sink */
+/*----------------------------------------------------------------------------*/
+static void _macload_rx(c_event_t c_event, p_data_t p_data)
+{
+	uint8_t *			pc_data;
+	uint16_t			i_node;
+	uint32_t			l_rxSeq;
+	uint64_t			ll_sent = 0;
+	uint64_t			ll_lat;
+	int					i;
+
+	if ((c_event != EVENT_TYPE_TCPIP) || (uip_udp_conn != pst_conn) ||
+		!uip_newdata() || (uip_datalen() < 12))
+		return;
+
+	/* The interface id of a sender ends with its node id */
+	i_node = (UIP_IP_BUF->srcipaddr.u8[14] << 8) | UIP_IP_BUF->srcipaddr.u8[15];
+	if (i_node > MACLOAD_MAX_NODES)
+		return;
+	pc_data = uip_appdata;
+	l_rxSeq = ((uint32_t)pc_data[0] << 24) | ((uint32_t)pc_data[1] << 16) |
+			((uint32_t)pc_data[2] << 8) | pc_data[3];
+	for (i = 0; i < 8; i++)
+		ll_sent = (ll_sent << 8) | pc_data[4 + i];
+	ll_lat = sim_getTimeUs() - ll_sent;
+	ll_latSum += ll_lat;
+	if (ll_lat > ll_latMax)
+		ll_latMax = ll_lat;
+	gst_sender[i_node].l_rx++;
+	if (l_rxSeq > gst_sender[i_node].l_maxSeq)
+		gst_sender[i_node].l_maxSeq = l_rxSeq;
+} /* _macload_rx() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Print the counters of the sink, called by the report timer */
+/*----------------------------------------------------------------------------*/
+static void _macload_report(c_event_t c_event, p_data_t p_data)
+{
+	uint32_t			l_offered = 0;
+	uint32_t			l_rx = 0;
+	uint64_t			ll_time;
+	uint64_t			ll_on;
+	uint16_t			i_senders = 0;
+	uint16_t			i;
+
+	if (!etimer_expired(&st_et))
+		return;
+	etimer_reset(&st_et);
+
+	for (i = 0; i <= MACLOAD_MAX_NODES; i++) {
+		if (gst_sender[i].l_maxSeq == 0)
+			continue;
+		i_senders++;
+		l_offered += gst_sender[i].l_maxSeq;
+		l_rx += gst_sender[i].l_rx;
+	}
+	l_reports++;
+	ll_time = sim_getTimeUs() - ll_start;
+	ll_on = sim_radioOnUs() - ll_startOn;
+	printf("macload mac=%s rdc=%s ccr=%u%s%s relay=%u interval=%lums load=%lubit/s t=%lus "
+			"senders=%u offered=%lu rx=%lu pdr=%lu%% goodput=%lubit/s "
+			"latency=%lu/%luus radio_on=%lu.%02lu%%\n",
+			_macload_macName(), _macload_rdcName(), _macload_ccr(),
+			(strcmp(_macload_macName(), "tsch") == 0) ? " sched=" : "",
+			(strcmp(_macload_macName(), "tsch") == 0) ? _macload_schedName() : "",
+			_macload_relay(),
+			(unsigned long)(l_interval * 1000 / bsp_get(E_BSP_GET_TRES)),
+			(unsigned long)(MACLOAD_PAYLOAD * 8 * bsp_get(E_BSP_GET_TRES) /
+					l_interval),
+			(unsigned long)(l_reports * MACLOAD_REPORT), i_senders,
+			(unsigned long)l_offered, (unsigned long)l_rx,
+			(unsigned long)(l_offered ? (uint64_t)l_rx * 100 / l_offered : 0),
+			(unsigned long)((uint64_t)l_rx * MACLOAD_PAYLOAD * 8 /
+					(l_reports * MACLOAD_REPORT)),
+			(unsigned long)(l_rx ? ll_latSum / l_rx : 0),
+			(unsigned long)ll_latMax,
+			(unsigned long)(ll_on * 100 / ll_time),
+			(unsigned long)(ll_on * 10000 / ll_time % 100));
+} /* _macload_report() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Print the counters of the relay, called by the report timer */
+/*----------------------------------------------------------------------------*/
+static void _macload_relayReport(c_event_t c_event, p_data_t p_data)
+{
+	uint32_t			l_fwd = 0;
+
+	if (!etimer_expired(&st_et))
+		return;
+	etimer_reset(&st_et);
+
+#if UIP_STATISTICS
+	l_fwd = uip_stat.ip.forwarded;
+#endif
+	l_reports++;
+	printf("macload relay=%u t=%lus forwarded=%lu copied=%lubyte/datagram\n",
+			sim_nodeId(), (unsigned long)(l_reports * MACLOAD_REPORT),
+			(unsigned long)l_fwd,
+			(unsigned long)(l_fwd ? queuebuf_copied_bytes() / l_fwd : 0));
+} /* _macload_relayReport() */
+
+/*==============================================================================
+ 	 	 	 	 	 	 	 	 API FUNCTIONS
+ =============================================================================*/
+
+uint8_t demo_macLoadConf(s_ns_t* pst_netStack)
+{
+	uint8_t 			c_ret = 1;
+	const s_nsHighMac_t *	p_hmac = &csma_driver;
+	const s_nsLowMac_t *	p_lmac = &sicslowmac_driver;
+
+	if (strcmp(_macload_macName(), "nullmac") == 0)
+		p_hmac = &nullmac_driver;
+	if (strcmp(_macload_macName(), "tsch") == 0)
+		p_hmac = &tsch_driver;
+	if (strcmp(_macload_rdcName(), "contikimac") == 0)
+		p_lmac = &contikimac_driver;
+	if (strcmp(_macload_rdcName(), "tschrdc") == 0)
+		p_lmac = &tschrdc_driver;
+
+    if (pst_netStack != NULL) {
+    	if (!pst_netStack->c_configured) {
+        	pst_netStack->hc     = &sicslowpan_driver;
+            pst_netStack->llsec  = &nullsec_driver;
+        	pst_netStack->hmac   = p_hmac;
+        	pst_netStack->lmac   = p_lmac;
+        	pst_netStack->frame  = &framer_802154;
+        	pst_netStack->c_configured = 1;
+            /* Transceiver interface is defined by @ref board_conf function*/
+    	} else {
+            if ((pst_netStack->hc == &sicslowpan_driver)   &&
+                (pst_netStack->llsec == &nullsec_driver)   &&
+            	(pst_netStack->hmac == p_hmac)             &&
+            	(pst_netStack->lmac == p_lmac)             &&
+            	(pst_netStack->frame == &framer_802154)) {
+            	/* right configuration */
+            }
+            else {
+                c_ret = 0;
+            }
+    	}
+    }
+    return c_ret;
+} /* demo_macLoadConf() */
+
+int8_t demo_macLoadInit(void)
+{
+	uip_ipaddr_t		un_sink;
+	uip_lladdr_t		un_sinkLl;
+	uip_ipaddr_t		un_addr;
+	uip_lladdr_t		un_ll;
+	const char *		pc_interval;
+	unsigned long		l_ms = MACLOAD_INTERVAL;
+	uint16_t			i_relay = _macload_relay();
+
+	pc_interval = getenv(MACLOAD_INTERVAL_ENV);
+	if (pc_interval != NULL)
+		l_ms = strtoul(pc_interval, NULL, 0);
+	if (l_ms == 0)
+		l_ms = 1;
+	l_interval = (clock_time_t)(l_ms * bsp_get(E_BSP_GET_TRES) / 1000);
+	if (l_interval == 0)
+		l_interval = 1;
+	if ((_macload_ccr() != 0) &&
+		(strcmp(_macload_rdcName(), "contikimac") == 0))
+		contikimac_set_channel_check_rate(_macload_ccr());
+	if (strcmp(_macload_macName(), "tsch") == 0) {
+		if (strcmp(_macload_schedName(), "autonomous") == 0)
+			tsch_set_scheduler(&tsch_scheduler_autonomous);
+		/* The sink starts the network */
+		if (sim_nodeId() == MACLOAD_SINK)
+			tsch_set_coordinator(1);
+	}
+	if (i_relay != 0) {
+		/* Link local addresses are not forwarded */
+		_macload_nodeAddr(sim_nodeId(), MACLOAD_PREFIX, &un_addr, &un_ll);
+		if (uip_ds6_addr_add(&un_addr, 0, ADDR_MANUAL) == NULL)
+			return 0;
+	}
+
+	if (sim_nodeId() == MACLOAD_SINK) {
+		pst_conn = udp_new(NULL, 0, NULL);
+		if (pst_conn == NULL)
+			return 0;
+		udp_bind(pst_conn, UIP_HTONS(MACLOAD_PORT));
+		evproc_regCallback(EVENT_TYPE_TCPIP, _macload_rx);
+		ll_start = sim_getTimeUs();
+		ll_startOn = sim_radioOnUs();
+		etimer_set(&st_et, MACLOAD_REPORT * bsp_get(E_BSP_GET_TRES),
+				_macload_report);
+		return 1;
+	}
+
+	_macload_nodeAddr(MACLOAD_SINK, (i_relay != 0) ? MACLOAD_PREFIX : 0xfe80,
+			&un_sink, &un_sinkLl);
+	if (sim_nodeId() == i_relay) {
+		if (!_macload_route(&un_sink, MACLOAD_SINK))
+			return 0;
+		etimer_set(&st_et, MACLOAD_REPORT * bsp_get(E_BSP_GET_TRES),
+				_macload_relayReport);
+		return 1;
+	}
+	if ((i_relay != 0) && !_macload_route(&un_sink, i_relay))
+		return 0;
+
+	pst_conn = udp_new(&un_sink, UIP_HTONS(MACLOAD_PORT), NULL);
+	if (pst_conn == NULL)
+		return 0;
+	/* First datagram after a second and a random part of the interval */
+	etimer_set(&st_et, bsp_get(E_BSP_GET_TRES) + random_rand() % l_interval,
+			_macload_send);
+	return 1;
+} /* demo_macLoadInit() */
+/** @} */
+/** @} */
+/** @} */
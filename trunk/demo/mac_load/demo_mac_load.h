@@ -0,0 +1,191 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * 	 \addtogroup embetter6
+ * 	 @{
+ *   \addtogroup demo
+ *   @{
+ *   \defgroup demo_mac_load	Goodput of a high MAC under load
+ *
+ *   Scenario of the native simulator (NATIVE_CONF_SIM=1) comparing the high
+ *   MAC drivers. Node \ref MACLOAD_SINK is the sink, every other node sends
+ *   UDP datagrams of \ref MACLOAD_PAYLOAD bytes to its link local address
+ *   at a fixed interval. The sink prints every \ref MACLOAD_REPORT seconds
+ *   the packets offered by the senders, the packets received, the goodput,
+ *   the average and maximum latency of a datagram and the share of the time
+ *   the receiver of the sink was on. The simulator prints the radio on time
+ *   averaged over all nodes when it ends.
+ *
+ *   The high MAC and the send interval are taken from the environment, so
+ *   one binary sweeps the offered load for both drivers:
+ *
+ *       for i in 1000 200 100 50 20; do
+ *           for m in nullmac csma; do
+ *               MACLOAD_MAC=$m MACLOAD_INTERVAL=$i ./ml_native.elf -n 6 -d 60
+ *           done
+ *       done
+ *
+ *   The low MAC and the channel check rate of contikimac are taken from
+ *   the environment as well:
+ *
+ *       for r in 2 4 8 16 32; do
+ *           MACLOAD_RDC=contikimac MACLOAD_CCR=$r ./ml_native.elf -n 6 -d 60
+ *       done
+ *
+ *   MACLOAD_MAC=tsch selects TSCH as high and low MAC, the sink is the
+ *   coordinator. A sender starts sending once it joined the network. The
+ *   scheduler of the senders and the sink is taken from the environment:
+ *
+ *       for s in minimal autonomous; do
+ *           MACLOAD_MAC=tsch MACLOAD_TSCH_SCHED=$s ./ml_native.elf -n 6 -d 60
+ *       done
+ *
+ *   MACLOAD_RELAY names a node which forwards the datagrams of all
+ *   senders to the sink, so the goodput of the sink is the forwarding
+ *   throughput of the relay. The nodes use global addresses and static
+ *   routes then. The relay prints the datagrams it forwarded and the bytes
+ *   it copied into queuebufs per forwarded datagram, e.g. to compare
+ *   builds with different PACKETBUF_CONF_SLOTS:
+ *
+ *       for i in 400 200 100 50; do
+ *           MACLOAD_RELAY=2 MACLOAD_INTERVAL=$i ./ml_native.elf -n 8 -d 60
+ *       done
+ *   @{
+*/
+/*! \file   demo_mac_load.h
+
+	\brief  Goodput of a high MAC under load
+
+	\version 0.0.1
+*/
+#ifndef _DEMO_MAC_LOAD_H_
+#define _DEMO_MAC_LOAD_H_
+/*============================================================================*/
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Environment variable selecting the high MAC, "csma", "nullmac" or
+    "tsch" */
+#define MACLOAD_MAC_ENV				"MACLOAD_MAC"
+
+/** Environment variable selecting the low MAC, "sicslowmac" or
+    "contikimac" */
+#define MACLOAD_RDC_ENV				"MACLOAD_RDC"
+
+/** Environment variable selecting the TSCH scheduler, "minimal" or
+    "autonomous" */
+#define MACLOAD_TSCH_SCHED_ENV		"MACLOAD_TSCH_SCHED"
+
+/** Environment variable holding the channel check rate of contikimac */
+#define MACLOAD_CCR_ENV				"MACLOAD_CCR"
+
+/** Environment variable holding the send interval in milliseconds */
+#define MACLOAD_INTERVAL_ENV		"MACLOAD_INTERVAL"
+
+/** Environment variable holding the node id of the relay, 0 if the senders
+    send to the sink directly */
+#define MACLOAD_RELAY_ENV			"MACLOAD_RELAY"
+
+/** Send interval of every sender in milliseconds */
+#ifdef MACLOAD_CONF_INTERVAL
+#define MACLOAD_INTERVAL			MACLOAD_CONF_INTERVAL
+#else
+#define MACLOAD_INTERVAL			1000
+#endif
+
+/** UDP payload of a datagram, at least 12 bytes for the sequence number
+    and the send time */
+#ifdef MACLOAD_CONF_PAYLOAD
+#define MACLOAD_PAYLOAD				MACLOAD_CONF_PAYLOAD
+#else
+#define MACLOAD_PAYLOAD				40
+#endif
+
+/** Node id of the sink */
+#ifdef MACLOAD_CONF_SINK
+#define MACLOAD_SINK				MACLOAD_CONF_SINK
+#else
+#define MACLOAD_SINK				1
+#endif
+
+/** Report interval of the sink in seconds */
+#ifdef MACLOAD_CONF_REPORT
+#define MACLOAD_REPORT				MACLOAD_CONF_REPORT
+#else
+#define MACLOAD_REPORT				10
+#endif
+
+/** UDP port of the sink */
+#define MACLOAD_PORT				5000
+
+/** First 16 bits of the global prefix used with a relay */
+#define MACLOAD_PREFIX				0xaaaa
+
+/** Highest node id counted by the sink */
+#define MACLOAD_MAX_NODES			64
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/*============================================================================*/
+/*!
+   \brief Initialization of the sink or of a sender.
+
+	\return 0 - error, 1 - success
+*/
+/*============================================================================*/
+int8_t demo_macLoadInit(void);
+
+/*============================================================================*/
+/*!
+	\brief Configuration of the scenario, selects the high and low MAC.
+
+	\return 0 - error, 1 - success
+*/
+/*============================================================================*/
+uint8_t demo_macLoadConf(s_ns_t* pst_netStack);
+
+#endif /* _DEMO_MAC_LOAD_H_ */
+/** @} */
+/** @} */
+/** @} */
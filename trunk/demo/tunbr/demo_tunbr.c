@@ -0,0 +1,409 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * 	 \addtogroup embetter6
+ * 	 @{
+ * 	 \addtogroup demo
+ * 	 @{
+ * 	 \addtogroup demo_tunbr
+ * 	 @{
+*/
+/*! \file   demo_tunbr.c
+
+ \brief  Border router between the mesh and a Linux tun interface
+
+         The tun descriptor is watched by the native HAL. Its handler runs
+         like an interrupt service routine and reads every packet queued by
+         the kernel into a ring of buffers with a single wake up, the
+         packets are then passed to the stack one after the other from the
+         main loop. Packets which can not be routed inside of the mesh leave
+         the stack through the fallback interface and are written to the
+         tun interface directly from uip_buf.
+
+ \version 0.0.1
+ */
+/*============================================================================*/
+
+/*==============================================================================
+ INCLUDE FILES
+ =============================================================================*/
+
+#include "emb6.h"
+#include "emb6_conf.h"
+#include "bsp.h"
+#include "hwinit.h"
+#include "demo_tunbr.h"
+#include "evproc.h"
+#include "tcpip.h"
+#include "uip.h"
+#include "uip-ds6.h"
+#include "rpl.h"
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+/*==============================================================================
+ 	 	 	 	 	 	 	 	 MACROS
+ =============================================================================*/
+#define 	LOGGER_ENABLE		LOGGER_DEMO_TUNBR
+#if			LOGGER_ENABLE 	== 	TRUE
+#define		LOGGER_SUBSYSTEM	"tunbr"
+#endif
+#include	"logger.h"
+
+#if NATIVE_CONF_SIM
+#error "The tun border router needs the real time, it can not be simulated"
+#endif
+
+#if (TUNBR_RX_BUFFERS & (TUNBR_RX_BUFFERS - 1))
+#error "TUNBR_RX_BUFFERS must be a power of two"
+#endif
+#define		TUNBR_RX_MASK			(TUNBR_RX_BUFFERS - 1)
+
+/** Largest packet exchanged with the tun interface */
+#define		TUNBR_MTU				(UIP_BUFSIZE - UIP_LLH_LEN)
+
+/** Smallest MTU of an IPv6 link */
+#define		TUNBR_MIN_MTU			1280
+
+/*==============================================================================
+ 	 	 	 	 	 	 STRUCTURES AND OTHER TYPEDEFS
+ =============================================================================*/
+/** Packet read from the tun interface */
+typedef struct
+{
+	uint16_t						i_len;
+	uint8_t							pc_data[TUNBR_MTU];
+}st_tunbrPacket_t;
+
+/** Address of an interface, struct in6_ifreq of the kernel */
+typedef struct
+{
+	uip_ip6addr_t					un_addr;
+	uint32_t						l_prefixLen;
+	int								i_ifIndex;
+}st_tunbrIfreq6_t;
+
+/*==============================================================================
+ 	 	 	 	 	 LOCAL VARIABLE DECLARATIONS
+ =============================================================================*/
+/** Descriptor of the tun interface */
+static	int							i_tunFd = -1;
+/** Packets read from the tun interface, written by \ref _tunbr_isr() */
+static	st_tunbrPacket_t			gst_rxPacket[TUNBR_RX_BUFFERS];
+/** Next packet passed to the stack */
+static	volatile uint16_t			i_rxHead;
+/** Next free buffer */
+static	volatile uint16_t			i_rxTail;
+/** Packets passed from the tun interface to the stack */
+static	uint32_t					l_rxPackets;
+/** Packets written to the tun interface */
+static	uint32_t					l_txPackets;
+/** Packets which could not be written to the tun interface */
+static	uint32_t					l_txDropped;
+
+/*==============================================================================
+ 	 	 	 	 	 	 LOCAL FUNCTION PROTOTYPES
+ =============================================================================*/
+static	void		_tunbr_init(void);
+static	void		_tunbr_output(void);
+static	void		_tunbr_isr(void * p_data);
+static	void		_tunbr_callback(c_event_t c_event, p_data_t p_data);
+static	int8_t		_tunbr_ifConf(const char * pc_name, uip_ip6addr_t * pun_host);
+static	int8_t		_tunbr_dagInit(uip_ip6addr_t * pun_host);
+
+/*==============================================================================
+ 	 	 	 	 	 	 	 	 GLOBAL VARIABLES
+ =============================================================================*/
+/** Fallback interface of the stack, see UIP_FALLBACK_INTERFACE */
+struct uip_fallback_interface tunbr_interface = {
+	_tunbr_init,
+	_tunbr_output
+};
+
+/*==============================================================================
+ 	 	 	 	 	 	 	 LOCAL FUNCTIONS
+ =============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Initialization of the fallback interface, called by tcpip_init().
+ *          The tun interface is opened later by \ref demo_tunbrInit().
+ */
+/*----------------------------------------------------------------------------*/
+static void _tunbr_init(void)
+{
+	i_rxHead = 0;
+	i_rxTail = 0;
+} /* _tunbr_init() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Writes the packet in uip_buf to the tun interface, called by the
+ *          stack for every packet without a route inside of the mesh.
+ */
+/*----------------------------------------------------------------------------*/
+static void _tunbr_output(void)
+{
+	if ((i_tunFd < 0) || (uip_len == 0))
+		return;
+
+	if (write(i_tunFd, &uip_buf[UIP_LLH_LEN], uip_len) != uip_len) {
+		l_txDropped++;
+		LOG_ERR("fail to write %u bytes (%d)", uip_len, errno);
+	} else {
+		l_txPackets++;
+	}
+} /* _tunbr_output() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Handler of the tun descriptor, reads every queued packet into a
+ *          free buffer. Packets which do not fit stay in the kernel until
+ *          the buffers were handed to the stack.
+ *
+ *  \param  p_data      not used
+ */
+/*----------------------------------------------------------------------------*/
+static void _tunbr_isr(void * p_data)
+{
+	st_tunbrPacket_t *	pst_packet;
+	ssize_t				l_len;
+
+	while ((uint16_t)(i_rxTail - i_rxHead) < TUNBR_RX_BUFFERS) {
+		pst_packet = &gst_rxPacket[i_rxTail & TUNBR_RX_MASK];
+		l_len = read(i_tunFd, pst_packet->pc_data, TUNBR_MTU);
+		if (l_len <= 0) {
+			if ((l_len < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+				LOG_ERR("read error %d", errno);
+			break;
+		}
+		pst_packet->i_len = (uint16_t)l_len;
+		i_rxTail++;
+	}
+
+	if (i_rxTail != i_rxHead)
+		evproc_putEvent(E_EVPROC_TAIL, EVENT_TYPE_TUN_POLL, NULL);
+} /* _tunbr_isr() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Passes all packets read from the tun interface to the stack
+ *
+ *  \param  c_event     event type, not used
+ *  \param  p_data      event data, not used
+ */
+/*----------------------------------------------------------------------------*/
+static void _tunbr_callback(c_event_t c_event, p_data_t p_data)
+{
+	st_tunbrPacket_t *	pst_packet;
+
+	while (i_rxHead != i_rxTail) {
+		pst_packet = &gst_rxPacket[i_rxHead & TUNBR_RX_MASK];
+		memcpy(&uip_buf[UIP_LLH_LEN], pst_packet->pc_data, pst_packet->i_len);
+		uip_len = pst_packet->i_len;
+		i_rxHead++;
+		l_rxPackets++;
+		tcpip_input();
+	}
+} /* _tunbr_callback() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Sets the MTU and the host address of the tun interface and brings
+ *          it up. This needs the CAP_NET_ADMIN capability, otherwise the
+ *          interface has to be configured by hand.
+ *
+ *  \param  pc_name     Name of the tun interface
+ *  \param  pun_host    Address of the host
+ *
+ *  \return 1 if success, 0 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _tunbr_ifConf(const char * pc_name, uip_ip6addr_t * pun_host)
+{
+	struct ifreq		st_ifr;
+	st_tunbrIfreq6_t	st_ifr6;
+	int					i_sock;
+	int8_t				c_ret = 0;
+
+	i_sock = socket(AF_INET6, SOCK_DGRAM, 0);
+	if (i_sock < 0)
+		return 0;
+
+	memset(&st_ifr, 0, sizeof(st_ifr));
+	strncpy(st_ifr.ifr_name, pc_name, IFNAMSIZ - 1);
+	st_ifr.ifr_mtu = TUNBR_MTU;
+	if (ioctl(i_sock, SIOCSIFMTU, &st_ifr) < 0) {
+		LOG_ERR("fail to set mtu %d of %s (%d)", TUNBR_MTU, pc_name, errno);
+	} else if (ioctl(i_sock, SIOCGIFINDEX, &st_ifr) < 0) {
+		LOG_ERR("fail to get index of %s (%d)", pc_name, errno);
+	} else {
+		memset(&st_ifr6, 0, sizeof(st_ifr6));
+		uip_ipaddr_copy(&st_ifr6.un_addr, pun_host);
+		st_ifr6.l_prefixLen = 64;
+		st_ifr6.i_ifIndex = st_ifr.ifr_ifindex;
+		if ((ioctl(i_sock, SIOCSIFADDR, &st_ifr6) < 0) && (errno != EEXIST)) {
+			LOG_ERR("fail to set address of %s (%d)", pc_name, errno);
+		} else if (ioctl(i_sock, SIOCGIFFLAGS, &st_ifr) < 0) {
+			LOG_ERR("fail to get flags of %s (%d)", pc_name, errno);
+		} else {
+			st_ifr.ifr_flags |= IFF_UP | IFF_RUNNING;
+			if (ioctl(i_sock, SIOCSIFFLAGS, &st_ifr) < 0)
+				LOG_ERR("fail to bring %s up (%d)", pc_name, errno);
+			else
+				c_ret = 1;
+		}
+	}
+	close(i_sock);
+	return c_ret;
+} /* _tunbr_ifConf() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Makes the node root of a new DAG announcing NETWORK_PREFIX_DODAG
+ *
+ *  \param  pun_host    Returns the address of the host in this prefix
+ *
+ *  \return 1 if success, 0 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _tunbr_dagInit(uip_ip6addr_t * pun_host)
+{
+	uip_ipaddr_t		un_ipaddr;
+	rpl_dag_t *			pst_dag;
+	uint16_t			pi_netPrefix[4] = {NETWORK_PREFIX_DODAG};
+
+	uip_ip6addr(&un_ipaddr, pi_netPrefix[0], pi_netPrefix[1],
+				pi_netPrefix[2], pi_netPrefix[3], 0, 0, 0, 0);
+	uip_ip6addr(pun_host, pi_netPrefix[0], pi_netPrefix[1],
+				pi_netPrefix[2], pi_netPrefix[3], 0, 0, 0, TUNBR_HOST_IID);
+	uip_ds6_set_addr_iid(&un_ipaddr, &uip_lladdr);
+	uip_ds6_addr_add(&un_ipaddr, 0, ADDR_MANUAL);
+
+	pst_dag = rpl_set_root(rpl_config.default_instance, &un_ipaddr);
+	if (pst_dag == NULL) {
+		LOG_ERR("%s", "failed to create a new RPL DAG");
+		return 0;
+	}
+	rpl_set_prefix(pst_dag, &un_ipaddr, 64);
+	LOG_INFO("%s", "created a new RPL DAG");
+	return 1;
+} /* _tunbr_dagInit() */
+
+/*==============================================================================
+ 	 	 	 	 	 	 	 	 API FUNCTIONS
+ =============================================================================*/
+
+uint8_t demo_tunbrConf(s_ns_t* pst_netStack)
+{
+	uint8_t c_ret = 1;
+
+	if (pst_netStack != NULL) {
+		if (!pst_netStack->c_configured) {
+			pst_netStack->hc     = &sicslowpan_driver;
+			pst_netStack->hmac   = &nullmac_driver;
+			pst_netStack->lmac   = &sicslowmac_driver;
+			pst_netStack->frame  = &framer_802154;
+			pst_netStack->c_configured = 1;
+			/* Transceiver interface is defined by @ref board_conf function*/
+			/* pst_netStack->inif   = $<some_transceiver>;*/
+		} else {
+			if ((pst_netStack->hc == &sicslowpan_driver)   &&
+				(pst_netStack->hmac == &nullmac_driver)    &&
+				(pst_netStack->lmac == &sicslowmac_driver) &&
+				(pst_netStack->frame == &framer_802154)) {
+				/* right configuration */
+			}
+			else {
+				c_ret = 0;
+			}
+		}
+	}
+	return (c_ret);
+} /* demo_tunbrConf() */
+
+int8_t demo_tunbrInit(void)
+{
+	struct ifreq		st_ifr;
+	uip_ip6addr_t		un_host;
+	const char *		pc_name;
+
+	if (!_tunbr_dagInit(&un_host))
+		return 0;
+
+	pc_name = getenv(TUNBR_IFNAME_ENV);
+	if (pc_name == NULL)
+		pc_name = TUNBR_IFNAME;
+
+	i_tunFd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+	if (i_tunFd < 0) {
+		LOG_ERR("fail to open /dev/net/tun (%d)", errno);
+		return 0;
+	}
+
+	memset(&st_ifr, 0, sizeof(st_ifr));
+	st_ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+	strncpy(st_ifr.ifr_name, pc_name, IFNAMSIZ - 1);
+	if (ioctl(i_tunFd, TUNSETIFF, &st_ifr) < 0) {
+		LOG_ERR("fail to attach to %s (%d)", pc_name, errno);
+		close(i_tunFd);
+		i_tunFd = -1;
+		return 0;
+	}
+
+	/* An interface which already exists may be configured by the user */
+	if (!_tunbr_ifConf(st_ifr.ifr_name, &un_host))
+		LOG_WARN("configure %s by hand", st_ifr.ifr_name);
+
+	evproc_regCallback(EVENT_TYPE_TUN_POLL, _tunbr_callback);
+	if (!hal_fdRegister(i_tunFd, _tunbr_isr, NULL)) {
+		close(i_tunFd);
+		i_tunFd = -1;
+		return 0;
+	}
+	LOG_INFO("forwarding to %s", st_ifr.ifr_name);
+	return 1;
+} /* demo_tunbrInit() */
+
+/** @} */
+/** @} */
+/** @} */
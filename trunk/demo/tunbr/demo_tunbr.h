@@ -0,0 +1,117 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * 	 \addtogroup embetter6
+ * 	 @{
+ *   \addtogroup demo
+ *   @{
+ *   \defgroup demo_tunbr	Border router to a Linux tun interface
+ *
+ *   The node acts as RPL DAG root and forwards every packet which can not be
+ *   routed inside of the mesh to a tun interface of the host (native target
+ *   only). The host reaches the mesh through this interface, e.g. to run
+ *   CoAP clients or throughput tests against simulated nodes.
+ *   @{
+*/
+/*! \file   demo_tunbr.h
+
+	\brief  Border router between the mesh and a Linux tun interface
+
+	\version 0.0.1
+*/
+#ifndef _DEMO_TUNBR_H_
+#define _DEMO_TUNBR_H_
+/*============================================================================*/
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Name of the tun interface if TUNBR_IFNAME is not set in the environment */
+#ifdef TUNBR_CONF_IFNAME
+#define TUNBR_IFNAME				TUNBR_CONF_IFNAME
+#else
+#define TUNBR_IFNAME				"tun0"
+#endif
+
+/** Environment variable holding the name of the tun interface */
+#define TUNBR_IFNAME_ENV			"TUNBR_IFNAME"
+
+/** Amount of packets read from the tun interface at once, power of two */
+#ifdef TUNBR_CONF_RX_BUFFERS
+#define TUNBR_RX_BUFFERS			TUNBR_CONF_RX_BUFFERS
+#else
+#define TUNBR_RX_BUFFERS			8
+#endif
+
+/** Last 16 bit word of the host address configured on the tun interface,
+ *  the first 64 bit are the prefix of the DAG */
+#ifdef TUNBR_CONF_HOST_IID
+#define TUNBR_HOST_IID				TUNBR_CONF_HOST_IID
+#else
+#define TUNBR_HOST_IID				0x0001
+#endif
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/*============================================================================*/
+/*!
+   \brief Initialization of the border router, makes the node DAG root.
+
+	\return 0 - error, 1 - success
+*/
+/*============================================================================*/
+int8_t demo_tunbrInit(void);
+
+/*============================================================================*/
+/*!
+	\brief Configuration of the border router.
+
+	\return 0 - error, 1 - success
+*/
+/*============================================================================*/
+uint8_t demo_tunbrConf(s_ns_t* pst_netStack);
+
+#endif /* _DEMO_TUNBR_H_ */
+/** @} */
+/** @} */
+/** @} */
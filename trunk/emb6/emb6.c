@@ -65,6 +65,8 @@
 #include "linkaddr.h"
 #include "ctimer.h"
 #include "random.h"
+#include "trace.h"
+#include "logger.h"
 
 
 
@@ -165,6 +167,9 @@ static int8_t loc_emb6DagRootInit(void)
 uint8_t loc_emb6NetstackInit(s_ns_t * ps_ns)
 {
 	/* Initialize stack protocols */
+#if TRACE_CONF_ENABLE
+	trace_init();
+#endif /* TRACE_CONF_ENABLE */
 	queuebuf_init();
 	ctimer_init();
 	if ((ps_ns->hc != NULL) && (ps_ns->llsec != NULL) && (ps_ns->hmac != NULL) &&
@@ -237,12 +242,40 @@ s_ns_t * emb6_get(void)
 
 void emb6_process(uint16_t us_delay)
 {
+	clock_time_t	l_now;
+	clock_time_t	l_deadline;
+	clock_time_t	l_maxSleep;
+
+	/* Maximal idle time in ticks, at least one tick if limited */
+	l_maxSleep = ((clock_time_t)us_delay * bsp_get(E_BSP_GET_TRES) + 999999UL) /
+				 1000000UL;
+
 	/* Attention: emb6 main process loop !! do not change !! */
 	while(1)
 	{
 		evproc_nextEvent();
 		etimer_request_poll();
-		bsp_delay_us(us_delay);
+
+		if (evproc_pending())
+			continue;
+
+#if LOGGER_DEFERRED
+		/* Write the deferred log messages while there is nothing else
+		 * to do, a few at a time so events are not delayed */
+		if (logger_flush(LOGGER_FLUSH_RECORDS))
+			continue;
+#endif /* LOGGER_DEFERRED */
+
+		/* Nothing to do: sleep until the next timer expires, an event is
+		 * posted or the maximal idle time has elapsed */
+		l_now = bsp_getTick();
+		l_deadline = etimer_next_expiration_time();
+		if ((l_maxSleep != 0) && ((l_deadline == 0) ||
+			((signed long)(l_deadline - (l_now + l_maxSleep)) > 0)))
+			l_deadline = l_now + l_maxSleep;
+		if ((l_deadline != 0) && ((signed long)(l_deadline - l_now) <= 0))
+			continue;
+		bsp_sleepUntil(l_deadline);
 	}
 }
 
@@ -361,6 +361,15 @@ typedef const struct netstack_interface {
 
 	/** Set RF Switch*/
 	void (* ant_rf_switch)(uint8_t value);
+
+	/** Clear channel assessment, returns 1 if the channel is clear.
+	 *  NULL if the transceiver can not assess the channel on request, the
+	 *  MAC relies on the channel access of the transmission then. */
+	int8_t (* cca)(void);
+
+	/** Tune to a channel, returns 1 on success. NULL if the channel is
+	 *  fixed by the board configuration. */
+	int8_t (* set_channel)(uint8_t channel);
 }s_nsIf_t;
 
 /*! Supported headers compression handlers */
@@ -376,11 +385,15 @@ extern const s_nsllsec_t 		nullsec_driver;
 
 /*! Supported high mac handlers */
 extern const s_nsHighMac_t 		nullmac_driver;
+extern const s_nsHighMac_t 		csma_driver;
+extern const s_nsHighMac_t 		tsch_driver;
 
 
 /*! Supported low mac handlers */
 extern const s_nsLowMac_t 		sicslowmac_driver;
 extern const s_nsLowMac_t 		nullrdc_driver;
+extern const s_nsLowMac_t 		contikimac_driver;
+extern const s_nsLowMac_t 		tschrdc_driver;
 
 
 /*! Supported framers */
@@ -427,9 +440,12 @@ uint8_t emb6_init(s_ns_t * ps_netstack);
 /*!
 \brief   emb6 process function
 
-		This function handles all the events and timers of the emb6 stack in a loop
+		This function handles all the events and timers of the emb6 stack in a loop.
+		Whenever no event is pending the MCU is put to sleep until the next
+		event timer expires or an event is posted.
 
-\param 	 delay sets a delay in µs at the end of the function
+\param 	 delay maximal idle sleep time in µs, 0 sleeps until the next timer
+		 or event
 
 \return  none
 
@@ -463,6 +479,18 @@ s_ns_t * emb6_get(void);
 #define QUEUEBUF_CONF_REF_NUM     			1
 #endif
 
+/* The AT86RF2xx drivers receive frames into a ring of packet descriptors,
+ * the depth is a power of two, see rxring.h */
+#if defined(IF_AT86RF230) || defined(IF_AT86RF212) || defined(IF_AT86RF212B)
+#ifndef RXRING_CONF_SIZE
+#define RXRING_CONF_SIZE					4
+#endif
+
+#ifndef PACKETBUF_CONF_RX_SLOTS
+#define PACKETBUF_CONF_RX_SLOTS				RXRING_CONF_SIZE
+#endif
+#endif
+
 
 #endif /* EMB6_H_ */
 
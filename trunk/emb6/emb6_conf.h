@@ -120,12 +120,23 @@
 /** Do we support 6lowpan fragmentation */
 #define SICSLOWPAN_CONF_FRAG      			TRUE
 
+/** Send the fragments of a datagram as a burst, all but the last one set
+ *  the frame pending bit */
+#ifndef SICSLOWPAN_CONF_FRAG_BURST
+#define SICSLOWPAN_CONF_FRAG_BURST			TRUE
+#endif
+
 /** Most browsers reissue GETs after 3 seconds which stops frag reassembly, longer MAXAGE does no good */
 #define SICSLOWPAN_CONF_MAXAGE    			3
 
 /** Do we compress the IP header or not */
 #define SICSLOWPAN_CONF_COMPRESSION       	SICSLOWPAN_COMPRESSION_HC06
 
+/** Export the HC06 compressor and decompressor, used by the benchmarks */
+#ifndef SICSLOWPAN_CONF_HC06_API
+#define SICSLOWPAN_CONF_HC06_API			FALSE
+#endif
+
 /** To avoid unnecessary complexity, we assume the common case of
    a constant LoWPAN-wide IEEE 802.15.4 security level, which
    can be specified by defining LLSEC802154_CONF_SECURITY_LEVEL. */
@@ -177,8 +188,10 @@
 #define UIP_CONF_IPV6_RPL           		TRUE
 #endif
 
-/** Set to 1 to enable RPL statistics */
-#define	RPL_CONF_STATS						FALSE
+/** Set to 1 to enable RPL statistics, on with the statistics registry */
+#ifndef RPL_CONF_STATS
+#define	RPL_CONF_STATS						STATS_CONF_ENABLE
+#endif
 
 #define	RPL_CONF_DAO_LATENCY				bsp_get(E_BSP_GET_TRES)
 #define RPL_CONF_DAG_MC						RPL_DAG_MC_ETX
@@ -710,6 +723,19 @@
 #endif /* UIP_CONF_BUFFER_SIZE */
 
 
+/** Register the statistics counters of all layers (see stats.h) */
+#ifndef STATS_CONF_ENABLE
+#define STATS_CONF_ENABLE					FALSE
+#endif
+
+/** The registry exports the IP statistics as well */
+#if STATS_CONF_ENABLE && !defined(UIP_CONF_STATISTICS)
+#define UIP_CONF_STATISTICS					1
+#endif
+#if STATS_CONF_ENABLE && !defined(UIP_MCAST6_CONF_STATS)
+#define UIP_MCAST6_CONF_STATS				1
+#endif
+
 /**
  * Determines if statistics support should be compiled in.
  *
@@ -796,6 +822,14 @@ void uip_log(char *msg);
 #define UIP_BYTE_ORDER     (UIP_LITTLE_ENDIAN)
 #endif /* UIP_CONF_BYTE_ORDER */
 
+/*=============================================================================
+                                 TRACE SECTION
+ ===============================================================================*/
+/** Record the packets passing the layers of the netstack (see trace.h) */
+#ifndef TRACE_CONF_ENABLE
+#define TRACE_CONF_ENABLE					FALSE
+#endif
+
  /*=============================================================================
                                  DEBUG ENABLER SECTION
  ===============================================================================*/
@@ -811,6 +845,8 @@ void uip_log(char *msg);
  #define LOGGER_DEMO_EXUDP					FALSE
  /** DEMO UDP example						(see demo_coap_*.c) */
  #define LOGGER_DEMO_COAP					FALSE
+ /** DEMO tun border router					(see demo_tunbr.c) */
+ #define LOGGER_DEMO_TUNBR					FALSE
  /** Event timer functions					(see etimer.c) */
  #define LOGGER_ETIMER						FALSE
  /** Callback timer functions				(see ctimer.c) */
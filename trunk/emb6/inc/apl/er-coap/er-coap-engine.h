@@ -44,12 +44,25 @@
 #include "er-coap-transactions.h"
 #include "er-coap-observe.h"
 #include "er-coap-separate.h"
+#include "stats.h"
 
 #define SERVER_LISTEN_PORT      UIP_HTONS(COAP_SERVER_PORT)
 
 typedef coap_packet_t rest_request_t;
 typedef coap_packet_t rest_response_t;
 
+#if STATS_CONF_ENABLE
+/* Counters of the engine, exported by the statistics registry */
+struct coap_stats {
+  uint16_t rx;          /* Messages received */
+  uint16_t rx_err;      /* Messages answered with an error */
+  uint16_t tx;          /* Transactions sent */
+  uint16_t retransmit;  /* Retransmissions of confirmable messages */
+  uint16_t timeout;     /* Confirmable messages never acknowledged */
+};
+extern struct coap_stats coap_stats;
+#endif /* STATS_CONF_ENABLE */
+
 void coap_init_engine(void);
 
 void coap_engine_callback(c_event_t c_event, p_data_t p_data);
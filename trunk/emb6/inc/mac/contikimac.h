@@ -0,0 +1,187 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Radio duty cycling low MAC in the style of ContikiMAC.
+ *
+ *         The radio is off most of the time. Every channel check interval
+ *         the receiver is switched on for two short clear channel
+ *         assessments. If one of them finds energy, the radio stays on as
+ *         long as the channel is active and goes back to sleep as soon as
+ *         the channel is silent (fast sleep).
+ *
+ *         A sender repeats its frame back to back (strobe) for up to a
+ *         full channel check interval. A unicast strobe ends with the
+ *         acknowledgement of the receiver, a broadcast strobe always lasts
+ *         the full interval. The time of every acknowledgement is kept per
+ *         neighbor, later packets to the neighbor are deferred until
+ *         shortly before it wakes up (phase lock), which shortens the
+ *         strobes. The frames of a packet list are sent as a burst: all
+ *         but the last one carry the frame pending bit, which keeps the
+ *         receiver awake, so only the first one is strobed.
+ *
+ *         The timing assumes a transceiver with automatic
+ *         acknowledgements whose send() waits for the acknowledgement and
+ *         which provides cca(). Without cca() the radio is never switched
+ *         off, the node still reaches duty cycled neighbors.
+ */
+
+#ifndef CONTIKIMAC_H_
+#define CONTIKIMAC_H_
+
+#include "rdc.h"
+
+/** Channel checks per second */
+#ifdef CONTIKIMAC_CONF_CHANNEL_CHECK_RATE
+#define CONTIKIMAC_CHANNEL_CHECK_RATE CONTIKIMAC_CONF_CHANNEL_CHECK_RATE
+#else
+#define CONTIKIMAC_CHANNEL_CHECK_RATE 8
+#endif
+
+/** Clear channel assessments of a channel check */
+#ifdef CONTIKIMAC_CONF_CCA_COUNT_MAX
+#define CONTIKIMAC_CCA_COUNT_MAX CONTIKIMAC_CONF_CCA_COUNT_MAX
+#else
+#define CONTIKIMAC_CCA_COUNT_MAX 2
+#endif
+
+/** Clear channel assessments before a strobe */
+#ifdef CONTIKIMAC_CONF_CCA_COUNT_MAX_TX
+#define CONTIKIMAC_CCA_COUNT_MAX_TX CONTIKIMAC_CONF_CCA_COUNT_MAX_TX
+#else
+#define CONTIKIMAC_CCA_COUNT_MAX_TX 6
+#endif
+
+/** Time the receiver needs for a clear channel assessment in microseconds */
+#ifdef CONTIKIMAC_CONF_CCA_CHECK_TIME_US
+#define CONTIKIMAC_CCA_CHECK_TIME_US CONTIKIMAC_CONF_CCA_CHECK_TIME_US
+#else
+#define CONTIKIMAC_CCA_CHECK_TIME_US 128
+#endif
+
+/** Sleep between two clear channel assessments in microseconds. Together
+ *  with CONTIKIMAC_CCA_CHECK_TIME_US it has to be longer than the gap
+ *  between two frames of a strobe, including the acknowledgement wait of
+ *  the transceiver. */
+#ifdef CONTIKIMAC_CONF_CCA_SLEEP_TIME_US
+#define CONTIKIMAC_CCA_SLEEP_TIME_US CONTIKIMAC_CONF_CCA_SLEEP_TIME_US
+#else
+#define CONTIKIMAC_CCA_SLEEP_TIME_US 800
+#endif
+
+/** Gap between two frames of a broadcast strobe in microseconds */
+#ifdef CONTIKIMAC_CONF_INTER_PACKET_INTERVAL_US
+#define CONTIKIMAC_INTER_PACKET_INTERVAL_US CONTIKIMAC_CONF_INTER_PACKET_INTERVAL_US
+#else
+#define CONTIKIMAC_INTER_PACKET_INTERVAL_US 400
+#endif
+
+/** Silence after which a receiver which detected activity sleeps again,
+ *  in microseconds */
+#ifdef CONTIKIMAC_CONF_MAX_SILENCE_US
+#define CONTIKIMAC_MAX_SILENCE_US CONTIKIMAC_CONF_MAX_SILENCE_US
+#else
+#define CONTIKIMAC_MAX_SILENCE_US 1000
+#endif
+
+/** Longest time a receiver stays awake for activity on the channel, in
+ *  microseconds, about two frames of maximum length */
+#ifdef CONTIKIMAC_CONF_LISTEN_TIME_AFTER_PACKET_DETECTED_US
+#define CONTIKIMAC_LISTEN_TIME_AFTER_PACKET_DETECTED_US CONTIKIMAC_CONF_LISTEN_TIME_AFTER_PACKET_DETECTED_US
+#else
+#define CONTIKIMAC_LISTEN_TIME_AFTER_PACKET_DETECTED_US 10000
+#endif
+
+/** Time the receiver stays awake after a frame with the pending bit, in
+ *  clock ticks */
+#ifdef CONTIKIMAC_CONF_AFTER_PENDING_WAIT
+#define CONTIKIMAC_AFTER_PENDING_WAIT CONTIKIMAC_CONF_AFTER_PENDING_WAIT
+#else
+#define CONTIKIMAC_AFTER_PENDING_WAIT (bsp_get(E_BSP_GET_TRES) / 100 + 1)
+#endif
+
+/** Time a phase locked strobe starts before the neighbor wakes up, in
+ *  clock ticks. It covers a clock tick, the channel check and the frame
+ *  whose energy woke the neighbor up */
+#ifdef CONTIKIMAC_CONF_GUARD_TIME
+#define CONTIKIMAC_GUARD_TIME CONTIKIMAC_CONF_GUARD_TIME
+#else
+#define CONTIKIMAC_GUARD_TIME (bsp_get(E_BSP_GET_TRES) / 125 + 1)
+#endif
+
+/** Neighbors whose wake up phase is kept, 0 disables the phase lock */
+#ifdef CONTIKIMAC_CONF_MAX_PHASES
+#define CONTIKIMAC_MAX_PHASES CONTIKIMAC_CONF_MAX_PHASES
+#else
+#define CONTIKIMAC_MAX_PHASES 8
+#endif
+
+/** Strobes without acknowledgement after which a phase is forgotten */
+#ifdef CONTIKIMAC_CONF_MAX_NOACKS
+#define CONTIKIMAC_MAX_NOACKS CONTIKIMAC_CONF_MAX_NOACKS
+#else
+#define CONTIKIMAC_MAX_NOACKS 2
+#endif
+
+/** Packets waiting for the wake up of their receiver at the same time */
+#ifdef CONTIKIMAC_CONF_MAX_DEFERRED
+#define CONTIKIMAC_MAX_DEFERRED CONTIKIMAC_CONF_MAX_DEFERRED
+#else
+#define CONTIKIMAC_MAX_DEFERRED 4
+#endif
+
+/** Senders whose last sequence number is kept to drop repeated frames */
+#ifdef CONTIKIMAC_CONF_MAX_SEQNOS
+#define CONTIKIMAC_MAX_SEQNOS CONTIKIMAC_CONF_MAX_SEQNOS
+#else
+#define CONTIKIMAC_MAX_SEQNOS 8
+#endif
+
+/**
+ * \brief      Change the channel check rate at run time
+ * \param rate Channel checks per second, 1 to the clock ticks per second
+ *
+ *             The wake up phases learned so far are forgotten. All nodes
+ *             of a network have to use the same rate.
+ */
+void contikimac_set_channel_check_rate(uint16_t rate);
+
+#endif /* CONTIKIMAC_H_ */
@@ -0,0 +1,130 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         CSMA/CA high MAC with a transmit queue per neighbor.
+ *
+ *         Every packet is put into the queue of its receiver. The queues
+ *         are served round robin, one transmission attempt at a time, so
+ *         a neighbor with many packets or a bad link can not block the
+ *         others. Before every attempt the MAC waits a random backoff of
+ *         up to 2^BE - 1 backoff periods and checks that the channel is
+ *         clear. A busy channel doubles the backoff window, a missing
+ *         acknowledgement or a collision reported by the transceiver
+ *         repeats the packet until the retry limit is reached.
+ *
+ *         A packet that announces a following packet to the same
+ *         neighbor with PACKETBUF_ATTR_PENDING, like the fragments of a
+ *         datagram, is sent by the low MAC together with the following
+ *         packets as a burst after a single channel access.
+ */
+
+#ifndef CSMA_H_
+#define CSMA_H_
+
+#include "mac.h"
+#include "queuebuf.h"
+
+/** Smallest backoff exponent */
+#ifdef CSMA_CONF_MIN_BE
+#define CSMA_MIN_BE CSMA_CONF_MIN_BE
+#else
+#define CSMA_MIN_BE 3
+#endif
+
+/** Largest backoff exponent */
+#ifdef CSMA_CONF_MAX_BE
+#define CSMA_MAX_BE CSMA_CONF_MAX_BE
+#else
+#define CSMA_MAX_BE 5
+#endif
+
+/** Busy channel assessments before a transmission attempt is given up */
+#ifdef CSMA_CONF_MAX_BACKOFFS
+#define CSMA_MAX_BACKOFFS CSMA_CONF_MAX_BACKOFFS
+#else
+#define CSMA_MAX_BACKOFFS 4
+#endif
+
+/** Retransmissions of a packet if the packet does not set
+ *  PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS */
+#ifdef CSMA_CONF_MAX_FRAME_RETRIES
+#define CSMA_MAX_FRAME_RETRIES CSMA_CONF_MAX_FRAME_RETRIES
+#else
+#define CSMA_MAX_FRAME_RETRIES 3
+#endif
+
+/** Backoff period in clock ticks */
+#ifdef CSMA_CONF_BACKOFF_PERIOD
+#define CSMA_BACKOFF_PERIOD CSMA_CONF_BACKOFF_PERIOD
+#else
+#define CSMA_BACKOFF_PERIOD 1
+#endif
+
+/** Neighbors with packets in their queue at the same time */
+#ifdef CSMA_CONF_MAX_NEIGHBOR_QUEUES
+#define CSMA_MAX_NEIGHBOR_QUEUES CSMA_CONF_MAX_NEIGHBOR_QUEUES
+#else
+#define CSMA_MAX_NEIGHBOR_QUEUES 4
+#endif
+
+/** Packets in all queues, each one holds a queuebuf */
+#ifdef CSMA_CONF_MAX_PACKETS
+#define CSMA_MAX_PACKETS CSMA_CONF_MAX_PACKETS
+#else
+#define CSMA_MAX_PACKETS QUEUEBUF_NUM
+#endif
+
+/** Packets in the queue of a single neighbor */
+#ifdef CSMA_CONF_MAX_PACKETS_PER_NEIGHBOR
+#define CSMA_MAX_PACKETS_PER_NEIGHBOR CSMA_CONF_MAX_PACKETS_PER_NEIGHBOR
+#else
+#define CSMA_MAX_PACKETS_PER_NEIGHBOR CSMA_MAX_PACKETS
+#endif
+
+/** Packets sent back to back in a burst, 1 disables bursts */
+#ifdef CSMA_CONF_MAX_BURST
+#define CSMA_MAX_BURST CSMA_CONF_MAX_BURST
+#else
+#define CSMA_MAX_BURST 8
+#endif
+
+#endif /* CSMA_H_ */
@@ -93,6 +93,7 @@
 
 #define FRAME802154_IEEE802154_2003 (0x00)
 #define FRAME802154_IEEE802154_2006 (0x01)
+#define FRAME802154_IEEE802154_2015 (0x02)
 
 #define FRAME802154_SECURITY_LEVEL_NONE        (0)
 #define FRAME802154_SECURITY_LEVEL_MIC_32      (1)
@@ -131,7 +132,9 @@ typedef struct {
   uint8_t frame_pending;     /**< 1 bit. True if sender has more data to send */
   uint8_t ack_required;      /**< 1 bit. Is an ack frame required? */
   uint8_t panid_compression; /**< 1 bit. Is this a compressed header? */
-  /*   uint8_t reserved; */  /**< 3 bit. Unused bits */
+  /*   uint8_t reserved; */  /**< 1 bit. Unused bit */
+  uint8_t sequence_number_suppression; /**< 1 bit. 2015 frames: no sequence number */
+  uint8_t ie_list_present;   /**< 1 bit. 2015 frames: information elements follow the header */
   uint8_t dest_addr_mode;    /**< 2 bit. Destination address mode, see 802.15.4 */
   uint8_t frame_version;     /**< 2 bit. 802.15.4 frame version */
   uint8_t src_addr_mode;     /**< 2 bit. Source address mode, see 802.15.4 */
@@ -178,12 +181,16 @@ typedef struct {
 	uint16_t dest_pid;              /**< Destination PAN ID */
 	uint16_t src_pid;               /**< Source PAN ID */
 	frame802154_aux_hdr_t aux_hdr;  /**< Aux security header */
-	uint8_t *payload;               /**< Pointer to 802.15.4 payload */
+	uint8_t *payload;               /**< Pointer to 802.15.4 payload, the
+	                                     information elements of 2015 frames
+	                                     are part of it */
 	int payload_len;                /**< Length of payload field */
 } frame802154_t;
 
 /* Prototypes */
 
+void frame802154_has_panid(frame802154_fcf_t *fcf, int *has_src_pan_id,
+                           int *has_dest_pan_id);
 int frame802154_hdrlen(frame802154_t *p);
 int frame802154_create(frame802154_t *p, uint8_t *buf);
 int frame802154_parse(uint8_t *data, int length, frame802154_t *pf);
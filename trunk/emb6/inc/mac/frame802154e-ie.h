@@ -0,0 +1,162 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Information elements of IEEE 802.15.4e used by TSCH.
+ *
+ *         Header IEs follow the MAC header of a 2015 frame, payload IEs
+ *         follow the header IEs. The header IE list ends with a header
+ *         termination IE (HT1 if payload IEs follow, HT2 if payload data
+ *         follows), the payload IE list with a payload termination IE if
+ *         payload data follows. TSCH needs the time correction header IE
+ *         and the MLME payload IE with the TSCH synchronization, slotframe
+ *         and link, timeslot and channel hopping nested IEs.
+ *
+ *         Every create function writes one IE into buf, returns its length
+ *         or -1 if it does not fit into len bytes.
+ */
+
+#ifndef FRAME_802154E_IE_H_
+#define FRAME_802154E_IE_H_
+
+#include "emb6.h"
+
+/** Links of a slotframe which can be announced in an EB */
+#ifdef FRAME802154E_IE_CONF_MAX_LINKS
+#define FRAME802154E_IE_MAX_LINKS FRAME802154E_IE_CONF_MAX_LINKS
+#else
+#define FRAME802154E_IE_MAX_LINKS 4
+#endif
+
+/** Longest channel hopping sequence carried in an IE */
+#define FRAME802154E_IE_MAX_HOPPING 16
+
+/* Header IE element ids */
+#define HEADER_IE_ACK_NACK_TIME_CORRECTION 0x1e
+#define HEADER_IE_LIST_TERMINATION_1       0x7e
+#define HEADER_IE_LIST_TERMINATION_2       0x7f
+
+/* Payload IE group ids */
+#define PAYLOAD_IE_MLME                    0x1
+#define PAYLOAD_IE_LIST_TERMINATION        0xf
+
+/* Nested MLME IE sub ids */
+#define MLME_SHORT_IE_TSCH_SYNCHRONIZATION       0x1a
+#define MLME_SHORT_IE_TSCH_SLOTFRAME_AND_LINK    0x1b
+#define MLME_SHORT_IE_TSCH_TIMESLOT              0x1c
+#define MLME_LONG_IE_TSCH_CHANNEL_HOPPING_SEQUENCE 0x9
+
+/** Absolute slot number, 5 bytes */
+struct tsch_asn_t {
+  uint32_t ls4b;
+  uint8_t ms1b;
+};
+
+/** Link of the slotframe and link IE */
+struct tsch_slotframe_and_links_link {
+  uint16_t timeslot;
+  uint16_t channel_offset;
+  uint8_t link_options;
+};
+
+/** Slotframe and link IE, a single slotframe is supported */
+struct tsch_slotframe_and_links {
+  uint8_t num_slotframes;
+  uint8_t slotframe_handle;
+  uint16_t slotframe_size;
+  uint8_t num_links;
+  struct tsch_slotframe_and_links_link links[FRAME802154E_IE_MAX_LINKS];
+};
+
+/** Content of the information elements of a frame */
+struct ieee802154_ies {
+  /* Header IEs */
+  int16_t ie_time_correction;
+  uint8_t ie_is_nack;
+  /* Payload MLME IE, length of the nested IEs */
+  uint16_t ie_mlme_len;
+  /* Nested MLME IEs, the offset of the synchronization IE from the start
+   * of the parsed or created IEs allows to update the ASN in place */
+  uint8_t ie_tsch_synchronization_offset;
+  struct tsch_asn_t ie_asn;
+  uint8_t ie_join_priority;
+  uint8_t ie_tsch_timeslot_id;
+  struct tsch_slotframe_and_links ie_tsch_slotframe_and_link;
+  uint8_t ie_channel_hopping_sequence_id;
+  uint8_t ie_hopping_sequence_len;
+  uint8_t ie_hopping_sequence[FRAME802154E_IE_MAX_HOPPING];
+};
+
+/* Header IEs */
+int frame80215e_create_ie_header_ack_nack_time_correction(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+int frame80215e_create_ie_header_list_termination_1(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+int frame80215e_create_ie_header_list_termination_2(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+/* Payload IEs */
+int frame80215e_create_ie_payload_list_termination(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+int frame80215e_create_ie_mlme(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+/* Nested MLME IEs */
+int frame80215e_create_ie_tsch_synchronization(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+int frame80215e_create_ie_tsch_slotframe_and_link(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+int frame80215e_create_ie_tsch_timeslot(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+int frame80215e_create_ie_tsch_channel_hopping_sequence(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+
+/**
+ * \brief      Parse the information elements at the start of the payload
+ *             of a 2015 frame
+ * \param buf  First byte after the MAC header
+ * \param buf_size Bytes after the MAC header
+ * \param ies  Receives the content of the known IEs
+ * \return     Length of all IEs including the terminations, -1 if an IE
+ *             is malformed
+ */
+int frame802154e_parse_information_elements(const uint8_t *buf,
+    uint8_t buf_size, struct ieee802154_ies *ies);
+
+#endif /* FRAME_802154E_IE_H_ */
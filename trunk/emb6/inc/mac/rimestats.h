@@ -58,6 +58,11 @@ struct rimestats {
 
 extern struct rimestats rimestats;
 
+/* The counters are exported by the statistics registry (see stats.h) */
+#if STATS_CONF_ENABLE
 #define RIMESTATS_ADD(x) rimestats.x++
+#else
+#define RIMESTATS_ADD(x)
+#endif
 
 #endif /* RIMESTATS_H_ */
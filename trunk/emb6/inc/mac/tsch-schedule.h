@@ -0,0 +1,233 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Slotframes and links of TSCH.
+ *
+ *         A slotframe is a sequence of timeslots which repeats itself, the
+ *         timeslot of an absolute slot number (ASN) is the ASN modulo the
+ *         size of the slotframe. A link makes a node transmit or receive
+ *         in a timeslot of a slotframe at a channel offset. Several
+ *         slotframes run at the same time; if links of several slotframes
+ *         or several links of one slotframe fall into the same slot, a
+ *         transmit link with a packet wins, otherwise the link of the
+ *         slotframe with the lowest handle.
+ *
+ *         A link to the broadcast address (linkaddr_null) serves the
+ *         broadcast packets, the enhanced beacons and the unicast packets
+ *         to neighbors without a dedicated transmit link.
+ */
+
+#ifndef TSCH_SCHEDULE_H_
+#define TSCH_SCHEDULE_H_
+
+#include "emb6.h"
+#include "linkaddr.h"
+#include "clist.h"
+#include "frame802154e-ie.h"
+
+/** Slotframes which can be active at the same time */
+#ifdef TSCH_SCHEDULE_CONF_MAX_SLOTFRAMES
+#define TSCH_SCHEDULE_MAX_SLOTFRAMES TSCH_SCHEDULE_CONF_MAX_SLOTFRAMES
+#else
+#define TSCH_SCHEDULE_MAX_SLOTFRAMES 4
+#endif
+
+/** Links of all slotframes */
+#ifdef TSCH_SCHEDULE_CONF_MAX_LINKS
+#define TSCH_SCHEDULE_MAX_LINKS TSCH_SCHEDULE_CONF_MAX_LINKS
+#else
+#define TSCH_SCHEDULE_MAX_LINKS 32
+#endif
+
+/** Size of the slotframe of the 6TiSCH minimal schedule */
+#ifdef TSCH_SCHEDULE_CONF_DEFAULT_LENGTH
+#define TSCH_SCHEDULE_DEFAULT_LENGTH TSCH_SCHEDULE_CONF_DEFAULT_LENGTH
+#else
+#define TSCH_SCHEDULE_DEFAULT_LENGTH 7
+#endif
+
+/* Link options, as in the slotframe and link IE */
+#define LINK_OPTION_TX              1
+#define LINK_OPTION_RX              2
+#define LINK_OPTION_SHARED          4
+#define LINK_OPTION_TIME_KEEPING    8
+
+/** Kind of traffic a link carries */
+enum link_type {
+  LINK_TYPE_NORMAL,
+  LINK_TYPE_ADVERTISING,
+  LINK_TYPE_ADVERTISING_ONLY,
+};
+
+struct tsch_link {
+  struct tsch_link *next;
+  /* Neighbor, linkaddr_null for broadcast links */
+  linkaddr_t addr;
+  uint16_t slotframe_handle;
+  uint16_t timeslot;
+  uint16_t channel_offset;
+  uint8_t link_options;
+  enum link_type link_type;
+};
+
+struct tsch_slotframe {
+  struct tsch_slotframe *next;
+  uint16_t handle;
+  uint16_t size;
+  LIST_STRUCT(links_list);
+};
+
+/**
+ * \brief      Callbacks of a scheduler which adds links of its own to the
+ *             schedule, e.g. an autonomous one. Every callback may be NULL.
+ */
+struct tsch_scheduler {
+  const char *name;
+  /** The node started a network or joined one, the schedule of the
+   *  network (the minimal one or the one of the EB) is installed */
+  void (* init)(void);
+  /** The time source changed, old or new are NULL when there is none */
+  void (* new_time_source)(const linkaddr_t *old, const linkaddr_t *new);
+  /** A unicast neighbor got a transmit queue */
+  void (* neighbor_added)(const linkaddr_t *addr);
+  /** The transmit queue of a unicast neighbor was removed */
+  void (* neighbor_removed)(const linkaddr_t *addr);
+};
+
+/**
+ * Receiver based autonomous scheduler in the style of Orchestra. Every
+ * node listens in the timeslot of its own address in a slotframe of its
+ * own and sends to a neighbor in the timeslot of the address of the
+ * neighbor. The links are derived from the addresses, no signaling is
+ * needed. Broadcasts and EBs keep using the schedule of the network.
+ */
+extern const struct tsch_scheduler tsch_scheduler_autonomous;
+
+/** Size of the slotframe of the autonomous scheduler, best a prime which
+ *  is not a multiple of the size of the minimal slotframe */
+#ifdef TSCH_AUTONOMOUS_CONF_PERIOD
+#define TSCH_AUTONOMOUS_PERIOD TSCH_AUTONOMOUS_CONF_PERIOD
+#else
+#define TSCH_AUTONOMOUS_PERIOD 17
+#endif
+
+/** Handle of the slotframe of the autonomous scheduler, a higher handle
+ *  than the one of the network has a lower priority */
+#ifdef TSCH_AUTONOMOUS_CONF_SLOTFRAME_HANDLE
+#define TSCH_AUTONOMOUS_SLOTFRAME_HANDLE TSCH_AUTONOMOUS_CONF_SLOTFRAME_HANDLE
+#else
+#define TSCH_AUTONOMOUS_SLOTFRAME_HANDLE 1
+#endif
+
+/** Channel offset of the links of the autonomous scheduler */
+#ifdef TSCH_AUTONOMOUS_CONF_CHANNEL_OFFSET
+#define TSCH_AUTONOMOUS_CHANNEL_OFFSET TSCH_AUTONOMOUS_CONF_CHANNEL_OFFSET
+#else
+#define TSCH_AUTONOMOUS_CHANNEL_OFFSET 1
+#endif
+
+/** \brief Remove all slotframes and links */
+void tsch_schedule_init(void);
+
+/** \brief Install the 6TiSCH minimal schedule, slotframe 0 with one shared
+ *         advertising link at timeslot 0 */
+void tsch_schedule_create_minimal(void);
+
+/**
+ * \brief      Add a slotframe
+ * \return     The slotframe, NULL if the handle is in use or no memory is left
+ */
+struct tsch_slotframe *tsch_schedule_add_slotframe(uint16_t handle,
+                                                   uint16_t size);
+
+/** \brief Remove a slotframe and its links, returns 1 on success */
+int tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe);
+
+/** \brief Remove all slotframes and their links */
+void tsch_schedule_remove_all_slotframes(void);
+
+/** \brief Slotframe with a handle, NULL if there is none */
+struct tsch_slotframe *tsch_schedule_get_slotframe_by_handle(uint16_t handle);
+
+/**
+ * \brief      Add a link to a slotframe. A slotframe may have several links
+ *             in a timeslot.
+ * \param address Neighbor, linkaddr_null or NULL for a broadcast link
+ * \return     The link, NULL if no memory is left
+ */
+struct tsch_link *tsch_schedule_add_link(struct tsch_slotframe *slotframe,
+                                         uint8_t link_options,
+                                         enum link_type link_type,
+                                         const linkaddr_t *address,
+                                         uint16_t timeslot,
+                                         uint16_t channel_offset);
+
+/** \brief Remove a link, returns 1 on success */
+int tsch_schedule_remove_link(struct tsch_slotframe *slotframe,
+                              struct tsch_link *link);
+
+/** \brief Remove the links of a slotframe in a timeslot to a neighbor */
+void tsch_schedule_remove_link_by_address(struct tsch_slotframe *slotframe,
+                                          uint16_t timeslot,
+                                          const linkaddr_t *address);
+
+/** \brief Slotframe following a slotframe in the order of the handles,
+ *         the first one for NULL */
+struct tsch_slotframe *tsch_schedule_get_slotframe_next(struct tsch_slotframe *sf);
+
+/** \brief Link following a link of a slotframe, the first one for NULL */
+struct tsch_link *tsch_schedule_get_link_next(struct tsch_slotframe *slotframe,
+                                              struct tsch_link *link);
+
+/**
+ * \brief      Slots from an ASN to the next slot with a link
+ * \return     1 to the size of the longest slotframe, 0 without any link
+ */
+uint16_t tsch_schedule_get_next_active_link(const struct tsch_asn_t *asn);
+
+/** \brief Whether a neighbor has a transmit link of its own */
+int tsch_schedule_has_tx_link(const linkaddr_t *address);
+
+/** \brief Timeslot of an ASN in a slotframe of a size */
+uint16_t tsch_asn_mod(const struct tsch_asn_t *asn, uint16_t size);
+
+#endif /* TSCH_SCHEDULE_H_ */
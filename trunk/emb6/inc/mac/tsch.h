@@ -0,0 +1,258 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Time slotted channel hopping (TSCH) of IEEE 802.15.4e.
+ *
+ *         Time is divided into timeslots numbered by the absolute slot
+ *         number (ASN). The schedule (tsch-schedule.h) tells in which
+ *         timeslots a node transmits or listens and on which channel
+ *         offset; the channel of a slot is taken from the hopping
+ *         sequence at (ASN + channel offset). Outside its active slots
+ *         the radio is off.
+ *
+ *         tsch_driver is the high MAC: it keeps a transmit queue per
+ *         neighbor, runs the slots, sends enhanced beacons (EBs) and
+ *         joins a network. tschrdc_driver is the low MAC which it needs:
+ *         it frames a packet and operates the radio within a slot.
+ *
+ *         A coordinator (tsch_set_coordinator()) starts a network with
+ *         the 6TiSCH minimal schedule, every other node scans the
+ *         channels of the hopping sequence for an EB. The EB carries the
+ *         ASN, the join priority, the hopping sequence and the links of
+ *         the slotframe. A node which joined keeps its slots aligned to
+ *         the EBs and frames of its time source, the node whose EB it
+ *         joined with, and sends EBs itself. Without any frame of the time
+ *         source for TSCH_DESYNC_THRESHOLD it leaves the network and scans
+ *         again.
+ *
+ *         Slots start at clock ticks, the timing within a slot uses
+ *         bsp_delay_us(). The time of a received frame is the clock tick
+ *         at the end of the reception, which limits the synchronization
+ *         to about a clock tick. It has to stay well below the TxOffset.
+ *         The acknowledgements are those of the transceiver, time
+ *         corrections are not exchanged with them.
+ *
+ *         Channel hopping needs set_channel() of the transceiver
+ *         interface, without it all slots use the channel of the board
+ *         configuration.
+ */
+
+#ifndef TSCH_H_
+#define TSCH_H_
+
+#include "emb6.h"
+#include "mac.h"
+#include "linkaddr.h"
+#include "tsch-schedule.h"
+
+/** Length of a timeslot in clock ticks */
+#ifdef TSCH_CONF_TIMESLOT_LENGTH
+#define TSCH_TIMESLOT_LENGTH TSCH_CONF_TIMESLOT_LENGTH
+#else
+#define TSCH_TIMESLOT_LENGTH ((bsp_get(E_BSP_GET_TRES) + 99) / 100)
+#endif
+
+/** Start of a transmission after the start of the slot in microseconds */
+#ifdef TSCH_CONF_TS_TX_OFFSET_US
+#define TSCH_TS_TX_OFFSET_US TSCH_CONF_TS_TX_OFFSET_US
+#else
+#define TSCH_TS_TX_OFFSET_US 2120
+#endif
+
+/** Window around the TxOffset in which a receiver listens for the start
+ *  of a frame in microseconds */
+#ifdef TSCH_CONF_TS_RX_WAIT_US
+#define TSCH_TS_RX_WAIT_US TSCH_CONF_TS_RX_WAIT_US
+#else
+#define TSCH_TS_RX_WAIT_US 2200
+#endif
+
+/** Longest time a receiver stays on for a frame and its acknowledgement
+ *  after the end of the receive window in microseconds */
+#ifdef TSCH_CONF_TS_MAX_RX_US
+#define TSCH_TS_MAX_RX_US TSCH_CONF_TS_MAX_RX_US
+#else
+#define TSCH_TS_MAX_RX_US 5000
+#endif
+
+/** Airtime of a byte and synchronization and PHY header in bytes,
+ *  used to find the start of a received frame */
+#ifdef TSCH_CONF_BYTE_AIRTIME_US
+#define TSCH_BYTE_AIRTIME_US TSCH_CONF_BYTE_AIRTIME_US
+#else
+#define TSCH_BYTE_AIRTIME_US 32
+#endif
+#define TSCH_PHY_HEADER_LEN 6
+
+/** Channel hopping sequence, the first TSCH_HOPPING_SEQUENCE_LEN entries */
+#ifdef TSCH_CONF_HOPPING_SEQUENCE
+#define TSCH_HOPPING_SEQUENCE TSCH_CONF_HOPPING_SEQUENCE
+#else
+#define TSCH_HOPPING_SEQUENCE { 15, 25, 26, 20 }
+#endif
+
+/** Time a node scans a channel for an EB before it tries the next one,
+ *  in clock ticks */
+#ifdef TSCH_CONF_CHANNEL_SCAN_DURATION
+#define TSCH_CHANNEL_SCAN_DURATION TSCH_CONF_CHANNEL_SCAN_DURATION
+#else
+#define TSCH_CHANNEL_SCAN_DURATION (bsp_get(E_BSP_GET_TRES))
+#endif
+
+/** Period of the EBs in clock ticks, each one is sent after a random time
+ *  of three quarters to the full period */
+#ifdef TSCH_CONF_EB_PERIOD
+#define TSCH_EB_PERIOD TSCH_CONF_EB_PERIOD
+#else
+#define TSCH_EB_PERIOD (4 * bsp_get(E_BSP_GET_TRES))
+#endif
+
+/** Time without a frame of the time source after which a node leaves the
+ *  network, in clock ticks */
+#ifdef TSCH_CONF_DESYNC_THRESHOLD
+#define TSCH_DESYNC_THRESHOLD TSCH_CONF_DESYNC_THRESHOLD
+#else
+#define TSCH_DESYNC_THRESHOLD (16 * TSCH_EB_PERIOD)
+#endif
+
+/** EBs with a join priority from this on are ignored */
+#ifdef TSCH_CONF_MAX_JOIN_PRIORITY
+#define TSCH_MAX_JOIN_PRIORITY TSCH_CONF_MAX_JOIN_PRIORITY
+#else
+#define TSCH_MAX_JOIN_PRIORITY 32
+#endif
+
+/** Retransmissions of a unicast packet */
+#ifdef TSCH_CONF_MAC_MAX_FRAME_RETRIES
+#define TSCH_MAC_MAX_FRAME_RETRIES TSCH_CONF_MAC_MAX_FRAME_RETRIES
+#else
+#define TSCH_MAC_MAX_FRAME_RETRIES 7
+#endif
+
+/** Backoff exponents in shared links, in shared slots to skip */
+#ifdef TSCH_CONF_MAC_MIN_BE
+#define TSCH_MAC_MIN_BE TSCH_CONF_MAC_MIN_BE
+#else
+#define TSCH_MAC_MIN_BE 1
+#endif
+#ifdef TSCH_CONF_MAC_MAX_BE
+#define TSCH_MAC_MAX_BE TSCH_CONF_MAC_MAX_BE
+#else
+#define TSCH_MAC_MAX_BE 5
+#endif
+
+/** Backoff exponent of a broadcast in shared links. A broadcast is not
+ *  acknowledged, it skips a random number of shared slots before it is
+ *  sent, which breaks up senders repeating their broadcasts in lock step */
+#ifdef TSCH_CONF_MAC_BROADCAST_BE
+#define TSCH_MAC_BROADCAST_BE TSCH_CONF_MAC_BROADCAST_BE
+#else
+#define TSCH_MAC_BROADCAST_BE 2
+#endif
+
+/** Unicast neighbors with a transmit queue */
+#ifdef TSCH_CONF_QUEUE_MAX_NEIGHBOR_QUEUES
+#define TSCH_QUEUE_MAX_NEIGHBOR_QUEUES TSCH_CONF_QUEUE_MAX_NEIGHBOR_QUEUES
+#else
+#define TSCH_QUEUE_MAX_NEIGHBOR_QUEUES 8
+#endif
+
+/** Packets of all queues */
+#ifdef TSCH_CONF_QUEUE_MAX_PACKETS
+#define TSCH_QUEUE_MAX_PACKETS TSCH_CONF_QUEUE_MAX_PACKETS
+#else
+#define TSCH_QUEUE_MAX_PACKETS 8
+#endif
+
+/** Packets of a single queue */
+#ifdef TSCH_CONF_QUEUE_NUM_PER_NEIGHBOR
+#define TSCH_QUEUE_NUM_PER_NEIGHBOR TSCH_CONF_QUEUE_NUM_PER_NEIGHBOR
+#else
+#define TSCH_QUEUE_NUM_PER_NEIGHBOR 4
+#endif
+
+/** Senders whose last sequence number is kept to drop repeated frames */
+#ifdef TSCH_CONF_MAX_SEQNOS
+#define TSCH_MAX_SEQNOS TSCH_CONF_MAX_SEQNOS
+#else
+#define TSCH_MAX_SEQNOS 8
+#endif
+
+/**
+ * \brief      Make the node the coordinator of a network or a node which
+ *             joins one. A running node leaves its network.
+ */
+void tsch_set_coordinator(int enable);
+
+/** \brief Whether the node is the coordinator */
+int tsch_is_coordinator(void);
+
+/** \brief Whether the node started or joined a network */
+int tsch_is_associated(void);
+
+/**
+ * \brief      Select a scheduler which adds its links to the schedule of
+ *             the network, NULL for the schedule of the network alone.
+ *             Takes effect with the next start or join.
+ */
+void tsch_set_scheduler(const struct tsch_scheduler *scheduler);
+
+/** \brief Time source of the node, NULL if there is none */
+const linkaddr_t *tsch_time_source(void);
+
+/** \brief ASN of the current or next active slot */
+void tsch_get_asn(struct tsch_asn_t *asn);
+
+/**
+ * \brief      Operate the radio for a receive slot, used by tsch_driver
+ *
+ *             Listens for the start of a frame during the receive window
+ *             and stays on until the frame and its acknowledgement are
+ *             over. A received frame is passed to the high MAC later.
+ *             Called at the start of the slot.
+ */
+void tschrdc_listen(uint8_t channel);
+
+/** \brief Tune the radio, used by tsch_driver while scanning */
+void tschrdc_set_channel(uint8_t channel);
+
+#endif /* TSCH_H_ */
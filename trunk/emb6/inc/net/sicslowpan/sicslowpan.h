@@ -315,6 +315,27 @@ struct sicslowpan_nh_compressor {
 
 int sicslowpan_get_last_rssi(void);
 
+#if SICSLOWPAN_CONF_HC06_API
+/**
+ * \brief Compress the headers of the IPv6 packet in uip_buf to the start
+ * of the packetbuf data, like the output path does before fragmentation.
+ * \param link_destaddr L2 destination address of the packet
+ * \param uncomp_len Set to the length of the compressed uip_buf headers
+ * \return Length of the compressed headers
+ */
+int sicslowpan_hc06_compress(linkaddr_t *link_destaddr, uint8_t *uncomp_len);
+
+/**
+ * \brief Uncompress the IPHC headers of the unfragmented packet in the
+ * packetbuf, like the input path does. The addresses may be derived from
+ * the sender and receiver addresses of the packetbuf.
+ * \param hdr Set to the uncompressed headers
+ * \param uncomp_len Set to the length of the uncompressed headers
+ * \return Length of the compressed headers, -1 if the packet has no
+ * IPHC dispatch
+ */
+int sicslowpan_hc06_uncompress(uint8_t **hdr, uint8_t *uncomp_len);
+#endif /* SICSLOWPAN_CONF_HC06_API */
 
 #endif /* SICSLOWPAN_H_ */
 /** @} */
@@ -62,6 +62,22 @@
 static service_callback_t service_cbk = NULL;
 static struct request_state_t request_state;
 
+#if STATS_CONF_ENABLE
+struct coap_stats coap_stats;
+
+static const st_statsEntry_t coap_stats_entry[] = {
+  STATS_COUNTER(struct coap_stats, rx),
+  STATS_COUNTER(struct coap_stats, rx_err),
+  STATS_COUNTER(struct coap_stats, tx),
+  STATS_COUNTER(struct coap_stats, retransmit),
+  STATS_COUNTER(struct coap_stats, timeout),
+};
+static st_statsGroup_t coap_stats_group = {
+  NULL, "coap", coap_stats_entry,
+  sizeof(coap_stats_entry) / sizeof(coap_stats_entry[0]), &coap_stats
+};
+#endif /* STATS_CONF_ENABLE */
+
 /*==============================================================================
  	 	 	 	 	 	 LOCAL FUNCTION PROTOTYPES
  =============================================================================*/
@@ -87,6 +103,7 @@ coap_receive(void)
   static coap_transaction_t *transaction = NULL;
 
   if(uip_newdata()) {
+    STATS_INC(coap_stats.rx);
 
     PRINTF("receiving UDP datagram from: ");
     PRINT6ADDR(&UIP_IP_BUF->srcipaddr);
@@ -283,7 +300,10 @@ coap_receive(void)
       if(erbium_status_code == PING_RESPONSE) {
         erbium_status_code = 0;
         reply_type = COAP_TYPE_RST;
-      } else if(erbium_status_code >= 192) {
+      } else {
+        STATS_INC(coap_stats.rx_err);
+      }
+      if(erbium_status_code >= 192) {
         /* set to sendable error code */
         erbium_status_code = INTERNAL_SERVER_ERROR_5_00;
         /* reuse input buffer for error message */
@@ -329,6 +349,9 @@ coap_init_engine(void)
 {
   PRINTF("Starting %s receiver...\n\r", coap_rest_implementation.name);
   rest_activate_resource(&res_well_known_core, ".well-known/core");
+#if STATS_CONF_ENABLE
+  stats_register(&coap_stats_group);
+#endif /* STATS_CONF_ENABLE */
 
   coap_init_connection(SERVER_LISTEN_PORT);
   evproc_regCallback(EVENT_TYPE_TCPIP, coap_engine_callback);
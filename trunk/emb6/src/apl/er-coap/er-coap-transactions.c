@@ -99,6 +99,7 @@ coap_send_transaction(coap_transaction_t *t)
   PRINTF("\rSending transaction %u\n\r", t->mid);
 
   coap_send_message(&t->addr, t->port, t->packet, t->packet_len);
+  STATS_INC(coap_stats.tx);
 
   if(COAP_TYPE_CON ==
      ((COAP_HEADER_TYPE_MASK & t->packet[0]) >> COAP_HEADER_TYPE_POSITION)) {
@@ -120,13 +121,16 @@ coap_send_transaction(coap_transaction_t *t)
                (int)t->retrans_timer.timer.interval / bsp_get(E_BSP_GET_TRES));
       }
 
+      /* retransmissions are randomized anyway, allow coalescing */
       etimer_set(&t->retrans_timer, t->retrans_timer.timer.interval, coap_engine_callback);
+      etimer_set_slack(&t->retrans_timer, t->retrans_timer.timer.interval / 16);
 
       t = NULL;
     } else {
       /* timed out */
 
       PRINTF("Timeout\n\r");
+      STATS_INC(coap_stats.timeout);
       restful_response_handler callback = t->callback;
       void *callback_data = t->callback_data;
 
@@ -178,6 +182,7 @@ coap_check_transactions()
     if(etimer_expired(&t->retrans_timer)) {
       ++(t->retrans_counter);
       PRINTF("Retransmitting %u (%u)\n\r", t->mid, t->retrans_counter);
+      STATS_INC(coap_stats.retransmit);
       coap_send_transaction(t);
     }
   }
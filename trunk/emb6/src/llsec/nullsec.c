@@ -48,6 +48,7 @@
 #include "nullsec.h"
 #include "frame802154.h"
 #include "packetbuf.h"
+#include "trace.h"
 
 static s_ns_t*	p_ns = NULL;
 /*---------------------------------------------------------------------------*/
@@ -61,6 +62,7 @@ init(s_ns_t* p_netStatck)
 static void
 send(mac_callback_t sent, void *ptr)
 {
+	TRACE_TX(E_TRACE_LLSEC);
 	packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_DATAFRAME);
 	p_ns->hmac->send(sent, ptr);
 }
@@ -74,6 +76,7 @@ on_frame_created(void)
 static void
 input(void)
 {
+	TRACE_RX(E_TRACE_LLSEC);
 	p_ns->hc->input();
 }
 /*---------------------------------------------------------------------------*/
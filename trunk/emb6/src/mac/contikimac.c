@@ -0,0 +1,650 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Radio duty cycling low MAC in the style of ContikiMAC, see
+ *         contikimac.h
+ */
+
+#include "emb6_conf.h"
+#include "emb6.h"
+#include "bsp.h"
+#include "contikimac.h"
+#include "packetbuf.h"
+#include "queuebuf.h"
+#include "linkaddr.h"
+#include "ctimer.h"
+#include "evproc.h"
+#include "memb.h"
+#include "trace.h"
+#include "stats.h"
+
+#include <string.h>
+
+#define DEBUG DEBUG_NONE
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/** Wake up phase of a neighbor, the time of its last acknowledgement */
+struct phase {
+  linkaddr_t addr;
+  clock_time_t time;
+  uint8_t noacks;
+  uint8_t used;
+};
+
+/** Packet waiting for the wake up of its receiver */
+struct deferred {
+  struct ctimer timer;
+  struct queuebuf *buf;
+  mac_callback_t sent;
+  void *ptr;
+};
+
+/** Last sequence number received from a sender */
+struct seqno {
+  linkaddr_t sender;
+  uint8_t seqno;
+};
+
+MEMB(deferred_memb, struct deferred, CONTIKIMAC_MAX_DEFERRED);
+
+static s_ns_t *p_ns = NULL;
+
+/** Channel check interval in clock ticks */
+static clock_time_t cycle_time;
+static struct ctimer cycle_timer;
+/** Ends the listening after a frame with the pending bit */
+static struct ctimer listen_timer;
+
+static uint8_t radio_is_on;
+static uint8_t keep_radio_on;
+static uint8_t we_are_sending;
+static uint8_t we_are_listening;
+
+#if CONTIKIMAC_MAX_PHASES
+static struct phase phases[CONTIKIMAC_MAX_PHASES];
+#endif
+static struct seqno seqnos[CONTIKIMAC_MAX_SEQNOS];
+static uint8_t seqno_next;
+
+#if STATS_CONF_ENABLE
+struct contikimac_stats {
+  uint32_t checks;      /* Channel checks */
+  uint32_t detected;    /* Channel checks which found activity */
+  uint32_t strobes;     /* Packets sent with a strobe */
+  uint32_t frames;      /* Frames sent, every copy of a strobe */
+  uint32_t noack;       /* Strobes without acknowledgement */
+  uint32_t busy;        /* Strobes not started because of a busy channel */
+  uint32_t deferred;    /* Packets deferred to the phase of the receiver */
+  uint32_t burst;       /* Frames sent to an awake receiver */
+  uint32_t dup;         /* Repeated frames dropped */
+};
+static struct contikimac_stats contikimac_stats;
+
+static const st_statsEntry_t contikimac_stats_entry[] = {
+  STATS_COUNTER(struct contikimac_stats, checks),
+  STATS_COUNTER(struct contikimac_stats, detected),
+  STATS_COUNTER(struct contikimac_stats, strobes),
+  STATS_COUNTER(struct contikimac_stats, frames),
+  STATS_COUNTER(struct contikimac_stats, noack),
+  STATS_COUNTER(struct contikimac_stats, busy),
+  STATS_COUNTER(struct contikimac_stats, deferred),
+  STATS_COUNTER(struct contikimac_stats, burst),
+  STATS_COUNTER(struct contikimac_stats, dup),
+};
+static st_statsGroup_t contikimac_stats_group = {
+  NULL, "contikimac", contikimac_stats_entry,
+  sizeof(contikimac_stats_entry) / sizeof(contikimac_stats_entry[0]),
+  &contikimac_stats
+};
+#endif /* STATS_CONF_ENABLE */
+
+static void powercycle(void *ptr);
+/*---------------------------------------------------------------------------*/
+static int
+has_cca(void)
+{
+  return p_ns->inif->cca != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+radio_on(void)
+{
+  if(!radio_is_on) {
+    radio_is_on = 1;
+    p_ns->inif->on();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+radio_off(void)
+{
+  /* Without clear channel assessment activity can not be detected */
+  if(radio_is_on && !keep_radio_on && !we_are_sending && !we_are_listening &&
+     has_cca()) {
+    radio_is_on = 0;
+    p_ns->inif->off();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+listen_timeout(void *ptr)
+{
+  we_are_listening = 0;
+  radio_off();
+}
+/*---------------------------------------------------------------------------*/
+/* Keep the receiver on for the next frame of a burst */
+static void
+listen_for_burst(void)
+{
+  we_are_listening = 1;
+  radio_on();
+  ctimer_set(&listen_timer, CONTIKIMAC_AFTER_PENDING_WAIT, listen_timeout, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+stop_listening(void)
+{
+  if(we_are_listening) {
+    we_are_listening = 0;
+    ctimer_stop(&listen_timer);
+  }
+  radio_off();
+}
+/*---------------------------------------------------------------------------*/
+#if CONTIKIMAC_MAX_PHASES
+static struct phase *
+phase_find(const linkaddr_t *addr)
+{
+  int i;
+
+  for(i = 0; i < CONTIKIMAC_MAX_PHASES; i++) {
+    if(phases[i].used && linkaddr_cmp(&phases[i].addr, addr)) {
+      return &phases[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Learn the phase of a neighbor from the result of a strobe */
+static void
+phase_update(const linkaddr_t *addr, int status, clock_time_t time)
+{
+  struct phase *p = phase_find(addr);
+  int i;
+
+  if(status == MAC_TX_OK) {
+    if(p == NULL) {
+      /* Replace the phase which was not confirmed for the longest time */
+      p = &phases[0];
+      for(i = 0; i < CONTIKIMAC_MAX_PHASES; i++) {
+        if(!phases[i].used) {
+          p = &phases[i];
+          break;
+        }
+        if((long)(phases[i].time - p->time) < 0) {
+          p = &phases[i];
+        }
+      }
+      linkaddr_copy(&p->addr, addr);
+      p->used = 1;
+    }
+    p->time = time;
+    p->noacks = 0;
+  } else if((status == MAC_TX_NOACK) && (p != NULL)) {
+    /* The clock of the neighbor drifted or it is gone */
+    if(++p->noacks >= CONTIKIMAC_MAX_NOACKS) {
+      p->used = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Clock ticks until a strobe to the receiver should start, 0 for now */
+static clock_time_t
+phase_wait(const linkaddr_t *addr)
+{
+  struct phase *p = phase_find(addr);
+  clock_time_t wait;
+
+  if(p == NULL) {
+    return 0;
+  }
+  /* The neighbor wakes up every cycle_time after the acknowledgement */
+  wait = cycle_time - (clock_time_t)(bsp_getTick() - p->time) % cycle_time;
+  if(wait <= CONTIKIMAC_GUARD_TIME + 1) {
+    wait = 0;
+  } else {
+    wait -= CONTIKIMAC_GUARD_TIME;
+  }
+  return wait;
+}
+#endif /* CONTIKIMAC_MAX_PHASES */
+/*---------------------------------------------------------------------------*/
+/* Send the frame in the packetbuf, strobed unless the receiver is awake */
+static int
+send_one(mac_callback_t sent, void *ptr, int receiver_awake)
+{
+  int is_broadcast = packetbuf_holds_broadcast();
+  int ret = MAC_TX_NOACK;
+  int transmissions = 0;
+  int busy = 0;
+  clock_time_t start;
+  clock_time_t strobe_time;
+  clock_time_t tx_time;
+  int i;
+
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, !is_broadcast);
+  if(p_ns->frame->create_and_secure(p_ns) < 0) {
+    PRINTF("contikimac: send failed, too large header\n");
+    if(sent) {
+      sent(ptr, MAC_TX_ERR_FATAL, 0);
+    }
+    return MAC_TX_ERR_FATAL;
+  }
+
+  we_are_sending = 1;
+  radio_on();
+
+  if(is_broadcast) {
+    receiver_awake = 0;
+  }
+  /* Do not strobe over the strobe of another node */
+  if(!receiver_awake && has_cca()) {
+    for(i = 0; i < CONTIKIMAC_CCA_COUNT_MAX_TX; i++) {
+      bsp_delay_us(CONTIKIMAC_CCA_CHECK_TIME_US);
+      if(!p_ns->inif->cca()) {
+        busy = 1;
+        break;
+      }
+      if(i + 1 < CONTIKIMAC_CCA_COUNT_MAX_TX) {
+        bsp_delay_us(CONTIKIMAC_CCA_SLEEP_TIME_US);
+      }
+    }
+  }
+
+  if(busy) {
+    STATS_INC(contikimac_stats.busy);
+    ret = MAC_TX_COLLISION;
+  } else {
+    /* Every neighbor wakes up once during a strobe of a full cycle */
+    strobe_time = receiver_awake ? 0 : cycle_time + 1;
+    if(receiver_awake) {
+      STATS_INC(contikimac_stats.burst);
+    } else {
+      STATS_INC(contikimac_stats.strobes);
+    }
+    start = bsp_getTick();
+    do {
+      tx_time = bsp_getTick();
+      transmissions++;
+      STATS_INC(contikimac_stats.frames);
+      switch(p_ns->inif->send(packetbuf_hdrptr(), packetbuf_totlen())) {
+      case RADIO_TX_OK:
+        ret = MAC_TX_OK;
+        break;
+      case RADIO_TX_NOACK:
+        ret = MAC_TX_NOACK;
+        break;
+      case RADIO_TX_COLLISION:
+        ret = MAC_TX_COLLISION;
+        break;
+      default:
+        ret = MAC_TX_ERR;
+        break;
+      }
+      if((ret == MAC_TX_COLLISION) || (ret == MAC_TX_ERR) ||
+         ((ret == MAC_TX_OK) && !is_broadcast)) {
+        break;
+      }
+      /* The gap of a unicast strobe is the acknowledgement wait */
+      if(is_broadcast) {
+        bsp_delay_us(CONTIKIMAC_INTER_PACKET_INTERVAL_US);
+      }
+    } while((clock_time_t)(bsp_getTick() - start) < strobe_time);
+    if(ret == MAC_TX_NOACK) {
+      STATS_INC(contikimac_stats.noack);
+    }
+#if CONTIKIMAC_MAX_PHASES
+    if(!is_broadcast && !receiver_awake) {
+      /* The receiver woke up shortly before the acknowledged frame */
+      phase_update(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), ret, tx_time);
+    }
+#endif /* CONTIKIMAC_MAX_PHASES */
+  }
+
+  we_are_sending = 0;
+  radio_off();
+  PRINTF("contikimac: sent %d after %d transmissions\n", ret, transmissions);
+  if(sent) {
+    sent(ptr, ret, transmissions);
+  }
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+#if CONTIKIMAC_MAX_PHASES
+static void
+send_deferred(void *ptr)
+{
+  struct deferred *d = ptr;
+  mac_callback_t sent = d->sent;
+  void *sent_ptr = d->ptr;
+
+  queuebuf_to_packetbuf(d->buf);
+  queuebuf_free(d->buf);
+  memb_free(&deferred_memb, d);
+  send_one(sent, sent_ptr, 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Defer a unicast packet until shortly before its receiver wakes up */
+static int
+defer_packet(mac_callback_t sent, void *ptr)
+{
+  struct deferred *d;
+  clock_time_t wait = phase_wait(packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+
+  if(wait == 0) {
+    return 0;
+  }
+  d = memb_alloc(&deferred_memb);
+  if(d == NULL) {
+    return 0;
+  }
+  d->buf = queuebuf_new_from_packetbuf();
+  if(d->buf == NULL) {
+    memb_free(&deferred_memb, d);
+    return 0;
+  }
+  d->sent = sent;
+  d->ptr = ptr;
+  STATS_INC(contikimac_stats.deferred);
+  ctimer_set(&d->timer, wait, send_deferred, d);
+  return 1;
+}
+#endif /* CONTIKIMAC_MAX_PHASES */
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  TRACE_TX(E_TRACE_LMAC);
+  if((p_ns == NULL) || (p_ns->frame == NULL) || (p_ns->inif == NULL)) {
+    if(sent) {
+      sent(ptr, MAC_TX_ERR_FATAL, 0);
+    }
+    return;
+  }
+#if CONTIKIMAC_MAX_PHASES
+  if(!packetbuf_holds_broadcast() && defer_packet(sent, ptr)) {
+    return;
+  }
+#endif /* CONTIKIMAC_MAX_PHASES */
+  send_one(sent, ptr, 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_list(mac_callback_t sent, void *ptr, struct lmac_buf_list *buf_list)
+{
+  struct lmac_buf_list *next;
+  int receiver_awake = 0;
+
+  if((p_ns == NULL) || (p_ns->frame == NULL) || (p_ns->inif == NULL)) {
+    if(sent) {
+      sent(ptr, MAC_TX_ERR_FATAL, 0);
+    }
+    return;
+  }
+  while(buf_list != NULL) {
+    /* The callback may free the list */
+    next = buf_list->next;
+    queuebuf_to_packetbuf(buf_list->buf);
+    /* The receiver stays awake for the next frame */
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, next != NULL);
+    TRACE_TX(E_TRACE_LMAC);
+    if(send_one(sent, ptr, receiver_awake) != MAC_TX_OK) {
+      /* Later frames would arrive out of order */
+      return;
+    }
+    receiver_awake = 1;
+    buf_list = next;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Check whether the frame in the packetbuf was received before */
+static int
+is_duplicate(void)
+{
+  const linkaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+  uint8_t seqno = (uint8_t)packetbuf_attr(PACKETBUF_ATTR_PACKET_ID);
+  int i;
+
+  for(i = 0; i < CONTIKIMAC_MAX_SEQNOS; i++) {
+    if(linkaddr_cmp(&seqnos[i].sender, sender)) {
+      if(seqnos[i].seqno == seqno) {
+        return 1;
+      }
+      seqnos[i].seqno = seqno;
+      return 0;
+    }
+  }
+  linkaddr_copy(&seqnos[seqno_next].sender, sender);
+  seqnos[seqno_next].seqno = seqno;
+  seqno_next = (seqno_next + 1) % CONTIKIMAC_MAX_SEQNOS;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_input(void)
+{
+  int for_us;
+
+  TRACE_RX(E_TRACE_LMAC);
+  if((p_ns == NULL) || (p_ns->frame == NULL) || (p_ns->hmac == NULL)) {
+    return;
+  }
+  if(p_ns->frame->parse() < 0) {
+    PRINTF("contikimac: failed to parse %u\n", packetbuf_datalen());
+    return;
+  }
+
+  for_us = packetbuf_holds_broadcast() ||
+    linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &linkaddr_node_addr);
+  /* A frame of a burst keeps the receiver awake, anything else ends the
+   * listening */
+  if(for_us && packetbuf_attr(PACKETBUF_ATTR_PENDING)) {
+    listen_for_burst();
+  } else {
+    stop_listening();
+  }
+  if(!for_us) {
+    return;
+  }
+  if(is_duplicate()) {
+    /* Another copy of a strobe or a repeated packet */
+    STATS_INC(contikimac_stats.dup);
+    return;
+  }
+  p_ns->hmac->input();
+}
+/*---------------------------------------------------------------------------*/
+/* Channel check, called every cycle_time */
+static void
+powercycle(void *ptr)
+{
+  int detected = 0;
+  int pending;
+  uint32_t listen = 0;
+  uint32_t silence = 0;
+  int i;
+
+  ctimer_reset(&cycle_timer);
+  if(radio_is_on || !has_cca()) {
+    /* The receiver is on anyway */
+    return;
+  }
+
+  STATS_INC(contikimac_stats.checks);
+  for(i = 0; (i < CONTIKIMAC_CCA_COUNT_MAX) && !detected; i++) {
+    radio_on();
+    bsp_delay_us(CONTIKIMAC_CCA_CHECK_TIME_US);
+    detected = !p_ns->inif->cca();
+    if(!detected) {
+      radio_off();
+      if(i + 1 < CONTIKIMAC_CCA_COUNT_MAX) {
+        bsp_delay_us(CONTIKIMAC_CCA_SLEEP_TIME_US);
+      }
+    }
+  }
+  if(!detected) {
+    return;
+  }
+
+  /* Stay awake while the channel is active, a received frame is handled
+   * by packet_input() which decides on the listening */
+  STATS_INC(contikimac_stats.detected);
+  pending = evproc_pending();
+  while((listen < CONTIKIMAC_LISTEN_TIME_AFTER_PACKET_DETECTED_US) &&
+        (silence < CONTIKIMAC_MAX_SILENCE_US)) {
+    bsp_delay_us(CONTIKIMAC_CCA_CHECK_TIME_US);
+    listen += CONTIKIMAC_CCA_CHECK_TIME_US;
+    if(!pending && evproc_pending()) {
+      /* A frame arrived, packet_input() switches the radio off */
+      we_are_listening = 1;
+      ctimer_set(&listen_timer, CONTIKIMAC_AFTER_PENDING_WAIT,
+                 listen_timeout, NULL);
+      return;
+    }
+    if(p_ns->inif->cca()) {
+      silence += CONTIKIMAC_CCA_CHECK_TIME_US;
+    } else {
+      silence = 0;
+    }
+  }
+  /* Fast sleep, the channel is silent or the activity is too long */
+  radio_off();
+}
+/*---------------------------------------------------------------------------*/
+static int8_t
+turn_on(void)
+{
+  if(p_ns == NULL) {
+    return 0;
+  }
+  keep_radio_on = 1;
+  radio_on();
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int8_t
+turn_off(int keep_on)
+{
+  if(p_ns == NULL) {
+    return 0;
+  }
+  keep_radio_on = keep_on;
+  if(keep_on) {
+    radio_on();
+  } else {
+    radio_off();
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return (unsigned short)cycle_time;
+}
+/*---------------------------------------------------------------------------*/
+void
+contikimac_set_channel_check_rate(uint16_t rate)
+{
+  if((rate == 0) || (rate > bsp_get(E_BSP_GET_TRES))) {
+    return;
+  }
+  cycle_time = bsp_get(E_BSP_GET_TRES) / rate;
+#if CONTIKIMAC_MAX_PHASES
+  memset(phases, 0, sizeof(phases));
+#endif /* CONTIKIMAC_MAX_PHASES */
+  if(p_ns != NULL) {
+    ctimer_set(&cycle_timer, cycle_time, powercycle, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(s_ns_t *p_netStack)
+{
+  if((p_netStack == NULL) || (p_netStack->inif == NULL)) {
+    return;
+  }
+  p_ns = p_netStack;
+  memb_init(&deferred_memb);
+  if(cycle_time == 0) {
+    cycle_time = bsp_get(E_BSP_GET_TRES) / CONTIKIMAC_CHANNEL_CHECK_RATE;
+  }
+  radio_is_on = 1;
+  keep_radio_on = 0;
+  we_are_sending = 0;
+  we_are_listening = 0;
+  p_ns->inif->on();
+  radio_off();
+  ctimer_set(&cycle_timer, cycle_time, powercycle, NULL);
+#if STATS_CONF_ENABLE
+  stats_register(&contikimac_stats_group);
+#endif /* STATS_CONF_ENABLE */
+}
+/*---------------------------------------------------------------------------*/
+const s_nsLowMac_t contikimac_driver = {
+  "contikimac",
+  init,
+  send_packet,
+  send_list,
+  packet_input,
+  turn_on,
+  turn_off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,600 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         CSMA/CA high MAC with a transmit queue per neighbor, see csma.h
+ */
+
+#include "emb6_conf.h"
+#include "emb6.h"
+#include "bsp.h"
+#include "csma.h"
+#include "packetbuf.h"
+#include "queuebuf.h"
+#include "ctimer.h"
+#include "clist.h"
+#include "memb.h"
+#include "random.h"
+#include "trace.h"
+#include "stats.h"
+
+#include <string.h>
+
+#define DEBUG DEBUG_NONE
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/** Packet waiting in the queue of a neighbor */
+struct packet_queue {
+  struct packet_queue *next;
+  struct queuebuf *buf;
+  mac_callback_t sent;
+  void *ptr;
+#if TRACE_CONF_ENABLE
+  /* The packet is sent later from a timer, outside of its trace */
+  uint16_t trace;
+#endif /* TRACE_CONF_ENABLE */
+};
+
+/** Transmit queue of a neighbor */
+struct neighbor_queue {
+  struct neighbor_queue *next;
+  linkaddr_t addr;
+  /** Time of the next transmission attempt */
+  clock_time_t ready;
+  /** State of the packet at the head of the queue */
+  uint8_t transmissions;
+  uint8_t max_transmissions;
+  uint8_t backoffs;
+  uint8_t be;
+  uint8_t num;
+  /** Packets handed to the low MAC and not reported yet */
+  uint8_t burst;
+  LIST_STRUCT(queue);
+};
+
+MEMB(neighbor_memb, struct neighbor_queue, CSMA_MAX_NEIGHBOR_QUEUES);
+MEMB(packet_memb, struct packet_queue, CSMA_MAX_PACKETS);
+LIST(neighbor_list);
+
+static s_ns_t *p_ns = NULL;
+
+/** Timer of the next transmission attempt of all queues */
+static struct ctimer service_timer;
+/** Queue served last, the next attempt is made by the following one */
+static struct neighbor_queue *last_served;
+/** Queue whose packet is being sent by the low MAC */
+static struct neighbor_queue *in_flight;
+/** Packets of the burst being sent by the low MAC */
+static struct lmac_buf_list burst_list[CSMA_MAX_BURST];
+
+#if STATS_CONF_ENABLE
+struct csma_stats {
+  uint32_t tx;          /* Transmission attempts */
+  uint32_t retransmit;  /* Repeated transmissions */
+  uint32_t busy;        /* Busy channel assessments */
+  uint32_t drop;        /* Packets given up */
+  uint32_t queue_full;  /* Packets rejected because the queues were full */
+  uint32_t burst;       /* Bursts of more than one packet */
+};
+static struct csma_stats csma_stats;
+
+static const st_statsEntry_t csma_stats_entry[] = {
+  STATS_COUNTER(struct csma_stats, tx),
+  STATS_COUNTER(struct csma_stats, retransmit),
+  STATS_COUNTER(struct csma_stats, busy),
+  STATS_COUNTER(struct csma_stats, drop),
+  STATS_COUNTER(struct csma_stats, queue_full),
+  STATS_COUNTER(struct csma_stats, burst),
+};
+static st_statsGroup_t csma_stats_group = {
+  NULL, "csma", csma_stats_entry,
+  sizeof(csma_stats_entry) / sizeof(csma_stats_entry[0]), &csma_stats
+};
+#endif /* STATS_CONF_ENABLE */
+
+static void service(void *ptr);
+static unsigned short channel_check_interval(void);
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+backoff_time(uint8_t be)
+{
+  return (clock_time_t)(random_rand() % (1u << be)) * CSMA_BACKOFF_PERIOD;
+}
+/*---------------------------------------------------------------------------*/
+/* Backoff after the channel was found busy. Behind a duty cycling low MAC
+ * the channel is busy with the strobe of a neighbor for up to one channel
+ * check interval, backoffs of a few periods would give up within a single
+ * strobe. */
+static clock_time_t
+busy_time(uint8_t be)
+{
+  clock_time_t interval = channel_check_interval();
+
+  if(interval > 0) {
+    return (clock_time_t)(random_rand() % interval);
+  }
+  return backoff_time(be);
+}
+/*---------------------------------------------------------------------------*/
+/* Start the channel access of the packet at the head of a queue */
+static void
+start_packet(struct neighbor_queue *n)
+{
+  struct packet_queue *q = list_head(n->queue);
+  int max_transmissions;
+
+  max_transmissions = queuebuf_attr(q->buf, PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
+  n->max_transmissions = (max_transmissions > 0) ? max_transmissions
+                                                 : CSMA_MAX_FRAME_RETRIES + 1;
+  n->transmissions = 0;
+  n->backoffs = 0;
+  n->be = CSMA_MIN_BE;
+  n->ready = bsp_getTick() + backoff_time(n->be);
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_ready(struct neighbor_queue *n, clock_time_t now)
+{
+  return (n != in_flight) && ((long)(n->ready - now) <= 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Arm the timer for the queue with the earliest transmission attempt */
+static void
+schedule(void)
+{
+  struct neighbor_queue *n;
+  clock_time_t now = bsp_getTick();
+  long wait = -1;
+  long d;
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(n == in_flight) {
+      continue;
+    }
+    d = (long)(n->ready - now);
+    if(d < 0) {
+      d = 0;
+    }
+    if((wait < 0) || (d < wait)) {
+      wait = d;
+    }
+  }
+  if(wait >= 0) {
+    ctimer_set(&service_timer, (clock_time_t)wait, service, NULL);
+  } else {
+    ctimer_stop(&service_timer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Remove the packet at the head of a queue and report the result */
+static void
+finish_packet(struct neighbor_queue *n, int status)
+{
+  struct packet_queue *q = list_pop(n->queue);
+  uint8_t transmissions = n->transmissions;
+  mac_callback_t sent;
+  void *ptr;
+
+  n->num--;
+  if(list_head(n->queue) != NULL) {
+    start_packet(n);
+  } else {
+    if(last_served == n) {
+      last_served = NULL;
+    }
+    list_remove(neighbor_list, n);
+    memb_free(&neighbor_memb, n);
+  }
+  if(status != MAC_TX_OK) {
+    STATS_INC(csma_stats.drop);
+  }
+  schedule();
+
+  if(q != NULL) {
+    sent = q->sent;
+    ptr = q->ptr;
+    queuebuf_free(q->buf);
+    memb_free(&packet_memb, q);
+    if(sent) {
+      sent(ptr, status, transmissions);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Give up the packet at the head of a queue together with the rest of its
+ * burst, the receiver can not use the following packets without it */
+static void
+drop_packet(struct neighbor_queue *n, int status)
+{
+  struct packet_queue *q;
+  int more;
+
+  do {
+    q = list_head(n->queue);
+    more = (n->num > 1) && queuebuf_attr(q->buf, PACKETBUF_ATTR_PENDING);
+    finish_packet(n, status);
+  } while(more);
+}
+/*---------------------------------------------------------------------------*/
+/* Give up the train at the tail of a queue whose next packet was not
+ * accepted, the receiver can not reassemble it. Packets already handed to
+ * the low MAC are reported by it. */
+static void
+drop_train(struct neighbor_queue *n)
+{
+  struct packet_queue *q;
+  struct packet_queue *first = NULL;
+  struct packet_queue *head = list_head(n->queue);
+  uint8_t keep = (n == in_flight) ? n->burst : 0;
+  uint8_t i = 0;
+  mac_callback_t sent;
+  void *ptr;
+
+  for(q = list_head(n->queue); q != NULL; q = list_item_next(q), i++) {
+    if(!queuebuf_attr(q->buf, PACKETBUF_ATTR_PENDING)) {
+      first = NULL;
+    } else if((first == NULL) && (i >= keep)) {
+      first = q;
+    }
+  }
+
+  while(first != NULL) {
+    q = first;
+    first = list_item_next(q);
+    list_remove(n->queue, q);
+    n->num--;
+    STATS_INC(csma_stats.drop);
+    sent = q->sent;
+    ptr = q->ptr;
+    queuebuf_free(q->buf);
+    memb_free(&packet_memb, q);
+    if(sent) {
+      sent(ptr, MAC_TX_ERR, 0);
+    }
+  }
+
+  if(n->num == 0) {
+    if(last_served == n) {
+      last_served = NULL;
+    }
+    list_remove(neighbor_list, n);
+    memb_free(&neighbor_memb, n);
+    schedule();
+  } else if(list_head(n->queue) != head) {
+    /* The channel access of the removed head does not apply to the new one */
+    start_packet(n);
+    schedule();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Result of a transmission attempt from the low MAC */
+static void
+packet_sent(void *ptr, int status, int num_tx)
+{
+  struct neighbor_queue *n = ptr;
+
+  if(status == MAC_TX_DEFERRED) {
+    return;
+  }
+  if(n != in_flight) {
+    return;
+  }
+  in_flight = NULL;
+
+  switch(status) {
+  case MAC_TX_OK:
+    if(n->burst > 1) {
+      /* The low MAC continues with the next packet of the burst */
+      n->burst--;
+      in_flight = n;
+    }
+    finish_packet(n, status);
+    if(in_flight == n) {
+      n->transmissions = 1;
+      STATS_INC(csma_stats.tx);
+    }
+    break;
+  case MAC_TX_COLLISION:
+  case MAC_TX_NOACK:
+    /* The low MAC stops a burst at a failed packet */
+    n->burst = 0;
+    if(n->transmissions < n->max_transmissions) {
+      /* Repeat the packet after a new channel access, a low MAC doing its
+       * own channel access reports a busy channel as a collision */
+      STATS_INC(csma_stats.retransmit);
+      n->backoffs = 0;
+      n->be = CSMA_MIN_BE;
+      n->ready = bsp_getTick() + ((status == MAC_TX_COLLISION) ?
+                                  busy_time(n->be) : backoff_time(n->be));
+      schedule();
+    } else {
+      drop_packet(n, status);
+    }
+    break;
+  default:
+    n->burst = 0;
+    drop_packet(n, status);
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Hand the packet at the head of a queue to the low MAC, together with the
+ * following packets it announces */
+static void
+send_head(struct neighbor_queue *n)
+{
+  struct packet_queue *q = list_head(n->queue);
+  uint8_t i = 0;
+#if TRACE_CONF_ENABLE
+  uint16_t trace_prev = TRACE_GET_PACKET();
+
+  /* A burst is traced as its head packet */
+  TRACE_SET_PACKET(q->trace);
+#endif /* TRACE_CONF_ENABLE */
+
+  while((q != NULL) && (i < CSMA_MAX_BURST)) {
+    burst_list[i].next = NULL;
+    burst_list[i].buf = q->buf;
+    burst_list[i].ptr = q->ptr;
+    if(i > 0) {
+      burst_list[i - 1].next = &burst_list[i];
+    }
+    i++;
+    if(!queuebuf_attr(q->buf, PACKETBUF_ATTR_PENDING)) {
+      break;
+    }
+    q = list_item_next(q);
+  }
+
+  n->burst = i;
+  if(i > 1) {
+    STATS_INC(csma_stats.burst);
+    p_ns->lmac->send_list(packet_sent, n, burst_list);
+  } else {
+    queuebuf_to_packetbuf(burst_list[0].buf);
+    /* The follower a packet announces may not be queued, e.g. when the
+     * queue was full, the radio must not wait for it */
+    q = list_head(n->queue);
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING,
+                       queuebuf_attr(q->buf, PACKETBUF_ATTR_PENDING) &&
+                       (list_item_next(q) != NULL));
+    p_ns->lmac->send(packet_sent, n);
+  }
+  TRACE_SET_PACKET(trace_prev);
+}
+/*---------------------------------------------------------------------------*/
+/* A transmission attempt of the next queue in round robin order */
+static void
+service(void *ptr)
+{
+  struct neighbor_queue *n;
+  clock_time_t now = bsp_getTick();
+
+  if(in_flight != NULL) {
+    return;
+  }
+
+  /* Queues after the one served last, then from the start of the list */
+  for(n = (last_served != NULL) ? list_item_next(last_served) : NULL;
+      n != NULL; n = list_item_next(n)) {
+    if(is_ready(n, now)) {
+      break;
+    }
+  }
+  if(n == NULL) {
+    for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+      if(is_ready(n, now) || (n == last_served)) {
+        break;
+      }
+    }
+    if((n != NULL) && !is_ready(n, now)) {
+      n = NULL;
+    }
+  }
+  if(n == NULL) {
+    schedule();
+    return;
+  }
+  last_served = n;
+
+  if((p_ns->inif->cca != NULL) && !p_ns->inif->cca()) {
+    /* Busy channel, wait longer */
+    STATS_INC(csma_stats.busy);
+    if(++n->backoffs > CSMA_MAX_BACKOFFS) {
+      drop_packet(n, MAC_TX_COLLISION);
+      return;
+    }
+    if(n->be < CSMA_MAX_BE) {
+      n->be++;
+    }
+    n->ready = now + busy_time(n->be) + CSMA_BACKOFF_PERIOD;
+    schedule();
+    return;
+  }
+
+  n->transmissions++;
+  in_flight = n;
+  STATS_INC(csma_stats.tx);
+  PRINTF("csma: send to %02x%02x, transmission %u\n",
+         n->addr.u8[6], n->addr.u8[7], n->transmissions);
+  send_head(n);
+  /* The low MAC may answer later, the other queues continue meanwhile */
+  schedule();
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  struct neighbor_queue *n;
+  struct packet_queue *q;
+  const linkaddr_t *addr = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+
+  TRACE_TX(E_TRACE_HMAC);
+  if((p_ns == NULL) || (p_ns->lmac == NULL) || (p_ns->inif == NULL)) {
+    if(sent) {
+      sent(ptr, MAC_TX_ERR_FATAL, 0);
+    }
+    return;
+  }
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(linkaddr_cmp(&n->addr, addr)) {
+      break;
+    }
+  }
+  if(n == NULL) {
+    n = memb_alloc(&neighbor_memb);
+    if(n != NULL) {
+      linkaddr_copy(&n->addr, addr);
+      n->num = 0;
+      LIST_STRUCT_INIT(n, queue);
+    }
+  }
+  q = NULL;
+  if((n != NULL) && (n->num < CSMA_MAX_PACKETS_PER_NEIGHBOR)) {
+    q = memb_alloc(&packet_memb);
+    if(q != NULL) {
+      q->buf = queuebuf_new_from_packetbuf();
+      if(q->buf == NULL) {
+        memb_free(&packet_memb, q);
+        q = NULL;
+      }
+    }
+  }
+  if(q == NULL) {
+    /* No space, the packet is dropped */
+    PRINTF("csma: queue full\n");
+    STATS_INC(csma_stats.queue_full);
+    if((n != NULL) && (n->num == 0)) {
+      memb_free(&neighbor_memb, n);
+    } else if(n != NULL) {
+      /* A fragment was rejected, the rest of its train is useless */
+      drop_train(n);
+    }
+    if(sent) {
+      sent(ptr, MAC_TX_ERR, 0);
+    }
+    return;
+  }
+
+  q->sent = sent;
+  q->ptr = ptr;
+#if TRACE_CONF_ENABLE
+  q->trace = TRACE_GET_PACKET();
+#endif /* TRACE_CONF_ENABLE */
+  list_add(n->queue, q);
+  if(n->num++ == 0) {
+    /* A new queue starts with its first packet */
+    start_packet(n);
+    list_add(neighbor_list, n);
+    schedule();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_input(void)
+{
+  TRACE_RX(E_TRACE_HMAC);
+  if((p_ns != NULL) && (p_ns->llsec != NULL)) {
+    p_ns->llsec->input();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int8_t
+on(void)
+{
+  if((p_ns != NULL) && (p_ns->lmac != NULL)) {
+    return p_ns->lmac->on();
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int8_t
+off(int keep_radio_on)
+{
+  if((p_ns != NULL) && (p_ns->lmac != NULL)) {
+    return p_ns->lmac->off(keep_radio_on);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  if((p_ns != NULL) && (p_ns->lmac != NULL) &&
+     (p_ns->lmac->channel_check_interval != NULL)) {
+    return p_ns->lmac->channel_check_interval();
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(s_ns_t *p_netStack)
+{
+  if(p_netStack == NULL) {
+    return;
+  }
+  p_ns = p_netStack;
+  memb_init(&neighbor_memb);
+  memb_init(&packet_memb);
+  list_init(neighbor_list);
+  last_served = NULL;
+  in_flight = NULL;
+#if STATS_CONF_ENABLE
+  stats_register(&csma_stats_group);
+#endif /* STATS_CONF_ENABLE */
+}
+/*---------------------------------------------------------------------------*/
+const s_nsHighMac_t csma_driver = {
+  "csma",
+  init,
+  send_packet,
+  packet_input,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
@@ -115,31 +115,74 @@ get_key_id_len(uint8_t key_id_mode)
 }
 #endif /* LLSEC802154_USES_EXPLICIT_KEYS */
 /*----------------------------------------------------------------------------*/
+/**
+ *   \brief Tells which PAN IDs a frame carries. 2015 frames follow table 7-2
+ *   of IEEE 802.15.4-2015, older frames carry the destination PAN ID with a
+ *   destination address and the source PAN ID with a source address unless
+ *   the PAN ID is compressed.
+ */
+void
+frame802154_has_panid(frame802154_fcf_t *fcf, int *has_src_pan_id,
+                      int *has_dest_pan_id)
+{
+  int src_pan_id = 0;
+  int dest_pan_id = 0;
+  uint8_t dest = fcf->dest_addr_mode & 3;
+  uint8_t src = fcf->src_addr_mode & 3;
+
+  if(fcf->frame_version == FRAME802154_IEEE802154_2015) {
+    if(fcf->panid_compression) {
+      /* Compressed: the destination PAN ID stands for both unless both
+       * addresses are long */
+      dest_pan_id = (dest != FRAME802154_NOADDR) &&
+        (src != FRAME802154_NOADDR) &&
+        !((dest == FRAME802154_LONGADDRMODE) &&
+          (src == FRAME802154_LONGADDRMODE));
+    } else {
+      dest_pan_id = (dest != FRAME802154_NOADDR);
+      src_pan_id = (src != FRAME802154_NOADDR) &&
+        !((dest == FRAME802154_LONGADDRMODE) &&
+          (src == FRAME802154_LONGADDRMODE));
+    }
+  } else {
+    dest_pan_id = (dest != FRAME802154_NOADDR);
+    src_pan_id = (src != FRAME802154_NOADDR) && !fcf->panid_compression;
+  }
+
+  if(has_src_pan_id != NULL) {
+    *has_src_pan_id = src_pan_id;
+  }
+  if(has_dest_pan_id != NULL) {
+    *has_dest_pan_id = dest_pan_id;
+  }
+}
+/*----------------------------------------------------------------------------*/
 static void
 field_len(frame802154_t *p, field_length_t *flen)
 {
+  int has_src_pid;
+  int has_dest_pid;
+
   /* init flen to zeros */
   memset(flen, 0, sizeof(field_length_t));
 
-  /* Determine lengths of each field based on fcf and other args */
-  if(p->fcf.dest_addr_mode & 3) {
-    flen->dest_pid_len = 2;
-  }
-  if(p->fcf.src_addr_mode & 3) {
-    flen->src_pid_len = 2;
-  }
-
   /* Set PAN ID compression bit if src pan id matches dest pan id. */
   if((p->fcf.dest_addr_mode & 3) && (p->fcf.src_addr_mode & 3) &&
      p->src_pid == p->dest_pid) {
     p->fcf.panid_compression = 1;
-
-    /* compressed header, only do dest pid */
-    flen->src_pid_len = 0;
   } else {
     p->fcf.panid_compression = 0;
   }
 
+  /* Determine lengths of each field based on fcf and other args */
+  frame802154_has_panid(&p->fcf, &has_src_pid, &has_dest_pid);
+  if(has_dest_pid) {
+    flen->dest_pid_len = 2;
+  }
+  if(has_src_pid) {
+    flen->src_pid_len = 2;
+  }
+
   /* determine address lengths */
   flen->dest_addr_len = addr_len(p->fcf.dest_addr_mode & 3);
   flen->src_addr_len = addr_len(p->fcf.src_addr_mode & 3);
@@ -169,7 +212,8 @@ frame802154_hdrlen(frame802154_t *p)
 {
   field_length_t flen;
   field_len(p, &flen);
-  return 3 + flen.dest_pid_len + flen.dest_addr_len +
+  return 3 - ((p->fcf.frame_version == FRAME802154_IEEE802154_2015) &&
+              p->fcf.sequence_number_suppression) + flen.dest_pid_len + flen.dest_addr_len +
     flen.src_pid_len + flen.src_addr_len + flen.aux_sec_len;
 }
 /*----------------------------------------------------------------------------*/
@@ -206,10 +250,17 @@ frame802154_create(frame802154_t *p, uint8_t *buf)
   buf[1] = ((p->fcf.dest_addr_mode & 3) << 2) |
     ((p->fcf.frame_version & 3) << 4) |
     ((p->fcf.src_addr_mode & 3) << 6);
+  pos = 2;
+  if(p->fcf.frame_version == FRAME802154_IEEE802154_2015) {
+    buf[1] |= (p->fcf.sequence_number_suppression & 1) |
+      ((p->fcf.ie_list_present & 1) << 1);
+  }
 
   /* sequence number */
-  buf[2] = p->seq;
-  pos = 3;
+  if((p->fcf.frame_version != FRAME802154_IEEE802154_2015) ||
+     !p->fcf.sequence_number_suppression) {
+    buf[pos++] = p->seq;
+  }
 
   /* Destination PAN ID */
   if(flen.dest_pid_len == 2) {
@@ -272,6 +323,8 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
   uint8_t *p;
   frame802154_fcf_t fcf;
   int c;
+  int has_src_pid;
+  int has_dest_pid;
   #if LLSEC802154_USES_EXPLICIT_KEYS
     uint8_t key_id_mode;
   #endif /* LLSEC802154_USES_EXPLICIT_KEYS */
@@ -292,17 +345,34 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
   fcf.dest_addr_mode = (p[1] >> 2) & 3;
   fcf.frame_version = (p[1] >> 4) & 3;
   fcf.src_addr_mode = (p[1] >> 6) & 3;
+  if(fcf.frame_version == FRAME802154_IEEE802154_2015) {
+    fcf.sequence_number_suppression = p[1] & 1;
+    fcf.ie_list_present = (p[1] >> 1) & 1;
+  } else {
+    fcf.sequence_number_suppression = 0;
+    fcf.ie_list_present = 0;
+  }
 
   /* copy fcf and seqNum */
   memcpy(&pf->fcf, &fcf, sizeof(frame802154_fcf_t));
-  pf->seq = p[2];
-  p += 3;                             /* Skip first three bytes */
+  p += 2;
+  if(fcf.sequence_number_suppression) {
+    pf->seq = 0;
+  } else {
+    pf->seq = p[0];
+    p += 1;
+  }
+  frame802154_has_panid(&fcf, &has_src_pid, &has_dest_pid);
 
-  /* Destination address, if any */
-  if(fcf.dest_addr_mode) {
-    /* Destination PAN */
+  /* A 2015 frame without PAN IDs belongs to our PAN */
+  pf->dest_pid = mac_phy_config.pan_id;
+  if(has_dest_pid) {
     pf->dest_pid = p[0] + (p[1] << 8);
     p += 2;
+  }
+
+  /* Destination address, if any */
+  if(fcf.dest_addr_mode) {
 
     /* Destination address */
 /*     l = addr_len(fcf.dest_addr_mode); */
@@ -323,13 +393,15 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
     }
   } else {
     linkaddr_copy((linkaddr_t *)&(pf->dest_addr), &linkaddr_null);
-    pf->dest_pid = 0;
+    if(!has_dest_pid && (fcf.frame_version != FRAME802154_IEEE802154_2015)) {
+      pf->dest_pid = 0;
+    }
   }
 
   /* Source address, if any */
   if(fcf.src_addr_mode) {
     /* Source PAN */
-    if(!fcf.panid_compression) {
+    if(has_src_pid) {
       pf->src_pid = p[0] + (p[1] << 8);
       p += 2;
     } else {
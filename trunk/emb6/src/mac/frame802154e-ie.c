@@ -0,0 +1,460 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Creation and parsing of the IEEE 802.15.4e information elements
+ *         used by TSCH, see frame802154e-ie.h
+ */
+
+#include "emb6.h"
+#include "frame802154e-ie.h"
+
+#include <string.h>
+
+#define DEBUG DEBUG_NONE
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/* IE types */
+#define HEADER_IE                 0
+#define PAYLOAD_IE                1
+/* Nested IE types */
+#define SHORT_IE                  0
+#define LONG_IE                   1
+
+/*---------------------------------------------------------------------------*/
+static void
+write16(uint8_t *buf, uint16_t val)
+{
+  buf[0] = val & 0xff;
+  buf[1] = (val >> 8) & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+read16(const uint8_t *buf)
+{
+  return buf[0] | ((uint16_t)buf[1] << 8);
+}
+/*---------------------------------------------------------------------------*/
+/* Header IE descriptor: length 7 bits, element id 8 bits, type 0 */
+static void
+create_header_ie_descriptor(uint8_t *buf, uint8_t element_id, int ie_len)
+{
+  write16(buf, (ie_len & 0x7f) + ((uint16_t)element_id << 7) +
+          ((uint16_t)HEADER_IE << 15));
+}
+/*---------------------------------------------------------------------------*/
+/* Payload IE descriptor: length 11 bits, group id 4 bits, type 1 */
+static void
+create_payload_ie_descriptor(uint8_t *buf, uint8_t group_id, int ie_len)
+{
+  write16(buf, (ie_len & 0x07ff) + ((uint16_t)(group_id & 0x0f) << 11) +
+          ((uint16_t)PAYLOAD_IE << 15));
+}
+/*---------------------------------------------------------------------------*/
+/* Nested MLME IE descriptors, short: length 8 bits, sub id 7 bits, type 0;
+ * long: length 11 bits, sub id 4 bits, type 1 */
+static void
+create_mlme_short_ie_descriptor(uint8_t *buf, uint8_t sub_id, int ie_len)
+{
+  write16(buf, (ie_len & 0xff) + ((uint16_t)(sub_id & 0x7f) << 8) +
+          ((uint16_t)SHORT_IE << 15));
+}
+/*---------------------------------------------------------------------------*/
+static void
+create_mlme_long_ie_descriptor(uint8_t *buf, uint8_t sub_id, int ie_len)
+{
+  write16(buf, (ie_len & 0x07ff) + ((uint16_t)(sub_id & 0x0f) << 11) +
+          ((uint16_t)LONG_IE << 15));
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_header_ack_nack_time_correction(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len = 2;
+  uint16_t drift_us;
+
+  if((ies == NULL) || (len < 2 + ie_len)) {
+    return -1;
+  }
+  /* 12 bit signed time correction, the nack flag in the top bit */
+  drift_us = (uint16_t)ies->ie_time_correction & 0x0fff;
+  if(ies->ie_is_nack) {
+    drift_us |= 0x8000;
+  }
+  write16(buf + 2, drift_us);
+  create_header_ie_descriptor(buf, HEADER_IE_ACK_NACK_TIME_CORRECTION, ie_len);
+  return 2 + ie_len;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_header_list_termination_1(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  if(len < 2) {
+    return -1;
+  }
+  create_header_ie_descriptor(buf, HEADER_IE_LIST_TERMINATION_1, 0);
+  return 2;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_header_list_termination_2(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  if(len < 2) {
+    return -1;
+  }
+  create_header_ie_descriptor(buf, HEADER_IE_LIST_TERMINATION_2, 0);
+  return 2;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_payload_list_termination(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  if(len < 2) {
+    return -1;
+  }
+  create_payload_ie_descriptor(buf, PAYLOAD_IE_LIST_TERMINATION, 0);
+  return 2;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_mlme(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  if((ies == NULL) || (len < 2)) {
+    return -1;
+  }
+  /* The nested IEs follow, ie_mlme_len holds their length */
+  create_payload_ie_descriptor(buf, PAYLOAD_IE_MLME, ies->ie_mlme_len);
+  return 2;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_tsch_synchronization(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len = 6;
+
+  if((ies == NULL) || (len < 2 + ie_len)) {
+    return -1;
+  }
+  buf[2] = ies->ie_asn.ls4b & 0xff;
+  buf[3] = (ies->ie_asn.ls4b >> 8) & 0xff;
+  buf[4] = (ies->ie_asn.ls4b >> 16) & 0xff;
+  buf[5] = (ies->ie_asn.ls4b >> 24) & 0xff;
+  buf[6] = ies->ie_asn.ms1b;
+  buf[7] = ies->ie_join_priority;
+  create_mlme_short_ie_descriptor(buf, MLME_SHORT_IE_TSCH_SYNCHRONIZATION,
+                                  ie_len);
+  return 2 + ie_len;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_tsch_slotframe_and_link(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  const struct tsch_slotframe_and_links *sf;
+  int ie_len;
+  int i;
+
+  if(ies == NULL) {
+    return -1;
+  }
+  sf = &ies->ie_tsch_slotframe_and_link;
+  if(sf->num_links > FRAME802154E_IE_MAX_LINKS) {
+    return -1;
+  }
+  ie_len = (sf->num_slotframes == 0) ? 1 : 5 + 5 * sf->num_links;
+  if(len < 2 + ie_len) {
+    return -1;
+  }
+  buf[2] = sf->num_slotframes;
+  if(sf->num_slotframes != 0) {
+    buf[3] = sf->slotframe_handle;
+    write16(buf + 4, sf->slotframe_size);
+    buf[6] = sf->num_links;
+    for(i = 0; i < sf->num_links; i++) {
+      write16(buf + 7 + 5 * i, sf->links[i].timeslot);
+      write16(buf + 9 + 5 * i, sf->links[i].channel_offset);
+      buf[11 + 5 * i] = sf->links[i].link_options;
+    }
+  }
+  create_mlme_short_ie_descriptor(buf, MLME_SHORT_IE_TSCH_SLOTFRAME_AND_LINK,
+                                  ie_len);
+  return 2 + ie_len;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_tsch_timeslot(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len = 1;
+
+  if((ies == NULL) || (len < 2 + ie_len)) {
+    return -1;
+  }
+  /* Only the id of the timeslot template is sent */
+  buf[2] = ies->ie_tsch_timeslot_id;
+  create_mlme_short_ie_descriptor(buf, MLME_SHORT_IE_TSCH_TIMESLOT, ie_len);
+  return 2 + ie_len;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame80215e_create_ie_tsch_channel_hopping_sequence(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len;
+
+  if(ies == NULL) {
+    return -1;
+  }
+  /* The id of the sequence, or the sequence itself for id 0xff */
+  ie_len = (ies->ie_channel_hopping_sequence_id == 0xff) ?
+    1 + ies->ie_hopping_sequence_len : 1;
+  if(len < 2 + ie_len) {
+    return -1;
+  }
+  buf[2] = ies->ie_channel_hopping_sequence_id;
+  if(ie_len > 1) {
+    memcpy(buf + 3, ies->ie_hopping_sequence, ies->ie_hopping_sequence_len);
+  }
+  create_mlme_long_ie_descriptor(buf,
+                                 MLME_LONG_IE_TSCH_CHANNEL_HOPPING_SEQUENCE,
+                                 ie_len);
+  return 2 + ie_len;
+}
+/*---------------------------------------------------------------------------*/
+/* Parse a header IE, returns 0 or -1 if it is malformed */
+static int
+parse_header_ie(const uint8_t *buf, int len, uint8_t element_id,
+                struct ieee802154_ies *ies)
+{
+  uint16_t time_sync_field;
+  int16_t drift_us;
+
+  switch(element_id) {
+  case HEADER_IE_ACK_NACK_TIME_CORRECTION:
+    if(len != 2) {
+      return -1;
+    }
+    time_sync_field = read16(buf);
+    /* Sign extension of the 12 bit correction */
+    drift_us = time_sync_field & 0x0fff;
+    if(drift_us & 0x0800) {
+      drift_us |= 0xf000;
+    }
+    ies->ie_time_correction = drift_us;
+    ies->ie_is_nack = (time_sync_field & 0x8000) ? 1 : 0;
+    break;
+  default:
+    break;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Parse a nested MLME IE, returns 0 or -1 if it is malformed */
+static int
+parse_mlme_ie(const uint8_t *buf, int len, uint8_t sub_id, int is_long,
+              struct ieee802154_ies *ies, int offset)
+{
+  struct tsch_slotframe_and_links *sf = &ies->ie_tsch_slotframe_and_link;
+  int i;
+
+  if(is_long) {
+    if(sub_id == MLME_LONG_IE_TSCH_CHANNEL_HOPPING_SEQUENCE) {
+      if(len < 1) {
+        return -1;
+      }
+      ies->ie_channel_hopping_sequence_id = buf[0];
+      if((buf[0] == 0xff) && (len - 1 <= FRAME802154E_IE_MAX_HOPPING)) {
+        ies->ie_hopping_sequence_len = len - 1;
+        memcpy(ies->ie_hopping_sequence, buf + 1, len - 1);
+      }
+    }
+    return 0;
+  }
+
+  switch(sub_id) {
+  case MLME_SHORT_IE_TSCH_SYNCHRONIZATION:
+    if(len != 6) {
+      return -1;
+    }
+    ies->ie_tsch_synchronization_offset = offset;
+    ies->ie_asn.ls4b = (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+      ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+    ies->ie_asn.ms1b = buf[4];
+    ies->ie_join_priority = buf[5];
+    break;
+  case MLME_SHORT_IE_TSCH_SLOTFRAME_AND_LINK:
+    if(len < 1) {
+      return -1;
+    }
+    sf->num_slotframes = buf[0];
+    if(sf->num_slotframes == 0) {
+      break;
+    }
+    if(len < 5) {
+      return -1;
+    }
+    /* Only the first slotframe is kept */
+    sf->slotframe_handle = buf[1];
+    sf->slotframe_size = read16(buf + 2);
+    sf->num_links = buf[4];
+    if((sf->num_links > FRAME802154E_IE_MAX_LINKS) ||
+       (len < 5 + 5 * sf->num_links)) {
+      return -1;
+    }
+    for(i = 0; i < sf->num_links; i++) {
+      sf->links[i].timeslot = read16(buf + 5 + 5 * i);
+      sf->links[i].channel_offset = read16(buf + 7 + 5 * i);
+      sf->links[i].link_options = buf[9 + 5 * i];
+    }
+    break;
+  case MLME_SHORT_IE_TSCH_TIMESLOT:
+    if(len < 1) {
+      return -1;
+    }
+    ies->ie_tsch_timeslot_id = buf[0];
+    break;
+  default:
+    break;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+frame802154e_parse_information_elements(const uint8_t *buf,
+    uint8_t buf_size, struct ieee802154_ies *ies)
+{
+  const uint8_t *start = buf;
+  uint16_t ie_desc;
+  uint8_t type;
+  uint8_t id;
+  uint16_t len;
+  /* Bytes of the MLME IE whose nested IEs are parsed */
+  int nested_mlme_len = 0;
+  enum { PARSING_HEADER_IE, PARSING_PAYLOAD_IE, PARSING_MLME_SUBIE } parsing_state;
+
+  if(ies == NULL) {
+    return -1;
+  }
+  memset(ies, 0, sizeof(struct ieee802154_ies));
+  parsing_state = PARSING_HEADER_IE;
+
+  while(buf_size >= 2) {
+    ie_desc = read16(buf);
+    buf += 2;
+    buf_size -= 2;
+    type = ie_desc >> 15;
+    if(parsing_state == PARSING_HEADER_IE) {
+      if(type != HEADER_IE) {
+        return -1;
+      }
+      len = ie_desc & 0x7f;
+      id = (ie_desc >> 7) & 0xff;
+    } else if(parsing_state == PARSING_PAYLOAD_IE) {
+      if(type != PAYLOAD_IE) {
+        return -1;
+      }
+      len = ie_desc & 0x07ff;
+      id = (ie_desc >> 11) & 0x0f;
+    } else if(type == LONG_IE) {
+      len = ie_desc & 0x07ff;
+      id = (ie_desc >> 11) & 0x0f;
+    } else {
+      len = ie_desc & 0xff;
+      id = (ie_desc >> 8) & 0x7f;
+    }
+    if(len > buf_size) {
+      PRINTF("frame802154e: IE %u too long %u/%u\n", id, len, buf_size);
+      return -1;
+    }
+
+    switch(parsing_state) {
+    case PARSING_HEADER_IE:
+      if(id == HEADER_IE_LIST_TERMINATION_1) {
+        /* Payload IEs follow */
+        parsing_state = PARSING_PAYLOAD_IE;
+      } else if(id == HEADER_IE_LIST_TERMINATION_2) {
+        /* Payload data follows */
+        return buf + len - start;
+      } else if(parse_header_ie(buf, len, id, ies) < 0) {
+        return -1;
+      }
+      break;
+    case PARSING_PAYLOAD_IE:
+      if((id == PAYLOAD_IE_MLME) && (len > 0)) {
+        /* The nested IEs are parsed next */
+        ies->ie_mlme_len = len;
+        nested_mlme_len = len;
+        parsing_state = PARSING_MLME_SUBIE;
+        continue;
+      } else if(id == PAYLOAD_IE_LIST_TERMINATION) {
+        return buf + len - start;
+      }
+      break;
+    case PARSING_MLME_SUBIE:
+      if(parse_mlme_ie(buf, len, id, type == LONG_IE, ies,
+                       buf - 2 - start) < 0) {
+        return -1;
+      }
+      nested_mlme_len -= 2 + len;
+      if(nested_mlme_len <= 0) {
+        parsing_state = PARSING_PAYLOAD_IE;
+      }
+      break;
+    }
+    buf += len;
+    buf_size -= len;
+  }
+
+  /* The IEs may end with the frame */
+  return (buf_size == 0) ? buf - start : -1;
+}
+/*---------------------------------------------------------------------------*/
@@ -40,18 +40,21 @@
 
 #include "emb6_conf.h"
 #include "emb6.h"
+#include "trace.h"
 
 static s_ns_t*	p_ns = NULL;
 
 /*---------------------------------------------------------------------------*/
 static void send_packet(mac_callback_t sent, void *ptr)
 {
+	TRACE_TX(E_TRACE_HMAC);
 	if ((p_ns != NULL) && (p_ns->lmac != NULL))
 		p_ns->lmac->send(sent, ptr);
 }
 /*---------------------------------------------------------------------------*/
 static void packet_input(void)
 {
+	TRACE_RX(E_TRACE_HMAC);
 	if ((p_ns != NULL) && (p_ns->llsec != NULL))
 		p_ns->llsec->input();
 }
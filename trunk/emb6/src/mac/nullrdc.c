@@ -70,7 +70,7 @@ static int
 send_one_packet(mac_callback_t sent, void *ptr)
 {
   int ret;
-  int last_sent_ok = MAC_TX_ERR;
+  int last_sent_ok = 0;
 
   packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
 
@@ -122,6 +122,8 @@ send_list(mac_callback_t sent, void *ptr, struct lmac_buf_list *buf_list)
     int last_sent_ok;
 
     queuebuf_to_packetbuf(buf_list->buf);
+    /* All frames but the last one announce the next frame of the burst */
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, next != NULL);
     last_sent_ok = send_one_packet(sent, ptr);
 
     /* If packet transmission was not successful, we should back off and let
@@ -52,6 +52,9 @@
 #include "packetbuf.h"
 #include "queuebuf.h"
 #include "random.h"
+#include "trace.h"
+#include "rimestats.h"
+#include "stats.h"
 
 #define DEBUG DEBUG_NONE
 
@@ -83,6 +86,20 @@ static uint8_t mac_dsn;
 //static uint16_t mac_src_pan_id = IEEE802154_PANID;
 
 static s_ns_t*	p_ns = NULL;
+
+#if STATS_CONF_ENABLE
+/** Counters of rimestats maintained by this MAC */
+static const st_statsEntry_t mac_stats_entry[] = {
+  STATS_COUNTER(struct rimestats, tx),
+  STATS_COUNTER(struct rimestats, rx),
+  STATS_COUNTER(struct rimestats, tooshort),
+  STATS_COUNTER(struct rimestats, noacktx),
+};
+static st_statsGroup_t mac_stats_group = {
+  NULL, "mac", mac_stats_entry,
+  sizeof(mac_stats_entry) / sizeof(mac_stats_entry[0]), &rimestats
+};
+#endif /* STATS_CONF_ENABLE */
 /*---------------------------------------------------------------------------*/
 static int
 is_broadcast_addr(uint8_t mode, uint8_t *addr)
@@ -96,11 +113,15 @@ is_broadcast_addr(uint8_t mode, uint8_t *addr)
   return 1;
 }
 /*---------------------------------------------------------------------------*/
-static void
-send_packet(mac_callback_t sent, void *ptr)
+static int
+send_one(mac_callback_t sent, void *ptr)
 {
   frame802154_t params;
   uint8_t len;
+  int status;
+  int num_tx = 1;
+
+  TRACE_TX(E_TRACE_LMAC);
 
   /* init to zeros */
   memset(&params, 0, sizeof(params));
@@ -108,7 +129,7 @@ send_packet(mac_callback_t sent, void *ptr)
   /* Build the FCF. */
   params.fcf.frame_type = FRAME802154_DATAFRAME;
   params.fcf.security_enabled = 0;
-  params.fcf.frame_pending = 0;
+  params.fcf.frame_pending = packetbuf_attr(PACKETBUF_ATTR_PENDING);
   params.fcf.ack_required = packetbuf_attr(PACKETBUF_ATTR_RELIABLE);
   params.fcf.panid_compression = 0;
 
@@ -163,30 +184,64 @@ send_packet(mac_callback_t sent, void *ptr)
     PRINTF("%u %u (%u)\n\r", len, packetbuf_datalen(), packetbuf_totlen());
 
     ret = p_ns->inif->send(packetbuf_hdrptr(), packetbuf_totlen());
+    RIMESTATS_ADD(tx);
+    if(ret == RADIO_TX_NOACK) {
+      RIMESTATS_ADD(noacktx);
+    }
+    switch(ret) {
+    case RADIO_TX_OK:
+      status = MAC_TX_OK;
+      break;
+    case RADIO_TX_COLLISION:
+      status = MAC_TX_COLLISION;
+      break;
+    case RADIO_TX_NOACK:
+      status = MAC_TX_NOACK;
+      num_tx = 3;
+      break;
+    case RADIO_TX_ERR:
+    default:
+      status = MAC_TX_ERR;
+      num_tx = 3;
+      break;
+    }
     if(sent) {
-      switch(ret) {
-      case RADIO_TX_OK:
-        sent(ptr, MAC_TX_OK, 1);
-        break;
-      case RADIO_TX_NOACK:
-    	  sent(ptr, MAC_TX_NOACK, 3);
-		  break;
-      case RADIO_TX_ERR:
-        sent(ptr, MAC_TX_ERR, 3);
-        break;
-      }
+      sent(ptr, status, num_tx);
     }
   } else {
     PRINTF("6MAC-UT: too large header: %u\n\r", len);
+    /* The upper layers wait for the result of every packet */
+    status = MAC_TX_ERR_FATAL;
+    if(sent) {
+      sent(ptr, status, 0);
+    }
   }
+  return status;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  send_one(sent, ptr);
 }
 /*---------------------------------------------------------------------------*/
 void
 send_list(mac_callback_t sent, void *ptr, struct lmac_buf_list *buf_list)
 {
-  if(buf_list != NULL) {
+  struct lmac_buf_list *next;
+
+  while(buf_list != NULL) {
+    /* The callback may free the list */
+    next = buf_list->next;
     queuebuf_to_packetbuf(buf_list->buf);
-    send_packet(sent, ptr);
+    /* All frames but the last one set the frame pending bit, the
+     * transceiver stays ready to transmit in between */
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, next != NULL);
+    if(send_one(sent, ptr) != MAC_TX_OK) {
+      /* Later frames would arrive out of order */
+      return;
+    }
+    buf_list = next;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -196,7 +251,10 @@ input_packet(void)
   frame802154_t frame;
   int len;
 
+  TRACE_RX(E_TRACE_LMAC);
+
   len = packetbuf_datalen();
+  RIMESTATS_ADD(rx);
   if(frame802154_parse(packetbuf_dataptr(), len, &frame) &&
      packetbuf_hdrreduce(len - frame.payload_len)) {
     if(frame.fcf.dest_addr_mode) {
@@ -230,6 +288,7 @@ input_packet(void)
 		p_ns->hmac->input();
 	}
   } else {
+    RIMESTATS_ADD(tooshort);
     PRINTF("6MAC: failed to parse hdr\n\r");
   }
 }
@@ -258,6 +317,10 @@ static void init(s_ns_t* p_netStack)
 {
 	mac_dsn = random_rand() % 256;
 
+#if STATS_CONF_ENABLE
+	stats_register(&mac_stats_group);
+#endif
+
 	if ((p_netStack != NULL) && (p_netStack->inif != NULL)) {
 		p_ns = p_netStack;
 		p_ns->inif->on();
@@ -0,0 +1,95 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Receiver based autonomous scheduler of TSCH, see tsch-schedule.h
+ */
+
+#include "emb6_conf.h"
+#include "emb6.h"
+#include "tsch-schedule.h"
+#include "linkaddr.h"
+
+static struct tsch_slotframe *sf_unicast;
+
+/*---------------------------------------------------------------------------*/
+static uint16_t
+timeslot_of(const linkaddr_t *addr)
+{
+  return (uint16_t)((addr->u8[LINKADDR_SIZE - 1] +
+                     ((uint16_t)addr->u8[LINKADDR_SIZE - 2] << 8)) %
+                    TSCH_AUTONOMOUS_PERIOD);
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  /* The schedule of the network is installed, add a slotframe of our own */
+  sf_unicast = tsch_schedule_add_slotframe(TSCH_AUTONOMOUS_SLOTFRAME_HANDLE,
+                                           TSCH_AUTONOMOUS_PERIOD);
+  tsch_schedule_add_link(sf_unicast, LINK_OPTION_RX, LINK_TYPE_NORMAL,
+                         &linkaddr_node_addr, timeslot_of(&linkaddr_node_addr),
+                         TSCH_AUTONOMOUS_CHANNEL_OFFSET);
+}
+/*---------------------------------------------------------------------------*/
+static void
+neighbor_added(const linkaddr_t *addr)
+{
+  /* Other senders to the neighbor use the same link */
+  tsch_schedule_add_link(sf_unicast, LINK_OPTION_TX | LINK_OPTION_SHARED,
+                         LINK_TYPE_NORMAL, addr, timeslot_of(addr),
+                         TSCH_AUTONOMOUS_CHANNEL_OFFSET);
+}
+/*---------------------------------------------------------------------------*/
+static void
+neighbor_removed(const linkaddr_t *addr)
+{
+  tsch_schedule_remove_link_by_address(sf_unicast, timeslot_of(addr), addr);
+}
+/*---------------------------------------------------------------------------*/
+const struct tsch_scheduler tsch_scheduler_autonomous = {
+  "autonomous",
+  init,
+  NULL,
+  neighbor_added,
+  neighbor_removed,
+};
+/*---------------------------------------------------------------------------*/
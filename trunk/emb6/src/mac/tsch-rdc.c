@@ -0,0 +1,353 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Low MAC of TSCH, operates the radio within a slot, see tsch.h
+ */
+
+#include "emb6_conf.h"
+#include "emb6.h"
+#include "bsp.h"
+#include "tsch.h"
+#include "packetbuf.h"
+#include "queuebuf.h"
+#include "linkaddr.h"
+#include "frame802154.h"
+#include "trace.h"
+#include "stats.h"
+
+#define DEBUG DEBUG_NONE
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/** Step of the clear channel assessments while a frame is on the air */
+#define TSCHRDC_CCA_STEP_US 128
+
+/** Last sequence number received from a sender */
+struct seqno {
+  linkaddr_t sender;
+  uint8_t seqno;
+};
+
+static s_ns_t *p_ns = NULL;
+
+static uint8_t radio_is_on;
+static uint8_t keep_radio_on;
+static uint8_t current_channel;
+
+static struct seqno seqnos[TSCH_MAX_SEQNOS];
+static uint8_t seqno_next;
+
+#if STATS_CONF_ENABLE
+struct tschrdc_stats {
+  uint32_t tx;          /* Frames sent */
+  uint32_t noack;       /* Unicast frames without acknowledgement */
+  uint32_t rx_slots;    /* Receive slots */
+  uint32_t rx_busy;     /* Receive slots with a frame on the air */
+  uint32_t dup;         /* Repeated frames dropped */
+};
+static struct tschrdc_stats tschrdc_stats;
+
+static const st_statsEntry_t tschrdc_stats_entry[] = {
+  STATS_COUNTER(struct tschrdc_stats, tx),
+  STATS_COUNTER(struct tschrdc_stats, noack),
+  STATS_COUNTER(struct tschrdc_stats, rx_slots),
+  STATS_COUNTER(struct tschrdc_stats, rx_busy),
+  STATS_COUNTER(struct tschrdc_stats, dup),
+};
+static st_statsGroup_t tschrdc_stats_group = {
+  NULL, "tschrdc", tschrdc_stats_entry,
+  sizeof(tschrdc_stats_entry) / sizeof(tschrdc_stats_entry[0]),
+  &tschrdc_stats
+};
+#endif /* STATS_CONF_ENABLE */
+
+/*---------------------------------------------------------------------------*/
+static void
+radio_on(void)
+{
+  if(!radio_is_on) {
+    radio_is_on = 1;
+    p_ns->inif->on();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+radio_off(void)
+{
+  if(radio_is_on && !keep_radio_on) {
+    radio_is_on = 0;
+    p_ns->inif->off();
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tschrdc_set_channel(uint8_t channel)
+{
+  if((p_ns == NULL) || (p_ns->inif->set_channel == NULL) ||
+     (channel == current_channel)) {
+    return;
+  }
+  if(p_ns->inif->set_channel(channel)) {
+    current_channel = channel;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tschrdc_listen(uint8_t channel)
+{
+  uint32_t waited = 0;
+
+  if(p_ns == NULL) {
+    return;
+  }
+  STATS_INC(tschrdc_stats.rx_slots);
+  tschrdc_set_channel(channel);
+  radio_on();
+  bsp_delay_us(TSCH_TS_TX_OFFSET_US + TSCH_TS_RX_WAIT_US / 2);
+  if(p_ns->inif->cca == NULL) {
+    /* A frame may be on the air, there is no way to know */
+    bsp_delay_us(TSCH_TS_MAX_RX_US);
+  } else if(!p_ns->inif->cca()) {
+    /* A frame started in the window, wait for its end and the
+     * acknowledgement. A frame which ended already was received. */
+    STATS_INC(tschrdc_stats.rx_busy);
+    while(!p_ns->inif->cca() && (waited < TSCH_TS_MAX_RX_US)) {
+      bsp_delay_us(TSCHRDC_CCA_STEP_US);
+      waited += TSCHRDC_CCA_STEP_US;
+    }
+  }
+  radio_off();
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_one(mac_callback_t sent, void *ptr)
+{
+  int ret;
+
+  if(!packetbuf_attr(PACKETBUF_ATTR_IS_CREATED_AND_SECURED)) {
+    /* An EB is framed by the high MAC already */
+    packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
+    packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, !packetbuf_holds_broadcast());
+    if(p_ns->frame->create_and_secure(p_ns) < 0) {
+      PRINTF("tschrdc: send failed, too large header\n");
+      if(sent) {
+        sent(ptr, MAC_TX_ERR_FATAL, 0);
+      }
+      return MAC_TX_ERR_FATAL;
+    }
+  }
+
+  tschrdc_set_channel((uint8_t)packetbuf_attr(PACKETBUF_ATTR_CHANNEL));
+  bsp_delay_us(TSCH_TS_TX_OFFSET_US);
+  STATS_INC(tschrdc_stats.tx);
+  switch(p_ns->inif->send(packetbuf_hdrptr(), packetbuf_totlen())) {
+  case RADIO_TX_OK:
+    ret = MAC_TX_OK;
+    break;
+  case RADIO_TX_NOACK:
+    STATS_INC(tschrdc_stats.noack);
+    ret = MAC_TX_NOACK;
+    break;
+  case RADIO_TX_COLLISION:
+    ret = MAC_TX_COLLISION;
+    break;
+  default:
+    ret = MAC_TX_ERR;
+    break;
+  }
+  /* The transceiver may listen after the transmission */
+  radio_is_on = 1;
+  radio_off();
+  if(sent) {
+    sent(ptr, ret, 1);
+  }
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+/* Called by the high MAC at the start of a transmit slot */
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  TRACE_TX(E_TRACE_LMAC);
+  if((p_ns == NULL) || (p_ns->frame == NULL) || (p_ns->inif == NULL)) {
+    if(sent) {
+      sent(ptr, MAC_TX_ERR_FATAL, 0);
+    }
+    return;
+  }
+  send_one(sent, ptr);
+}
+/*---------------------------------------------------------------------------*/
+/* A slot carries a single frame, the high MAC sends the others in later
+ * slots */
+static void
+send_list(mac_callback_t sent, void *ptr, struct lmac_buf_list *buf_list)
+{
+  if(buf_list == NULL) {
+    return;
+  }
+  queuebuf_to_packetbuf(buf_list->buf);
+  send_packet(sent, ptr);
+}
+/*---------------------------------------------------------------------------*/
+/* Check whether the frame in the packetbuf was received before */
+static int
+is_duplicate(void)
+{
+  const linkaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+  uint8_t seqno = (uint8_t)packetbuf_attr(PACKETBUF_ATTR_PACKET_ID);
+  int i;
+
+  for(i = 0; i < TSCH_MAX_SEQNOS; i++) {
+    if(linkaddr_cmp(&seqnos[i].sender, sender)) {
+      if(seqnos[i].seqno == seqno) {
+        return 1;
+      }
+      seqnos[i].seqno = seqno;
+      return 0;
+    }
+  }
+  linkaddr_copy(&seqnos[seqno_next].sender, sender);
+  seqnos[seqno_next].seqno = seqno;
+  seqno_next = (seqno_next + 1) % TSCH_MAX_SEQNOS;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_input(void)
+{
+  uint32_t air_us;
+  clock_time_t end;
+
+  TRACE_RX(E_TRACE_LMAC);
+  if((p_ns == NULL) || (p_ns->frame == NULL) || (p_ns->hmac == NULL)) {
+    return;
+  }
+  /* The radio stamps the end of the reception */
+  end = (clock_time_t)packetbuf_attr(PACKETBUF_ATTR_TIMESTAMP);
+  air_us = TSCH_TS_TX_OFFSET_US +
+    (uint32_t)(packetbuf_datalen() + TSCH_PHY_HEADER_LEN) * TSCH_BYTE_AIRTIME_US;
+
+  if(p_ns->frame->parse() < 0) {
+    PRINTF("tschrdc: failed to parse %u\n", packetbuf_datalen());
+    return;
+  }
+  if(!packetbuf_holds_broadcast() &&
+     !linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &linkaddr_node_addr)) {
+    return;
+  }
+  if((packetbuf_attr(PACKETBUF_ATTR_FRAME_TYPE) != FRAME802154_BEACONFRAME) &&
+     is_duplicate()) {
+    /* A retransmission whose acknowledgement was lost */
+    STATS_INC(tschrdc_stats.dup);
+    return;
+  }
+  /* The high MAC synchronizes to the start of the slot of the sender */
+  packetbuf_set_attr(PACKETBUF_ATTR_TIMESTAMP, (packetbuf_attr_t)(end -
+                     (clock_time_t)(air_us * bsp_get(E_BSP_GET_TRES) / 1000000UL)));
+  p_ns->hmac->input();
+}
+/*---------------------------------------------------------------------------*/
+static int8_t
+turn_on(void)
+{
+  if(p_ns == NULL) {
+    return 0;
+  }
+  keep_radio_on = 1;
+  radio_on();
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int8_t
+turn_off(int keep_on)
+{
+  if(p_ns == NULL) {
+    return 0;
+  }
+  keep_radio_on = keep_on;
+  if(keep_on) {
+    radio_on();
+  } else {
+    radio_off();
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(s_ns_t *p_netStack)
+{
+  if((p_netStack == NULL) || (p_netStack->inif == NULL)) {
+    return;
+  }
+  p_ns = p_netStack;
+  keep_radio_on = 0;
+  radio_is_on = 1;
+  /* Unknown, the first slot tunes the radio */
+  current_channel = 0xff;
+  radio_off();
+#if STATS_CONF_ENABLE
+  stats_register(&tschrdc_stats_group);
+#endif /* STATS_CONF_ENABLE */
+}
+/*---------------------------------------------------------------------------*/
+const s_nsLowMac_t tschrdc_driver = {
+  "tschrdc",
+  init,
+  send_packet,
+  send_list,
+  packet_input,
+  turn_on,
+  turn_off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,267 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Slotframes and links of TSCH, see tsch-schedule.h
+ */
+
+#include "emb6_conf.h"
+#include "emb6.h"
+#include "tsch-schedule.h"
+#include "memb.h"
+
+#include <string.h>
+
+MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
+MEMB(link_memb, struct tsch_link, TSCH_SCHEDULE_MAX_LINKS);
+/* Slotframes in the order of their handles */
+LIST(slotframe_list);
+
+/*---------------------------------------------------------------------------*/
+uint16_t
+tsch_asn_mod(const struct tsch_asn_t *asn, uint16_t size)
+{
+  if(size == 0) {
+    return 0;
+  }
+  /* 2^32 % size, computed without 64 bit arithmetic */
+  return (uint16_t)(((uint32_t)(asn->ls4b % size) +
+                     (uint32_t)asn->ms1b * ((0xffffffffUL % size + 1) % size))
+                    % size);
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_schedule_init(void)
+{
+  memb_init(&slotframe_memb);
+  memb_init(&link_memb);
+  list_init(slotframe_list);
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_slotframe *
+tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_slotframe *prev = NULL;
+  struct tsch_slotframe *next;
+
+  if((size == 0) || (tsch_schedule_get_slotframe_by_handle(handle) != NULL)) {
+    return NULL;
+  }
+  sf = memb_alloc(&slotframe_memb);
+  if(sf == NULL) {
+    return NULL;
+  }
+  sf->handle = handle;
+  sf->size = size;
+  LIST_STRUCT_INIT(sf, links_list);
+  /* Keep the handles in order, the lowest handle has priority */
+  for(next = list_head(slotframe_list); (next != NULL) && (next->handle < handle);
+      next = list_item_next(next)) {
+    prev = next;
+  }
+  list_insert(slotframe_list, prev, sf);
+  return sf;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
+{
+  struct tsch_link *l;
+
+  if(slotframe == NULL) {
+    return 0;
+  }
+  while((l = list_pop(slotframe->links_list)) != NULL) {
+    memb_free(&link_memb, l);
+  }
+  list_remove(slotframe_list, slotframe);
+  memb_free(&slotframe_memb, slotframe);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_schedule_remove_all_slotframes(void)
+{
+  while(list_head(slotframe_list) != NULL) {
+    tsch_schedule_remove_slotframe(list_head(slotframe_list));
+  }
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_slotframe *
+tsch_schedule_get_slotframe_by_handle(uint16_t handle)
+{
+  struct tsch_slotframe *sf;
+
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    if(sf->handle == handle) {
+      return sf;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_link *
+tsch_schedule_add_link(struct tsch_slotframe *slotframe,
+                       uint8_t link_options, enum link_type link_type,
+                       const linkaddr_t *address,
+                       uint16_t timeslot, uint16_t channel_offset)
+{
+  struct tsch_link *l;
+
+  if((slotframe == NULL) || (timeslot >= slotframe->size)) {
+    return NULL;
+  }
+  l = memb_alloc(&link_memb);
+  if(l == NULL) {
+    return NULL;
+  }
+  linkaddr_copy(&l->addr, (address != NULL) ? address : &linkaddr_null);
+  l->slotframe_handle = slotframe->handle;
+  l->timeslot = timeslot;
+  l->channel_offset = channel_offset;
+  l->link_options = link_options;
+  l->link_type = link_type;
+  list_add(slotframe->links_list, l);
+  return l;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_remove_link(struct tsch_slotframe *slotframe,
+                          struct tsch_link *link)
+{
+  if((slotframe == NULL) || (link == NULL)) {
+    return 0;
+  }
+  list_remove(slotframe->links_list, link);
+  memb_free(&link_memb, link);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_schedule_remove_link_by_address(struct tsch_slotframe *slotframe,
+                                     uint16_t timeslot,
+                                     const linkaddr_t *address)
+{
+  struct tsch_link *l;
+  struct tsch_link *next;
+
+  if(slotframe == NULL) {
+    return;
+  }
+  for(l = list_head(slotframe->links_list); l != NULL; l = next) {
+    next = list_item_next(l);
+    if((l->timeslot == timeslot) && linkaddr_cmp(&l->addr, address)) {
+      tsch_schedule_remove_link(slotframe, l);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_slotframe *
+tsch_schedule_get_slotframe_next(struct tsch_slotframe *sf)
+{
+  return (sf == NULL) ? list_head(slotframe_list) : list_item_next(sf);
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_link *
+tsch_schedule_get_link_next(struct tsch_slotframe *slotframe,
+                            struct tsch_link *link)
+{
+  if(slotframe == NULL) {
+    return NULL;
+  }
+  return (link == NULL) ? list_head(slotframe->links_list)
+                        : list_item_next(link);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+tsch_schedule_get_next_active_link(const struct tsch_asn_t *asn)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  uint16_t timeslot;
+  uint16_t diff;
+  uint16_t min = 0;
+
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    timeslot = tsch_asn_mod(asn, sf->size);
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      /* Slots strictly after the ASN */
+      diff = (l->timeslot > timeslot) ? l->timeslot - timeslot
+                                      : sf->size - timeslot + l->timeslot;
+      if((min == 0) || (diff < min)) {
+        min = diff;
+      }
+    }
+  }
+  return min;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_has_tx_link(const linkaddr_t *address)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      if((l->link_options & LINK_OPTION_TX) &&
+         linkaddr_cmp(&l->addr, address)) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_schedule_create_minimal(void)
+{
+  struct tsch_slotframe *sf;
+
+  tsch_schedule_remove_all_slotframes();
+  sf = tsch_schedule_add_slotframe(0, TSCH_SCHEDULE_DEFAULT_LENGTH);
+  tsch_schedule_add_link(sf,
+                         LINK_OPTION_TX | LINK_OPTION_RX | LINK_OPTION_SHARED |
+                         LINK_OPTION_TIME_KEEPING,
+                         LINK_TYPE_ADVERTISING, &linkaddr_null, 0, 0);
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,1049 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH high MAC: transmit queues, slot operation, enhanced beacons
+ *         and joining, see tsch.h
+ */
+
+#include "emb6_conf.h"
+#include "emb6.h"
+#include "bsp.h"
+#include "tsch.h"
+#include "tsch-schedule.h"
+#include "frame802154.h"
+#include "frame802154e-ie.h"
+#include "packetbuf.h"
+#include "queuebuf.h"
+#include "ctimer.h"
+#include "clist.h"
+#include "memb.h"
+#include "random.h"
+#include "trace.h"
+#include "stats.h"
+
+#include <string.h>
+
+#define DEBUG DEBUG_NONE
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/** Packet waiting in the queue of a neighbor */
+struct tsch_packet {
+  struct tsch_packet *next;
+  struct queuebuf *buf;
+  mac_callback_t sent;
+  void *ptr;
+  uint8_t transmissions;
+  uint8_t max_transmissions;
+#if TRACE_CONF_ENABLE
+  /* The packet is sent later in its slot, outside of its trace */
+  uint16_t trace;
+#endif /* TRACE_CONF_ENABLE */
+};
+
+/** Transmit queue of a neighbor */
+struct tsch_neighbor {
+  struct tsch_neighbor *next;
+  linkaddr_t addr;
+  /** Backoff in shared links, in shared slots still to skip */
+  uint8_t be;
+  uint8_t backoff_window;
+  uint8_t num;
+  LIST_STRUCT(queue);
+};
+
+MEMB(neighbor_memb, struct tsch_neighbor, TSCH_QUEUE_MAX_NEIGHBOR_QUEUES);
+MEMB(packet_memb, struct tsch_packet, TSCH_QUEUE_MAX_PACKETS);
+/* Unicast neighbors, the queue of a neighbor is kept while it is empty */
+LIST(neighbor_list);
+static struct tsch_neighbor broadcast_neighbor;
+
+static s_ns_t *p_ns = NULL;
+
+static const uint8_t default_hopping_sequence[] = TSCH_HOPPING_SEQUENCE;
+static uint8_t hopping_sequence[FRAME802154E_IE_MAX_HOPPING];
+static uint8_t hopping_sequence_len;
+
+static uint8_t is_coordinator;
+static uint8_t associated;
+static uint8_t join_priority;
+static const struct tsch_scheduler *scheduler;
+static linkaddr_t time_source;
+static uint8_t has_time_source;
+/** Last frame of the time source */
+static clock_time_t last_sync;
+
+/** Current or next active slot and the tick it starts */
+static struct tsch_asn_t current_asn;
+static clock_time_t current_slot_start;
+static struct ctimer slot_timer;
+/** Start of the last receive slot */
+static clock_time_t last_rx_slot_start;
+/** Result of the transmission in the current slot */
+static int tx_status;
+/** Neighbor served last in a shared link */
+static struct tsch_neighbor *last_served;
+
+/** EB waiting for an advertising link, the ASN and the join priority are
+ *  written at eb_sync_offset when it is sent */
+static struct queuebuf *eb_buf;
+static uint8_t eb_sync_offset;
+static uint8_t eb_seqno;
+static struct ctimer eb_timer;
+
+static struct ctimer scan_timer;
+static uint8_t scan_index;
+
+#if STATS_CONF_ENABLE
+struct tsch_stats {
+  uint32_t slots;       /* Active slots */
+  uint32_t tx;          /* Transmissions of data frames */
+  uint32_t retransmit;  /* Repeated transmissions */
+  uint32_t drop;        /* Packets given up */
+  uint32_t queue_full;  /* Packets rejected because the queues were full */
+  uint32_t eb_tx;       /* EBs sent */
+  uint32_t eb_rx;       /* EBs received */
+  uint32_t join;        /* Networks joined or started */
+  uint32_t leave;       /* Networks left */
+  uint32_t resync;      /* Corrections of the slot timing */
+  uint32_t late;        /* Slots missed because the timer fired late */
+};
+static struct tsch_stats tsch_stats;
+
+static const st_statsEntry_t tsch_stats_entry[] = {
+  STATS_COUNTER(struct tsch_stats, slots),
+  STATS_COUNTER(struct tsch_stats, tx),
+  STATS_COUNTER(struct tsch_stats, retransmit),
+  STATS_COUNTER(struct tsch_stats, drop),
+  STATS_COUNTER(struct tsch_stats, queue_full),
+  STATS_COUNTER(struct tsch_stats, eb_tx),
+  STATS_COUNTER(struct tsch_stats, eb_rx),
+  STATS_COUNTER(struct tsch_stats, join),
+  STATS_COUNTER(struct tsch_stats, leave),
+  STATS_COUNTER(struct tsch_stats, resync),
+  STATS_COUNTER(struct tsch_stats, late),
+};
+static st_statsGroup_t tsch_stats_group = {
+  NULL, "tsch", tsch_stats_entry,
+  sizeof(tsch_stats_entry) / sizeof(tsch_stats_entry[0]), &tsch_stats
+};
+#endif /* STATS_CONF_ENABLE */
+
+static void slot_operation(void *ptr);
+static void start(void);
+/*---------------------------------------------------------------------------*/
+static void
+asn_inc(struct tsch_asn_t *asn, uint32_t inc)
+{
+  uint32_t ls4b = asn->ls4b + inc;
+
+  if(ls4b < asn->ls4b) {
+    asn->ms1b++;
+  }
+  asn->ls4b = ls4b;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+calculate_channel(uint16_t channel_offset)
+{
+  uint16_t index = (tsch_asn_mod(&current_asn, hopping_sequence_len) +
+                    channel_offset % hopping_sequence_len) % hopping_sequence_len;
+
+  return hopping_sequence[index];
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_hopping_sequence(const uint8_t *sequence, uint8_t len)
+{
+  if(len > FRAME802154E_IE_MAX_HOPPING) {
+    len = FRAME802154E_IE_MAX_HOPPING;
+  }
+  memcpy(hopping_sequence, sequence, len);
+  hopping_sequence_len = len;
+}
+/*---------------------------------------------------------------------------*/
+/* Arm the slot timer, slots which passed already are skipped */
+static void
+arm_slot_timer(void)
+{
+  clock_time_t now = bsp_getTick();
+  uint16_t diff;
+
+  while((long)(current_slot_start - now) < 0) {
+    diff = tsch_schedule_get_next_active_link(&current_asn);
+    if(diff == 0) {
+      /* No links, keep the ASN running */
+      diff = TSCH_SCHEDULE_DEFAULT_LENGTH;
+    }
+    asn_inc(&current_asn, diff);
+    current_slot_start += (clock_time_t)diff * TSCH_TIMESLOT_LENGTH;
+  }
+  ctimer_set(&slot_timer, current_slot_start - now, slot_operation, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+schedule_next_slot(void)
+{
+  uint16_t diff = tsch_schedule_get_next_active_link(&current_asn);
+
+  if(diff == 0) {
+    diff = TSCH_SCHEDULE_DEFAULT_LENGTH;
+  }
+  asn_inc(&current_asn, diff);
+  current_slot_start += (clock_time_t)diff * TSCH_TIMESLOT_LENGTH;
+  arm_slot_timer();
+}
+/*---------------------------------------------------------------------------*/
+/* Move the slots by the difference between the start of a slot of the
+ * time source and the start of the same slot here */
+static void
+resync(long drift)
+{
+  last_sync = bsp_getTick();
+  if(drift == 0) {
+    return;
+  }
+  PRINTF("tsch: resync by %ld\n", drift);
+  STATS_INC(tsch_stats.resync);
+  current_slot_start += (clock_time_t)drift;
+  last_rx_slot_start += (clock_time_t)drift;
+  arm_slot_timer();
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_neighbor *
+neighbor_find(const linkaddr_t *addr)
+{
+  struct tsch_neighbor *n;
+
+  if(linkaddr_cmp(addr, &linkaddr_null)) {
+    return &broadcast_neighbor;
+  }
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(linkaddr_cmp(&n->addr, addr)) {
+      return n;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+neighbor_remove(struct tsch_neighbor *n)
+{
+  linkaddr_t addr;
+
+  linkaddr_copy(&addr, &n->addr);
+  if(last_served == n) {
+    last_served = NULL;
+  }
+  list_remove(neighbor_list, n);
+  memb_free(&neighbor_memb, n);
+  if((scheduler != NULL) && (scheduler->neighbor_removed != NULL)) {
+    scheduler->neighbor_removed(&addr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_neighbor *
+neighbor_add(const linkaddr_t *addr)
+{
+  struct tsch_neighbor *n = memb_alloc(&neighbor_memb);
+
+  if(n == NULL) {
+    /* Give the queue of an idle neighbor away */
+    for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+      if((n->num == 0) &&
+         !(has_time_source && linkaddr_cmp(&n->addr, &time_source))) {
+        neighbor_remove(n);
+        break;
+      }
+    }
+    n = memb_alloc(&neighbor_memb);
+    if(n == NULL) {
+      return NULL;
+    }
+  }
+  linkaddr_copy(&n->addr, addr);
+  n->be = TSCH_MAC_MIN_BE;
+  n->backoff_window = 0;
+  n->num = 0;
+  LIST_STRUCT_INIT(n, queue);
+  list_add(neighbor_list, n);
+  if((scheduler != NULL) && (scheduler->neighbor_added != NULL)) {
+    scheduler->neighbor_added(addr);
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Start the channel access of the packet at the head of a queue */
+static void
+start_packet(struct tsch_neighbor *n)
+{
+  n->be = TSCH_MAC_MIN_BE;
+  n->backoff_window = 0;
+  if((n == &broadcast_neighbor) && (n->num > 0)) {
+    n->backoff_window = (uint8_t)(random_rand() % (1u << TSCH_MAC_BROADCAST_BE)) + 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Remove the packet at the head of a queue and report the result */
+static void
+finish_packet(struct tsch_neighbor *n, int status)
+{
+  struct tsch_packet *q = list_pop(n->queue);
+  mac_callback_t sent;
+  void *ptr;
+  uint8_t transmissions;
+
+  if(q == NULL) {
+    return;
+  }
+  n->num--;
+  start_packet(n);
+  if(status != MAC_TX_OK) {
+    STATS_INC(tsch_stats.drop);
+  }
+  sent = q->sent;
+  ptr = q->ptr;
+  transmissions = q->transmissions;
+  queuebuf_free(q->buf);
+  memb_free(&packet_memb, q);
+  if(sent) {
+    sent(ptr, status, transmissions);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_queues(void)
+{
+  struct tsch_neighbor *n;
+
+  while(broadcast_neighbor.num > 0) {
+    finish_packet(&broadcast_neighbor, MAC_TX_ERR);
+  }
+  while((n = list_head(neighbor_list)) != NULL) {
+    while(n->num > 0) {
+      finish_packet(n, MAC_TX_ERR);
+    }
+    neighbor_remove(n);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* A queue may send in a link */
+static int
+is_ready(struct tsch_neighbor *n, const struct tsch_link *link)
+{
+  return (n->num > 0) &&
+    (!(link->link_options & LINK_OPTION_SHARED) || (n->backoff_window == 0));
+}
+/*---------------------------------------------------------------------------*/
+/* A shared transmit slot passed for the queues which may use the link */
+static void
+update_backoff_windows(const struct tsch_link *link)
+{
+  struct tsch_neighbor *n;
+  int is_broadcast_link = linkaddr_cmp(&link->addr, &linkaddr_null);
+
+  if(is_broadcast_link && (broadcast_neighbor.backoff_window > 0)) {
+    broadcast_neighbor.backoff_window--;
+  }
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if((n->backoff_window > 0) &&
+       (is_broadcast_link || linkaddr_cmp(&n->addr, &link->addr))) {
+      n->backoff_window--;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Unicast queue without a transmit link of its own, in round robin order */
+static struct tsch_neighbor *
+get_unicast_for_shared_link(const struct tsch_link *link)
+{
+  struct tsch_neighbor *n;
+
+  for(n = (last_served != NULL) ? list_item_next(last_served) : NULL;
+      n != NULL; n = list_item_next(n)) {
+    if(is_ready(n, link) && !tsch_schedule_has_tx_link(&n->addr)) {
+      return n;
+    }
+  }
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(is_ready(n, link) && !tsch_schedule_has_tx_link(&n->addr)) {
+      return n;
+    }
+    if(n == last_served) {
+      break;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* What a transmit link sends in the current slot: an EB (n is NULL), the
+ * packet of a queue or nothing */
+static int
+get_packet_for_link(const struct tsch_link *link, struct tsch_neighbor **np)
+{
+  struct tsch_neighbor *n = NULL;
+
+  *np = NULL;
+  if(!linkaddr_cmp(&link->addr, &linkaddr_null)) {
+    n = neighbor_find(&link->addr);
+    if((n != NULL) && is_ready(n, link)) {
+      *np = n;
+      return 1;
+    }
+    return 0;
+  }
+  if((link->link_type != LINK_TYPE_NORMAL) && (eb_buf != NULL)) {
+    return 1;
+  }
+  if(link->link_type == LINK_TYPE_ADVERTISING_ONLY) {
+    return 0;
+  }
+  if(is_ready(&broadcast_neighbor, link)) {
+    n = &broadcast_neighbor;
+  } else {
+    n = get_unicast_for_shared_link(link);
+    if(n != NULL) {
+      last_served = n;
+    }
+  }
+  *np = n;
+  return n != NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* The link of the current slot: a transmit link with something to send,
+ * else the first receive link of the slotframe with the lowest handle.
+ * A receive only link goes before a shared transmit and receive link of a
+ * lower handle: a neighbor sends on the receive only link of a node, e.g.
+ * of the autonomous scheduler, whenever it has a packet for it, and would
+ * always miss the node in slots where the minimal cell is active too.
+ * Broadcasts lost in the shared cell are repeated by the upper layers. */
+static struct tsch_link *
+select_link(struct tsch_neighbor **np, int *has_packet)
+{
+  struct tsch_slotframe *sf = NULL;
+  struct tsch_link *l;
+  struct tsch_link *best = NULL;
+  uint16_t timeslot;
+
+  *np = NULL;
+  *has_packet = 0;
+  while((sf = tsch_schedule_get_slotframe_next(sf)) != NULL) {
+    timeslot = tsch_asn_mod(&current_asn, sf->size);
+    for(l = tsch_schedule_get_link_next(sf, NULL); l != NULL;
+        l = tsch_schedule_get_link_next(sf, l)) {
+      if(l->timeslot != timeslot) {
+        continue;
+      }
+      if((l->link_options & (LINK_OPTION_TX | LINK_OPTION_SHARED)) ==
+         (LINK_OPTION_TX | LINK_OPTION_SHARED)) {
+        update_backoff_windows(l);
+      }
+      if(!*has_packet && (l->link_options & LINK_OPTION_TX) &&
+         get_packet_for_link(l, np)) {
+        *has_packet = 1;
+        best = l;
+      }
+      if(!*has_packet && (l->link_options & LINK_OPTION_RX) &&
+         ((best == NULL) ||
+          ((best->link_options & LINK_OPTION_TX) &&
+           !(l->link_options & LINK_OPTION_TX)))) {
+        best = l;
+      }
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(void *ptr, int status, int num_tx)
+{
+  tx_status = status;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tx_slot(struct tsch_link *link, struct tsch_neighbor *n, uint8_t channel)
+{
+  struct tsch_packet *q;
+  uint8_t *asn;
+#if TRACE_CONF_ENABLE
+  uint16_t trace_prev = TRACE_GET_PACKET();
+#endif /* TRACE_CONF_ENABLE */
+
+  tx_status = MAC_TX_ERR;
+  if(n == NULL) {
+    /* The EB carries the ASN of the slot it is sent in */
+    queuebuf_to_packetbuf(eb_buf);
+    asn = (uint8_t *)packetbuf_hdrptr() + eb_sync_offset + 2;
+    asn[0] = (uint8_t)current_asn.ls4b;
+    asn[1] = (uint8_t)(current_asn.ls4b >> 8);
+    asn[2] = (uint8_t)(current_asn.ls4b >> 16);
+    asn[3] = (uint8_t)(current_asn.ls4b >> 24);
+    asn[4] = current_asn.ms1b;
+    asn[5] = join_priority;
+    packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, channel);
+    p_ns->lmac->send(packet_sent, NULL);
+    STATS_INC(tsch_stats.eb_tx);
+    queuebuf_free(eb_buf);
+    eb_buf = NULL;
+    return;
+  }
+
+  q = list_head(n->queue);
+  queuebuf_to_packetbuf(q->buf);
+  packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, channel);
+  if(q->transmissions > 0) {
+    STATS_INC(tsch_stats.retransmit);
+  }
+  q->transmissions++;
+  STATS_INC(tsch_stats.tx);
+  PRINTF("tsch: send to %02x%02x, transmission %u, channel %u\n",
+         n->addr.u8[6], n->addr.u8[7], q->transmissions, channel);
+  /* The low MAC answers within the slot */
+#if TRACE_CONF_ENABLE
+  TRACE_SET_PACKET(q->trace);
+#endif /* TRACE_CONF_ENABLE */
+  p_ns->lmac->send(packet_sent, NULL);
+  TRACE_SET_PACKET(trace_prev);
+
+  if((tx_status == MAC_TX_OK) || (n == &broadcast_neighbor) ||
+     (tx_status == MAC_TX_ERR_FATAL) ||
+     (q->transmissions >= q->max_transmissions)) {
+    finish_packet(n, tx_status);
+    return;
+  }
+  /* A retransmission keeps the sequence number */
+  queuebuf_update_attr_from_packetbuf(q->buf);
+  if(link->link_options & LINK_OPTION_SHARED) {
+    if(n->be < TSCH_MAC_MAX_BE) {
+      n->be++;
+    }
+    n->backoff_window = (uint8_t)(random_rand() % (1u << n->be)) + 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+leave_network(void)
+{
+  const linkaddr_t *old = has_time_source ? &time_source : NULL;
+
+  PRINTF("tsch: leaving the network\n");
+  STATS_INC(tsch_stats.leave);
+  associated = 0;
+  ctimer_stop(&slot_timer);
+  ctimer_stop(&eb_timer);
+  flush_queues();
+  if((old != NULL) && (scheduler != NULL) &&
+     (scheduler->new_time_source != NULL)) {
+    scheduler->new_time_source(old, NULL);
+  }
+  has_time_source = 0;
+  tsch_schedule_remove_all_slotframes();
+  if(eb_buf != NULL) {
+    queuebuf_free(eb_buf);
+    eb_buf = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+slot_operation(void *ptr)
+{
+  struct tsch_link *link;
+  struct tsch_neighbor *n;
+  int has_packet;
+  uint8_t channel;
+
+  if(!associated) {
+    return;
+  }
+  if(bsp_getTick() != current_slot_start) {
+    /* The timing within the slot would be wrong */
+    STATS_INC(tsch_stats.late);
+  } else {
+    link = select_link(&n, &has_packet);
+    if(link != NULL) {
+      STATS_INC(tsch_stats.slots);
+      channel = calculate_channel(link->channel_offset);
+      if(has_packet) {
+        tx_slot(link, n, channel);
+      } else if(link->link_options & LINK_OPTION_RX) {
+        last_rx_slot_start = current_slot_start;
+        tschrdc_listen(channel);
+      }
+    }
+  }
+
+  if(!is_coordinator &&
+     ((long)(bsp_getTick() - last_sync) > (long)TSCH_DESYNC_THRESHOLD)) {
+    leave_network();
+    start();
+    return;
+  }
+  schedule_next_slot();
+}
+/*---------------------------------------------------------------------------*/
+/* Frame an EB, the ASN and the join priority are written when it is sent */
+static void
+create_eb(void)
+{
+  frame802154_t params;
+  struct ieee802154_ies ies;
+  struct tsch_slotframe *sf;
+  struct tsch_link *l = NULL;
+  struct tsch_slotframe_and_links_link *ie_link;
+  uint8_t *buf;
+  int len = 0;
+  int mlme_start;
+  int hdr_len;
+  int ret;
+
+  packetbuf_clear();
+  buf = packetbuf_dataptr();
+  memset(&ies, 0, sizeof(ies));
+  /* Id 0xff: the sequence itself is sent, joining nodes take it over */
+  ies.ie_channel_hopping_sequence_id = 0xff;
+  ies.ie_hopping_sequence_len = hopping_sequence_len;
+  memcpy(ies.ie_hopping_sequence, hopping_sequence, hopping_sequence_len);
+  /* The links of slotframe 0 are the schedule of the network */
+  sf = tsch_schedule_get_slotframe_by_handle(0);
+  if(sf != NULL) {
+    ies.ie_tsch_slotframe_and_link.num_slotframes = 1;
+    ies.ie_tsch_slotframe_and_link.slotframe_handle = 0;
+    ies.ie_tsch_slotframe_and_link.slotframe_size = sf->size;
+    while(((l = tsch_schedule_get_link_next(sf, l)) != NULL) &&
+          (ies.ie_tsch_slotframe_and_link.num_links < FRAME802154E_IE_MAX_LINKS)) {
+      ie_link = &ies.ie_tsch_slotframe_and_link.links[ies.ie_tsch_slotframe_and_link.num_links++];
+      ie_link->timeslot = l->timeslot;
+      ie_link->channel_offset = l->channel_offset;
+      ie_link->link_options = l->link_options;
+    }
+  }
+
+  /* Header termination, then the MLME IE and its nested IEs */
+  ret = frame80215e_create_ie_header_list_termination_1(buf, PACKETBUF_SIZE, &ies);
+  if(ret < 0) {
+    return;
+  }
+  len += ret;
+  mlme_start = len;
+  len += 2;
+  ies.ie_tsch_synchronization_offset = (uint8_t)len;
+  ret = frame80215e_create_ie_tsch_synchronization(buf + len, PACKETBUF_SIZE - len, &ies);
+  if(ret < 0) {
+    return;
+  }
+  len += ret;
+  ret = frame80215e_create_ie_tsch_timeslot(buf + len, PACKETBUF_SIZE - len, &ies);
+  if(ret < 0) {
+    return;
+  }
+  len += ret;
+  ret = frame80215e_create_ie_tsch_channel_hopping_sequence(buf + len,
+                                                            PACKETBUF_SIZE - len, &ies);
+  if(ret < 0) {
+    return;
+  }
+  len += ret;
+  if(sf != NULL) {
+    ret = frame80215e_create_ie_tsch_slotframe_and_link(buf + len,
+                                                        PACKETBUF_SIZE - len, &ies);
+    if(ret < 0) {
+      return;
+    }
+    len += ret;
+  }
+  ies.ie_mlme_len = (uint16_t)(len - mlme_start - 2);
+  frame80215e_create_ie_mlme(buf + mlme_start, 2, &ies);
+  packetbuf_set_datalen(len);
+
+  memset(&params, 0, sizeof(params));
+  params.fcf.frame_type = FRAME802154_BEACONFRAME;
+  params.fcf.frame_version = FRAME802154_IEEE802154_2015;
+  params.fcf.ie_list_present = 1;
+  params.fcf.src_addr_mode = (LINKADDR_SIZE == 2) ? FRAME802154_SHORTADDRMODE
+                                                  : FRAME802154_LONGADDRMODE;
+  params.fcf.dest_addr_mode = FRAME802154_SHORTADDRMODE;
+  params.dest_addr[0] = 0xff;
+  params.dest_addr[1] = 0xff;
+  params.dest_pid = mac_phy_config.pan_id;
+  params.src_pid = mac_phy_config.pan_id;
+  linkaddr_copy((linkaddr_t *)&params.src_addr, &linkaddr_node_addr);
+  params.seq = eb_seqno++;
+  params.payload = packetbuf_dataptr();
+  params.payload_len = packetbuf_datalen();
+  hdr_len = frame802154_hdrlen(&params);
+  if(!packetbuf_hdralloc(hdr_len)) {
+    return;
+  }
+  frame802154_create(&params, packetbuf_hdrptr());
+  eb_sync_offset = (uint8_t)(hdr_len + ies.ie_tsch_synchronization_offset);
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_BEACONFRAME);
+  packetbuf_set_attr(PACKETBUF_ATTR_IS_CREATED_AND_SECURED, 1);
+  eb_buf = queuebuf_new_from_packetbuf();
+}
+/*---------------------------------------------------------------------------*/
+static void
+eb_timer_expired(void *ptr)
+{
+  clock_time_t period = TSCH_EB_PERIOD;
+
+  if(associated && (eb_buf == NULL)) {
+    create_eb();
+  }
+  ctimer_set(&eb_timer, period - random_rand() % (period / 4 + 1),
+             eb_timer_expired, NULL);
+}
+/*---------------------------------------------------------------------------*/
+/* Network started or joined */
+static void
+associate_done(void)
+{
+  clock_time_t period = TSCH_EB_PERIOD;
+
+  associated = 1;
+  last_sync = bsp_getTick();
+  STATS_INC(tsch_stats.join);
+  ctimer_stop(&scan_timer);
+  p_ns->lmac->off(0);
+  if((scheduler != NULL) && (scheduler->init != NULL)) {
+    scheduler->init();
+  }
+  if(has_time_source && (scheduler != NULL) &&
+     (scheduler->new_time_source != NULL)) {
+    scheduler->new_time_source(NULL, &time_source);
+  }
+  schedule_next_slot();
+  ctimer_set(&eb_timer, random_rand() % (period / 4 + 1), eb_timer_expired, NULL);
+}
+/*---------------------------------------------------------------------------*/
+/* Join the network of an EB */
+static void
+associate(const struct ieee802154_ies *ies, const linkaddr_t *sender,
+          packetbuf_attr_t slot_start)
+{
+  const struct tsch_slotframe_and_links *sfl = &ies->ie_tsch_slotframe_and_link;
+  struct tsch_slotframe *sf;
+  clock_time_t now = bsp_getTick();
+  int i;
+
+  if(ies->ie_hopping_sequence_len > 0) {
+    set_hopping_sequence(ies->ie_hopping_sequence, ies->ie_hopping_sequence_len);
+  }
+  tsch_schedule_remove_all_slotframes();
+  if(sfl->num_slotframes > 0) {
+    sf = tsch_schedule_add_slotframe(sfl->slotframe_handle, sfl->slotframe_size);
+    for(i = 0; i < sfl->num_links; i++) {
+      tsch_schedule_add_link(sf, sfl->links[i].link_options,
+                             LINK_TYPE_ADVERTISING, &linkaddr_null,
+                             sfl->links[i].timeslot, sfl->links[i].channel_offset);
+    }
+  } else {
+    tsch_schedule_create_minimal();
+  }
+
+  current_asn = ies->ie_asn;
+  /* The time stamp holds the lower bits of the tick */
+  current_slot_start = now - (clock_time_t)(packetbuf_attr_t)((packetbuf_attr_t)now - slot_start);
+  join_priority = ies->ie_join_priority + 1;
+  linkaddr_copy(&time_source, sender);
+  has_time_source = 1;
+  PRINTF("tsch: joined with asn %lu, join priority %u\n",
+         (unsigned long)current_asn.ls4b, join_priority);
+  associate_done();
+}
+/*---------------------------------------------------------------------------*/
+static void
+eb_input(void)
+{
+  struct ieee802154_ies ies;
+  const linkaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+  packetbuf_attr_t slot_start = packetbuf_attr(PACKETBUF_ATTR_TIMESTAMP);
+  clock_time_t expected;
+
+  memset(&ies, 0, sizeof(ies));
+  if((frame802154e_parse_information_elements(packetbuf_dataptr(),
+                                              packetbuf_datalen(), &ies) < 0) ||
+     (ies.ie_tsch_synchronization_offset == 0)) {
+    /* Not a TSCH EB */
+    return;
+  }
+  STATS_INC(tsch_stats.eb_rx);
+
+  if(!associated) {
+    if(!is_coordinator && (ies.ie_join_priority < TSCH_MAX_JOIN_PRIORITY - 1)) {
+      associate(&ies, sender, slot_start);
+    }
+    return;
+  }
+  if(has_time_source && linkaddr_cmp(sender, &time_source)) {
+    /* Start of the slot of the EB here */
+    expected = current_slot_start - (clock_time_t)((long)(current_asn.ls4b -
+                                                  ies.ie_asn.ls4b) * TSCH_TIMESLOT_LENGTH);
+    join_priority = ies.ie_join_priority + 1;
+    resync((int16_t)(packetbuf_attr_t)(slot_start - (packetbuf_attr_t)expected));
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+scan_next(void *ptr)
+{
+  if(associated) {
+    return;
+  }
+  scan_index = (scan_index + 1) % hopping_sequence_len;
+  tschrdc_set_channel(hopping_sequence[scan_index]);
+  ctimer_reset(&scan_timer);
+}
+/*---------------------------------------------------------------------------*/
+/* Start a network or scan for one */
+static void
+start(void)
+{
+  if(associated) {
+    leave_network();
+  }
+  set_hopping_sequence(default_hopping_sequence, sizeof(default_hopping_sequence));
+  if(is_coordinator) {
+    memset(&current_asn, 0, sizeof(current_asn));
+    current_slot_start = bsp_getTick();
+    join_priority = 0;
+    has_time_source = 0;
+    tsch_schedule_create_minimal();
+    PRINTF("tsch: starting a network\n");
+    associate_done();
+    return;
+  }
+  PRINTF("tsch: scanning\n");
+  scan_index = 0;
+  tschrdc_set_channel(hopping_sequence[0]);
+  p_ns->lmac->on();
+  ctimer_set(&scan_timer, TSCH_CHANNEL_SCAN_DURATION, scan_next, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *q = NULL;
+  const linkaddr_t *addr = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  int max_transmissions;
+
+  TRACE_TX(E_TRACE_HMAC);
+  if((p_ns == NULL) || (p_ns->lmac == NULL) || !associated) {
+    if(sent) {
+      sent(ptr, associated ? MAC_TX_ERR_FATAL : MAC_TX_ERR, 0);
+    }
+    return;
+  }
+
+  n = neighbor_find(addr);
+  if(n == NULL) {
+    n = neighbor_add(addr);
+  }
+  if((n != NULL) && (n->num < TSCH_QUEUE_NUM_PER_NEIGHBOR)) {
+    q = memb_alloc(&packet_memb);
+    if(q != NULL) {
+      q->buf = queuebuf_new_from_packetbuf();
+      if(q->buf == NULL) {
+        memb_free(&packet_memb, q);
+        q = NULL;
+      }
+    }
+  }
+  if(q == NULL) {
+    PRINTF("tsch: queue full\n");
+    STATS_INC(tsch_stats.queue_full);
+    if(sent) {
+      sent(ptr, MAC_TX_ERR, 0);
+    }
+    return;
+  }
+
+  max_transmissions = packetbuf_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
+  q->max_transmissions = (max_transmissions > 0) ? max_transmissions
+                                                 : TSCH_MAC_MAX_FRAME_RETRIES + 1;
+  q->transmissions = 0;
+  q->sent = sent;
+  q->ptr = ptr;
+#if TRACE_CONF_ENABLE
+  q->trace = TRACE_GET_PACKET();
+#endif /* TRACE_CONF_ENABLE */
+  list_add(n->queue, q);
+  if(n->num++ == 0) {
+    start_packet(n);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_input(void)
+{
+  packetbuf_attr_t slot_start;
+  int16_t drift;
+
+  TRACE_RX(E_TRACE_HMAC);
+  if(p_ns == NULL) {
+    return;
+  }
+  if(packetbuf_attr(PACKETBUF_ATTR_FRAME_TYPE) == FRAME802154_BEACONFRAME) {
+    eb_input();
+    return;
+  }
+  if(!associated) {
+    return;
+  }
+  if(has_time_source &&
+     linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_SENDER), &time_source)) {
+    /* The frame was sent in the last receive slot */
+    slot_start = packetbuf_attr(PACKETBUF_ATTR_TIMESTAMP);
+    drift = (int16_t)(packetbuf_attr_t)(slot_start -
+                                                (packetbuf_attr_t)last_rx_slot_start);
+    if((drift <= (int16_t)(TSCH_TIMESLOT_LENGTH / 2)) &&
+       (-drift <= (int16_t)(TSCH_TIMESLOT_LENGTH / 2))) {
+      resync(drift);
+    }
+  }
+  if(p_ns->llsec != NULL) {
+    p_ns->llsec->input();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int8_t
+on(void)
+{
+  if((p_ns != NULL) && (p_ns->lmac != NULL)) {
+    return p_ns->lmac->on();
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int8_t
+off(int keep_radio_on)
+{
+  if((p_ns != NULL) && (p_ns->lmac != NULL)) {
+    return p_ns->lmac->off(keep_radio_on);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_set_coordinator(int enable)
+{
+  is_coordinator = (enable != 0);
+  if(p_ns != NULL) {
+    start();
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_is_coordinator(void)
+{
+  return is_coordinator;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_is_associated(void)
+{
+  return associated;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_set_scheduler(const struct tsch_scheduler *sched)
+{
+  scheduler = sched;
+}
+/*---------------------------------------------------------------------------*/
+const linkaddr_t *
+tsch_time_source(void)
+{
+  return has_time_source ? &time_source : NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_get_asn(struct tsch_asn_t *asn)
+{
+  *asn = current_asn;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(s_ns_t *p_netStack)
+{
+  if((p_netStack == NULL) || (p_netStack->lmac == NULL)) {
+    return;
+  }
+  p_ns = p_netStack;
+  memb_init(&neighbor_memb);
+  memb_init(&packet_memb);
+  list_init(neighbor_list);
+  memset(&broadcast_neighbor, 0, sizeof(broadcast_neighbor));
+  broadcast_neighbor.be = TSCH_MAC_MIN_BE;
+  LIST_STRUCT_INIT(&broadcast_neighbor, queue);
+  tsch_schedule_init();
+  associated = 0;
+  has_time_source = 0;
+  last_served = NULL;
+  eb_buf = NULL;
+  eb_seqno = random_rand() & 0xff;
+#if STATS_CONF_ENABLE
+  stats_register(&tsch_stats_group);
+#endif /* STATS_CONF_ENABLE */
+  start();
+}
+/*---------------------------------------------------------------------------*/
+const s_nsHighMac_t tsch_driver = {
+  "tsch",
+  init,
+  send_packet,
+  packet_input,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
@@ -41,16 +41,37 @@
 #include "emb6_conf.h"
 #include "emb6.h"
 #include "uip-mcast6-stats.h"
+#include "stats.h"
 
 #include <string.h>
 /*---------------------------------------------------------------------------*/
 uip_mcast6_stats_t uip_mcast6_stats;
 /*---------------------------------------------------------------------------*/
+#if STATS_CONF_ENABLE
+static const st_statsEntry_t mcast6_stats_entry[] = {
+  STATS_COUNTER(uip_mcast6_stats_t, mcast_in_unique),
+  STATS_COUNTER(uip_mcast6_stats_t, mcast_in_all),
+  STATS_COUNTER(uip_mcast6_stats_t, mcast_in_ours),
+  STATS_COUNTER(uip_mcast6_stats_t, mcast_fwd),
+  STATS_COUNTER(uip_mcast6_stats_t, mcast_out),
+  STATS_COUNTER(uip_mcast6_stats_t, mcast_bad),
+  STATS_COUNTER(uip_mcast6_stats_t, mcast_dropped),
+};
+static st_statsGroup_t mcast6_stats_group = {
+  NULL, "mcast6", mcast6_stats_entry,
+  sizeof(mcast6_stats_entry) / sizeof(mcast6_stats_entry[0]),
+  &uip_mcast6_stats
+};
+#endif /* STATS_CONF_ENABLE */
+/*---------------------------------------------------------------------------*/
 void
 uip_mcast6_stats_init(void *stats)
 {
   memset(&uip_mcast6_stats, 0, sizeof(uip_mcast6_stats));
   uip_mcast6_stats.engine_stats = stats;
+#if STATS_CONF_ENABLE
+  stats_register(&mcast6_stats_group);
+#endif /* STATS_CONF_ENABLE */
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
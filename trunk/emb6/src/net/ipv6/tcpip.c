@@ -60,6 +60,8 @@
 
 #include <string.h>
 #include "evproc.h"
+#include "trace.h"
+#include "stats.h"
 #define DEBUG DEBUG_NONE
 #include "uip-debug.h"
 
@@ -126,7 +128,17 @@ tcpip_output(const uip_lladdr_t *a)
 {
   int ret;
   if(outputfunc != NULL) {
+#if TRACE_CONF_ENABLE
+    /* Packets sent outside of the processing of a received packet
+       start a journey of their own */
+    uint16_t trace_prev = TRACE_GET_PACKET();
+    if(trace_prev == 0) {
+      TRACE_NEW_PACKET();
+    }
+#endif /* TRACE_CONF_ENABLE */
+    TRACE_TX(E_TRACE_TCPIP);
     ret = outputfunc(a);
+    TRACE_SET_PACKET(trace_prev);
     return ret;
   }
   UIP_LOG("tcpip_output: Use tcpip_set_outputfunc() to set an output function");
@@ -199,6 +211,7 @@ packet_input(void)
     if(uip_fw_forward() == UIP_FW_LOCAL) {
       tcpip_is_forwarding = 0;
       check_for_tcp_syn();
+      TRACE_RX(E_TRACE_UIP);
       uip_input();
       if(uip_len > 0) {
 #if UIP_CONF_TCP_SPLIT
@@ -218,6 +231,7 @@ packet_input(void)
 #else /* UIP_CONF_IP_FORWARD */
   if(uip_len > 0) {
     check_for_tcp_syn();
+    TRACE_RX(E_TRACE_UIP);
     uip_input();
     if(uip_len > 0) {
 #if UIP_CONF_TCP_SPLIT
@@ -498,6 +512,7 @@ eventhandler(c_event_t ev, p_data_t data)
 void
 tcpip_input(void)
 {
+	TRACE_RX(E_TRACE_TCPIP);
 	evproc_putEvent(E_EVPROC_EXEC,EVENT_TYPE_PCK_INPUT,NULL);
 //	evproc_pushEvent(EVENT_TYPE_PCK_INPUT, NULL);
   //process_post_synch(&tcpip_process, PACKET_INPUT, NULL);
@@ -764,6 +779,8 @@ tcpip_uipcall(void)
 //  if(ts->p != NULL) {
 //	process_post_synch(ts->p, tcpip_event, ts->state);
 // 	}
+ 	 if (uip_newdata())
+ 		 TRACE_RX(E_TRACE_APP);
  	 if (ts->conn_id != 0)
  		 evproc_putEvent(E_EVPROC_EXEC,EVENT_TYPE_TCPIP,ts->state);
 
@@ -776,6 +793,47 @@ void *	tcpip_gethandler(void)
 	return eventhandler;
 }
 
+/*---------------------------------------------------------------------------*/
+#if STATS_CONF_ENABLE && UIP_STATISTICS == 1
+/** Counters of uip_stat exported by the statistics registry */
+static const st_statsEntry_t tcpip_stats_entry[] = {
+  STATS_COUNTER(struct uip_stats, ip.recv),
+  STATS_COUNTER(struct uip_stats, ip.sent),
+  STATS_COUNTER(struct uip_stats, ip.forwarded),
+  STATS_COUNTER(struct uip_stats, ip.drop),
+  STATS_COUNTER(struct uip_stats, ip.vhlerr),
+  STATS_COUNTER(struct uip_stats, ip.hblenerr),
+  STATS_COUNTER(struct uip_stats, ip.fragerr),
+  STATS_COUNTER(struct uip_stats, ip.chkerr),
+  STATS_COUNTER(struct uip_stats, ip.protoerr),
+  STATS_COUNTER(struct uip_stats, icmp.recv),
+  STATS_COUNTER(struct uip_stats, icmp.sent),
+  STATS_COUNTER(struct uip_stats, icmp.drop),
+  STATS_COUNTER(struct uip_stats, icmp.typeerr),
+  STATS_COUNTER(struct uip_stats, icmp.chkerr),
+#if UIP_TCP
+  STATS_COUNTER(struct uip_stats, tcp.recv),
+  STATS_COUNTER(struct uip_stats, tcp.sent),
+  STATS_COUNTER(struct uip_stats, tcp.drop),
+  STATS_COUNTER(struct uip_stats, tcp.chkerr),
+  STATS_COUNTER(struct uip_stats, tcp.rexmit),
+#endif /* UIP_TCP */
+#if UIP_UDP
+  STATS_COUNTER(struct uip_stats, udp.recv),
+  STATS_COUNTER(struct uip_stats, udp.sent),
+  STATS_COUNTER(struct uip_stats, udp.drop),
+  STATS_COUNTER(struct uip_stats, udp.chkerr),
+#endif /* UIP_UDP */
+  STATS_COUNTER(struct uip_stats, nd6.recv),
+  STATS_COUNTER(struct uip_stats, nd6.sent),
+  STATS_COUNTER(struct uip_stats, nd6.drop),
+};
+static st_statsGroup_t tcpip_stats_group = {
+  NULL, "ipv6", tcpip_stats_entry,
+  sizeof(tcpip_stats_entry) / sizeof(tcpip_stats_entry[0]), &uip_stat
+};
+#endif /* STATS_CONF_ENABLE && UIP_STATISTICS == 1 */
+
 /*---------------------------------------------------------------------------*/
 void tcpip_init(void)
 {
@@ -796,7 +854,11 @@ void tcpip_init(void)
    // it is neede to register callback
 #endif /* UIP_CONF_ICMP6 */
   etimer_set(&periodic, bsp_get(E_BSP_GET_TRES) / 2, eventhandler);
+  etimer_set_slack(&periodic, bsp_get(E_BSP_GET_TRES) / 8);
   uip_init();
+#if STATS_CONF_ENABLE && UIP_STATISTICS == 1
+  stats_register(&tcpip_stats_group);
+#endif /* STATS_CONF_ENABLE && UIP_STATISTICS == 1 */
 #ifdef UIP_FALLBACK_INTERFACE
   UIP_FALLBACK_INTERFACE.init();
 #endif
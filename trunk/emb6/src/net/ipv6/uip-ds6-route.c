@@ -45,6 +45,7 @@
 #include "clist.h"
 #include "memb.h"
 #include "nbr-table.h"
+#include "stats.h"
 
 #include <string.h>
 
@@ -62,6 +63,12 @@ MEMB(neighborroutememb, struct uip_ds6_route_neighbor_route, UIP_DS6_ROUTE_NB);
 LIST(routelist);
 MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 
+#if STATS_CONF_ENABLE
+static st_statsGroup_t routememb_stats = {
+  NULL, "mem.route", stats_membEntry, STATS_MEMB_ENTRIES, &routememb
+};
+#endif /* STATS_CONF_ENABLE */
+
 /* Default routes are held on the defaultrouterlist and their
    structures are allocated from the defaultroutermemb memory block.*/
 LIST(defaultrouterlist);
@@ -149,6 +156,9 @@ uip_ds6_route_init(void)
 {
   memb_init(&routememb);
   list_init(routelist);
+#if STATS_CONF_ENABLE
+  stats_register(&routememb_stats);
+#endif /* STATS_CONF_ENABLE */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 
@@ -140,6 +140,7 @@ uip_ds6_init(void)
             		 bsp_get(E_BSP_GET_TRES)), tcpip_gethandler());
 #endif /* UIP_CONF_ROUTER */
   etimer_set(&uip_ds6_timer_periodic, UIP_DS6_PERIOD, tcpip_gethandler());
+  etimer_set_slack(&uip_ds6_timer_periodic, UIP_DS6_PERIOD / 4);
 
   return;
 }
@@ -125,7 +125,9 @@ new_dio_interval(rpl_instance_t *instance)
 
   /* schedule the timer */
   PRINTF("RPL: Scheduling DIO timer %lu ticks in future (Interval)\n\r", ticks);
+  /* trickle tolerates some jitter, allow coalescing with other timers */
   ctimer_set(&instance->dio_timer, ticks, handle_dio_timer, instance);
+  ctimer_set_slack(&instance->dio_timer, ticks / 16);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -48,6 +48,7 @@
 #include "uip-ds6.h"
 #include "uip-icmp6.h"
 #include "rpl-private.h"
+#include "stats.h"
 #if UIP_CONF_IPV6_MULTICAST
 #include "uip-mcast6.h"
 #endif
@@ -63,6 +64,25 @@
 rpl_stats_t rpl_stats;
 #endif
 
+#if RPL_CONF_STATS && STATS_CONF_ENABLE
+static const st_statsEntry_t rpl_stats_entry[] = {
+  STATS_COUNTER(rpl_stats_t, mem_overflows),
+  STATS_COUNTER(rpl_stats_t, local_repairs),
+  STATS_COUNTER(rpl_stats_t, global_repairs),
+  STATS_COUNTER(rpl_stats_t, malformed_msgs),
+  STATS_COUNTER(rpl_stats_t, resets),
+  STATS_COUNTER(rpl_stats_t, parent_switch),
+  STATS_COUNTER(rpl_stats_t, forward_errors),
+  STATS_COUNTER(rpl_stats_t, loop_errors),
+  STATS_COUNTER(rpl_stats_t, loop_warnings),
+  STATS_COUNTER(rpl_stats_t, root_repairs),
+};
+static st_statsGroup_t rpl_stats_group = {
+  NULL, "rpl", rpl_stats_entry,
+  sizeof(rpl_stats_entry) / sizeof(rpl_stats_entry[0]), &rpl_stats
+};
+#endif /* RPL_CONF_STATS && STATS_CONF_ENABLE */
+
 static enum rpl_mode mode = RPL_MODE_MESH;
 /*---------------------------------------------------------------------------*/
 enum rpl_mode
@@ -313,6 +333,9 @@ rpl_init(void)
 
 #if RPL_CONF_STATS
   memset(&rpl_stats, 0, sizeof(rpl_stats));
+#if STATS_CONF_ENABLE
+  stats_register(&rpl_stats_group);
+#endif /* STATS_CONF_ENABLE */
 #endif
   RPL_OF.reset(NULL);
 }
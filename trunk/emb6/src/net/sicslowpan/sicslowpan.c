@@ -73,8 +73,9 @@
 #include "uip-ds6.h"
 #include "rime.h"
 #include "sicslowpan.h"
+#include "trace.h"
+#include "stats.h"
 
-#include "queuebuf.h"
 #include "packetbuf.h"
 #include "nullmac.h"
 #include "sicslowmac.h"
@@ -273,6 +274,37 @@ static struct timer reass_timer;
 #define sicslowpan_len uip_len
 #endif /* SICSLOWPAN_CONF_FRAG */
 
+#if STATS_CONF_ENABLE
+/** Counters of the adaptation layer */
+struct sicslowpan_stats {
+  uint32_t tx;          /**< IP packets to send */
+  uint32_t tx_frag;     /**< Fragments sent */
+  uint32_t tx_drop;     /**< IP packets not or only partly sent */
+  uint32_t rx_frame;    /**< Frames received */
+  uint32_t rx;          /**< IP packets passed to the IP layer */
+  uint32_t rx_drop;     /**< Frames dropped */
+  uint32_t reass_drop;  /**< Reassemblies cancelled */
+  st_statsHist_t frame_len; /**< Length of the received frames */
+};
+static struct sicslowpan_stats sicslowpan_stats;
+
+static const st_statsEntry_t sicslowpan_stats_entry[] = {
+  STATS_COUNTER(struct sicslowpan_stats, tx),
+  STATS_COUNTER(struct sicslowpan_stats, tx_frag),
+  STATS_COUNTER(struct sicslowpan_stats, tx_drop),
+  STATS_COUNTER(struct sicslowpan_stats, rx_frame),
+  STATS_COUNTER(struct sicslowpan_stats, rx),
+  STATS_COUNTER(struct sicslowpan_stats, rx_drop),
+  STATS_COUNTER(struct sicslowpan_stats, reass_drop),
+  STATS_HISTOGRAM(struct sicslowpan_stats, frame_len),
+};
+static st_statsGroup_t sicslowpan_stats_group = {
+  NULL, "6lowpan", sicslowpan_stats_entry,
+  sizeof(sicslowpan_stats_entry) / sizeof(sicslowpan_stats_entry[0]),
+  &sicslowpan_stats
+};
+#endif /* STATS_CONF_ENABLE */
+
 static int last_rssi;
 
 static s_ns_t*		p_ns = NULL;
@@ -1358,6 +1390,9 @@ send_packet(linkaddr_t *dest)
     packetbuf_set_attr(PACKETBUF_ATTR_RELIABLE, 1);
 #endif
 
+    /* A MAC queueing the packet reports the result later */
+    last_tx_status = MAC_TX_DEFERRED;
+
     if ((p_ns != NULL) && (p_ns->llsec != NULL)) {
 		/* Provide a callback function to receive the result of
 		 a packet transmission. */
@@ -1390,6 +1425,9 @@ static uint8_t output(const uip_lladdr_t *localdest)
   /* Number of bytes processed. */
   uint16_t processed_ip_out_len;
 
+  TRACE_TX(E_TRACE_HC);
+  STATS_INC(sicslowpan_stats.tx);
+
   /* init */
   uncomp_hdr_len = 0;
   packetbuf_hdr_len = 0;
@@ -1472,7 +1510,16 @@ static uint8_t output(const uip_lladdr_t *localdest)
 
   if((int)uip_len - (int)uncomp_hdr_len > max_payload - (int)packetbuf_hdr_len) {
 #if SICSLOWPAN_CONF_FRAG
-    struct queuebuf *q;
+    /*
+     * Attributes of the fragments. The lower layers modify the
+     * attributes while sending, they are restored before each fragment.
+     * The fragment payload is taken from uip_buf and the fragment header
+     * is rewritten for each fragment, so the packetbuf does not need to
+     * be copied into a queuebuf and back.
+     */
+    struct packetbuf_attr frag_attrs[PACKETBUF_NUM_ATTRS];
+    struct packetbuf_addr frag_addrs[PACKETBUF_NUM_ADDRS];
+    uint16_t frag_tag;
     /*
      * The outbound IPv6 packet is too large to fit into a single 15.4
      * packet, so we fragment it into multiple packets and send them.
@@ -1480,13 +1527,6 @@ static uint8_t output(const uip_lladdr_t *localdest)
      * IPv6/HC1/HC06/HC_UDP dispatchs/headers.
      * The following fragments contain only the fragn dispatch.
      */
-    int estimated_fragments = ((int)uip_len) / ((int)MAC_MAX_PAYLOAD - SICSLOWPAN_FRAGN_HDR_LEN) + 1;
-    int freebuf = queuebuf_numfree() - 1;
-    PRINTFO("uip_len: %d, fragments: %d, free bufs: %d\n", uip_len, estimated_fragments, freebuf);
-    if(freebuf < estimated_fragments) {
-        PRINTFO("Dropping packet, not enough free bufs\n");
-        return 0;
-    }
 
     PRINTFO("Fragmentation sending packet len %d\n\r", uip_len);
 
@@ -1505,31 +1545,31 @@ static uint8_t output(const uip_lladdr_t *localdest)
     SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
           ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | uip_len));
 /*     PACKETBUF_FRAG_BUF->tag = uip_htons(my_tag); */
-    SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, my_tag);
+    frag_tag = my_tag;
+    SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, frag_tag);
     my_tag++;
 
     /* Copy payload and send */
     packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
     packetbuf_payload_len = (max_payload - packetbuf_hdr_len) & 0xfffffff8;
-    PRINTFO("(len %d, tag %d)\n\r", packetbuf_payload_len, my_tag);
+    PRINTFO("(len %d, tag %d)\n\r", packetbuf_payload_len, frag_tag);
     memcpy(packetbuf_ptr + packetbuf_hdr_len,
            (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, packetbuf_payload_len);
     packetbuf_set_datalen(packetbuf_payload_len + packetbuf_hdr_len);
-    q = queuebuf_new_from_packetbuf();
-    if(q == NULL) {
-      PRINTFO("could not allocate queuebuf for first fragment, dropping packet\n\r");
-      return 0;
-    }
+#if SICSLOWPAN_CONF_FRAG_BURST
+    /* More fragments follow, the MAC sends them as a burst */
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 1);
+#endif /* SICSLOWPAN_CONF_FRAG_BURST */
+    packetbuf_attr_copyto(frag_attrs, frag_addrs);
     send_packet(&dest);
-    queuebuf_to_packetbuf(q);
-    queuebuf_free(q);
-    q = NULL;
+    STATS_INC(sicslowpan_stats.tx_frag);
 
     /* Check tx result. */
     if((last_tx_status == MAC_TX_COLLISION) ||
        (last_tx_status == MAC_TX_ERR) ||
        (last_tx_status == MAC_TX_ERR_FATAL)) {
       PRINTFO("error in fragment tx, dropping subsequent fragments.\n\r");
+      STATS_INC(sicslowpan_stats.tx_drop);
       return 0;
     }
 
@@ -1538,17 +1578,22 @@ static uint8_t output(const uip_lladdr_t *localdest)
     
     /*
      * Create following fragments
-     * Datagram tag is already in the buffer, we need to set the
-     * FRAGN dispatch and for each fragment, the offset
+     * The lower layers may have modified the packetbuf, so for each
+     * fragment the packetbuf is reset, the attributes are restored and
+     * the FRAGN dispatch, the datagram tag and the offset are written.
      */
     packetbuf_hdr_len = SICSLOWPAN_FRAGN_HDR_LEN;
-/*     PACKETBUF_FRAG_BUF->dispatch_size = */
-/*       uip_htons((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len); */
-    SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
-          ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
     packetbuf_payload_len = (max_payload - packetbuf_hdr_len) & 0xfffffff8;
     while(processed_ip_out_len < uip_len) {
       PRINTFO("sicslowpan output: fragment ");
+      packetbuf_clear();
+      packetbuf_attr_copyfrom(frag_attrs, frag_addrs);
+      packetbuf_ptr = packetbuf_dataptr();
+/*     PACKETBUF_FRAG_BUF->dispatch_size = */
+/*       uip_htons((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len); */
+      SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+            ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
+      SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, frag_tag);
       PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = processed_ip_out_len >> 3;
       
       /* Copy payload and send */
@@ -1556,20 +1601,19 @@ static uint8_t output(const uip_lladdr_t *localdest)
         /* last fragment */
         packetbuf_payload_len = uip_len - processed_ip_out_len;
       }
+#if SICSLOWPAN_CONF_FRAG_BURST
+      if(processed_ip_out_len + packetbuf_payload_len >= uip_len) {
+        /* The last fragment ends the burst */
+        packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 0);
+      }
+#endif /* SICSLOWPAN_CONF_FRAG_BURST */
       PRINTFO("(offset %d, len %d, tag %d)\n\r",
-             processed_ip_out_len >> 3, packetbuf_payload_len, my_tag);
+             processed_ip_out_len >> 3, packetbuf_payload_len, frag_tag);
       memcpy(packetbuf_ptr + packetbuf_hdr_len,
              (uint8_t *)UIP_IP_BUF + processed_ip_out_len, packetbuf_payload_len);
       packetbuf_set_datalen(packetbuf_payload_len + packetbuf_hdr_len);
-      q = queuebuf_new_from_packetbuf();
-      if(q == NULL) {
-        PRINTFO("could not allocate queuebuf, dropping fragment\n\r");
-        return 0;
-      }
       send_packet(&dest);
-      queuebuf_to_packetbuf(q);
-      queuebuf_free(q);
-      q = NULL;
+      STATS_INC(sicslowpan_stats.tx_frag);
       processed_ip_out_len += packetbuf_payload_len;
 
       /* Check tx result. */
@@ -1577,11 +1621,13 @@ static uint8_t output(const uip_lladdr_t *localdest)
          (last_tx_status == MAC_TX_ERR) ||
          (last_tx_status == MAC_TX_ERR_FATAL)) {
         PRINTFO("error in fragment tx, dropping subsequent fragments.\n\r");
+        STATS_INC(sicslowpan_stats.tx_drop);
         return 0;
       }
     }
 #else /* SICSLOWPAN_CONF_FRAG */
     PRINTFO("sicslowpan output: Packet too large to be sent without fragmentation support; dropping packet\n\r");
+    STATS_INC(sicslowpan_stats.tx_drop);
     return 0;
 #endif /* SICSLOWPAN_CONF_FRAG */
   } else {
@@ -1625,6 +1671,10 @@ input(void)
   uint8_t first_fragment = 0, last_fragment = 0;
 #endif /*SICSLOWPAN_CONF_FRAG*/
 
+  TRACE_RX(E_TRACE_HC);
+  STATS_INC(sicslowpan_stats.rx_frame);
+  STATS_HIST(sicslowpan_stats.frame_len, packetbuf_datalen());
+
   /* init */
   uncomp_hdr_len = 0;
   packetbuf_hdr_len = 0;
@@ -1639,6 +1689,9 @@ input(void)
 #if SICSLOWPAN_CONF_FRAG
   /* if reassembly timed out, cancel it */
   if(timer_expired(&reass_timer)) {
+    if(processed_ip_in_len > 0) {
+      STATS_INC(sicslowpan_stats.reass_drop);
+    }
     sicslowpan_len = 0;
     processed_ip_in_len = 0;
   }
@@ -1700,10 +1753,14 @@ input(void)
 #if PRIORITIZE_NEW_PACKETS
   if(!is_fragment) {
     /* Prioritize non-fragment packets too. */
+    if(processed_ip_in_len > 0) {
+      STATS_INC(sicslowpan_stats.reass_drop);
+    }
     sicslowpan_len = 0;
     processed_ip_in_len = 0;
   } else if(processed_ip_in_len > 0 && first_fragment
       && !linkaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+    STATS_INC(sicslowpan_stats.reass_drop);
     sicslowpan_len = 0;
     processed_ip_in_len = 0;
   }
@@ -1722,6 +1779,7 @@ input(void)
        * being reassembled or the packet is not a fragment.
        */
       PRINTFI("sicslowpan input: Dropping 6lowpan packet that is not a fragment of the packet currently being reassembled\n\r");
+      STATS_INC(sicslowpan_stats.rx_drop);
       return;
     }
   } else {
@@ -1733,6 +1791,7 @@ input(void)
       /* We are currently not reassembling a packet, but have received a packet fragment
        * that is not the first one. */
       if(is_fragment && !first_fragment) {
+        STATS_INC(sicslowpan_stats.rx_drop);
         return;
       }
 
@@ -1780,6 +1839,7 @@ input(void)
       /* unknown header */
       PRINTFI("sicslowpan input: unknown dispatch: %u\n\r",
              PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH]);
+      STATS_INC(sicslowpan_stats.rx_drop);
       return;
   }
    
@@ -1796,6 +1856,7 @@ input(void)
    */
   if(packetbuf_datalen() < packetbuf_hdr_len) {
     PRINTF("SICSLOWPAN: packet dropped due to header > total packet\n\r");
+    STATS_INC(sicslowpan_stats.rx_drop);
     return;
   }
   packetbuf_payload_len = packetbuf_datalen() - packetbuf_hdr_len;
@@ -1809,6 +1870,7 @@ input(void)
           "SICSLOWPAN: packet dropped, minimum required SICSLOWPAN_IP_BUF size: %d+%d+%d+%d=%d (current size: %d)\n\r",
           UIP_LLH_LEN, uncomp_hdr_len, (uint16_t)(frag_offset << 3),
           packetbuf_payload_len, req_size, sizeof(sicslowpan_buf));
+      STATS_INC(sicslowpan_stats.rx_drop);
       return;
     }
   }
@@ -1871,6 +1933,7 @@ input(void)
       callback->input_callback();
     }
 
+    STATS_INC(sicslowpan_stats.rx);
     tcpip_input();
 #if SICSLOWPAN_CONF_FRAG
   }
@@ -1889,6 +1952,10 @@ void sicslowpan_init(s_ns_t* p_netStack)
    */
   tcpip_set_outputfunc(output);
 
+#if STATS_CONF_ENABLE
+  stats_register(&sicslowpan_stats_group);
+#endif /* STATS_CONF_ENABLE */
+
   if ((p_netStack == NULL) || (p_netStack->llsec == NULL) || (p_netStack->hmac == NULL) || (p_netStack->frame == NULL))
 	  return;
 
@@ -1944,6 +2011,36 @@ sicslowpan_get_last_rssi(void)
 {
   return last_rssi;
 }
+#if SICSLOWPAN_CONF_HC06_API && SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+/*--------------------------------------------------------------------*/
+int
+sicslowpan_hc06_compress(linkaddr_t *link_destaddr, uint8_t *uncomp_len)
+{
+  uncomp_hdr_len = 0;
+  packetbuf_hdr_len = 0;
+  packetbuf_ptr = packetbuf_dataptr();
+
+  compress_hdr_hc06(link_destaddr);
+  *uncomp_len = uncomp_hdr_len;
+  return packetbuf_hdr_len;
+}
+/*--------------------------------------------------------------------*/
+int
+sicslowpan_hc06_uncompress(uint8_t **hdr, uint8_t *uncomp_len)
+{
+  uncomp_hdr_len = 0;
+  packetbuf_hdr_len = 0;
+  packetbuf_ptr = packetbuf_dataptr();
+
+  if((PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH] & 0xe0) != SICSLOWPAN_DISPATCH_IPHC) {
+    return -1;
+  }
+  uncompress_hdr_hc06(0);
+  *hdr = &sicslowpan_buf[UIP_LLH_LEN];
+  *uncomp_len = uncomp_hdr_len;
+  return packetbuf_hdr_len;
+}
+#endif /* SICSLOWPAN_CONF_HC06_API && SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
 /*--------------------------------------------------------------------*/
 const s_nsHeadComp_t sicslowpan_driver = {
   "sicslowpan",
@@ -259,6 +259,22 @@ uint16_t bsp_led(en_bspLedColor_t ui_led, en_bspLedAction_t en_ledAction);
 /*============================================================================*/
 #define	    bsp_delay_us(i_delay)           hal_delay_us(i_delay)
 
+/*============================================================================*/
+/** \brief  This function sleeps until a deadline or until an event was posted
+ *
+ *  \param  l_deadline Tick value to wake up at, 0 for no deadline
+ *
+ */
+/*============================================================================*/
+#define	    bsp_sleepUntil(l_deadline)      hal_sleepUntil(l_deadline)
+
+/*============================================================================*/
+/** \brief  This function wakes up a sleeping \ref bsp_sleepUntil()
+ *
+ */
+/*============================================================================*/
+#define	    bsp_wakeup()                    hal_wakeup()
+
 /*============================================================================*/
 /** \brief  This function initialize a specific pin
  *
@@ -305,6 +321,13 @@ void bsp_wdt(en_bspWdtAction_t wdtAct);
 /*============================================================================*/
 #define 	bsp_getSec()               hal_getSec()
 
+/*============================================================================*/
+/** \brief  This function will return a monotonic 64 bit time in microseconds
+ *
+ */
+/*============================================================================*/
+#define 	bsp_getTimeUs()            hal_getTimeUs()
+
 /*============================================================================*/
 /** \brief  This function will return parameter specifed by type
  *
@@ -135,7 +135,7 @@ uint8_t bsp_init (s_ns_t * ps_ns)
 	if (!board_conf(ps_ns))
 	    return 0;
 
-	random_init(hal_getrand());
+	random_init(((unsigned short)hal_getrand() << 8) | hal_getrand());
 
 	/* Normal exit*/
 	return 1;
@@ -233,6 +233,8 @@ void bsp_spiFrameRead(void * p_spi,uint8_t c_addr, uint8_t * pc_data, uint16_t *
 
 	hal_spiWrite(&c_addr, 1);
 	hal_spiRead((uint8_t *)pi_len, 1);
+	/* The PHR holds a 7 bit length, the reserved bit must not overrun the buffer */
+	*pi_len &= 0x7F;
 	hal_spiRead(pc_data, *pi_len + 1);
 	hal_spiSlaveSel(p_spi,false);
 }
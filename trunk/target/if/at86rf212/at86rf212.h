@@ -99,7 +99,9 @@
 
 #define RF212_CONF_AUTOACK       				TRUE	//!< Define autoacknoledgment
 #define RF212_CONF_AUTORETRIES    				2		//!< Amount of autoretries after failed transmitting
-#define RF212_CONF_RX_BUFFERS 					3		//!< Define using of rx buffers
+#define RF212_TX_BURST_TIMEOUT					(bsp_get(E_BSP_GET_TRES) / 100)	//!< Ticks before the receiver is enabled after an unfinished burst
+#define RF212_CCA_POLL_US						20		//!< Interval of polling the result of a clear channel assessment
+#define RF212_CCA_POLLS							50		//!< Polls before a clear channel assessment is given up
 //#define	RF212_MIN_RX_POWER						0 		// RX sensitivity reduced down to -48 dBm
 #define RF212_CONF_CHECKSUM 					0		//!< RF212_CONF_CHECKSUM=0 for automatic hardware checksum
 #define RF212_CHECKSUM_LEN 						2		//!< Length of a checksum in a frame
@@ -313,18 +315,6 @@ typedef enum E_RF212_SM_STATUS{
                          STRUCTURES AND OTHER TYPEDEFS
 ==============================================================================*/
 
-/** \struct st_rxframe_t
- *  \brief  This struct defines the rx data container.
- *
- *  \see _rf212_fRead
- */
-typedef struct {
-	uint8_t length;                       	/**< Length of frame. */
-	uint8_t data[ MAX_FRAME_LENGTH ]; 		/**< Actual frame data. */
-	uint8_t lqi;                          	/**< LQI value for received frame. */
-	bool crc;                             	/**< Flag - did CRC pass for received frame? */
-}st_rxframe_t ;
-
 #endif /* AT86RF212_H_ */
 /** @} */
 /** @} */
@@ -64,7 +64,9 @@
 #include "at86rf212b_regmap.h"
 
 #include "evproc.h"
+#include "ctimer.h"
 #include "packetbuf.h"
+#include "rxring.h"
 
 
 /*==============================================================================
@@ -82,12 +84,6 @@
 #define bsp_getPin(pin)						bsp_pin(E_BSP_PIN_GET, pin)
 
 
-
-#define move_ind(a)							a++; if (a >= RF212B_CONF_RX_BUFFERS) a=0;
-#define	move_head_ind()						move_ind(c_rxframe_head);
-#define move_tail_ind()						move_ind(c_rxframe_tail);
-
-
 /*==============================================================================
                                      ENUMS
 ==============================================================================*/
@@ -95,18 +91,20 @@
 /*==============================================================================
                           VARIABLE DECLARATIONS
 ==============================================================================*/
-		st_rxframe_t 			gps_rxframe[RF212B_CONF_RX_BUFFERS];
 		uint8_t 				pc_buffer[RF212B_MAX_TX_FRAME_LENGTH + RF212B_CHECKSUM_LEN];
-static	uint8_t 				c_rxframe_head;
-static	uint8_t 				c_rxframe_tail;
+/** Frames received by the interrupt handler */
+static	st_rxring_t				st_rxRing;
 static	uint8_t 				c_receive_on;
+/** The transceiver stays ready to transmit the next frame of a burst */
+static	uint8_t 				c_tx_burst = 0;
+/** Ends a burst that is not continued in time */
+static	struct ctimer			st_burstTimer;
 static  uint8_t 				c_channel;
 static	uint8_t 				c_last_correlation;
 static	uint8_t					c_last_rssi;
 static	uint8_t					c_smallest_rssi;
 static  int8_t					c_rssi_base_val = -100;
 static	uint8_t					c_rf212b_pending;
-static	uint8_t					c_pckCounter = 0;
 static  uint8_t					c_power;
 static  uint8_t					c_sensitivity;
 static	void * 					p_spi = NULL;
@@ -170,7 +168,7 @@ static	uint32_t				pck_cntr_out = 0;
                            LOCAL FUNCTION PROTOTYPES
 ==============================================================================*/
 /* Radio transceiver local functions */
-static void 					_rf212b_fRead(st_rxframe_t * ps_rx_frame);
+static uint8_t 					_rf212b_fRead(void);
 static void						_rf212b_fWrite(uint8_t * pc_write_buffer, uint8_t c_length);
 static void 					_rf212b_setChannel(uint8_t c);
 static void 					_rf212b_smReset(void);
@@ -182,10 +180,11 @@ static e_radio_tx_status_t	 	_rf212b_transmit(uint8_t c_len);
 static void 					_rf212b_callback(c_event_t c_event, p_data_t p_data);
 static	void					_isr_callback(void *);
 static int8_t 					_rf212b_prepare(const void * p_payload, uint8_t c_len);
-static int8_t 					_rf212b_read(void *p_buf, uint8_t c_bufsize);
+static int8_t 					_rf212b_read(void);
 static	void 					_rf212b_setPanAddr(unsigned pan,unsigned addr,const uint8_t ieee_addr[8]);
 static	int8_t					_rf212b_intON(void);
 static	int8_t					_rf212b_intOFF(void);
+static	void					_rf212b_burstEnd(void * p_arg);
 static	int8_t 					_rf212b_extON(void);
 static	int8_t 					_rf212b_extOFF(void);
 static	uint8_t 				_rf212b_getTxPower(void);
@@ -195,6 +194,7 @@ static  int8_t 					_rf212b_getPower(void);
 static	void 					_rf212b_setSensitivity(int8_t sens);
 static	int8_t 					_rf212b_getSensitivity(void);
 static	int8_t					_rf212b_getRSSI(void);
+static	int8_t					_rf212b_cca(void);
 static	void 					_rf212b_wReset(void);
 static	int8_t 					_rf212b_send(const void *pr_payload, uint8_t c_len);
 static	int8_t 					_rf212b_init(s_ns_t* p_netStack);
@@ -221,6 +221,7 @@ const s_nsIf_t rf212b_driver = {
 		_rf212b_getRSSI,
 		_rf212b_AntDiv,
 		_rf212b_AntExtSw,
+		_rf212b_cca,
 };
 /*==============================================================================
                                 LOCAL FUNCTIONS
@@ -237,21 +238,27 @@ static	void _spiBitWrite(void * p_spi,uint8_t c_addr,uint8_t c_mask, uint8_t c_o
 
 
 /*----------------------------------------------------------------------------*/
-/** \brief  Transfer a frame from the radio transceiver to a RAM buffer
+/** \brief  Transfer a frame from the radio transceiver into the receive ring
  *
- *          This version is optimized for use with RF212BB driver.
- *          The callback routine and CRC are left out for speed in reading the rx buffer.
+ *          The frame buffer is read with a single burst transfer directly into
+ *          the packet descriptor of the next free entry of the ring, the frame
+ *          is not copied again before the MAC parses it.
  *          Any delays here can lead to overwrites by the next packet!
  *
- *          If the frame length is out of the defined bounds, the length, lqi and crc
- *          are set to zero.
+ *          Frames with a length out of the defined bounds, duplicates and
+ *          frames that find the ring full are dropped.
  *
- *  \param  ps_rxframe    Pointer to the data structure where the frame is stored.
+ *  \return 1 if the frame was added to the ring, 0 otherwise
  */
-static void _rf212b_fRead(st_rxframe_t * ps_rxframe)
+static uint8_t _rf212b_fRead(void)
 {
+    uint8_t * 	pc_rxdata;
     uint16_t 	c_flen = 0;
 
+	pc_rxdata = rxring_getBuf(&st_rxRing);
+	if (pc_rxdata == NULL)
+		return 0;
+
 	/* CRC was checked in hardware, but redoing the checksum here ensures the rx buffer
 	 * is not being overwritten by the next packet. Since that lengthy computation makes
 	 * such overwrites more likely, we skip it and hope for the best.
@@ -259,22 +266,17 @@ static void _rf212b_fRead(st_rxframe_t * ps_rxframe)
 	 * The 802.15.4 standard requires 640us after a greater than 18 byte frame.
 	 * With a low interrupt latency overwrites should never occur.
 	 */
-	bsp_spiFrameRead(p_spi, 0x20, ps_rxframe->data, &c_flen);
-	ps_rxframe->length = c_flen;
-	/*Read LQI value for this frame.*/
-	ps_rxframe->lqi = ps_rxframe->data[c_flen + 1];
+	bsp_spiFrameRead(p_spi, 0x20, pc_rxdata, &c_flen);
 
-	/* If crc was calculated set crc field in rx_frame_t accordingly.
-	 * Else show the crc has passed the hardware check.
-	 */
-	ps_rxframe->crc   = TRUE;
 	/*Check for correct frame length. Bypassing this test can result in a buffer overrun! */
-    if ( (c_flen <= MIN_FRAME_LENGTH) || (c_flen > MAX_FRAME_LENGTH)) {
-        /* Length test failed */
-    	ps_rxframe->length = 0;
-    	ps_rxframe->lqi    = 0;
-    	ps_rxframe->crc    = FALSE;
-    }
+	if ((c_flen <= MIN_FRAME_LENGTH) || (c_flen > MAX_FRAME_LENGTH))
+		return 0;
+	if (rxring_isDup(&st_rxRing, c_flen))
+		return 0;
+
+	/* The LQI value of the frame follows the frame */
+	rxring_put(&st_rxRing, c_flen, pc_rxdata[c_flen], c_last_rssi);
+	return 1;
 } /*  _rf212b_fRead() */
 
 /*----------------------------------------------------------------------------*/
@@ -614,7 +616,17 @@ static e_radio_tx_status_t _rf212b_transmit(uint8_t c_len)
 	}
 
 	if(c_receive_on) {
-		_rf212b_intON();
+		/* A frame announcing the next one leaves the transceiver in the
+		 * transmit state, the receiver is enabled after the burst */
+		if (packetbuf_attr(PACKETBUF_ATTR_PENDING) &&
+			((c_tx_result == RF212B_TX_SUCCESS) || (c_tx_result == RF212B_TX_SUC_DPEND)))
+		{
+			c_tx_burst = 1;
+			/* The upper layer may not continue the burst */
+			ctimer_set(&st_burstTimer, RF212B_TX_BURST_TIMEOUT, _rf212b_burstEnd, NULL);
+		}
+		else
+			_rf212b_intON();
 	} else {
 	#if RADIOALWAYSON
 	/* Enable reception */
@@ -650,6 +662,19 @@ static e_radio_tx_status_t _rf212b_transmit(uint8_t c_len)
     }
 } /*  _rf212b_transmit() */
 
+/*----------------------------------------------------------------------------*/
+/** \brief  Enables the receiver when no frame followed the last frame of a
+ *          burst in time
+ *
+ *  \param  p_arg   not used
+ */
+/*----------------------------------------------------------------------------*/
+static void _rf212b_burstEnd(void * p_arg)
+{
+	if (c_tx_burst && c_receive_on)
+		_rf212b_intON();
+} /* _rf212b_burstEnd() */
+
 /*----------------------------------------------------------------------------*/
 /** \brief  This function prepares data for transmitting
  *
@@ -707,151 +732,55 @@ static int8_t _rf212b_prepare(const void * p_payload, uint8_t c_len)
 
 
 /*----------------------------------------------------------------------------*/
-/** \brief  This function reads packet that was uploaded from Radio in ISR
- *			he two-byte checksum is appended but the returned length does not include it.
- * 			Frames are buffered in the interrupt routine so this routine
- * 			does not access the hardware or change its status.
- * 			However, this routine must be called with interrupts disabled to avoid ISR
- * 			writing to the same buffer we are reading.
+/** \brief  This function hands the oldest frame of the receive ring to the
+ * 			packetbuf. The packet descriptor the frame was received into
+ * 			becomes the current packetbuf, the frame is not copied.
+ *			The two-byte checksum stays in the buffer but the returned length
+ *			does not include it.
  *  \param     	none
  *
  *  \return    	0			In case of error
  *  \return		length		length of a read packet.
  */
 /*---------------------------------------------------------------------------*/
-static int8_t _rf212b_read(void *p_buf, uint8_t c_bufsize)
+static int8_t _rf212b_read(void)
 {
-	uint8_t 	c_len;
-	uint8_t		*pc_framep;
-#if FOOTER_LEN
-  uint8_t footer[FOOTER_LEN];
-#endif
-#if RF212B_CONF_CHECKSUM
-  uint16_t checksum;
-#endif
-#if RF212B_INSERTACK
-/* Return an ACK to the mac layer */
-  if(ack_pending && bufsize == 3){
-    ack_pending=0;
-    uint8_t *buff=(uint8_t *)buf;
-    buff[0]=2;
-    buff[1]=0;
-    buff[2]=ack_seqnum;
-    return bufsize;
- }
-#endif
+	st_rxringEntry_t *	pst_entry;
+	uint8_t 			c_len;
 
-	/* The length includes the twp-byte checksum but not the LQI byte */
-	c_len = gps_rxframe[c_rxframe_head].length;
-	if (c_len==0) {
-		LOG_ERR( "c_len is 0");
-		move_head_ind();
+	pst_entry = rxring_peek(&st_rxRing);
+	if (pst_entry == NULL)
 		return 0;
-  }
 
-#if RADIOALWAYSON
-	if (c_receive_on) {
-#else
-		if (!c_receive_on) {
-			LOG_ERR("Radio txrx was switched off.");
-			move_head_ind();
-			return 0;
-		}
-#endif
+	if (!c_receive_on) {
+		LOG_ERR("Radio txrx was switched off.");
+		rxring_drop(&st_rxRing);
+		return 0;
+	}
 
+	/* The length includes the two-byte checksum but not the LQI byte */
+	c_len = pst_entry->c_len;
 	if(c_len > RF212B_MAX_TX_FRAME_LENGTH) {
 		/* Oops, we must be out of sync. */
-		gps_rxframe[c_rxframe_head].length=0;
 		LOG_ERR("Radio out of sync.");
-		move_head_ind();
+		rxring_drop(&st_rxRing);
 		return 0;
 	}
 
 	if(c_len <= RF212B_CHECKSUM_LEN) {
-		gps_rxframe[c_rxframe_head].length=0;
 		LOG_ERR("C_LEN too small");
-		move_head_ind();
+		rxring_drop(&st_rxRing);
 		return 0;
 	}
 
-	if(c_len - RF212B_CHECKSUM_LEN > c_bufsize) {
-		gps_rxframe[c_rxframe_head].length=0;
-		LOG_ERR("c_bufsize too small");
-		move_head_ind();
-		return 0;
-	}
-	/* Transfer the frame, stripping the footer, but copying the checksum */
-	pc_framep=&(gps_rxframe[c_rxframe_head].data[0]);
-	memcpy(p_buf,pc_framep,c_len - RF212B_CHECKSUM_LEN + RF212B_CHECKSUM_LEN);
-	c_last_correlation = gps_rxframe[c_rxframe_head].lqi;
-
-	/* Clear the length field to allow buffering of the next packet */
-	gps_rxframe[c_rxframe_head].length=0;
-	move_head_ind();
-//	/* If another packet has been buffered, schedule another receive poll */
-//	if (gps_rxframe[c_rxframe_head].length)
-//		evproc_putEvent(E_EVPROC_TAIL,EVENT_TYPE_PCK_LL,NULL);
-//		_rf212b_callback();
-
-	/* Point to the checksum */
-	pc_framep += c_len - RF212B_CHECKSUM_LEN;
-#if RF212B_CONF_CHECKSUM
-	memcpy(&checksum,pc_framep,RF212B_CHECKSUM_LEN);
-#endif /* RF212B_CONF_CHECKSUM */
-	pc_framep += RF212B_CHECKSUM_LEN;
-	pc_framep += RF212B_TIMESTAMP_LEN;
-#if FOOTER_LEN
-	memcpy(footer,framep,FOOTER_LEN);
-#endif
-#if RF212B_CONF_CHECKSUM
-	if(checksum != crc16_data(p_buf, c_len - RF212B_CHECKSUM_LEN, 0)) {
-		//PRINTF("checksum failed 0x%04x != 0x%04x\n\r",
-		//  checksum, crc16_data(buf, len - AUX_LEN, 0));
-	}
-#if FOOTER_LEN
-	if(footer[1] & FOOTER1_CRC_OK &&
-			checksum == crc16_data(p_buf, c_len - RF212B_CHECKSUM_LEN, 0)) {
-#endif
-#endif /* RF212B_CONF_CHECKSUM */
-
-/* Get the received signal strength for the packet, 0-84 dB above rx threshold */
-#if RF212B_CONF_AUTOACK
- //   _rf212b_last_rssi = bsp_spiSubRead(SR_ED_LEVEL);  //0-84 resolution 1 dB
-		c_last_rssi = bsp_spiRegRead(p_spi, RF212B_READ_COMMAND | RG_PHY_ED_LEVEL); //0-84, resolution 1 dB
-//    c_last_rssi =bsp_spiRead(RG_PHY_ED_LEVEL);  //0-84, resolution 1 dB
-#else
-/* last_rssi will have been set at RX_START interrupt */
-//  _rf212b_last_rssi = 3*bsp_spiSubRead(SR_RSSI);    //0-28 resolution 3 dB
-#endif
-
+	c_last_correlation = pst_entry->c_lqi;
 	/* Save the smallest rssi. The display routine can reset by setting it to zero */
-	if ((c_smallest_rssi == 0) || (c_last_rssi < c_smallest_rssi))
-		c_smallest_rssi = c_last_rssi;
-
- //   _rf212b_last_correlation = rxframe[rxframe_head].lqi;
-    packetbuf_set_attr(PACKETBUF_ATTR_RSSI, c_last_rssi);
-    packetbuf_set_attr(PACKETBUF_ATTR_LINK_QUALITY, c_last_correlation);
+	if ((c_smallest_rssi == 0) || (pst_entry->c_rssi < c_smallest_rssi))
+		c_smallest_rssi = pst_entry->c_rssi;
 
-#if RF212B_CONF_CHECKSUM
-#if FOOTER_LEN
-	} else {
-		len = AUX_LEN;
-	}
-#endif
-#endif
-
-#ifdef RF212BB_HOOK_RX_PACKET
-  RF212BB_HOOK_RX_PACKET(buf,len);
-#endif
-
-  /* Here return just the data length. The checksum is however still in the buffer for packet sniffing */
-  return c_len - RF212B_CHECKSUM_LEN;
-
-#if RADIOALWAYSON
-} else { //Stack thought radio was off
-   return 0;
-}
-#endif
+	/* Here return just the data length. The checksum is however still in the buffer for packet sniffing */
+	rxring_take(&st_rxRing, c_len - RF212B_CHECKSUM_LEN);
+	return c_len - RF212B_CHECKSUM_LEN;
 } /*  _rf212b_read() */
 
 /*----------------------------------------------------------------------------*/
@@ -985,6 +914,50 @@ int8_t _rf212b_getRSSI(void)
 	return (c_rssi_base_val + 1.03 * c_last_rssi);
 }
 
+/*----------------------------------------------------------------------------*/
+/** \brief  Clear channel assessment
+ *
+ *          A measurement can only be requested in RX_ON, the transceiver
+ *          leaves RX_AACK_ON or a transmit burst for it and returns to
+ *          receiving afterwards. A transceiver that is switched off is woken
+ *          up for the measurement. A frame being received makes the channel
+ *          busy.
+ *
+ *  \return 1 if the channel is clear, 0 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _rf212b_cca(void)
+{
+	uint8_t		c_wasOff = !c_receive_on;
+	uint8_t		c_state;
+	int8_t		c_clear = 0;
+	uint16_t	i;
+
+	if (c_wasOff)
+		_rf212b_intON();
+
+	c_state = _rf212b_getState();
+	if ((c_state != BUSY_RX) && (c_state != BUSY_RX_AACK)) {
+		_rf212b_setTrxState(RX_ON);
+		_spiBitWrite(p_spi, RG_PHY_CC_CCA, SR_CCA_REQUEST, 1);
+		/* Eight symbols, 400 us with BPSK-20 */
+		for (i = 0; i < RF212B_CCA_POLLS; i++) {
+			bsp_delay_us(RF212B_CCA_POLL_US);
+			if (bsp_spiBitRead(p_spi, RF212B_READ_COMMAND | RG_TRX_STATUS, SR_E_CCA_DONE)) {
+				c_clear = bsp_spiBitRead(p_spi, RF212B_READ_COMMAND | RG_TRX_STATUS,
+						SR_E_CCA_STATUS);
+				break;
+			}
+		}
+	}
+
+	if (c_wasOff)
+		_rf212b_intOFF();
+	else
+		_rf212b_intON();
+	return c_clear;
+} /* _rf212b_cca() */
+
 void _rf212b_AntDiv(uint8_t value)
 {
 
@@ -1127,6 +1100,7 @@ static int8_t _rf212b_send(const void *pr_payload, uint8_t c_len)
 static int8_t _rf212b_intON(void)
 {
 	c_receive_on = 1;
+	c_tx_burst = 0;
 /* If radio is off (slptr high), turn it on */
 	if (bsp_getPin(p_slpTrig)) {
 	#if RF212BB_CONF_LEDONPORTE1
@@ -1160,6 +1134,7 @@ static int8_t _rf212b_intON(void)
 static int8_t _rf212b_intOFF(void)
 {
 	c_receive_on = 0;
+	c_tx_burst = 0;
 #if RF212BB_CONF_LEDONPORTE1
 	PORTE&=~(1<<PE1); //ledoff
 #endif
@@ -1187,7 +1162,7 @@ static int8_t _rf212b_intOFF(void)
 
 static int8_t _rf212b_extON(void)
 {
-	if (c_receive_on)
+	if (c_receive_on && !c_tx_burst)
 		return 1;
 	_rf212b_intON();
 	return 1;
@@ -1226,7 +1201,6 @@ static void _show_stat(void * ptr)
  =============================================================================*/
 static int8_t _rf212b_init(s_ns_t* p_netStack)
 {
-	uint8_t 	i;
 	uint8_t		c_ret = 0;
 	uint8_t 	c_tvers;
 	uint8_t 	c_tmanu;
@@ -1242,11 +1216,9 @@ static int8_t _rf212b_init(s_ns_t* p_netStack)
 	{
 		bsp_extIntInit(E_TARGET_RADIO_INT, _isr_callback);
 
-		/* Set receive buffers empty and point to the first */
-		for (i=0;i<RF212B_CONF_RX_BUFFERS;i++)
-		  gps_rxframe[i].length=0;
-		c_rxframe_head=0;
-		c_rxframe_tail=0;
+		/* Reserve a packet descriptor for every receive buffer */
+		if (rxring_init(&st_rxRing, "rf212b") != 0)
+			LOG_ERR("%s\n\r","Not all receive buffers reserved.");
 
 
 		bsp_clrPin(p_rst);
@@ -1322,8 +1294,9 @@ static int8_t _rf212b_init(s_ns_t* p_netStack)
 } /* _rf212b_init() */
 
 /*----------------------------------------------------------------------------*/
-/** \brief  This function is called from ISR and it reads packet form
- * 			the frame buffer
+/** \brief  This function is called after the ISR buffered frames and hands
+ * 			them to the MAC. The ISR only writes the tail of the receive
+ * 			ring, so interrupts stay enabled.
  *
  *  \param     none
  *
@@ -1334,26 +1307,18 @@ static void _rf212b_callback(c_event_t c_event, p_data_t p_data)
 {
 	int8_t c_len;
     c_rf212b_pending = 0;
-    // The case where c_pckCounter is less or equal to 0 is not possible, however...
-    c_pckCounter = (c_pckCounter > 0) ? (c_pckCounter - 1) : c_pckCounter;
-    packetbuf_clear();
-
-    /* Turn off interrupts to avoid ISR writing to the same buffers we are reading. */
-    bsp_enterCritical();
-
-    c_len = _rf212b_read(packetbuf_dataptr(), PACKETBUF_SIZE);
 
-    /* Restore interrupts. */
-    bsp_exitCritical();
-    LOG_DBG("%u bytes lqi %u",c_len,c_last_correlation);
+    /* Frames received meanwhile are handled by the same event */
+    while (rxring_peek(&st_rxRing) != NULL) {
+    	c_len = _rf212b_read();
+    	LOG_DBG("%u bytes lqi %u",c_len,c_last_correlation);
 
-    if((c_len > 0) && (p_lmac != NULL)) {
-    	  packetbuf_set_datalen(c_len);
-    	  p_lmac->input();
-    }
+    	if((c_len > 0) && (p_lmac != NULL))
+    		p_lmac->input();
 #if PRINT_PCK_STAT
-    pck_cntr_in++;
+    	pck_cntr_in++;
 #endif /* PRINT_PCK_STAT */
+    }
    // bsp_led(E_BSP_LED_GREEN,E_BSP_LED_TOGGLE);
 } /*  _rf212b_callback() */
 
@@ -1373,7 +1338,6 @@ void _isr_callback(void * p_input)
     uint8_t c_state;
     uint8_t c_int_src; /* used after bsp_spiTranOpen/CLOSE block */
     uint8_t c_isr_mask;
-    c_pckCounter = (c_pckCounter < RF212B_CONF_RX_BUFFERS) ? (c_pckCounter + 1) : c_pckCounter;
     /* Using SPI bus from ISR is generally a bad idea... */
     c_int_src = bsp_spiRegRead(p_spi, RF212B_READ_COMMAND | RG_IRQ_STATUS);
     /* Note: all IRQ are not always automatically disabled when running in ISR */
@@ -1403,9 +1367,7 @@ void _isr_callback(void * p_input)
 #endif
 			if (c_last_rssi >= RF212B_MIN_RX_POWER) {
 #endif
-				_rf212b_fRead(&gps_rxframe[c_rxframe_tail]);
-				move_tail_ind();
-				if (c_receive_on /* && (c_pckCounter < RF212B_CONF_RX_BUFFERS) */)
+				if (_rf212b_fRead() && c_receive_on)
 					evproc_putEvent(E_EVPROC_HEAD,EVENT_TYPE_PCK_LL,NULL);
 #ifdef RF212B_MIN_RX_POWER
 			}
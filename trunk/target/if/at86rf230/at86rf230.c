@@ -63,7 +63,9 @@
 #include "at86rf212b_regmap.h"
 
 #include "evproc.h"
+#include "ctimer.h"
 #include "packetbuf.h"
+#include "rxring.h"
 
 /*==============================================================================
                                      MACROS
@@ -91,11 +93,14 @@
 /*==============================================================================
                           VARIABLE DECLARATIONS
 ==============================================================================*/
-		st_rxframe_t 			gps_rxframe[RF230_CONF_RX_BUFFERS];
 		uint8_t 				pc_buffer[RF230_MAX_TX_FRAME_LENGTH + RF230_CHECKSUM_LEN];
-static	uint8_t 				c_rxframe_head;
-static	uint8_t 				c_rxframe_tail;
+/** Frames received by the interrupt handler */
+static	st_rxring_t				st_rxRing;
 static	uint8_t 				c_receive_on = 0;
+/** The transceiver stays ready to transmit the next frame of a burst */
+static	uint8_t 				c_tx_burst = 0;
+/** Ends a burst that is not continued in time */
+static	struct ctimer			st_burstTimer;
 static uint8_t 					c_channel;
 static	uint8_t 				c_last_correlation;
 static	uint8_t					c_last_rssi;
@@ -115,7 +120,7 @@ const uint8_t mac_address[8] = {RADIO_MAC_ADDR};
                            LOCAL FUNCTION PROTOTYPES
 ==============================================================================*/
 /* Radio transceiver local functions */
-static void 					_rf230_fRead(st_rxframe_t * ps_rx_frame);
+static uint8_t					_rf230_fRead(void);
 static void						_rf230_fWrite(uint8_t * pc_write_buffer, uint8_t c_length);
 static void 					_rf230_setChannel(uint8_t c);
 static void 					_rf230_smReset(void);
@@ -127,10 +132,11 @@ static e_radio_tx_status_t	 	_rf230_transmit(uint8_t c_len);
 static void 					_rf230_callback(c_event_t c_event, p_data_t p_data);
 static void 					_isr_callback(void * p_input);
 static int8_t 					_rf230_prepare(const void * p_payload, uint8_t c_len);
-static int8_t 					_rf230_read(void *p_buf, uint8_t c_bufsize);
+static int8_t 					_rf230_read(void);
 static	void 					_rf230_setPanAddr(unsigned pan,unsigned addr,const uint8_t ieee_addr[8]);
 static	int8_t					_rf230_intON(void);
 static	int8_t					_rf230_intOFF(void);
+static	void					_rf230_burstEnd(void * p_arg);
 static	int8_t 					_rf230_extON(void);
 static	int8_t 					_rf230_extOFF(void);
 static	uint8_t 				_rf230_getTxPower(void);
@@ -165,24 +171,26 @@ static	void _spiBitWrite(void * p_spi,uint8_t c_addr,uint8_t c_mask, uint8_t c_o
 
 
 /*----------------------------------------------------------------------------*/
-/** \brief  Transfer a frame from the radio transceiver to a RAM buffer
+/** \brief  Transfer a frame from the radio transceiver into the receive ring
  *
- *          This version is optimized for use with RF230BB driver.
- *          The callback routine and CRC are left out for speed in reading the rx buffer.
+ *          The frame buffer is read with a single burst transfer directly into
+ *          the packet descriptor of the next free entry of the ring, the frame
+ *          is not copied again before the MAC parses it.
  *          Any delays here can lead to overwrites by the next packet!
  *
- *          If the frame length is out of the defined bounds, the length, lqi and crc
- *          are set to zero.
+ *          Frames with a length out of the defined bounds, duplicates and
+ *          frames that find the ring full are dropped.
  *
- *  \param  ps_rxframe    Pointer to the data structure where the frame is stored.
+ *  \return 1 if the frame was added to the ring, 0 otherwise
  */
-static void _rf230_fRead(st_rxframe_t * ps_rxframe)
+static uint8_t _rf230_fRead(void)
 {
-    uint8_t * 	pc_rxdata = NULL;
+    uint8_t * 	pc_rxdata;
     uint16_t 	c_flen = 0;
 
-	pc_rxdata = (ps_rxframe->data);
-
+	pc_rxdata = rxring_getBuf(&st_rxRing);
+	if (pc_rxdata == NULL)
+		return 0;
 
 	/* CRC was checked in hardware, but redoing the checksum here ensures the rx buffer
 	 * is not being overwritten by the next packet. Since that lengthy computation makes
@@ -193,21 +201,15 @@ static void _rf230_fRead(st_rxframe_t * ps_rxframe)
 	 */
 	bsp_spiFrameRead(p_spi, 0x20, pc_rxdata, &c_flen);
 
-	ps_rxframe->length = c_flen;
-	/*Read LQI value for this frame.*/
-	ps_rxframe->lqi = pc_rxdata[c_flen + 1];
-
-	/* If crc was calculated set crc field in rx_frame_t accordingly.
-	 * Else show the crc has passed the hardware check.
-	 */
-	ps_rxframe->crc   = TRUE;
 	/*Check for correct frame length. Bypassing this test can result in a buffer overrun! */
-    if ( (c_flen <= MIN_FRAME_LENGTH) || (c_flen >= MAX_FRAME_LENGTH)) {
-        /* Length test failed */
-    	ps_rxframe->length = 0;
-    	ps_rxframe->lqi    = 0;
-    	ps_rxframe->crc    = FALSE;
-    }
+	if ((c_flen <= MIN_FRAME_LENGTH) || (c_flen >= MAX_FRAME_LENGTH))
+		return 0;
+	if (rxring_isDup(&st_rxRing, c_flen))
+		return 0;
+
+	/* The LQI value of the frame follows the frame */
+	rxring_put(&st_rxRing, c_flen, pc_rxdata[c_flen], c_last_rssi);
+	return 1;
 } /*  _rf230_fRead() */
 
 /*----------------------------------------------------------------------------*/
@@ -538,7 +540,17 @@ static e_radio_tx_status_t _rf230_transmit(uint8_t c_len)
 	}
 
 	if(c_receive_on) {
-		_rf230_intON();
+		/* A frame announcing the next one leaves the transceiver in the
+		 * transmit state, the receiver is enabled after the burst */
+		if (packetbuf_attr(PACKETBUF_ATTR_PENDING) &&
+			((c_tx_result == RF230_TX_SUCCESS) || (c_tx_result == RF230_TX_SUC_DPEND)))
+		{
+			c_tx_burst = 1;
+			/* The upper layer may not continue the burst */
+			ctimer_set(&st_burstTimer, RF230_TX_BURST_TIMEOUT, _rf230_burstEnd, NULL);
+		}
+		else
+			_rf230_intON();
 	} else {
 	#if RADIOALWAYSON
 	/* Enable reception */
@@ -575,11 +587,25 @@ static e_radio_tx_status_t _rf230_transmit(uint8_t c_len)
     }
 } /*  _rf230_transmit() */
 
+/*----------------------------------------------------------------------------*/
+/** \brief  Enables the receiver when no frame followed the last frame of a
+ *          burst in time
+ *
+ *  \param  p_arg   not used
+ */
+/*----------------------------------------------------------------------------*/
+static void _rf230_burstEnd(void * p_arg)
+{
+	if (c_tx_burst && c_receive_on)
+		_rf230_intON();
+} /* _rf230_burstEnd() */
+
 
 
 /*----------------------------------------------------------------------------*/
-/** \brief  This function is called from ISR and it reads packet form
- * 			the frame buffer
+/** \brief  This function is called after the ISR buffered frames and hands
+ * 			them to the MAC. The ISR only writes the tail of the receive
+ * 			ring, so interrupts stay enabled.
  *
  *  \param     none
  *
@@ -592,20 +618,13 @@ static void _rf230_callback(c_event_t c_event, p_data_t p_data)
 
     c_rf230_pending = 0;
 
-    packetbuf_clear();
-
-    /* Turn off interrupts to avoid ISR writing to the same buffers we are reading. */
-    bsp_enterCritical();
-
-    c_len = _rf230_read(packetbuf_dataptr(), PACKETBUF_SIZE);
-
-    /* Restore interrupts. */
-    bsp_exitCritical();
-    LOG_DBG("%u bytes lqi %u\n\r",c_len,c_last_correlation);
+    /* Frames received meanwhile are handled by the same event */
+    while (rxring_peek(&st_rxRing) != NULL) {
+    	c_len = _rf230_read();
+    	LOG_DBG("%u bytes lqi %u\n\r",c_len,c_last_correlation);
 
-    if((c_len > 0) && (p_lmac != NULL)) {
-    	  packetbuf_set_datalen(c_len);
-    	  p_lmac->input();
+    	if((c_len > 0) && (p_lmac != NULL))
+    		p_lmac->input();
     }
     //bsp_led(E_BSP_LED_GREEN,E_BSP_LED_TOGGLE);
 } /*  _rf230_callback() */
@@ -667,149 +686,55 @@ static int8_t _rf230_prepare(const void * p_payload, uint8_t c_len)
 
 
 /*----------------------------------------------------------------------------*/
-/** \brief  This function reads packet that was uploaded from Radio in ISR
- *			he two-byte checksum is appended but the returned length does not include it.
- * 			Frames are buffered in the interrupt routine so this routine
- * 			does not access the hardware or change its status.
- * 			However, this routine must be called with interrupts disabled to avoid ISR
- * 			writing to the same buffer we are reading.
+/** \brief  This function hands the oldest frame of the receive ring to the
+ * 			packetbuf. The packet descriptor the frame was received into
+ * 			becomes the current packetbuf, the frame is not copied.
+ *			The two-byte checksum stays in the buffer but the returned length
+ *			does not include it.
  *  \param     	none
  *
  *  \return    	0			In case of error
  *  \return		length		length of a read packet.
  */
 /*---------------------------------------------------------------------------*/
-static int8_t _rf230_read(void *p_buf, uint8_t c_bufsize)
+static int8_t _rf230_read(void)
 {
-	uint8_t 	c_len;
-	uint8_t		*pc_framep;
-#if FOOTER_LEN
-  uint8_t footer[FOOTER_LEN];
-#endif
-#if RF230_CONF_CHECKSUM
-  uint16_t checksum;
-#endif
-#if RF230_INSERTACK
-/* Return an ACK to the mac layer */
-  if(ack_pending && bufsize == 3){
-    ack_pending=0;
-    uint8_t *buff=(uint8_t *)buf;
-    buff[0]=2;
-    buff[1]=0;
-    buff[2]=ack_seqnum;
-    return bufsize;
- }
-#endif
+	st_rxringEntry_t *	pst_entry;
+	uint8_t 			c_len;
 
-	/* The length includes the twp-byte checksum but not the LQI byte */
-	c_len = gps_rxframe[c_rxframe_head].length;
-	if (c_len==0) {
-#if RADIOALWAYSON && DEBUGFLOWSIZE
-   if (c_receive_on==0) {if (debugflow[debugflowsize-1]!='z') DEBUGFLOW('z');} //cxmac calls with radio off?
-#endif
-    return 0;
-  }
+	pst_entry = rxring_peek(&st_rxRing);
+	if (pst_entry == NULL)
+		return 0;
 
-#if RADIOALWAYSON
-	if (c_receive_on) {
-#else
-		if (bsp_pin(E_BSP_PIN_GET, p_slpTrig)) {
-			return 0;
-		}
-		if (!c_receive_on) {
-			return 0;
-		}
-#endif
+	if (!c_receive_on) {
+		LOG_ERR("Radio txrx was switched off.");
+		rxring_drop(&st_rxRing);
+		return 0;
+	}
 
+	/* The length includes the two-byte checksum but not the LQI byte */
+	c_len = pst_entry->c_len;
 	if(c_len > RF230_MAX_TX_FRAME_LENGTH) {
 		/* Oops, we must be out of sync. */
-		gps_rxframe[c_rxframe_head].length=0;
+		LOG_ERR("Radio out of sync.");
+		rxring_drop(&st_rxRing);
 		return 0;
 	}
 
 	if(c_len <= RF230_CHECKSUM_LEN) {
-		gps_rxframe[c_rxframe_head].length=0;
+		LOG_ERR("C_LEN too small");
+		rxring_drop(&st_rxRing);
 		return 0;
 	}
 
-	if(c_len - RF230_CHECKSUM_LEN > c_bufsize) {
-		gps_rxframe[c_rxframe_head].length=0;
-		return 0;
-	}
-	/* Transfer the frame, stripping the footer, but copying the checksum */
-	pc_framep=&(gps_rxframe[c_rxframe_head].data[0]);
-	memcpy(p_buf,pc_framep,c_len - RF230_CHECKSUM_LEN + RF230_CHECKSUM_LEN);
-	c_last_correlation = gps_rxframe[c_rxframe_head].lqi;
-
-	/* Clear the length field to allow buffering of the next packet */
-	gps_rxframe[c_rxframe_head].length=0;
-	c_rxframe_head++;
-	if (c_rxframe_head >= RF230_CONF_RX_BUFFERS)
-		c_rxframe_head=0;
-	/* If another packet has been buffered, schedule another receive poll */
-	if (gps_rxframe[c_rxframe_head].length && c_receive_on)
-		evproc_putEvent(E_EVPROC_HEAD,EVENT_TYPE_PCK_LL,NULL);
-//		_rf230_callback();
-
-	/* Point to the checksum */
-	pc_framep += c_len - RF230_CHECKSUM_LEN;
-#if RF230_CONF_CHECKSUM
-	memcpy(&checksum,pc_framep,RF230_CHECKSUM_LEN);
-#endif /* RF230_CONF_CHECKSUM */
-	pc_framep += RF230_CHECKSUM_LEN;
-	pc_framep += RF230_TIMESTAMP_LEN;
-#if FOOTER_LEN
-	memcpy(footer,framep,FOOTER_LEN);
-#endif
-#if RF230_CONF_CHECKSUM
-	if(checksum != crc16_data(p_buf, c_len - RF230_CHECKSUM_LEN, 0)) {
-		//PRINTF("checksum failed 0x%04x != 0x%04x\n\r",
-		//  checksum, crc16_data(buf, len - AUX_LEN, 0));
-	}
-#if FOOTER_LEN
-	if(footer[1] & FOOTER1_CRC_OK &&
-			checksum == crc16_data(p_buf, c_len - RF230_CHECKSUM_LEN, 0)) {
-#endif
-#endif /* RF230_CONF_CHECKSUM */
-
-/* Get the received signal strength for the packet, 0-84 dB above rx threshold */
-#if RF230_CONF_AUTOACK
- //   _rf230_last_rssi = bsp_spiSubRead(SR_ED_LEVEL);  //0-84 resolution 1 dB
-		c_last_rssi = bsp_spiRegRead(p_spi, RF230_READ_COMMAND | RG_PHY_ED_LEVEL); //0-84, resolution 1 dB
-//    c_last_rssi =bsp_spiRead(RG_PHY_ED_LEVEL);  //0-84, resolution 1 dB
-#else
-/* last_rssi will have been set at RX_START interrupt */
-//  _rf230_last_rssi = 3*bsp_spiSubRead(SR_RSSI);    //0-28 resolution 3 dB
-#endif
-
+	c_last_correlation = pst_entry->c_lqi;
 	/* Save the smallest rssi. The display routine can reset by setting it to zero */
-	if ((c_smallest_rssi == 0) || (c_last_rssi < c_smallest_rssi))
-		c_smallest_rssi = c_last_rssi;
-
- //   _rf230_last_correlation = rxframe[rxframe_head].lqi;
-    packetbuf_set_attr(PACKETBUF_ATTR_RSSI, c_last_rssi);
-    packetbuf_set_attr(PACKETBUF_ATTR_LINK_QUALITY, c_last_correlation);
-
-#if RF230_CONF_CHECKSUM
-#if FOOTER_LEN
-	} else {
-		len = AUX_LEN;
-	}
-#endif
-#endif
-
-#ifdef RF230BB_HOOK_RX_PACKET
-  RF230BB_HOOK_RX_PACKET(buf,len);
-#endif
+	if ((c_smallest_rssi == 0) || (pst_entry->c_rssi < c_smallest_rssi))
+		c_smallest_rssi = pst_entry->c_rssi;
 
-  /* Here return just the data length. The checksum is however still in the buffer for packet sniffing */
-  return c_len - RF230_CHECKSUM_LEN;
-
-#if RADIOALWAYSON
-} else { //Stack thought radio was off
-   return 0;
-}
-#endif
+	/* Here return just the data length. The checksum is however still in the buffer for packet sniffing */
+	rxring_take(&st_rxRing, c_len - RF230_CHECKSUM_LEN);
+	return c_len - RF230_CHECKSUM_LEN;
 } /*  _rf230_read() */
 
 /*----------------------------------------------------------------------------*/
@@ -987,6 +912,7 @@ static int8_t _rf230_send(const void *pr_payload, uint8_t c_len)
 static int8_t _rf230_intON(void)
 {
 	c_receive_on = 1;
+	c_tx_burst = 0;
 /* If radio is off (slptr high), turn it on */
 	if (bsp_pin(E_BSP_PIN_GET, p_slpTrig)) {
 	#if RF230BB_CONF_LEDONPORTE1
@@ -1018,6 +944,7 @@ static int8_t _rf230_intON(void)
 static int8_t _rf230_intOFF(void)
 {
 	c_receive_on = 0;
+	c_tx_burst = 0;
 #if RF230BB_CONF_LEDONPORTE1
 	PORTE&=~(1<<PE1); //ledoff
 #endif
@@ -1046,7 +973,7 @@ static int8_t _rf230_intOFF(void)
 
 static int8_t _rf230_extON(void)
 {
-	if (c_receive_on)
+	if (c_receive_on && !c_tx_burst)
 		return 1;
 	_rf230_intON();
 	return 1;
@@ -1075,7 +1002,6 @@ static int8_t _rf230_extOFF(void)
  =============================================================================*/
 static int8_t _rf230_init(s_ns_t* ns)
 {
-	uint8_t 	i;
 	uint8_t 	c_tvers;
 	uint8_t 	c_tmanu;
 	uint8_t		c_ret = 0;
@@ -1093,11 +1019,9 @@ static int8_t _rf230_init(s_ns_t* ns)
 	}
 	bsp_extIntInit(E_TARGET_RADIO_INT, _isr_callback);
 
-	/* Set receive buffers empty and point to the first */
-	for (i=0;i<RF230_CONF_RX_BUFFERS;i++)
-	  gps_rxframe[i].length=0;
-	c_rxframe_head=0;
-	c_rxframe_tail=0;
+	/* Reserve a packet descriptor for every receive buffer */
+	if (rxring_init(&st_rxRing, "rf230") != 0)
+		LOG_ERR("%s\n\r","Not all receive buffers reserved.");
 
 
 	bsp_clrPin(p_rst);
@@ -1170,12 +1094,11 @@ void _isr_callback(void * p_input)
     uint8_t c_state;
     uint8_t c_int_src; /* used after bsp_spiTranOpen/CLOSE block */
     uint8_t c_isr_mask;
-    uint8_t i;
     /* Using SPI bus from ISR is generally a bad idea... */
     c_int_src = bsp_spiRegRead(p_spi, RF230_READ_COMMAND | RG_IRQ_STATUS);
     /* Note: all IRQ are not always automatically disabled when running in ISR */
     /*Handle the incomming interrupt. Prioritized.*/
-    printf("Int source = %d\n\r",c_int_src);
+//    printf("Int source = %d\n\r",c_int_src);
     if ((c_int_src & RX_START_MASK)){
 #if !RF230_CONF_AUTOACK
     	bsp_spiTxRx(p_spi, RF230_READ_COMMAND | SR_RSSI,  &c_last_rssi);
@@ -1200,22 +1123,8 @@ void _isr_callback(void * p_input)
 #endif
 			if (c_last_rssi >= RF230_MIN_RX_POWER) {
 #endif
-				_rf230_fRead(&gps_rxframe[c_rxframe_tail]);
-				for (i=0;i<RF230_CONF_RX_BUFFERS;i++) {
-					if ((i != c_rxframe_tail) && (memcmp(gps_rxframe[c_rxframe_tail].data,gps_rxframe[i].data, MAX_FRAME_LENGTH) == 0)) {
-						gps_rxframe[c_rxframe_tail].length = 0;
-						LOG_INFO("%s\n\r","Duplicate packet detected");
-					}
-				}
-				if (gps_rxframe[c_rxframe_tail].length == 0)
-					return;
-				else {
-					c_rxframe_tail++;
-					if (c_rxframe_tail >= RF230_CONF_RX_BUFFERS)
-						c_rxframe_tail=0;
-					if (c_receive_on)
-						evproc_putEvent(E_EVPROC_HEAD,EVENT_TYPE_PCK_LL,NULL);
-				}
+				if (_rf230_fRead() && c_receive_on)
+					evproc_putEvent(E_EVPROC_HEAD,EVENT_TYPE_PCK_LL,NULL);
 #ifdef RF230_MIN_RX_POWER
 			}
 #endif
@@ -98,7 +98,7 @@
 #define CHANNEL_802_15_4          				26		//!< Define default working channel
 #define RF230_CONF_AUTOACK       				TRUE	//!< Define autoacknoledgment
 #define RF230_CONF_AUTORETRIES    				2		//!< Amount of autoretries after failed transmitting
-#define RF230_CONF_RX_BUFFERS 					3		//!< Define using of rx buffers
+#define RF230_TX_BURST_TIMEOUT					(bsp_get(E_BSP_GET_TRES) / 100)	//!< Ticks before the receiver is enabled after an unfinished burst
 #define RF230_MIN_RX_POWER						0		//!< Receive frames ragardless the input power
 #define RF230_CONF_CHECKSUM 					0		//!< RF230_CONF_CHECKSUM=0 for automatic hardware checksum
 #define RF230_CHECKSUM_LEN 						2		//!< Length of a checksum in a frame
@@ -306,18 +306,6 @@ typedef enum E_RF230_SM_STATUS{
                          STRUCTURES AND OTHER TYPEDEFS
 ==============================================================================*/
 
-/** \struct st_rxframe_t
- *  \brief  This struct defines the rx data container.
- *
- *  \see _rf230_fRead
- */
-typedef struct {
-	uint8_t length;                       	/**< Length of frame. */
-	uint8_t data[ MAX_FRAME_LENGTH ]; 		/**< Actual frame data. */
-	uint8_t lqi;                          	/**< LQI value for received frame. */
-	bool crc;                             	/**< Flag - did CRC pass for received frame? */
-}st_rxframe_t ;
-
 #endif /* AT86RF230_H_ */
 /** @} */
 /** @} */
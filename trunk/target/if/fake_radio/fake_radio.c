@@ -16,13 +16,24 @@
 /*==============================================================================
                                  INCLUDE FILES
 ==============================================================================*/
+#define		_GNU_SOURCE
 #include "emb6.h"
 #include "emb6_conf.h"
 #include "fake_radio.h"
+#include "fradio_medium.h"
 #include "evproc.h"
-#include "etimer.h"
+#include "packetbuf.h"
+#include "uip.h"
+#include "bsp.h"
+#include "hwinit.h"
+#include "sim.h"
+#include "trace.h"
 #include <fcntl.h>
 #include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdlib.h>
 /*==============================================================================
                                      MACROS
 ==============================================================================*/
@@ -32,18 +43,63 @@
 #endif
 #include	"logger.h"
 
+/** Number of received frames buffered by the driver, power of two */
+#ifdef FRADIO_CONF_RX_BUFFERS
+#define		FRADIO_RX_BUFFERS			FRADIO_CONF_RX_BUFFERS
+#else
+#define		FRADIO_RX_BUFFERS			8
+#endif
+
+#if (FRADIO_RX_BUFFERS & (FRADIO_RX_BUFFERS - 1)) != 0
+#error "FRADIO_CONF_RX_BUFFERS must be a power of two"
+#endif
+
+#define		FRADIO_RX_MASK				(FRADIO_RX_BUFFERS - 1)
 /*==============================================================================
                                      ENUMS
 ==============================================================================*/
 
+/*==============================================================================
+						 STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Received frame */
+typedef struct
+{
+	/** Length of the frame */
+	uint16_t 						i_len;
+	/** Header added by the medium simulator */
+	st_fradioMediumHdr_t			st_hdr;
+	/** Tick at the end of the reception */
+	clock_time_t					l_time;
+#if TRACE_CONF_ENABLE
+	/** Trace id of the frame */
+	uint16_t						i_trace;
+#endif
+	/** Frame payload */
+	uint8_t 						pc_data[PACKETBUF_SIZE];
+}st_fradioFrame_t;
+
 /*==============================================================================
                           VARIABLE DECLARATIONS
 ==============================================================================*/
-		static	int 					sockfd;
+#if !NATIVE_SIM
+		static	int 					sockfd = -1;
 		static	struct 	sockaddr_in 	servaddr;
 		static	struct 	sockaddr_in 	cliaddr;
-		static	uint8_t 				tmp_buf[PACKETBUF_SIZE];
-		static 	struct 	etimer 			tmr;
+#endif
+		static	s_nsLowMac_t*			p_lmac = NULL;
+		static	uint8_t					c_receive_on = 1;
+		static	int8_t					c_last_rssi = 0;
+#if FRADIO_MEDIUM || NATIVE_SIM
+		static	uint16_t				i_nodeId = FRADIO_NODE_ID;
+#endif
+/** Ring of received frames, written by _fradio_isr() or _fradio_simRx() and read by
+ *  _fradio_callback() */
+		static	st_fradioFrame_t		gst_rxFrame[FRADIO_RX_BUFFERS];
+		static	volatile uint16_t		i_rxHead = 0;
+		static	volatile uint16_t		i_rxTail = 0;
+/** Number of datagrams dropped because the receive ring was full */
+		static	uint32_t				l_rxDropped = 0;
 
 /*==============================================================================
                                 GLOBAL CONSTANTS
@@ -55,35 +111,84 @@ const uint8_t mac_address[8] = {0x00, 0x00, 0x00, 0x00, 0x00, FAKE_MAC_2_BIT, 0x
 /* Radio transceiver local functions */
 		static	int8_t 					_fradio_on(void);
 		static	int8_t 					_fradio_off(void);
-		static	int8_t 					_fradio_init(void);
+		static	int8_t 					_fradio_init(s_ns_t* p_netStack);
 		static	int8_t 					_fradio_send(const void *pr_payload, uint8_t c_len);
-		static	void					_fradio_handler(c_event_t ev, p_data_t data);
+		static	void					_fradio_setPower(int8_t c_power);
+		static	int8_t					_fradio_getPower(void);
+		static	void					_fradio_setSensitivity(int8_t c_sens);
+		static	int8_t					_fradio_getSensitivity(void);
+		static	int8_t					_fradio_getRSSI(void);
+		static	int8_t					_fradio_cca(void);
+		static	int8_t					_fradio_setChannel(uint8_t c_chan);
+#if NATIVE_SIM
+		static	void					_fradio_simRx(const uint8_t * pc_data, uint16_t i_len,
+														int8_t c_rssi, uint8_t c_lqi);
+		static	uint16_t				_fradio_ackFrom(const uint8_t * pc_frame, uint8_t c_len);
+#else
+		static	int8_t					_fradio_openSocket(void);
+		static	void					_fradio_isr(void * p_data);
+#endif /* NATIVE_SIM */
+		static	void					_fradio_callback(c_event_t c_event, p_data_t p_data);
 
 /*==============================================================================
 						 STRUCTURES AND OTHER TYPEDEFS
 ==============================================================================*/
-const struct s_nsIf_t fradio_driver = {
+const s_nsIf_t fradio_driver = {
+		"fradio",
 		_fradio_init,
 		_fradio_send,
 		_fradio_on,
 		_fradio_off,
+		_fradio_setPower,
+		_fradio_getPower,
+		_fradio_setSensitivity,
+		_fradio_getSensitivity,
+		_fradio_getRSSI,
+		NULL,
+		NULL,
+		_fradio_cca,
+		_fradio_setChannel,
 };
 /*==============================================================================
                                 LOCAL FUNCTIONS
 ==============================================================================*/
-static int8_t _fradio_init(void)
+#if !NATIVE_SIM
+/*----------------------------------------------------------------------------*/
+/** \brief  Open the socket connecting the node to its peer or to the medium
+ *
+ *  \return 1 if success, 0 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _fradio_openSocket(void)
 {
 	uint32_t	env_s_ip;
 	uint32_t	env_s_port;
 	uint32_t	env_c_ip;
 	uint32_t 	env_c_port;
-	linkaddr_t 	un_addr;
+	int			flags;
+	char *		pc_env;
 
+#if FRADIO_MEDIUM
+	/* Every process of a simulated network gets its id from the environment */
+	pc_env = getenv(FRADIO_MEDIUM_NODE_ENV);
+	if ((pc_env != NULL) && (atoi(pc_env) > 0))
+		i_nodeId = atoi(pc_env);
+	if ((i_nodeId == 0) || (i_nodeId >= FRADIO_MEDIUM_MAX_NODES)) {
+		LOG_ERR("invalid node id %d\n\r", i_nodeId);
+		return 0;
+	}
+	env_s_ip = inet_addr(FRADIO_S_IP);
+	env_c_ip = inet_addr(FRADIO_MEDIUM_IP);
+	env_s_port = FRADIO_MEDIUM_PORT + i_nodeId;
+	env_c_port = FRADIO_MEDIUM_PORT;
+	LOG_INFO("node %d attached to medium %s:%d\n", i_nodeId, FRADIO_MEDIUM_IP, FRADIO_MEDIUM_PORT);
+#else
+	(void)pc_env;
 	env_s_ip = inet_addr(FRADIO_S_IP);
 	env_c_ip = inet_addr(FRADIO_C_IP);
 	if (!env_s_ip || !env_c_ip){
 		LOG_ERR("%s\n\r","FRADIO_S_IP or FRADIO_C_IP not found");
-		exit(1);
+		return 0;
 	}
 	LOG_INFO("serv ip is: %s\n", FRADIO_S_IP);
 	LOG_INFO("cli ip is: %s\n", FRADIO_C_IP);
@@ -91,124 +196,353 @@ static int8_t _fradio_init(void)
 #if CLIENT & !SERVER
 	env_s_port = atoi(FRADIO_OUTPORT_CLIENT);
 	env_c_port = atoi(FRADIO_INPORT_CLIENT);
-#elif SERVER & !CLIENT
+#else
 	env_s_port = atoi(FRADIO_OUTPORT_SERVER);
 	env_c_port = atoi(FRADIO_INPORT_SERVER);
 #endif
 	if (!env_s_port || !env_c_port){
 		LOG_ERR("%s\n\r","OUTPORT or INPORT not found");
-		exit(1);
+		return 0;
 	}
 	LOG_INFO("serv port is: %d\n", env_s_port);
 	LOG_INFO("cli port is: %d\n", env_c_port);
+#endif /* FRADIO_MEDIUM */
 
-//	LOG_INFO("initial ll addr = %02X:%02X:%02X:%02X:%02X:%02X\n",uip_lladdr.addr[0],uip_lladdr.addr[1],uip_lladdr.addr[2],uip_lladdr.addr[3],uip_lladdr.addr[4],uip_lladdr.addr[5]);
-	sockfd=socket(AF_INET,SOCK_DGRAM,0);
+	sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (sockfd < 0) {
+		LOG_ERR("fail to create a socket: error %d\n",errno);
+		return 0;
+	}
 
 	memset(&servaddr,0,sizeof(servaddr));
 	servaddr.sin_family = AF_INET;
 	servaddr.sin_addr.s_addr=env_s_ip;
 	servaddr.sin_port=htons(env_s_port);
 	if (bind(sockfd,(struct sockaddr *)&servaddr,sizeof(servaddr)) < 0) {
-		LOG_ERR("fail to create a socket: error %d\n",errno);
-		exit(1);
+		LOG_ERR("fail to bind a socket: error %d\n",errno);
+		return 0;
 	}
 	memset(&cliaddr,0,sizeof(cliaddr));
 	cliaddr.sin_family = AF_INET;
 	cliaddr.sin_addr.s_addr=env_c_ip;
 	cliaddr.sin_port=htons(env_c_port);
-	int flags = fcntl(sockfd, F_GETFL, 0);
-	if (flags < 0){
+	flags = fcntl(sockfd, F_GETFL, 0);
+	if ((flags < 0) || (fcntl(sockfd, F_SETFL, flags | O_NONBLOCK) < 0)) {
 		LOG_ERR("%s\n\r","fcntl error");
-		exit(1);
+		return 0;
 	}
-	flags = (flags|O_NONBLOCK);
-	fcntl(sockfd, F_SETFL, flags);
-	LOG_INFO("%s\n\r","fake_radio driver was initialized");
+	return 1;
+} /* _fradio_openSocket() */
+#endif /* NATIVE_SIM */
+
+/*---------------------------------------------------------------------------*/
+static int8_t _fradio_init(s_ns_t* p_netStack)
+{
+	linkaddr_t 	un_addr;
+
+	if ((p_netStack == NULL) || (p_netStack->lmac == NULL)) {
+		LOG_ERR("%s\n\r","low mac is not set");
+		return 0;
+	}
+	p_lmac = p_netStack->lmac;
+
+#if NATIVE_SIM
+	/* The simulator provides the medium and the node id */
+	i_nodeId = sim_nodeId();
+	sim_radioRegister(_fradio_simRx);
+#else
+	if (!_fradio_openSocket())
+		return 0;
+#endif /* NATIVE_SIM */
+
 	memcpy((void *)&un_addr.u8,  &mac_address, 8);
+#if FRADIO_MEDIUM || NATIVE_SIM
+	un_addr.u8[6] = (uint8_t)(i_nodeId >> 8);
+	un_addr.u8[7] = (uint8_t)(i_nodeId);
+#endif
 	memcpy(&uip_lladdr.addr, &un_addr.u8, 8);
-	linkaddr_set_node_addr(&un_addr);
+	rimeaddr_emb6_set_node_addr(&un_addr);
 	LOG_INFO("MAC address %x:%x:%x:%x:%x:%x:%x:%x\n",	\
 							un_addr.u8[0],un_addr.u8[1],\
 							un_addr.u8[2],un_addr.u8[3],\
 							un_addr.u8[4],un_addr.u8[5],\
 							un_addr.u8[6],un_addr.u8[7]);
-	/* Start the packet receive process */
-	etimer_set(&tmr, 10, _fradio_handler);
-	printf("set %p for %p callback\n\r",&tmr, &_fradio_handler);
-  return 0;
+
+	evproc_regCallback(EVENT_TYPE_PCK_LL, _fradio_callback);
+#if !NATIVE_SIM
+	/* Frames are received as soon as the socket is readable */
+	if (!hal_fdRegister(sockfd, _fradio_isr, NULL)) {
+		LOG_ERR("%s\n\r","fail to watch the socket");
+		return 0;
+	}
+#endif /* NATIVE_SIM */
+	LOG_INFO("%s\n\r","fake_radio driver was initialized");
+	return 1;
 } /* _fradio_init() */
 
 /*---------------------------------------------------------------------------*/
 static int8_t _fradio_send(const void *pr_payload, uint8_t c_len)
 {
-  int ret = sendto(sockfd, pr_payload, c_len, 0,
-		  (struct sockaddr *)&cliaddr, sizeof(cliaddr));
-  if(ret == -1){
-	  LOG_ERR("%s\n\r","sendto");
-	  return RADIO_TX_ERR;
-  }
-  else {
-		uint8_t _ret = ret;
-		uint8_t i=0;
-		LOG_INFO("send msg with len = %d\n",ret);
-//		while(_ret--){
-//			printf("%02X", (uint8_t)(*((uint8_t *)pr_payload + i)));
-//			i++;
-//		}
-//		LOG_RAW("\n");
-
-		return RADIO_TX_OK;
-  }
+	int						ret;
+#if FRADIO_MEDIUM && !NATIVE_SIM
+	st_fradioMediumHdr_t	st_hdr;
+	struct	iovec			pst_iov[2];
+	struct	msghdr			st_msg;
+#endif
+
+	TRACE_TX(E_TRACE_RADIO);
+#if NATIVE_SIM
+	ret = sim_radioSend(pr_payload, c_len, _fradio_ackFrom(pr_payload, c_len));
+	if (ret == SIM_TX_NOACK)
+		return RADIO_TX_NOACK;
+	ret = (ret == SIM_TX_OK) ? c_len : -1;
+#elif FRADIO_MEDIUM
+	st_hdr.i_node = htons(i_nodeId);
+	st_hdr.c_rssi = 0;
+	st_hdr.c_lqi = 0;
+	pst_iov[0].iov_base = &st_hdr;
+	pst_iov[0].iov_len = sizeof(st_hdr);
+	pst_iov[1].iov_base = (void *)pr_payload;
+	pst_iov[1].iov_len = c_len;
+	memset(&st_msg, 0, sizeof(st_msg));
+	st_msg.msg_name = &cliaddr;
+	st_msg.msg_namelen = sizeof(cliaddr);
+	st_msg.msg_iov = pst_iov;
+	st_msg.msg_iovlen = 2;
+	ret = sendmsg(sockfd, &st_msg, 0);
+#else
+	ret = sendto(sockfd, pr_payload, c_len, 0,
+			(struct sockaddr *)&cliaddr, sizeof(cliaddr));
+#endif /* NATIVE_SIM */
+	if(ret == -1){
+		LOG_ERR("%s\n\r","sendto");
+		return RADIO_TX_ERR;
+	}
+	LOG_DBG("send msg with len = %d\n",ret);
+	return RADIO_TX_OK;
 } /* _fradio_send() */
 
 /*---------------------------------------------------------------------------*/
-static int _fradio_read(void *buf, unsigned short buf_len)
+static void _fradio_setPower(int8_t c_power)
+{
+	/* The transmit power is part of the medium topology */
+} /* _fradio_setPower() */
+
+/*---------------------------------------------------------------------------*/
+static int8_t _fradio_getPower(void)
+{
+	return 0;
+} /* _fradio_getPower() */
+
+/*---------------------------------------------------------------------------*/
+static void _fradio_setSensitivity(int8_t c_sens)
+{
+	/* The sensitivity is part of the medium topology */
+} /* _fradio_setSensitivity() */
+
+/*---------------------------------------------------------------------------*/
+static int8_t _fradio_getSensitivity(void)
 {
-	int ret = recv(sockfd, tmp_buf, buf_len, 0);
-	if((ret == -1) && (errno != 11)){
-		LOG_ERR("%s\n\r","receive error");
-		return 0;
-	}
-	if(ret > 0){
-			LOG_INFO("receive msg len = %d\n",ret);
-			memcpy(buf,tmp_buf,ret);
-			uint8_t _ret = ret;
-			uint8_t i=0;
-//			while(_ret--){
-//				LOG_RAW("%02X", (uint8_t)(*((uint8_t *)tmp_buf + i)));
-//				i++;
-//			}
-//			LOG_RAW("\r\n");
-		return ret;
-	}
 	return 0;
-} /* _fradio_read() */
+} /* _fradio_getSensitivity() */
+
+/*---------------------------------------------------------------------------*/
+static int8_t _fradio_getRSSI(void)
+{
+	return c_last_rssi;
+} /* _fradio_getRSSI() */
+
+/*---------------------------------------------------------------------------*/
+static int8_t _fradio_cca(void)
+{
+#if NATIVE_SIM
+	return sim_radioCca();
+#else
+	/* The medium does not tell whether somebody else is transmitting */
+	return 1;
+#endif /* NATIVE_SIM */
+} /* _fradio_cca() */
+
+/*---------------------------------------------------------------------------*/
+static int8_t _fradio_setChannel(uint8_t c_chan)
+{
+#if NATIVE_SIM
+	sim_radioChannel(c_chan);
+#else
+	/* The UDP medium has a single channel */
+	(void)c_chan;
+#endif
+	return 1;
+} /* _fradio_setChannel() */
 
 /*---------------------------------------------------------------------------*/
 static int8_t _fradio_on(void)
 {
-  return 0;
+	c_receive_on = 1;
+#if NATIVE_SIM
+	sim_radioListen(1);
+#endif
+	return 1;
 } /* _fradio_on() */
 
 /*---------------------------------------------------------------------------*/
 static int8_t _fradio_off(void)
 {
-  return 0;
+	c_receive_on = 0;
+#if NATIVE_SIM
+	sim_radioListen(0);
+#endif
+	return 1;
 }  /* _fradio_off() */
 
-/*---------------------------------------------------------------------------*/
-static void _fradio_handler(c_event_t ev, p_data_t data)
-{
-	uint8_t len = 0;
-	if (etimer_expired(&tmr)) {
-		if ((len = _fradio_read(packetbuf_dataptr(), PACKETBUF_SIZE)) > 0)	{
-			packetbuf_set_datalen(len);
-			//p_ns->lmac->input();
-		}
-		etimer_restart(&tmr);
+#if !NATIVE_SIM
+/*----------------------------------------------------------------------------*/
+/** \brief  Called by the HAL as soon as the socket is readable. Reads all
+ *          pending datagrams with a single system call into the free
+ *          entries of the receive ring and schedules the receive event.
+ *
+ *  \param  p_data  not used
+ */
+/*----------------------------------------------------------------------------*/
+static void _fradio_isr(void * p_data)
+{
+	struct	mmsghdr			pst_msg[FRADIO_RX_BUFFERS];
+	struct	iovec			pst_iov[FRADIO_RX_BUFFERS][2];
+	uint8_t					pc_drop[PACKETBUF_SIZE];
+	st_fradioFrame_t *		pst_frame;
+	uint16_t				i_free;
+	uint16_t				i_idx;
+	int						i_num;
+	int						i;
+
+	i_free = FRADIO_RX_BUFFERS - (uint16_t)(i_rxTail - i_rxHead);
+	if (i_free == 0) {
+		/* The ring is full, the datagram is lost as on a real radio */
+		if (recv(sockfd, pc_drop, sizeof(pc_drop), MSG_DONTWAIT) > 0)
+			l_rxDropped++;
+		return;
+	}
+
+	memset(pst_msg, 0, sizeof(pst_msg));
+	for (i = 0; i < i_free; i++) {
+		i_idx = (i_rxTail + i) & FRADIO_RX_MASK;
+		/* Frames from the medium start with a header */
+		pst_iov[i][0].iov_base = &gst_rxFrame[i_idx].st_hdr;
+		pst_iov[i][0].iov_len = FRADIO_MEDIUM ? sizeof(st_fradioMediumHdr_t) : 0;
+		pst_iov[i][1].iov_base = gst_rxFrame[i_idx].pc_data;
+		pst_iov[i][1].iov_len = PACKETBUF_SIZE;
+		pst_msg[i].msg_hdr.msg_iov = pst_iov[i];
+		pst_msg[i].msg_hdr.msg_iovlen = 2;
+	}
+
+	i_num = recvmmsg(sockfd, pst_msg, i_free, MSG_DONTWAIT, NULL);
+	if (i_num < 0) {
+		if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+			LOG_ERR("receive error %d\n\r", errno);
+		return;
+	}
+
+	/* Datagram i was written to slot i_rxTail + i. Dropped datagrams leave
+	 * gaps, so the frame is moved to the tail before its length and the
+	 * other fields are set: all of them have to be in the same slot. */
+	i_idx = i_rxTail;
+	for (i = 0; i < i_num; i++, i_idx++) {
+		if (!c_receive_on || (pst_msg[i].msg_len <= pst_iov[i][0].iov_len))
+			continue;
+		pst_frame = &gst_rxFrame[i_rxTail & FRADIO_RX_MASK];
+		if (i_idx != i_rxTail)
+			*pst_frame = gst_rxFrame[i_idx & FRADIO_RX_MASK];
+		pst_frame->i_len = pst_msg[i].msg_len - pst_iov[i][0].iov_len;
+		pst_frame->l_time = bsp_getTick();
+#if TRACE_CONF_ENABLE
+		pst_frame->i_trace = trace_newPacket();
+		TRACE_PUT(pst_frame->i_trace, E_TRACE_RADIO, E_TRACE_RX);
+#endif
+		i_rxTail++;
+	}
+
+	if (i_rxTail != i_rxHead)
+		evproc_putEvent(E_EVPROC_HEAD, EVENT_TYPE_PCK_LL, NULL);
+} /* _fradio_isr() */
+#else
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Node which acknowledges a frame like a transceiver with automatic
+ *          acknowledgements, the node ids are the last two bytes of the
+ *          long addresses
+ *
+ *  \return Node id, 0 if the frame does not request an acknowledgement
+ */
+/*----------------------------------------------------------------------------*/
+static uint16_t _fradio_ackFrom(const uint8_t * pc_frame, uint8_t c_len)
+{
+	/* Frame control, sequence number, PAN id and long destination address,
+	 * the address is sent with the least significant byte first */
+	if ((c_len < 13) || !(pc_frame[0] & 0x20) || ((pc_frame[1] & 0x0C) != 0x0C))
+		return 0;
+	return (pc_frame[6] << 8) | pc_frame[5];
+} /* _fradio_ackFrom() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Called by the simulator for every frame received by the node
+ */
+/*----------------------------------------------------------------------------*/
+static void _fradio_simRx(const uint8_t * pc_data, uint16_t i_len,
+							int8_t c_rssi, uint8_t c_lqi)
+{
+	st_fradioFrame_t *	pst_frame;
+
+	if (!c_receive_on || (i_len > PACKETBUF_SIZE))
+		return;
+	if ((uint16_t)(i_rxTail - i_rxHead) == FRADIO_RX_BUFFERS) {
+		l_rxDropped++;
+		return;
+	}
+	pst_frame = &gst_rxFrame[i_rxTail & FRADIO_RX_MASK];
+	memcpy(pst_frame->pc_data, pc_data, i_len);
+	pst_frame->i_len = i_len;
+	pst_frame->st_hdr.c_rssi = c_rssi;
+	pst_frame->st_hdr.c_lqi = c_lqi;
+	pst_frame->l_time = bsp_getTick();
+#if TRACE_CONF_ENABLE
+	pst_frame->i_trace = trace_newPacket();
+	TRACE_PUT(pst_frame->i_trace, E_TRACE_RADIO, E_TRACE_RX);
+#endif
+	i_rxTail++;
+	evproc_putEvent(E_EVPROC_HEAD, EVENT_TYPE_PCK_LL, NULL);
+} /* _fradio_simRx() */
+#endif /* NATIVE_SIM */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Hands all buffered frames to the low MAC layer
+ *
+ *  \param  c_event     event type, not used
+ *  \param  p_data      event data, not used
+ */
+/*----------------------------------------------------------------------------*/
+static void _fradio_callback(c_event_t c_event, p_data_t p_data)
+{
+	st_fradioFrame_t *	pst_frame;
+
+	while (i_rxHead != i_rxTail) {
+		pst_frame = &gst_rxFrame[i_rxHead & FRADIO_RX_MASK];
+		LOG_DBG("receive msg len = %d\n", pst_frame->i_len);
+		packetbuf_clear();
+		memcpy(packetbuf_dataptr(), pst_frame->pc_data, pst_frame->i_len);
+		packetbuf_set_datalen(pst_frame->i_len);
+#if FRADIO_MEDIUM || NATIVE_SIM
+		c_last_rssi = pst_frame->st_hdr.c_rssi;
+		packetbuf_set_attr(PACKETBUF_ATTR_RSSI, pst_frame->st_hdr.c_rssi);
+		packetbuf_set_attr(PACKETBUF_ATTR_LINK_QUALITY, pst_frame->st_hdr.c_lqi);
+#endif
+		packetbuf_set_attr(PACKETBUF_ATTR_TIMESTAMP, (packetbuf_attr_t)pst_frame->l_time);
+		TRACE_SET_PACKET(pst_frame->i_trace);
+		i_rxHead++;
+		if (p_lmac != NULL)
+			p_lmac->input();
 	}
-}
+	TRACE_SET_PACKET(0);
+} /* _fradio_callback() */
 
 
 
@@ -37,6 +37,26 @@
 #define FRADIO_INPORT_SERVER				FRADIO_OUTPORT
 #define UDPDEV_LLADDR_SERVER				"2"
 
+/** Attach the driver to the shared medium simulator instead of the
+ *  point to point UDP link, see fradio_medium.h */
+#ifdef FRADIO_CONF_MEDIUM
+#define FRADIO_MEDIUM						FRADIO_CONF_MEDIUM
+#else
+#define FRADIO_MEDIUM						0
+#endif
+
+/** Node id used if FRADIO_NODE_ID is not set in the environment */
+#ifdef FRADIO_CONF_NODE_ID
+#define FRADIO_NODE_ID						FRADIO_CONF_NODE_ID
+#else
+#define FRADIO_NODE_ID						1
+#endif
+
+/** Byte of the MAC address which differs between the nodes */
+#ifndef FAKE_MAC_2_BIT
+#define FAKE_MAC_2_BIT						0x01
+#endif
+
 
 #endif /* UDPDEV_RADIO_H_ */
 /** @} */
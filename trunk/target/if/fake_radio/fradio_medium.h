@@ -0,0 +1,66 @@
+/**
+ * \addtogroup fake_radio
+ * @{
+ */
+/*============================================================================*/
+/*! \file   fradio_medium.h
+
+    \brief  Protocol between the fake radio driver and the shared medium
+            simulator (tools/fradio_medium).
+
+            Every node sends its frames to the medium as UDP datagrams. The
+            medium decides which nodes receive a frame according to its
+            topology file and forwards the frame to the port
+            \ref FRADIO_MEDIUM_PORT + node id of every receiver. Every
+            datagram starts with a \ref st_fradioMediumHdr_t header.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+#ifndef FRADIO_MEDIUM_H_
+#define FRADIO_MEDIUM_H_
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdint.h>
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** IP address of the medium simulator */
+#ifdef FRADIO_CONF_MEDIUM_IP
+#define FRADIO_MEDIUM_IP					FRADIO_CONF_MEDIUM_IP
+#else
+#define FRADIO_MEDIUM_IP					"127.0.0.1"
+#endif
+
+/** UDP port of the medium simulator, node n listens on this port + n */
+#ifdef FRADIO_CONF_MEDIUM_PORT
+#define FRADIO_MEDIUM_PORT					FRADIO_CONF_MEDIUM_PORT
+#else
+#define FRADIO_MEDIUM_PORT					41000
+#endif
+
+/** Environment variable holding the node id of a process */
+#define FRADIO_MEDIUM_NODE_ENV				"FRADIO_NODE_ID"
+
+/** Highest node id supported by the medium */
+#define FRADIO_MEDIUM_MAX_NODES				1024
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Header of every datagram exchanged with the medium */
+typedef struct
+{
+	/** Transmitting node id, network byte order */
+	uint16_t						i_node;
+	/** RSSI of the frame in dBm, set by the medium */
+	int8_t							c_rssi;
+	/** LQI of the frame, set by the medium */
+	uint8_t							c_lqi;
+}st_fradioMediumHdr_t;
+
+#endif /* FRADIO_MEDIUM_H_ */
+/** @} */
@@ -0,0 +1,169 @@
+/**
+ * \addtogroup fake_radio
+ * @{
+ */
+/*============================================================================*/
+/*! \file   fradio_topo.c
+
+    \brief  Topology and link model shared by the medium simulator and the
+            single process simulation.
+
+            The file does not depend on the stack, the medium simulator is
+            built from it without the emb6 sources.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fradio_topo.h"
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Reproducible pseudo random numbers (xorshift32) */
+/*----------------------------------------------------------------------------*/
+static uint32_t _fradio_topoRand(st_fradioTopo_t * pst_topo)
+{
+	pst_topo->l_seed ^= pst_topo->l_seed << 13;
+	pst_topo->l_seed ^= pst_topo->l_seed >> 17;
+	pst_topo->l_seed ^= pst_topo->l_seed << 5;
+	return pst_topo->l_seed;
+} /* _fradio_topoRand() */
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+/*==============================================================================
+  fradio_topoInit()
+ =============================================================================*/
+int fradio_topoInit(st_fradioTopo_t * pst_topo, uint16_t i_numNodes, uint32_t l_seed)
+{
+	pst_topo->pst_nodes = calloc(i_numNodes, sizeof(st_fradioLinks_t));
+	if (pst_topo->pst_nodes == NULL)
+		return -1;
+	pst_topo->i_numNodes = i_numNodes;
+	pst_topo->l_airtime = FRADIO_TOPO_DEF_AIRTIME;
+	pst_topo->l_seed = (l_seed == 0) ? 1 : l_seed;
+	return 0;
+} /* fradio_topoInit() */
+
+/*==============================================================================
+  fradio_topoAddLink()
+ =============================================================================*/
+int fradio_topoAddLink(st_fradioTopo_t * pst_topo, unsigned int ui_from,
+					   unsigned int ui_to, double d_loss, int i_rssi, int i_lqi,
+					   unsigned long ul_delay)
+{
+	st_fradioLinks_t *	pst_node;
+	st_fradioLink_t *	pst_link;
+
+	if ((ui_from == 0) || (ui_from > pst_topo->i_numNodes) ||
+		(ui_to == 0) || (ui_to > pst_topo->i_numNodes) || (ui_from == ui_to))
+		return -1;
+
+	pst_node = &pst_topo->pst_nodes[ui_from - 1];
+	pst_link = realloc(pst_node->pst_links, (pst_node->i_numLinks + 1) * sizeof(st_fradioLink_t));
+	if (pst_link == NULL)
+		return -1;
+	pst_node->pst_links = pst_link;
+	pst_link = &pst_node->pst_links[pst_node->i_numLinks++];
+
+	d_loss = (d_loss < 0.0) ? 0.0 : (d_loss > 100.0) ? 100.0 : d_loss;
+	pst_link->i_to = ui_to;
+	pst_link->l_loss = (uint32_t)(d_loss * 65536.0 / 100.0);
+	pst_link->c_rssi = (int8_t)i_rssi;
+	pst_link->c_lqi = (uint8_t)i_lqi;
+	pst_link->l_delay = ul_delay;
+	return 0;
+} /* fradio_topoAddLink() */
+
+/*==============================================================================
+  fradio_topoLoad()
+ =============================================================================*/
+int fradio_topoLoad(st_fradioTopo_t * pst_topo, const char * pc_file)
+{
+	FILE *			pst_file;
+	char			pc_line[256];
+	char			pc_cmd[16];
+	unsigned int	ui_a;
+	unsigned int	ui_b;
+	double			d_loss;
+	int				i_rssi;
+	int				i_lqi;
+	unsigned long	ul_delay;
+	int				i_lineNr = 0;
+	int				i_ret = 0;
+	char *			pc_comment;
+
+	pst_file = fopen(pc_file, "r");
+	if (pst_file == NULL) {
+		fprintf(stderr, "cannot open topology file %s\n", pc_file);
+		return -1;
+	}
+
+	while ((i_ret == 0) && (fgets(pc_line, sizeof(pc_line), pst_file) != NULL)) {
+		i_lineNr++;
+		pc_comment = strchr(pc_line, '#');
+		if (pc_comment != NULL)
+			*pc_comment = '\0';
+		if (sscanf(pc_line, "%15s", pc_cmd) != 1)
+			continue;
+
+		if (strcmp(pc_cmd, "airtime") == 0) {
+			if (sscanf(pc_line, "%*s %lu", &ul_delay) != 1)
+				i_ret = -1;
+			else
+				pst_topo->l_airtime = ul_delay;
+		} else if ((strcmp(pc_cmd, "link") == 0) || (strcmp(pc_cmd, "bilink") == 0)) {
+			if (sscanf(pc_line, "%*s %u %u %lf %d %d %lu",
+					&ui_a, &ui_b, &d_loss, &i_rssi, &i_lqi, &ul_delay) != 6)
+				i_ret = -1;
+			else
+				i_ret = fradio_topoAddLink(pst_topo, ui_a, ui_b, d_loss, i_rssi, i_lqi, ul_delay);
+			if ((i_ret == 0) && (pc_cmd[0] == 'b'))
+				i_ret = fradio_topoAddLink(pst_topo, ui_b, ui_a, d_loss, i_rssi, i_lqi, ul_delay);
+		} else {
+			i_ret = -1;
+		}
+		if (i_ret != 0)
+			fprintf(stderr, "%s:%d: invalid statement\n", pc_file, i_lineNr);
+	}
+	fclose(pst_file);
+	return i_ret;
+} /* fradio_topoLoad() */
+
+/*==============================================================================
+  fradio_topoLinks()
+ =============================================================================*/
+const st_fradioLinks_t * fradio_topoLinks(const st_fradioTopo_t * pst_topo,
+										  uint16_t i_from)
+{
+	if ((i_from == 0) || (i_from > pst_topo->i_numNodes))
+		return NULL;
+	return &pst_topo->pst_nodes[i_from - 1];
+} /* fradio_topoLinks() */
+
+/*==============================================================================
+  fradio_topoLost()
+ =============================================================================*/
+uint8_t fradio_topoLost(st_fradioTopo_t * pst_topo, const st_fradioLink_t * pst_link)
+{
+	return (_fradio_topoRand(pst_topo) & 0xFFFF) < pst_link->l_loss;
+} /* fradio_topoLost() */
+
+/*==============================================================================
+  fradio_topoAirtime()
+ =============================================================================*/
+uint64_t fradio_topoAirtime(const st_fradioTopo_t * pst_topo, uint16_t i_len)
+{
+	return (uint64_t)(i_len + FRADIO_TOPO_PHY_OVERHEAD) * pst_topo->l_airtime;
+} /* fradio_topoAirtime() */
+
+/** @} */
@@ -0,0 +1,139 @@
+/**
+ * \addtogroup fake_radio
+ * @{
+ */
+/*============================================================================*/
+/*! \file   fradio_topo.h
+
+    \brief  Topology and link model shared by the medium simulator
+            (tools/fradio_medium) and the single process simulation
+            (target/mcu/native/sim.c).
+
+            Topology file, one statement per line, '#' starts a comment:
+
+                airtime <us per byte>
+                link    <from> <to> <loss %> <rssi dBm> <lqi> <delay us>
+                bilink  <a> <b> <loss %> <rssi dBm> <lqi> <delay us>
+
+            "link" is directional, "bilink" adds the link in both directions.
+            A frame sent over a link is lost with the loss probability of the
+            link, otherwise it reaches the receiver after the delay of the
+            link with the RSSI and LQI of the link.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+#ifndef FRADIO_TOPO_H_
+#define FRADIO_TOPO_H_
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdint.h>
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Default airtime of one byte, 250 kbit/s */
+#define FRADIO_TOPO_DEF_AIRTIME				32
+/** Synchronisation header and PHY header added to every frame */
+#define FRADIO_TOPO_PHY_OVERHEAD			6
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Link from a transmitter to a receiver */
+typedef struct
+{
+	uint16_t						i_to;
+	/** Loss probability in 1/65536 */
+	uint32_t						l_loss;
+	int8_t							c_rssi;
+	uint8_t							c_lqi;
+	uint32_t						l_delay;
+}st_fradioLink_t;
+
+/** Links of one transmitter */
+typedef struct
+{
+	st_fradioLink_t *				pst_links;
+	uint16_t						i_numLinks;
+}st_fradioLinks_t;
+
+/** Topology of nodes 1 .. i_numNodes */
+typedef struct
+{
+	/** Links of every node, indexed by the node id - 1 */
+	st_fradioLinks_t *				pst_nodes;
+	uint16_t						i_numNodes;
+	/** Airtime of one byte in us */
+	uint32_t						l_airtime;
+	/** State of the random numbers deciding the losses */
+	uint32_t						l_seed;
+}st_fradioTopo_t;
+
+/*==============================================================================
+                          FUNCTION PROTOTYPES
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Initialize a topology without links
+ *
+ *  \param  pst_topo    Topology
+ *  \param  i_numNodes  Highest node id
+ *  \param  l_seed      Seed of the loss decisions, 0 is replaced by 1
+ *
+ *  \return 0 if success, -1 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+int fradio_topoInit(st_fradioTopo_t * pst_topo, uint16_t i_numNodes, uint32_t l_seed);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Add a directional link
+ *
+ *  \param  d_loss      Loss probability in percent
+ *  \param  ul_delay    Propagation delay in us
+ *
+ *  \return 0 if success, -1 if a node id is invalid or out of memory
+ */
+/*----------------------------------------------------------------------------*/
+int fradio_topoAddLink(st_fradioTopo_t * pst_topo, unsigned int ui_from,
+					   unsigned int ui_to, double d_loss, int i_rssi, int i_lqi,
+					   unsigned long ul_delay);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Add the statements of a topology file
+ *
+ *  \return 0 if success, -1 otherwise, the invalid line is printed
+ */
+/*----------------------------------------------------------------------------*/
+int fradio_topoLoad(st_fradioTopo_t * pst_topo, const char * pc_file);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Get the links of a transmitter
+ *
+ *  \return Links of the node, NULL if the id is invalid
+ */
+/*----------------------------------------------------------------------------*/
+const st_fradioLinks_t * fradio_topoLinks(const st_fradioTopo_t * pst_topo,
+										  uint16_t i_from);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Decide whether a frame sent over a link is lost
+ *
+ *  \return 1 if the frame is lost, 0 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+uint8_t fradio_topoLost(st_fradioTopo_t * pst_topo, const st_fradioLink_t * pst_link);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Get the airtime of a frame including the PHY overhead
+ *
+ *  \param  i_len       Length of the frame (PSDU)
+ *
+ *  \return Airtime in us
+ */
+/*----------------------------------------------------------------------------*/
+uint64_t fradio_topoAirtime(const st_fradioTopo_t * pst_topo, uint16_t i_len);
+
+#endif /* FRADIO_TOPO_H_ */
+/** @} */
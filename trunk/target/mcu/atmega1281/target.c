@@ -62,6 +62,7 @@
 #include "emb6.h"
 #include "board_conf.h"
 #include "avr/wdt.h"
+#include "avr/sleep.h"
 #include "math.h"
 #include "target.h"
 #include "hwinit.h"
@@ -114,7 +115,10 @@ inline static	void 	_hal_delay_loop(uint16_t __count) __attribute__((always_inli
 ==============================================================================*/
 		clock_time_t volatile 	l_tick;
 		clock_time_t volatile 	l_sec;
+/** Wraparounds of the tick counter, extends the time to 64 bit */
+static	uint32_t volatile 	l_tickHigh;
 static	uint8_t volatile 	c_sreg;
+static	uint8_t volatile 	c_wakeup = 0;
 static 	int8_t				c_nested = 0;
 static FILE 				st_usartStdout = FDEV_SETUP_STREAM(_hal_uart1PutChar,NULL,_FDEV_SETUP_WRITE);
 		pfn_intCallb_t		isr_radioCallb=	NULL;
@@ -306,6 +310,8 @@ ISR(TIMER0_COMPA_vect)
 	if(l_tick % CONF_TICK_SEC == 0)
 		l_sec++;
 	l_tick++;
+	if(l_tick == 0)
+		l_tickHigh++;
 } /* AVR_OUTPUT_COMPARE_INT() */
 
 ISR(INT5_vect)
@@ -480,6 +486,34 @@ void	hal_delay_us(uint32_t i_delay)
 	_hal_delay_loop((i_delay * 4)/2);
 } /* hal_delay_us() */
 
+/*==============================================================================
+  hal_sleepUntil()
+ =============================================================================*/
+void	hal_sleepUntil(clock_time_t l_deadline)
+{
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	cli();
+	while ((!c_wakeup) && ((l_deadline == 0) || CLOCK_LT(l_tick, l_deadline))) {
+		/* Instruction following sei() is always executed before a pending
+		 * interrupt, so no wake up can be lost in between */
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+		cli();
+	}
+	c_wakeup = 0;
+	sei();
+} /* hal_sleepUntil() */
+
+/*==============================================================================
+  hal_wakeup()
+ =============================================================================*/
+void	hal_wakeup(void)
+{
+	c_wakeup = 1;
+} /* hal_wakeup() */
+
 /*==============================================================================
   hal_ctrlPinInit()
  =============================================================================*/
@@ -700,6 +734,28 @@ clock_time_t 	hal_getSec(void)
 	return l_sec;
 } /* hal_getSec() */
 
+/*==============================================================================
+  hal_getTimeUs()
+ =============================================================================*/
+uint64_t 	hal_getTimeUs(void)
+{
+	uint64_t	ll_tick;
+	uint8_t		c_cnt;
+
+	hal_enterCritical();
+	ll_tick = ((uint64_t)l_tickHigh << 32) | l_tick;
+	c_cnt = TCNT0;
+	/* Compare match not served yet, counter already cleared */
+	if (TIFR0 & _BV(OCF0A)) {
+		c_cnt = TCNT0;
+		ll_tick++;
+	}
+	hal_exitCritical();
+
+	return (ll_tick * 1000000UL +
+			(uint32_t)c_cnt * 1000000UL / ((uint16_t)OCR0A + 1)) / CLOCK_SECOND;
+} /* hal_getTimeUs() */
+
 clock_time_t hal_getTRes(void)
 {
 	return CLOCK_SECOND;
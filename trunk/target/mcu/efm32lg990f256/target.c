@@ -172,6 +172,11 @@ static void _hal_radioCb(uint8_t pin);
 static clock_time_t volatile l_hal_tick;
 /** Seconds since startup */
 static clock_time_t volatile l_hal_sec;
+/** Wraparounds of the tick counter, extends the time to 64 bit */
+static uint32_t volatile l_hal_tickHigh;
+
+/** Set by hal_wakeup() to leave hal_sleepUntil() */
+static uint8_t volatile c_wakeup = 0;
 
 /** Definition of the SPI interface */
 static s_hal_spiDrv s_hal_spi = {
@@ -282,6 +287,8 @@ static void _hal_tcCb( void )
 	if( l_hal_tick % CONF_TICK_SEC == 0 )
 		l_hal_sec++;
 	l_hal_tick++;
+	if( l_hal_tick == 0 )
+		l_hal_tickHigh++;
 } /* _isr_tc_interrupt() */
 
 
@@ -416,6 +423,31 @@ void hal_delay_us( uint32_t i_delay )
 
 } /* hal_delay_us() */
 
+/*==============================================================================
+  hal_sleepUntil()
+ =============================================================================*/
+void	hal_sleepUntil(clock_time_t l_deadline)
+{
+	hal_enterCritical();
+	while ((!c_wakeup) && ((l_deadline == 0) || CLOCK_LT(l_hal_tick, l_deadline))) {
+		/* Pending interrupt wakes the core up even with masked interrupts,
+		 * it is served right after leaving the critical section */
+		__WFI();
+		hal_exitCritical();
+		hal_enterCritical();
+	}
+	c_wakeup = 0;
+	hal_exitCritical();
+} /* hal_sleepUntil() */
+
+/*==============================================================================
+  hal_wakeup()
+ =============================================================================*/
+void	hal_wakeup(void)
+{
+	c_wakeup = 1;
+} /* hal_wakeup() */
+
 /*==============================================================================
   hal_pinInit()
  =============================================================================*/
@@ -644,6 +676,31 @@ clock_time_t hal_getSec(void)
 	return l_hal_sec;
 } /* hal_getSec() */
 
+/*==============================================================================
+  hal_getTimeUs()
+ =============================================================================*/
+uint64_t hal_getTimeUs(void)
+{
+	uint64_t ll_tick;
+	uint32_t l_cnt;
+	uint32_t l_top;
+
+	hal_enterCritical();
+	ll_tick = ((uint64_t)l_hal_tickHigh << 32) | (uint32_t)l_hal_tick;
+	l_top = TIMER_TopGet( TIMER1 );
+	l_cnt = TIMER_CounterGet( TIMER1 );
+	/* Overflow not served yet, counter already restarted */
+	if( TIMER_IntGet( TIMER1 ) & TIMER_IF_OF )
+	{
+		l_cnt = TIMER_CounterGet( TIMER1 );
+		ll_tick++;
+	}
+	hal_exitCritical();
+
+	return ( ll_tick * 1000000UL +
+			 (uint64_t)l_cnt * 1000000UL / ( l_top + 1 ) ) / CLOCK_SECOND;
+} /* hal_getTimeUs() */
+
 
 /*==============================================================================
   hal_getTRes()
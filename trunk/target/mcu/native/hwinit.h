@@ -55,6 +55,31 @@
 #define RIME_CONF_BROADCAST_ANNOUNCEMENT_MAX_TIME INFINITE_TIME/CLOCK_CONF_SECOND /* Default uses 600 */
 #define COLLECT_CONF_BROADCAST_ANNOUNCEMENT_MAX_TIME INFINITE_TIME/CLOCK_CONF_SECOND /* Default uses 600 */
 
+/* Run the node on a virtual clock. The time only advances when the node
+ * sleeps, it jumps directly to the next deadline, and delays do not wait.
+ * Always used by the simulator, see sim.h */
+#ifdef NATIVE_CONF_VIRTUAL_TIME
+#define NATIVE_VIRTUAL_TIME					NATIVE_CONF_VIRTUAL_TIME
+#else
+#define NATIVE_VIRTUAL_TIME					0
+#endif
+
+/* Seed of the random numbers if EMB6_SEED is not set in the environment.
+ * Without virtual time the seed is taken from the real time instead. */
+#ifdef NATIVE_CONF_SEED
+#define NATIVE_SEED							NATIVE_CONF_SEED
+#else
+#define NATIVE_SEED							1
+#endif
+
+/* Environment variable holding the seed of the random numbers */
+#define NATIVE_SEED_ENV						"EMB6_SEED"
+
+/* Environment variable holding the name of the file receiving the trace
+ * records if built with TRACE_CONF_ENABLE=1. The simulator appends the node
+ * id to the name. */
+#define NATIVE_TRACE_ENV					"EMB6_TRACE_FILE"
+
 // Macro for delay. It is essential to put some delay in native emulation
 // as without it program will "eat" all of a process working time
 #define HOWMUCH								500
@@ -76,6 +101,31 @@
 ==============================================================================*/
 extern const uint8_t 						mac_address[8];
 
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Watch a file descriptor in \ref hal_sleepUntil(). The handler is
+ *          called from the main loop as soon as the descriptor is readable
+ *          and plays the role of an interrupt service routine.
+ *
+ *  \param  i_fd            File descriptor to watch
+ *  \param  pfn_callback    Handler of the descriptor
+ *  \param  p_data          Parameter of the handler
+ *
+ *  \return 1 if success, 0 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+int8_t	hal_fdRegister(int i_fd, pfn_intCallb_t pfn_callback, void * p_data);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Stop watching a file descriptor
+ *
+ *  \param  i_fd            File descriptor registered with \ref hal_fdRegister()
+ */
+/*----------------------------------------------------------------------------*/
+void	hal_fdUnregister(int i_fd);
+
 #endif /* HWINIT_H_ */
 /** @} */
 /** @} */
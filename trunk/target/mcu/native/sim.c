@@ -0,0 +1,669 @@
+/**
+ * \addtogroup sim
+ * @{
+ */
+/*============================================================================*/
+/*! \file   native/sim.c
+
+    \brief  Single process discrete event simulation of many emb6 nodes.
+
+            Usage of a program built with NATIVE_CONF_SIM=1:
+
+                <program> [-n nodes] [-t topology] [-d seconds] [-s seed]
+
+            Without a topology file all nodes hear each other. The topology
+            file and the link model are shared with the medium simulator
+            (tools/fradio_medium), see fradio_topo.h.
+
+            At the end of the run a summary line is printed to stderr. It
+            holds the frames sent, received, lost on a link, destroyed by a
+            collision and missed by a receiver which was off or on another
+            channel, and the average time the radios were on.
+
+            Frames only reach and collide with nodes on the same channel.
+            Every node starts on channel 0 and stays there unless its radio
+            driver changes the channel.
+
+            The nodes boot at different times within the first second, the
+            boot times are drawn from the seed. Nodes booting together would
+            send their first neighbor discovery frames and start their
+            periodic timers in lock step.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include "sim.h"
+#include "fradio_topo.h"
+
+#if NATIVE_SIM
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Virtual time when the simulation starts, a tick of zero has a special
+ *  meaning for the timers */
+#define SIM_START_TIME						1000000ULL
+/** Default duration of a simulation in seconds */
+#define SIM_DEF_DURATION					60
+/** Nodes boot at a random time within this period after the start, nodes
+ *  booting at the same time send their first frames at the same time */
+#define SIM_BOOT_SPREAD						1000000UL
+/** Length of an acknowledgement frame */
+#define SIM_ACK_LEN							5
+/** Turnaround time of a transceiver before an acknowledgement, 12 symbols */
+#define SIM_TURNAROUND_US					192
+/** Highest node id */
+#define SIM_MAX_NODES						1024
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Frame on the air towards one receiver */
+typedef struct st_simFrame
+{
+	struct st_simFrame *			pst_next;
+	uint64_t						ll_start;
+	uint64_t						ll_end;
+	uint16_t						i_from;
+	uint16_t						i_to;
+	int8_t							c_rssi;
+	uint8_t							c_lqi;
+	uint8_t							c_collided;
+	/** The receiver has to acknowledge the frame */
+	uint8_t							c_ackReq;
+	uint8_t							c_channel;
+	uint16_t						i_len;
+	uint8_t							pc_data[SIM_MAX_FRAME];
+}st_simFrame_t;
+
+struct st_sim;
+
+/** Simulated node */
+typedef struct
+{
+	uint16_t						i_id;
+	/** Execution context of the node */
+	ucontext_t						st_ctx;
+	void *							p_stack;
+	/** Copy of .data and .bss of the node while it is not loaded */
+	uint8_t *						pc_image;
+	/** Virtual time to wake up the node, 0 if there is none */
+	uint64_t						ll_deadline;
+	uint8_t							c_wakeup;
+	uint8_t							c_done;
+	/** Virtual time the node boots */
+	uint64_t						ll_bootAt;
+	/** Frames received but not yet passed to the node */
+	st_simFrame_t *					pst_inbox;
+	pfn_simRx_t						pfn_rx;
+	/** End of the current transmission of the node */
+	uint64_t						ll_txUntil;
+	/** Start of listening, 0 if the receiver is off */
+	uint64_t						ll_listenSince;
+	/** Radio on time accumulated until ll_listenSince */
+	uint64_t						ll_onUs;
+	/** The last frame sent was acknowledged */
+	uint8_t							c_acked;
+	uint8_t							c_channel;
+	struct st_sim *					pst_sim;
+}st_simNode_t;
+
+/** Simulator, allocated on the heap because .data and .bss belong to the
+ *  loaded node */
+typedef struct st_sim
+{
+	ucontext_t						st_ctx;
+	st_simNode_t *					pst_nodes;
+	uint16_t						i_numNodes;
+	st_simNode_t *					pst_loaded;
+	size_t							l_imageSize;
+	st_simFrame_t *					pst_air;
+	uint64_t						ll_now;
+	uint64_t						ll_end;
+	/** Links between the nodes and the loss decisions */
+	st_fradioTopo_t					st_topo;
+	/** Seed given on the command line */
+	uint32_t						l_baseSeed;
+	/* statistics */
+	uint64_t						ll_runs;
+	uint64_t						ll_swaps;
+	uint32_t						l_tx;
+	uint32_t						l_rx;
+	uint32_t						l_lost;
+	uint32_t						l_collided;
+	uint32_t						l_missed;
+}st_sim_t;
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+/** Start and end of the writable data of the program, set by the linker */
+extern	char						__data_start[];
+extern	char						_end[];
+
+/** Running node, part of the swapped memory and set after every swap */
+static	st_simNode_t *				gpst_simNode;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Mark every frame on the air towards i_to on channel c_channel
+ *          which overlaps the interval [ll_start, ll_end) as collided.
+ *
+ *  \return Number of overlapping frames
+ */
+/*----------------------------------------------------------------------------*/
+static int _sim_collide(st_sim_t * pst_sim, uint16_t i_to, uint8_t c_channel,
+						uint64_t ll_start, uint64_t ll_end)
+{
+	st_simFrame_t *	pst_frame;
+	int				i_num = 0;
+
+	for (pst_frame = pst_sim->pst_air; pst_frame != NULL; pst_frame = pst_frame->pst_next) {
+		if ((pst_frame->i_to == i_to) && (pst_frame->c_channel == c_channel) &&
+			(pst_frame->ll_start < ll_end) && (ll_start < pst_frame->ll_end)) {
+			pst_frame->c_collided = 1;
+			i_num++;
+		}
+	}
+	return i_num;
+} /* _sim_collide() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Move the frames whose reception ended to the receivers
+ */
+/*----------------------------------------------------------------------------*/
+static void _sim_deliver(st_sim_t * pst_sim)
+{
+	st_simFrame_t **	ppst_frame = &pst_sim->pst_air;
+	st_simFrame_t *		pst_frame;
+	st_simFrame_t **	ppst_inbox;
+	st_simNode_t *		pst_node;
+
+	while ((pst_frame = *ppst_frame) != NULL) {
+		if (pst_frame->ll_end > pst_sim->ll_now) {
+			ppst_frame = &pst_frame->pst_next;
+			continue;
+		}
+		*ppst_frame = pst_frame->pst_next;
+		pst_frame->pst_next = NULL;
+		pst_node = &pst_sim->pst_nodes[pst_frame->i_to - 1];
+		if (pst_frame->c_collided || pst_node->c_done) {
+			pst_sim->l_collided += pst_frame->c_collided;
+			free(pst_frame);
+			continue;
+		}
+		/* The receiver has to listen on the channel from the
+		 * synchronisation header on */
+		if ((pst_node->ll_listenSince == 0) ||
+			(pst_node->ll_listenSince > pst_frame->ll_start) ||
+			(pst_node->c_channel != pst_frame->c_channel)) {
+			pst_sim->l_missed++;
+			free(pst_frame);
+			continue;
+		}
+		if (pst_frame->c_ackReq) {
+			pst_sim->pst_nodes[pst_frame->i_from - 1].c_acked = 1;
+			/* The receiver is busy with the acknowledgement */
+			pst_node->ll_txUntil = pst_frame->ll_end + SIM_TURNAROUND_US +
+				fradio_topoAirtime(&pst_sim->st_topo, SIM_ACK_LEN);
+		}
+		/* Keep the order of reception */
+		for (ppst_inbox = &pst_node->pst_inbox; *ppst_inbox != NULL;
+			 ppst_inbox = &(*ppst_inbox)->pst_next)
+			;
+		*ppst_inbox = pst_frame;
+		pst_sim->l_rx++;
+	}
+} /* _sim_deliver() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Load the memory of a node and let it run until it sleeps
+ */
+/*----------------------------------------------------------------------------*/
+static void _sim_run(st_sim_t * pst_sim, st_simNode_t * pst_node)
+{
+	if (pst_sim->pst_loaded != pst_node) {
+		if (pst_sim->pst_loaded != NULL)
+			memcpy(pst_sim->pst_loaded->pc_image, __data_start, pst_sim->l_imageSize);
+		memcpy(__data_start, pst_node->pc_image, pst_sim->l_imageSize);
+		pst_sim->pst_loaded = pst_node;
+		pst_sim->ll_swaps++;
+	}
+	gpst_simNode = pst_node;
+	pst_sim->ll_runs++;
+	swapcontext(&pst_sim->st_ctx, &pst_node->st_ctx);
+} /* _sim_run() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Start function of a node
+ */
+/*----------------------------------------------------------------------------*/
+static void _sim_nodeEntry(void)
+{
+	sim_nodeMain();
+	/* The node returns to the simulator through uc_link */
+	gpst_simNode->c_done = 1;
+} /* _sim_nodeEntry() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Random number derived from the seed of the simulation and a node id
+ */
+/*----------------------------------------------------------------------------*/
+static uint32_t _sim_hash(const st_sim_t * pst_sim, uint16_t i_id)
+{
+	/* MurmurHash3 finalizer: every pair of base seed and id gives another
+	 * value, so the values of two runs are not permutations of each other */
+	uint32_t l_key = pst_sim->l_baseSeed * 0x9E3779B9UL + i_id;
+
+	l_key ^= l_key >> 16;
+	l_key *= 0x85EBCA6BUL;
+	l_key ^= l_key >> 13;
+	l_key *= 0xC2B2AE35UL;
+	l_key ^= l_key >> 16;
+	return l_key;
+} /* _sim_hash() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Next virtual time the node has to run, 0 if it waits for ever
+ */
+/*----------------------------------------------------------------------------*/
+static uint64_t _sim_nodeNext(st_sim_t * pst_sim, st_simNode_t * pst_node)
+{
+	if (pst_node->c_done)
+		return 0;
+	if (pst_node->c_wakeup || (pst_node->pst_inbox != NULL))
+		return pst_sim->ll_now;
+	if ((pst_node->ll_deadline != 0) && (pst_node->ll_deadline < pst_sim->ll_now))
+		return pst_sim->ll_now;
+	return pst_node->ll_deadline;
+} /* _sim_nodeNext() */
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+/*==============================================================================
+  sim_nodeId()
+ =============================================================================*/
+uint16_t sim_nodeId(void)
+{
+	return gpst_simNode->i_id;
+} /* sim_nodeId() */
+
+/*==============================================================================
+  sim_nodeSeed()
+ =============================================================================*/
+uint32_t sim_nodeSeed(void)
+{
+	return _sim_hash(gpst_simNode->pst_sim, gpst_simNode->i_id);
+} /* sim_nodeSeed() */
+
+/*==============================================================================
+  sim_getTimeUs()
+ =============================================================================*/
+uint64_t sim_getTimeUs(void)
+{
+	return gpst_simNode->pst_sim->ll_now;
+} /* sim_getTimeUs() */
+
+/*==============================================================================
+  sim_sleepUntil()
+ =============================================================================*/
+void	sim_sleepUntil(uint64_t ll_deadline)
+{
+	st_simNode_t *	pst_node = gpst_simNode;
+	st_simFrame_t *	pst_frame;
+
+	if (!pst_node->c_wakeup && (pst_node->pst_inbox == NULL)) {
+		pst_node->ll_deadline = ll_deadline;
+		swapcontext(&pst_node->st_ctx, &pst_node->pst_sim->st_ctx);
+	}
+	pst_node->c_wakeup = 0;
+	pst_node->ll_deadline = 0;
+
+	/* Received frames act as radio interrupts */
+	while ((pst_frame = pst_node->pst_inbox) != NULL) {
+		pst_node->pst_inbox = pst_frame->pst_next;
+		if (pst_node->pfn_rx != NULL)
+			pst_node->pfn_rx(pst_frame->pc_data, pst_frame->i_len,
+							 pst_frame->c_rssi, pst_frame->c_lqi);
+		free(pst_frame);
+	}
+} /* sim_sleepUntil() */
+
+/*==============================================================================
+  sim_wakeup()
+ =============================================================================*/
+void	sim_wakeup(void)
+{
+	gpst_simNode->c_wakeup = 1;
+} /* sim_wakeup() */
+
+/*==============================================================================
+  sim_radioRegister()
+ =============================================================================*/
+void	sim_radioRegister(pfn_simRx_t pfn_rx)
+{
+	gpst_simNode->pfn_rx = pfn_rx;
+} /* sim_radioRegister() */
+
+/*==============================================================================
+  sim_delayUs()
+ =============================================================================*/
+void	sim_delayUs(uint32_t l_us)
+{
+	st_simNode_t *	pst_node = gpst_simNode;
+	uint64_t		ll_until = pst_node->pst_sim->ll_now + l_us;
+
+	/* Like sim_radioSend(), the main loop is woken up afterwards in case
+	 * a frame was received meanwhile */
+	pst_node->c_wakeup = 0;
+	while (pst_node->pst_sim->ll_now < ll_until)
+		sim_sleepUntil(ll_until);
+	pst_node->c_wakeup = 1;
+} /* sim_delayUs() */
+
+/*==============================================================================
+  sim_radioSend()
+ =============================================================================*/
+int8_t	sim_radioSend(const uint8_t * pc_data, uint16_t i_len, uint16_t i_ackFrom)
+{
+	st_simNode_t *				pst_node = gpst_simNode;
+	st_sim_t *					pst_sim = pst_node->pst_sim;
+	const st_fradioLinks_t *	pst_links;
+	const st_fradioLink_t *		pst_link;
+	st_simFrame_t *				pst_frame;
+	uint64_t					ll_air;
+	uint64_t					ll_until;
+	int							i;
+
+	if (i_len > SIM_MAX_FRAME)
+		return SIM_TX_ERR;
+
+	ll_air = fradio_topoAirtime(&pst_sim->st_topo, i_len);
+	pst_sim->l_tx++;
+	/* A transmitting node does not hear anything */
+	pst_node->ll_txUntil = pst_sim->ll_now + ll_air;
+	_sim_collide(pst_sim, pst_node->i_id, pst_node->c_channel, pst_sim->ll_now,
+			pst_node->ll_txUntil);
+	pst_node->c_acked = 0;
+	ll_until = pst_node->ll_txUntil;
+	if (i_ackFrom != 0)
+		ll_until += SIM_TURNAROUND_US + fradio_topoAirtime(&pst_sim->st_topo, SIM_ACK_LEN);
+
+	pst_links = fradio_topoLinks(&pst_sim->st_topo, pst_node->i_id);
+	for (i = 0; i < pst_links->i_numLinks; i++) {
+		pst_link = &pst_links->pst_links[i];
+		if (fradio_topoLost(&pst_sim->st_topo, pst_link)) {
+			pst_sim->l_lost++;
+			continue;
+		}
+		pst_frame = malloc(sizeof(st_simFrame_t));
+		if (pst_frame == NULL) {
+			pst_sim->l_lost++;
+			continue;
+		}
+		pst_frame->i_from = pst_node->i_id;
+		pst_frame->i_to = pst_link->i_to;
+		pst_frame->c_rssi = pst_link->c_rssi;
+		pst_frame->c_lqi = pst_link->c_lqi;
+		pst_frame->ll_start = pst_sim->ll_now + pst_link->l_delay;
+		pst_frame->ll_end = pst_frame->ll_start + ll_air;
+		pst_frame->i_len = i_len;
+		pst_frame->c_ackReq = (pst_link->i_to == i_ackFrom);
+		pst_frame->c_channel = pst_node->c_channel;
+		if (pst_frame->c_ackReq)
+			ll_until += 2 * pst_link->l_delay;
+		memcpy(pst_frame->pc_data, pc_data, i_len);
+		pst_frame->c_collided =
+			(_sim_collide(pst_sim, pst_frame->i_to, pst_frame->c_channel,
+					pst_frame->ll_start, pst_frame->ll_end) != 0) ||
+			(pst_frame->ll_start < pst_sim->pst_nodes[pst_frame->i_to - 1].ll_txUntil);
+		pst_frame->pst_next = pst_sim->pst_air;
+		pst_sim->pst_air = pst_frame;
+	}
+
+	/* The radio of a sleeping receiver is switched on for the transmission
+	 * and for the acknowledgement */
+	if (pst_node->ll_listenSince == 0)
+		pst_node->ll_onUs += ll_until - pst_sim->ll_now;
+
+	/* Wait for the end of the transmission. A pending wakeup must not
+	 * end the wait, the main loop is woken up afterwards instead. */
+	pst_node->c_wakeup = 0;
+	while (pst_sim->ll_now < ll_until)
+		sim_sleepUntil(ll_until);
+	pst_node->c_wakeup = 1;
+	if ((i_ackFrom != 0) && !pst_node->c_acked)
+		return SIM_TX_NOACK;
+	return SIM_TX_OK;
+} /* sim_radioSend() */
+
+/*==============================================================================
+  sim_radioListen()
+ =============================================================================*/
+void	sim_radioListen(uint8_t c_on)
+{
+	st_simNode_t *	pst_node = gpst_simNode;
+	uint64_t		ll_now = pst_node->pst_sim->ll_now;
+
+	if (c_on && (pst_node->ll_listenSince == 0)) {
+		pst_node->ll_listenSince = ll_now;
+	} else if (!c_on && (pst_node->ll_listenSince != 0)) {
+		pst_node->ll_onUs += ll_now - pst_node->ll_listenSince;
+		pst_node->ll_listenSince = 0;
+	}
+} /* sim_radioListen() */
+
+/*==============================================================================
+  sim_radioChannel()
+ =============================================================================*/
+void	sim_radioChannel(uint8_t c_channel)
+{
+	st_simNode_t *	pst_node = gpst_simNode;
+
+	if (pst_node->c_channel == c_channel)
+		return;
+	pst_node->c_channel = c_channel;
+	/* Frames which started on the old channel are lost */
+	if (pst_node->ll_listenSince != 0) {
+		sim_radioListen(0);
+		sim_radioListen(1);
+	}
+} /* sim_radioChannel() */
+
+/*==============================================================================
+  sim_radioOnUs()
+ =============================================================================*/
+uint64_t sim_radioOnUs(void)
+{
+	st_simNode_t *	pst_node = gpst_simNode;
+
+	if (pst_node->ll_listenSince == 0)
+		return pst_node->ll_onUs;
+	return pst_node->ll_onUs + pst_node->pst_sim->ll_now - pst_node->ll_listenSince;
+} /* sim_radioOnUs() */
+
+/*==============================================================================
+  sim_radioCca()
+ =============================================================================*/
+int8_t	sim_radioCca(void)
+{
+	st_simNode_t *	pst_node = gpst_simNode;
+	st_sim_t *		pst_sim = pst_node->pst_sim;
+	st_simFrame_t *	pst_frame;
+
+	if (pst_sim->ll_now < pst_node->ll_txUntil)
+		return 0;
+	/* Energy of every frame reaching the node, even of collided ones */
+	for (pst_frame = pst_sim->pst_air; pst_frame != NULL; pst_frame = pst_frame->pst_next) {
+		if ((pst_frame->i_to == pst_node->i_id) &&
+			(pst_frame->c_channel == pst_node->c_channel) &&
+			(pst_frame->ll_start <= pst_sim->ll_now) && (pst_sim->ll_now < pst_frame->ll_end))
+			return 0;
+	}
+	return 1;
+} /* sim_radioCca() */
+
+/*==============================================================================
+                                 MAIN FUNCTION
+==============================================================================*/
+int main(int argc, char ** argv)
+{
+	st_sim_t *		pst_sim;
+	st_simNode_t *	pst_node;
+	st_simNode_t *	pst_next;
+	st_simFrame_t *	pst_frame;
+	const char *	pc_topology = NULL;
+	uint8_t *		pc_initImage;
+	uint64_t		ll_nodeTime;
+	uint64_t		ll_time;
+	uint64_t		ll_airTime;
+	uint64_t		ll_duration = SIM_DEF_DURATION;
+	struct timespec	st_start;
+	struct timespec	st_stop;
+	double			d_wall;
+	double			d_on;
+	int				i_numNodes = 2;
+	int				i_opt;
+	int				i;
+	int				j;
+
+	pst_sim = calloc(1, sizeof(st_sim_t));
+	if (pst_sim == NULL)
+		return 1;
+	pst_sim->l_baseSeed = 1;
+
+	while ((i_opt = getopt(argc, argv, "n:t:d:s:")) != -1) {
+		switch (i_opt) {
+		case 'n': i_numNodes = atoi(optarg); break;
+		case 't': pc_topology = optarg; break;
+		case 'd': ll_duration = strtoull(optarg, NULL, 0); break;
+		case 's': pst_sim->l_baseSeed = strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-n nodes] [-t topology] [-d seconds] [-s seed]\n", argv[0]);
+			return 1;
+		}
+	}
+	if ((i_numNodes <= 0) || (i_numNodes >= SIM_MAX_NODES)) {
+		fprintf(stderr, "invalid number of nodes\n");
+		return 1;
+	}
+	if (pst_sim->l_baseSeed == 0)
+		pst_sim->l_baseSeed = 1;
+	if (fradio_topoInit(&pst_sim->st_topo, i_numNodes, pst_sim->l_baseSeed) != 0)
+		return 1;
+
+	/* Every node starts with the memory of the program before main() */
+	pst_sim->l_imageSize = _end - __data_start;
+	pc_initImage = malloc(pst_sim->l_imageSize);
+	pst_sim->pst_nodes = calloc(i_numNodes, sizeof(st_simNode_t));
+	if ((pc_initImage == NULL) || (pst_sim->pst_nodes == NULL))
+		return 1;
+	memcpy(pc_initImage, __data_start, pst_sim->l_imageSize);
+	pst_sim->i_numNodes = i_numNodes;
+
+	for (i = 0; i < i_numNodes; i++) {
+		pst_node = &pst_sim->pst_nodes[i];
+		pst_node->i_id = i + 1;
+		pst_node->pst_sim = pst_sim;
+		/* The boot time takes the ids above the node ids, it does not
+		 * depend on the seed of the random numbers of the node */
+		pst_node->ll_bootAt = SIM_START_TIME +
+			_sim_hash(pst_sim, pst_node->i_id + SIM_MAX_NODES) % SIM_BOOT_SPREAD;
+		pst_node->ll_deadline = pst_node->ll_bootAt;
+		pst_node->ll_listenSince = pst_node->ll_bootAt;
+		pst_node->pc_image = malloc(pst_sim->l_imageSize);
+		pst_node->p_stack = malloc(SIM_STACK_SIZE);
+		if ((pst_node->pc_image == NULL) || (pst_node->p_stack == NULL))
+			return 1;
+		memcpy(pst_node->pc_image, pc_initImage, pst_sim->l_imageSize);
+		getcontext(&pst_node->st_ctx);
+		pst_node->st_ctx.uc_stack.ss_sp = pst_node->p_stack;
+		pst_node->st_ctx.uc_stack.ss_size = SIM_STACK_SIZE;
+		pst_node->st_ctx.uc_link = &pst_sim->st_ctx;
+		makecontext(&pst_node->st_ctx, _sim_nodeEntry, 0);
+	}
+	free(pc_initImage);
+
+	if (pc_topology != NULL) {
+		if (fradio_topoLoad(&pst_sim->st_topo, pc_topology) != 0)
+			return 1;
+	} else {
+		/* Every node hears every other node */
+		for (i = 1; i <= i_numNodes; i++)
+			for (j = 1; j <= i_numNodes; j++)
+				if (i != j)
+					fradio_topoAddLink(&pst_sim->st_topo, i, j, 0.0, -60, 255, 0);
+	}
+
+	pst_sim->ll_now = SIM_START_TIME;
+	pst_sim->ll_end = SIM_START_TIME + ll_duration * 1000000ULL;
+	clock_gettime(CLOCK_MONOTONIC, &st_start);
+
+	while (pst_sim->ll_now <= pst_sim->ll_end) {
+		/* The node with the earliest event runs first, ties are broken by
+		 * the node id which makes runs reproducible */
+		pst_next = NULL;
+		ll_nodeTime = 0;
+		for (i = 0; i < i_numNodes; i++) {
+			pst_node = &pst_sim->pst_nodes[i];
+			ll_time = _sim_nodeNext(pst_sim, pst_node);
+			if ((ll_time != 0) && ((pst_next == NULL) || (ll_time < ll_nodeTime))) {
+				pst_next = pst_node;
+				ll_nodeTime = ll_time;
+			}
+		}
+		ll_airTime = 0;
+		for (pst_frame = pst_sim->pst_air; pst_frame != NULL; pst_frame = pst_frame->pst_next)
+			if ((ll_airTime == 0) || (pst_frame->ll_end < ll_airTime))
+				ll_airTime = pst_frame->ll_end;
+
+		if ((ll_airTime != 0) && ((pst_next == NULL) || (ll_airTime <= ll_nodeTime))) {
+			pst_sim->ll_now = ll_airTime;
+			_sim_deliver(pst_sim);
+		} else if (pst_next != NULL) {
+			pst_sim->ll_now = ll_nodeTime;
+			if (pst_sim->ll_now <= pst_sim->ll_end)
+				_sim_run(pst_sim, pst_next);
+		} else {
+			/* Nothing will ever happen again */
+			break;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &st_stop);
+	d_wall = (st_stop.tv_sec - st_start.tv_sec) + (st_stop.tv_nsec - st_start.tv_nsec) / 1e9;
+	d_on = 0.0;
+	ll_time = 0;
+	for (i = 0; i < i_numNodes; i++) {
+		pst_node = &pst_sim->pst_nodes[i];
+		d_on += pst_node->ll_onUs;
+		if ((pst_node->ll_listenSince != 0) && (pst_node->ll_listenSince < pst_sim->ll_now))
+			d_on += pst_sim->ll_now - pst_node->ll_listenSince;
+		if (pst_node->ll_bootAt < pst_sim->ll_now)
+			ll_time += pst_sim->ll_now - pst_node->ll_bootAt;
+	}
+	fprintf(stderr, "sim nodes=%d virtual_s=%llu wall_s=%.3f speedup=%.1f runs=%llu swaps=%llu "
+			"tx=%u rx=%u lost=%u collided=%u missed=%u radio_on=%.2f%%\n",
+			i_numNodes, (unsigned long long)ll_duration, d_wall,
+			(d_wall > 0.0) ? ll_duration / d_wall : 0.0,
+			(unsigned long long)pst_sim->ll_runs, (unsigned long long)pst_sim->ll_swaps,
+			pst_sim->l_tx, pst_sim->l_rx, pst_sim->l_lost, pst_sim->l_collided,
+			pst_sim->l_missed,
+			(ll_time != 0) ? d_on * 100.0 / ll_time : 0.0);
+	return 0;
+} /* main() */
+
+#endif /* NATIVE_SIM */
+/** @} */
@@ -0,0 +1,187 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+/**
+ * \addtogroup native
+ * @{
+ * \defgroup sim Discrete event simulation of many nodes
+ *
+ * With NATIVE_CONF_SIM=1 the native target runs many emb6 nodes in one
+ * process. Each node runs the demo main function on its own stack. Only
+ * one node is loaded at a time: the simulator swaps the writable data
+ * (.data and .bss) of the program in and out, so every node has its own
+ * copy of uip_buf, packetbuf, the event queue, the timers and so on,
+ * without any change to the stack code. The nodes see a virtual clock
+ * which the simulator advances from one event to the next, so a run is
+ * deterministic and usually much faster than real time.
+ *
+ * The simulator state lives on the heap and on the stack of the
+ * simulator, never in .data or .bss. The program must be linked
+ * dynamically so that the C library state is not part of the swapped
+ * memory.
+ * @{
+ */
+/*============================================================================*/
+/*! \file   native/sim.h
+
+    \brief  Single process discrete event simulation of many emb6 nodes.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdint.h>
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#ifdef NATIVE_CONF_SIM
+#define NATIVE_SIM							NATIVE_CONF_SIM
+#else
+#define NATIVE_SIM							0
+#endif
+
+/** Stack size of a simulated node */
+#ifdef SIM_CONF_STACK_SIZE
+#define SIM_STACK_SIZE						SIM_CONF_STACK_SIZE
+#else
+#define SIM_STACK_SIZE						(64 * 1024)
+#endif
+
+/** Largest frame handled by the simulated medium */
+#define SIM_MAX_FRAME						256
+
+/** Results of \ref sim_radioSend() */
+#define SIM_TX_ERR							0
+#define SIM_TX_OK							1
+#define SIM_TX_NOACK						2
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Handler of a frame received by a node */
+typedef void (*pfn_simRx_t)(const uint8_t * pc_data, uint16_t i_len,
+							int8_t c_rssi, uint8_t c_lqi);
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Entry of a simulated node, the main function of the application.
+ *          It is provided by the application when built with
+ *          NATIVE_CONF_SIM=1.
+ */
+/*----------------------------------------------------------------------------*/
+int		sim_nodeMain(void);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Id of the running node, starting with 1
+ */
+/*----------------------------------------------------------------------------*/
+uint16_t sim_nodeId(void);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Seed of the random numbers of the running node, derived from the
+ *          seed of the simulation and the node id
+ */
+/*----------------------------------------------------------------------------*/
+uint32_t sim_nodeSeed(void);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Virtual time in microseconds
+ */
+/*----------------------------------------------------------------------------*/
+uint64_t sim_getTimeUs(void);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Give control back to the simulator until the virtual time
+ *          reaches the deadline, a frame is received or \ref sim_wakeup()
+ *          was called. Received frames are passed to the handler set with
+ *          \ref sim_radioRegister() before returning.
+ *
+ *  \param  ll_deadline     Deadline in microseconds, 0 for no deadline
+ */
+/*----------------------------------------------------------------------------*/
+void	sim_sleepUntil(uint64_t ll_deadline);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Prevent the next \ref sim_sleepUntil() of the running node
+ *          from sleeping
+ */
+/*----------------------------------------------------------------------------*/
+void	sim_wakeup(void);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Set the receive handler of the running node
+ */
+/*----------------------------------------------------------------------------*/
+void	sim_radioRegister(pfn_simRx_t pfn_rx);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Give control back to the simulator for a busy wait of the
+ *          running node. Frames received meanwhile are passed to the
+ *          receive handler like interrupts, a pending wakeup is kept.
+ *
+ *  \param  l_us            Duration in microseconds
+ */
+/*----------------------------------------------------------------------------*/
+void	sim_delayUs(uint32_t l_us);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Transmit a frame from the running node on the simulated medium.
+ *          Returns after the airtime of the frame like a real transceiver,
+ *          frames received meanwhile are passed to the receive handler.
+ *
+ *          A node acknowledges a frame like a transceiver with automatic
+ *          acknowledgements if the frame was sent with its id as
+ *          i_ackFrom and it listened during the whole frame. The sender
+ *          then waits for the acknowledgement as well. Acknowledgements
+ *          occupy the acknowledging node but do not collide with other
+ *          frames.
+ *
+ *  \param  i_ackFrom       Id of the node which has to acknowledge the
+ *                          frame, 0 if no acknowledgement is requested
+ *
+ *  \return \ref SIM_TX_OK, \ref SIM_TX_NOACK or \ref SIM_TX_ERR
+ */
+/*----------------------------------------------------------------------------*/
+int8_t	sim_radioSend(const uint8_t * pc_data, uint16_t i_len, uint16_t i_ackFrom);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Switch the receiver of the running node on or off. A frame is
+ *          received only if the receiver was on from its start to its end.
+ *          Nodes start with the receiver on.
+ */
+/*----------------------------------------------------------------------------*/
+void	sim_radioListen(uint8_t c_on);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Tune the radio of the running node to a channel. Frames are
+ *          only received from and only collide with nodes on the same
+ *          channel. A frame on the air while the channel changes is lost.
+ */
+/*----------------------------------------------------------------------------*/
+void	sim_radioChannel(uint8_t c_channel);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Time the radio of the running node was on, receiving or
+ *          transmitting, in microseconds since the start
+ */
+/*----------------------------------------------------------------------------*/
+uint64_t sim_radioOnUs(void);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Clear channel assessment of the running node
+ *
+ *  \return 1 if neither the node nor a node it hears is transmitting,
+ *          0 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+int8_t	sim_radioCca(void);
+
+#endif /* SIM_H_ */
+/** @} */
+/** @} */
@@ -74,12 +74,33 @@
 ==============================================================================*/
 #include <stdio.h>
 
+#include "emb6_conf.h"
 #include "target.h"
+#include "bsp.h"
 #include "hwinit.h"
+#include "sim.h"
+#include "trace.h"
 #include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include "logger.h"
+/** Virtual time when a node starts, a tick of zero has a special meaning
+ *  for the timers */
+#define HAL_VIRTUAL_START					1000000ULL
+
+/** Maximum number of file descriptors watched by hal_sleepUntil() */
+#ifdef HAL_CONF_MAX_FDS
+#define HAL_MAX_FDS							HAL_CONF_MAX_FDS
+#else
+#define HAL_MAX_FDS							4
+#endif
+
+/** Number of trace records written to the trace file at once */
+#define HAL_TRACE_CHUNK						32
 /*==============================================================================
                                      ENUMS
 ==============================================================================*/
@@ -87,6 +108,16 @@
 /*==============================================================================
                          STRUCTURES AND OTHER TYPEDEFS
 ==============================================================================*/
+/** File descriptor watched by the main loop */
+typedef struct
+{
+	/** File descriptor, -1 if the entry is free */
+	int								i_fd;
+	/** Handler called when the descriptor is readable */
+	pfn_intCallb_t					pfn_callback;
+	/** Parameter of the handler */
+	void *							p_data;
+}st_halFd_t;
 
 /*==============================================================================
                            LOCAL FUNCTION PROTOTYPES
@@ -95,7 +126,29 @@
 /*==============================================================================
                           VARIABLE DECLARATIONS
 ==============================================================================*/
+#if !NATIVE_VIRTUAL_TIME && !NATIVE_SIM
 static	struct timespec 			tim = {0,0};
+#endif
+/** Event file descriptor used to interrupt hal_sleepUntil() */
+static	int							i_wakeFd = -1;
+/** Set while hal_sleepUntil() is blocked */
+static	volatile uint8_t			c_sleeping = 0;
+/** Set by hal_wakeup() to leave hal_sleepUntil() */
+static	volatile uint8_t			c_wakeup = 0;
+/** epoll instance waiting for the wake up eventfd and registered descriptors */
+static	int							i_epollFd = -1;
+/** Descriptors registered with hal_fdRegister() */
+static	st_halFd_t					gst_fds[HAL_MAX_FDS];
+#if NATIVE_VIRTUAL_TIME && !NATIVE_SIM
+/** Virtual time in microseconds */
+static	uint64_t					ll_virtualTime = HAL_VIRTUAL_START;
+#endif
+/** State of hal_getrand() */
+static	uint32_t					l_randState = NATIVE_SEED;
+#if TRACE_CONF_ENABLE
+/** File receiving the trace records, NULL if not set in the environment */
+static	FILE *						pf_trace = NULL;
+#endif
 /*==============================================================================
                                 LOCAL CONSTANTS
 ==============================================================================*/
@@ -104,6 +157,98 @@ static	struct timespec 			tim = {0,0};
 /*==============================================================================
                                 LOCAL FUNCTIONS
 ==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Wait for the wake up eventfd and the registered descriptors and
+ *          call the handlers of all readable descriptors.
+ *
+ *  \param  i_timeout   Timeout in milliseconds, -1 to wait forever
+ */
+/*----------------------------------------------------------------------------*/
+static void _hal_waitFds(int i_timeout)
+{
+	struct	epoll_event	pst_ev[HAL_MAX_FDS + 1];
+	st_halFd_t *		pst_fd;
+	uint64_t			ll_cnt;
+	int					i_num;
+	int					i;
+
+	i_num = epoll_wait(i_epollFd, pst_ev, HAL_MAX_FDS + 1, i_timeout);
+	for (i = 0; i < i_num; i++) {
+		pst_fd = pst_ev[i].data.ptr;
+		if (pst_fd == NULL) {
+			/* Reset the counter of an eventfd */
+			if (read(i_wakeFd, &ll_cnt, sizeof(ll_cnt)) < 0)
+				LOG_ERR("%s\n\r","fail to read wake up eventfd");
+		} else if ((pst_fd->i_fd >= 0) && (pst_fd->pfn_callback != NULL)) {
+			/* Acts as the interrupt handler of the descriptor */
+			pst_fd->pfn_callback(pst_fd->p_data);
+		}
+	}
+} /* _hal_waitFds() */
+
+#if TRACE_CONF_ENABLE
+/*----------------------------------------------------------------------------*/
+/** \brief  Open the trace file given in the environment and write its header
+ */
+/*----------------------------------------------------------------------------*/
+static void _hal_traceOpen(void)
+{
+	char				pc_name[256];
+	uint8_t				pc_hdr[8];
+
+	if (getenv(NATIVE_TRACE_ENV) == NULL)
+		return;
+#if NATIVE_SIM
+	snprintf(pc_name, sizeof(pc_name), "%s.%u", getenv(NATIVE_TRACE_ENV),
+			sim_nodeId());
+#else
+	snprintf(pc_name, sizeof(pc_name), "%s", getenv(NATIVE_TRACE_ENV));
+#endif
+	pf_trace = fopen(pc_name, "wb");
+	if (pf_trace == NULL) {
+		LOG_ERR("fail to open trace file %s\n\r", pc_name);
+		return;
+	}
+	memcpy(pc_hdr, TRACE_FILE_MAGIC, 4);
+	pc_hdr[4] = TRACE_FILE_VERSION & 0xFF;
+	pc_hdr[5] = TRACE_FILE_VERSION >> 8;
+	pc_hdr[6] = sizeof(st_traceRec_t) & 0xFF;
+	pc_hdr[7] = sizeof(st_traceRec_t) >> 8;
+	fwrite(pc_hdr, sizeof(pc_hdr), 1, pf_trace);
+} /* _hal_traceOpen() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Write the pending trace records to the trace file. Called before
+ *          going to sleep, so the file is written while the node is idle.
+ */
+/*----------------------------------------------------------------------------*/
+static void _hal_traceFlush(void)
+{
+	st_traceRec_t		pst_rec[HAL_TRACE_CHUNK];
+	uint8_t				pc_buf[HAL_TRACE_CHUNK * sizeof(st_traceRec_t)];
+	uint8_t *			pc_out;
+	uint16_t			i_num;
+	uint16_t			i;
+
+	if (pf_trace == NULL)
+		return;
+	while ((i_num = trace_read(pst_rec, HAL_TRACE_CHUNK)) > 0) {
+		/* The file is little endian whatever the host is */
+		for (i = 0, pc_out = pc_buf; i < i_num; i++) {
+			*pc_out++ = pst_rec[i].l_time & 0xFF;
+			*pc_out++ = (pst_rec[i].l_time >> 8) & 0xFF;
+			*pc_out++ = (pst_rec[i].l_time >> 16) & 0xFF;
+			*pc_out++ = (pst_rec[i].l_time >> 24) & 0xFF;
+			*pc_out++ = pst_rec[i].i_packet & 0xFF;
+			*pc_out++ = pst_rec[i].i_packet >> 8;
+			*pc_out++ = pst_rec[i].c_layer;
+			*pc_out++ = pst_rec[i].c_dir;
+		}
+		fwrite(pc_buf, pc_out - pc_buf, 1, pf_trace);
+	}
+	fflush(pf_trace);
+} /* _hal_traceFlush() */
+#endif /* TRACE_CONF_ENABLE */
 
 /*==============================================================================
                                  API FUNCTIONS
@@ -127,8 +272,106 @@ void hal_exitCritical(void)
 ==============================================================================*/
 int8_t hal_init (void)
 {
+	struct	epoll_event	st_ev;
+	int					i;
+
+	for (i = 0; i < HAL_MAX_FDS; i++)
+		gst_fds[i].i_fd = -1;
+
+	/* Runs on a virtual clock are reproducible unless a seed is given */
+	if (getenv(NATIVE_SEED_ENV) != NULL)
+		l_randState = strtoul(getenv(NATIVE_SEED_ENV), NULL, 0);
+#if NATIVE_SIM
+	else
+		l_randState = sim_nodeSeed();
+#elif !NATIVE_VIRTUAL_TIME
+	else
+		l_randState = (uint32_t)hal_getTimeUs() ^ (uint32_t)getpid();
+#endif
+	if (l_randState == 0)
+		l_randState = 1;
+
+#if TRACE_CONF_ENABLE
+	_hal_traceOpen();
+#endif
+
+#if NATIVE_SIM
+	/* The simulator wakes up the node */
+	return 1;
+#endif
+
+	i_wakeFd = eventfd(0, EFD_NONBLOCK);
+	i_epollFd = epoll_create1(0);
+	if ((i_wakeFd < 0) || (i_epollFd < 0)) {
+		LOG_ERR("%s\n\r","fail to create wake up eventfd");
+		return 0;
+	}
+	st_ev.events = EPOLLIN;
+	st_ev.data.ptr = NULL;
+	if (epoll_ctl(i_epollFd, EPOLL_CTL_ADD, i_wakeFd, &st_ev) < 0) {
+		LOG_ERR("%s\n\r","fail to watch wake up eventfd");
+		return 0;
+	}
+	return 1;
 }/* hal_init() */
 
+/*==============================================================================
+  hal_fdRegister()
+ =============================================================================*/
+int8_t hal_fdRegister(int i_fd, pfn_intCallb_t pfn_callback, void * p_data)
+{
+	struct	epoll_event	st_ev;
+	int					i;
+
+	if ((i_fd < 0) || (pfn_callback == NULL) || (i_epollFd < 0))
+		return 0;
+
+	for (i = 0; i < HAL_MAX_FDS; i++) {
+		if (gst_fds[i].i_fd < 0) {
+			st_ev.events = EPOLLIN;
+			st_ev.data.ptr = &gst_fds[i];
+			if (epoll_ctl(i_epollFd, EPOLL_CTL_ADD, i_fd, &st_ev) < 0) {
+				LOG_ERR("fail to watch descriptor %d\n\r", i_fd);
+				return 0;
+			}
+			gst_fds[i].i_fd = i_fd;
+			gst_fds[i].pfn_callback = pfn_callback;
+			gst_fds[i].p_data = p_data;
+			return 1;
+		}
+	}
+	LOG_ERR("%s\n\r","no free descriptor entry");
+	return 0;
+} /* hal_fdRegister() */
+
+/*==============================================================================
+  hal_fdUnregister()
+ =============================================================================*/
+void hal_fdUnregister(int i_fd)
+{
+	int					i;
+
+	for (i = 0; i < HAL_MAX_FDS; i++) {
+		if ((i_fd >= 0) && (gst_fds[i].i_fd == i_fd)) {
+			epoll_ctl(i_epollFd, EPOLL_CTL_DEL, i_fd, NULL);
+			gst_fds[i].i_fd = -1;
+			gst_fds[i].pfn_callback = NULL;
+		}
+	}
+} /* hal_fdUnregister() */
+
+/*==============================================================================
+  hal_getrand()
+ =============================================================================*/
+uint8_t	hal_getrand(void)
+{
+	/* xorshift32 */
+	l_randState ^= l_randState << 13;
+	l_randState ^= l_randState >> 17;
+	l_randState ^= l_randState << 5;
+	return (uint8_t)(l_randState >> 24);
+} /* hal_getrand() */
+
 /*==============================================================================
   hal_extIntInit()
  =============================================================================*/
@@ -140,8 +383,10 @@ uint8_t hal_extIntInit(en_targetExtInt_t e_intSource,  pfn_intCallb_t pfn_intCal
 /*==============================================================================
   hal_spiInit()
  =============================================================================*/
-void hal_spiInit(void)
+void *	hal_spiInit(void)
 {
+	/* There is no SPI bus, the radio is emulated */
+	return NULL;
 } /* hal_spiInit() */
 
 /*==============================================================================
@@ -149,120 +394,177 @@ void hal_spiInit(void)
  =============================================================================*/
 void	hal_delay_us(uint32_t l_delay)
 {
+#if NATIVE_SIM
+	/* Other nodes run meanwhile */
+	sim_delayUs(l_delay);
+#elif NATIVE_VIRTUAL_TIME
+	ll_virtualTime += l_delay;
+#else
 	tim.tv_nsec = l_delay*1000;
 	nanosleep(&tim, NULL);
+#endif
 } /* hal_delay_us() */
 
-
 /*==============================================================================
-  hal_setPin()
+  hal_sleepUntil()
  =============================================================================*/
-void	hal_setPin(pinDesc_t * st_pin)
+void	hal_sleepUntil(clock_time_t l_deadline)
 {
-} /* hal_setPin() */
+	int				i_timeout = -1;
+	clock_time_t	l_now;
 
-/*==============================================================================
-  hal_clrPin()
+#if TRACE_CONF_ENABLE
+	_hal_traceFlush();
+#endif
+#if NATIVE_SIM
+	sim_sleepUntil((uint64_t)l_deadline * (1000000UL / CLOCK_SECOND));
+	return;
+#elif NATIVE_VIRTUAL_TIME
+	c_sleeping = 1;
+	/* Serve the registered descriptors without waiting */
+	if (i_epollFd >= 0)
+		_hal_waitFds(0);
+	if (!c_wakeup) {
+		if (l_deadline != 0) {
+			/* Nothing to do until the deadline, jump to it */
+			if ((uint64_t)l_deadline * (1000000UL / CLOCK_SECOND) > ll_virtualTime)
+				ll_virtualTime = (uint64_t)l_deadline * (1000000UL / CLOCK_SECOND);
+		} else if (i_epollFd >= 0) {
+			/* Nothing is scheduled, only the outside world can wake up */
+			_hal_waitFds(-1);
+		}
+	}
+	c_sleeping = 0;
+	c_wakeup = 0;
+	return;
+#endif
+	c_sleeping = 1;
+	__sync_synchronize();
+	if (c_wakeup) {
+		i_timeout = 0;
+	} else if (l_deadline != 0) {
+		l_now = hal_getTick();
+		i_timeout = CLOCK_LT(l_now, l_deadline) ? (int)(l_deadline - l_now) : 0;
+	}
+	/* Registered descriptors are serviced even if there is no time to sleep */
+	if (i_epollFd >= 0)
+		_hal_waitFds(i_timeout);
+	c_sleeping = 0;
+	c_wakeup = 0;
+} /* hal_sleepUntil() */
+
+/*==============================================================================
+  hal_wakeup()
  =============================================================================*/
-void	hal_clrPin(pinDesc_t * st_pin)
+void	hal_wakeup(void)
 {
-} /* hal_clrPin() */
+	uint64_t		ll_cnt = 1;
+
+#if NATIVE_SIM
+	sim_wakeup();
+	return;
+#endif
+	c_wakeup = 1;
+	__sync_synchronize();
+	/* A system call is required only if the main loop is already blocked */
+	if (c_sleeping && (i_wakeFd >= 0)) {
+		if (write(i_wakeFd, &ll_cnt, sizeof(ll_cnt)) < 0)
+			LOG_ERR("%s\n\r","fail to write wake up eventfd");
+	}
+} /* hal_wakeup() */
+
 
 /*==============================================================================
-  hal_getPin()
+  hal_ledOn()
  =============================================================================*/
-uint8_t	hal_getPin(pinDesc_t * st_pin)
+void	hal_ledOn(uint16_t ui_led)
 {
-	return NULL;
-} /* hal_getPin() */
+} /* hal_ledOn() */
 
 /*==============================================================================
-  hal_spiRead()
+  hal_ledOff()
  =============================================================================*/
-uint8_t hal_spiRead(uint8_t c_address)
+void	hal_ledOff(uint16_t ui_led)
 {
-	return 0;
-} /* hal_spiRead() */
+} /* hal_ledOff() */
 
 /*==============================================================================
-  hal_spiWrite()
+  hal_gpioPinInit()
  =============================================================================*/
-void hal_spiWrite(uint8_t c_address, uint8_t c_value)
+uint8_t	hal_gpioPinInit(uint8_t c_pin, uint8_t c_dir, uint8_t c_initState)
 {
-} /* hal_spiWrite() */
+	return 0;
+} /* hal_gpioPinInit() */
 
 /*==============================================================================
-  hal_spiSubRead()
+  hal_ctrlPinInit()
  =============================================================================*/
-uint8_t hal_spiSubRead(		uint8_t c_address,
-						uint8_t c_mask,
-						uint8_t c_position)
+void *	hal_ctrlPinInit(en_targetExtPin_t e_pinType)
 {
-	return 0;
-} /* hal_spiSubRead() */
+	return NULL;
+} /* hal_ctrlPinInit() */
 
 /*==============================================================================
-  hal_spiSubWrite()
+  hal_pinSet()
  =============================================================================*/
-void hal_spiSubWrite(	uint8_t c_address,
-					uint8_t c_mask,
-					uint8_t c_position,
-					uint8_t c_value)
+void	hal_pinSet(void * p_pin)
 {
-} /* hal_spiSubWrite() */
+} /* hal_pinSet() */
 
 /*==============================================================================
-  hal_spiTranOpen()
+  hal_pinClr()
  =============================================================================*/
-void hal_spiTranOpen(void)
+void	hal_pinClr(void * p_pin)
 {
-} /* hal_spiTranOpen() */
+} /* hal_pinClr() */
 
 /*==============================================================================
-  hal_spiTranClose()
+  hal_pinGet()
  =============================================================================*/
-void hal_spiTranClose(void)
+uint8_t	hal_pinGet(void * p_pin)
 {
-} /* hal_spiTranClose() */
+	return 0;
+} /* hal_pinGet() */
 
 /*==============================================================================
-  hal_spiTranWrite()
+  hal_spiSlaveSel()
  =============================================================================*/
-void hal_spiTranWrite(uint8_t c_value)
+uint8_t	hal_spiSlaveSel(void * p_spi, bool action)
 {
-} /* hal_spiTranWrite() */
+	return 0;
+} /* hal_spiSlaveSel() */
 
 /*==============================================================================
-  hal_spiTranRead()
+  hal_spiRead()
  =============================================================================*/
-uint8_t hal_spiTranRead(void)
+uint8_t	hal_spiRead(uint8_t * p_reg, uint16_t i_length)
 {
-	return	0;
-} /* hal_spiTranRead() */
+	return 0;
+} /* hal_spiRead() */
 
 /*==============================================================================
-  hal_spiTranRead()
+  hal_spiWrite()
  =============================================================================*/
-void hal_spiTranWait(void)
+void	hal_spiWrite(uint8_t * value, uint16_t i_length)
 {
-} /* hal_spiTranWait() */
+} /* hal_spiWrite() */
 
 /*==============================================================================
-  hal_spiTranRead()
+  hal_watchdogReset()
  =============================================================================*/
 void 	hal_watchdogReset(void)
 {
 } /* hal_watchdogReset() */
 
 /*==============================================================================
-  hal_spiTranRead()
+  hal_watchdogStart()
  =============================================================================*/
 void 	hal_watchdogStart(void)
 {
 } /* hal_watchdogStart() */
 
 /*==============================================================================
-  hal_spiTranRead()
+  hal_watchdogStop()
  =============================================================================*/
 void 	hal_watchdogStop(void)
 {
@@ -270,28 +572,45 @@ void 	hal_watchdogStop(void)
 
 
 /*==============================================================================
-  hal_getTick()
+  hal_getTimeUs()
  =============================================================================*/
-uint32_t 	hal_getTick(void)
+uint64_t 	hal_getTimeUs(void)
 {
-	  struct timeval tv;
+	struct timespec st_ts;
+
+#if NATIVE_SIM
+	return sim_getTimeUs();
+#elif NATIVE_VIRTUAL_TIME
+	return ll_virtualTime;
+#endif
+	clock_gettime(CLOCK_MONOTONIC, &st_ts);
 
-	  gettimeofday(&tv, NULL);
+	return (uint64_t)st_ts.tv_sec * 1000000UL + st_ts.tv_nsec / 1000;
+} /* hal_getTimeUs() */
 
-	  return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+/*==============================================================================
+  hal_getTick()
+ =============================================================================*/
+clock_time_t 	hal_getTick(void)
+{
+	return hal_getTimeUs() / (1000000UL / CLOCK_SECOND);
 } /* hal_getTick() */
 
 /*==============================================================================
   hal_getSec()
  =============================================================================*/
-uint32_t 	hal_getSec(void)
+clock_time_t 	hal_getSec(void)
 {
-	  struct timeval tv;
-
-	  gettimeofday(&tv, NULL);
-
-	  return tv.tv_sec;
+	return hal_getTimeUs() / 1000000UL;
 } /* hal_getSec() */
+
+/*==============================================================================
+  hal_getTRes()
+ =============================================================================*/
+clock_time_t 	hal_getTRes(void)
+{
+	return CLOCK_SECOND;
+} /* hal_getTRes() */
 /** @} */
 /** @} */
 /** @} */
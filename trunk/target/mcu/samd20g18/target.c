@@ -78,6 +78,9 @@
 #endif
 #include	"logger.h"
 
+/** RTC counts per system tick */
+#define 	HAL_RTC_TICK_PERIOD		32
+
 /*==============================================================================
                                      ENUMS
 ==============================================================================*/
@@ -102,6 +105,9 @@
 ==============================================================================*/
 static	clock_time_t volatile 	l_tick;
 static	clock_time_t volatile 	l_sec;
+/** Wraparounds of the tick counter, extends the time to 64 bit */
+static	uint32_t volatile 		l_tickHigh;
+static	uint8_t volatile 		c_wakeup = 0;
 static	struct 	usart_module 	st_usartInst;
 static	struct 	spi_module 		st_masterInst;
 static	struct 	spi_slave_inst 	st_spi;
@@ -166,7 +172,7 @@ static void _hal_tcInit(void)
 	//! [init_rtc]
 
 	//! [period]
-		rtc_count_set_period(&rtc_instance, 32);
+		rtc_count_set_period(&rtc_instance, HAL_RTC_TICK_PERIOD);
 	//! [period]
 
 	//! [reg_callback]
@@ -285,6 +291,8 @@ void _isr_tc_interrupt(	void )
 	if(l_tick % CONF_TICK_SEC == 0)
 		l_sec++;
 	l_tick++;
+	if (l_tick == 0)
+		l_tickHigh++;
 } /* _isr_tc_interrupt() */
 
 void _isr_radio_callback(uint32_t channel)
@@ -447,6 +455,31 @@ void	hal_delay_us(uint32_t i_delay)
 	delay_us(i_delay);
 } /* hal_delay_us() */
 
+/*==============================================================================
+  hal_sleepUntil()
+ =============================================================================*/
+void	hal_sleepUntil(clock_time_t l_deadline)
+{
+	hal_enterCritical();
+	while ((!c_wakeup) && ((l_deadline == 0) || CLOCK_LT(l_tick, l_deadline))) {
+		/* Pending interrupt wakes the core up even with masked interrupts,
+		 * it is served right after leaving the critical section */
+		__WFI();
+		hal_exitCritical();
+		hal_enterCritical();
+	}
+	c_wakeup = 0;
+	hal_exitCritical();
+} /* hal_sleepUntil() */
+
+/*==============================================================================
+  hal_wakeup()
+ =============================================================================*/
+void	hal_wakeup(void)
+{
+	c_wakeup = 1;
+} /* hal_wakeup() */
+
 uint8_t  hal_gpioPinInit(uint8_t c_pin, uint8_t c_dir, uint8_t c_initState)
 {
     struct port_config pin_conf;
@@ -663,6 +696,28 @@ clock_time_t 	hal_getSec(void)
 	return l_sec;
 } /* hal_getSec() */
 
+/*==============================================================================
+  hal_getTimeUs()
+ =============================================================================*/
+uint64_t 	hal_getTimeUs(void)
+{
+	uint64_t	ll_tick;
+	uint32_t	l_cnt;
+
+	hal_enterCritical();
+	ll_tick = ((uint64_t)l_tickHigh << 32) | (uint32_t)l_tick;
+	l_cnt = rtc_count_get_count(&rtc_instance);
+	/* Overflow not served yet, counter already restarted */
+	if (rtc_count_is_overflow(&rtc_instance)) {
+		l_cnt = rtc_count_get_count(&rtc_instance);
+		ll_tick++;
+	}
+	hal_exitCritical();
+
+	return (ll_tick * 1000000UL +
+			(uint64_t)l_cnt * 1000000UL / (HAL_RTC_TICK_PERIOD + 1)) / CLOCK_SECOND;
+} /* hal_getTimeUs() */
+
 
 /*==============================================================================
   hal_getTRes()
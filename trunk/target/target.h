@@ -139,6 +139,30 @@ uint8_t	hal_extIntInit(en_targetExtInt_t e_extInt, pfn_intCallb_t pfn_intCallbac
 /*============================================================================*/
 void	hal_delay_us(uint32_t i_delay);
 
+/*============================================================================*/
+/** \brief  This function puts the MCU into an idle state until the given
+ * 			tick value is reached or \ref hal_wakeup() was called
+ *
+ *			The function may return earlier, callers have to check their
+ *			conditions again.
+ *
+ *  \param  l_deadline	Tick value to wake up at, 0 to sleep until
+ *  					\ref hal_wakeup() was called
+ *
+ *  \retval	none
+ */
+/*============================================================================*/
+void	hal_sleepUntil(clock_time_t l_deadline);
+
+/*============================================================================*/
+/** \brief  This function terminates a pending or the next call of
+ * 			\ref hal_sleepUntil(). Can be called from an interrupt context.
+ *
+ *  \retval	none
+ */
+/*============================================================================*/
+void	hal_wakeup(void);
+
 /*============================================================================*/
 /** \brief  This function initialise given gpio pin
  *
@@ -275,6 +299,19 @@ clock_time_t 	hal_getTick(void);
 /*============================================================================*/
 clock_time_t 	hal_getSec(void);
 
+/*============================================================================*/
+/** \brief  This function will return a monotonic time in microseconds
+ *
+ *			The start point is target specific. The time never goes backwards and
+ *			does not wrap around during the lifetime of a device. The
+ *			resolution depends on the target, ticks are interpolated by the
+ *			counter of the tick timer.
+ *
+ *  \retval	microseconds
+ */
+/*============================================================================*/
+uint64_t 		hal_getTimeUs(void);
+
 /*============================================================================*/
 /** \brief  This function will time resolution
  * 			How many ticks in one second
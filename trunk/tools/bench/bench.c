@@ -0,0 +1,228 @@
+/*============================================================================*/
+/*! \file   bench.c
+
+    \brief  Common part of the benchmarks of the native target.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#define		_POSIX_C_SOURCE		199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "emb6.h"
+#include "bench.h"
+#include "bsp.h"
+#include "queuebuf.h"
+#include "ctimer.h"
+#include "random.h"
+#include "tcpip.h"
+
+/*==============================================================================
+                           LOCAL FUNCTION PROTOTYPES
+==============================================================================*/
+static	int8_t	_bench_radioInit(s_ns_t * p_ns);
+static	int8_t	_bench_radioSend(const void * pr_payload, uint8_t c_len);
+static	int8_t	_bench_radioOn(void);
+static	int8_t	_bench_radioOff(void);
+static	void	_bench_radioSetPower(int8_t c_power);
+static	int8_t	_bench_radioGetPower(void);
+static	void	_bench_radioSetSensitivity(int8_t c_sens);
+static	int8_t	_bench_radioGetSensitivity(void);
+static	int8_t	_bench_radioGetRSSI(void);
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+/** Last frames passed to the radio */
+static	uint8_t						pc_frames[BENCH_MAX_FRAMES][BENCH_MAX_FRAME];
+/** Lengths of the last frames */
+static	uint16_t					pi_frameLens[BENCH_MAX_FRAMES];
+/** Frames passed to the radio */
+static	uint32_t					l_frames;
+/** Attempts of a frame which are not acknowledged */
+static	uint8_t						c_noAcks;
+/** Attempts of the current frame */
+static	uint8_t						c_attempts;
+
+const s_nsIf_t bench_radio = {
+		"bench",
+		_bench_radioInit,
+		_bench_radioSend,
+		_bench_radioOn,
+		_bench_radioOff,
+		_bench_radioSetPower,
+		_bench_radioGetPower,
+		_bench_radioSetSensitivity,
+		_bench_radioGetSensitivity,
+		_bench_radioGetRSSI,
+		NULL,
+		NULL,
+};
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+static int8_t _bench_radioInit(s_ns_t * p_ns)
+{
+	linkaddr_t	un_addr;
+
+	memcpy(&un_addr.u8, mac_phy_config.mac_address, sizeof(un_addr.u8));
+	memcpy(&uip_lladdr.addr, &un_addr.u8, sizeof(un_addr.u8));
+	rimeaddr_emb6_set_node_addr(&un_addr);
+	return 1;
+}
+
+static int8_t _bench_radioSend(const void * pr_payload, uint8_t c_len)
+{
+	uint32_t	l_idx = l_frames % BENCH_MAX_FRAMES;
+
+	pi_frameLens[l_idx] = (c_len > BENCH_MAX_FRAME) ? BENCH_MAX_FRAME : c_len;
+	memcpy(pc_frames[l_idx], pr_payload, pi_frameLens[l_idx]);
+	l_frames++;
+	if (c_attempts < c_noAcks) {
+		c_attempts++;
+		return RADIO_TX_NOACK;
+	}
+	c_attempts = 0;
+	return RADIO_TX_OK;
+}
+
+static int8_t _bench_radioOn(void)
+{
+	return 1;
+}
+
+static int8_t _bench_radioOff(void)
+{
+	return 1;
+}
+
+static void _bench_radioSetPower(int8_t c_power)
+{
+}
+
+static int8_t _bench_radioGetPower(void)
+{
+	return 0;
+}
+
+static void _bench_radioSetSensitivity(int8_t c_sens)
+{
+}
+
+static int8_t _bench_radioGetSensitivity(void)
+{
+	return 0;
+}
+
+static int8_t _bench_radioGetRSSI(void)
+{
+	return 0;
+}
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+uint64_t bench_getNs(void)
+{
+	struct timespec st_ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &st_ts);
+	return (uint64_t)st_ts.tv_sec * 1000000000ULL + st_ts.tv_nsec;
+}
+
+uint32_t bench_ops(uint32_t l_ops)
+{
+	const char *	pc_scale = getenv(BENCH_SCALE_ENV);
+	double			d_ops = l_ops;
+
+	if (pc_scale != NULL)
+		d_ops *= atof(pc_scale);
+	return (d_ops < 1.0) ? 1 : (uint32_t)d_ops;
+}
+
+void bench_start(st_bench_t * pst_bench, const char * pc_suite,
+				 const char * pc_case, uint32_t l_ops)
+{
+	pst_bench->pc_suite = pc_suite;
+	pst_bench->pc_case = pc_case;
+	pst_bench->l_ops = l_ops;
+	pst_bench->ll_start = bench_getNs();
+}
+
+uint64_t bench_stop(st_bench_t * pst_bench)
+{
+	uint64_t	ll_ns = bench_getNs() - pst_bench->ll_start;
+
+	printf("{\"suite\":\"%s\",\"case\":\"%s\",\"ops\":%lu,\"ns\":%llu,\"ns_per_op\":%.3f}\n",
+			pst_bench->pc_suite, pst_bench->pc_case,
+			(unsigned long)pst_bench->l_ops, (unsigned long long)ll_ns,
+			(double)ll_ns / pst_bench->l_ops);
+	fflush(stdout);
+	return ll_ns;
+}
+
+void bench_metric(const char * pc_suite, const char * pc_metric,
+				  double d_value, const char * pc_unit)
+{
+	printf("{\"suite\":\"%s\",\"metric\":\"%s\",\"value\":%.3f,\"unit\":\"%s\"}\n",
+			pc_suite, pc_metric, d_value, pc_unit);
+	fflush(stdout);
+}
+
+uint8_t bench_netstackInit(s_ns_t * pst_ns)
+{
+	pst_ns->hc = &sicslowpan_driver;
+	pst_ns->llsec = &nullsec_driver;
+	pst_ns->hmac = &nullmac_driver;
+	pst_ns->lmac = &sicslowmac_driver;
+	pst_ns->frame = &framer_802154;
+	pst_ns->inif = &bench_radio;
+	pst_ns->c_configured = 1;
+
+	if (!hal_init())
+		return 0;
+	random_init(((unsigned short)hal_getrand() << 8) | hal_getrand());
+
+	/* Same order as emb6_init() */
+	queuebuf_init();
+	ctimer_init();
+	pst_ns->inif->init(pst_ns);
+	pst_ns->frame->init(pst_ns);
+	pst_ns->lmac->init(pst_ns);
+	pst_ns->hmac->init(pst_ns);
+	pst_ns->llsec->init(pst_ns);
+	pst_ns->hc->init(pst_ns);
+	tcpip_init();
+	return 1;
+}
+
+const uint8_t * bench_radioFrame(uint16_t * pi_len)
+{
+	return bench_radioFrameAt(l_frames - 1, pi_len);
+}
+
+const uint8_t * bench_radioFrameAt(uint32_t l_num, uint16_t * pi_len)
+{
+	if ((l_num >= l_frames) || (l_frames - l_num > BENCH_MAX_FRAMES))
+		return NULL;
+	*pi_len = pi_frameLens[l_num % BENCH_MAX_FRAMES];
+	return pc_frames[l_num % BENCH_MAX_FRAMES];
+}
+
+void bench_radioSetNoAcks(uint8_t c_num)
+{
+	c_noAcks = c_num;
+	c_attempts = 0;
+}
+
+uint32_t bench_radioFrames(void)
+{
+	return l_frames;
+}
@@ -0,0 +1,159 @@
+/*============================================================================*/
+/*! \file   bench.h
+
+    \brief  Common part of the benchmarks of the native target.
+
+            Every benchmark is an own program linked to the stack library.
+            The results are printed to stdout, one JSON object per line:
+
+                {"suite":"evproc","case":"put_next","ops":1000000,"ns":21000000,"ns_per_op":21.000}
+                {"suite":"forward","metric":"frames_per_packet","value":1.000,"unit":"frame"}
+
+            The amount of operations of every case is multiplied by the
+            BENCH_SCALE environment variable, e.g. BENCH_SCALE=10 for
+            more stable results or BENCH_SCALE=0 for a quick smoke test
+            running every case once.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdint.h>
+#include "emb6.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Environment variable scaling the amount of operations */
+#define BENCH_SCALE_ENV						"BENCH_SCALE"
+
+/** Largest frame captured by \ref bench_radio */
+#define BENCH_MAX_FRAME						128
+
+/** Frames kept by \ref bench_radio */
+#define BENCH_MAX_FRAMES					8
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Running benchmark case */
+typedef struct
+{
+	const char *					pc_suite;
+	const char *					pc_case;
+	uint32_t						l_ops;
+	uint64_t						ll_start;
+}st_bench_t;
+
+/*==============================================================================
+                          GLOBAL VARIABLE DECLARATIONS
+==============================================================================*/
+/** Radio interface capturing all transmitted frames instead of sending them */
+extern const s_nsIf_t				bench_radio;
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Monotonic time in nanoseconds
+ */
+/*----------------------------------------------------------------------------*/
+uint64_t bench_getNs(void);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Amount of operations of a case scaled by BENCH_SCALE
+ *
+ *  \param  l_ops       Default amount of operations
+ *
+ *  \return Amount of operations, at least 1
+ */
+/*----------------------------------------------------------------------------*/
+uint32_t bench_ops(uint32_t l_ops);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Start measuring a case
+ *
+ *  \param  pst_bench   Case to start
+ *  \param  pc_suite    Name of the suite, i.e. of the program
+ *  \param  pc_case     Name of the case
+ *  \param  l_ops       Amount of operations executed by the case
+ */
+/*----------------------------------------------------------------------------*/
+void	bench_start(st_bench_t * pst_bench, const char * pc_suite,
+					const char * pc_case, uint32_t l_ops);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Stop measuring a case and print its result
+ *
+ *  \return Nanoseconds taken by the case
+ */
+/*----------------------------------------------------------------------------*/
+uint64_t bench_stop(st_bench_t * pst_bench);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Print a result which is not a duration
+ *
+ *  \param  pc_suite    Name of the suite
+ *  \param  pc_metric   Name of the metric
+ *  \param  d_value     Value
+ *  \param  pc_unit     Unit of the value
+ */
+/*----------------------------------------------------------------------------*/
+void	bench_metric(const char * pc_suite, const char * pc_metric,
+					 double d_value, const char * pc_unit);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Initialize the HAL and a network stack of sicslowpan, nullsec,
+ *          nullmac, sicslowmac and the 802.15.4 framer on top of
+ *          \ref bench_radio, like emb6_init() does for a board.
+ *
+ *  \param  pst_ns      Network stack to fill in
+ *
+ *  \return 1 if success, 0 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+uint8_t	bench_netstackInit(s_ns_t * pst_ns);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Last frame passed to \ref bench_radio
+ *
+ *  \param  pi_len      Returns the length of the frame
+ *
+ *  \return Pointer to the frame
+ */
+/*----------------------------------------------------------------------------*/
+const uint8_t * bench_radioFrame(uint16_t * pi_len);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Frame passed to \ref bench_radio, one of the last
+ *          BENCH_MAX_FRAMES
+ *
+ *  \param  l_num       Number of the frame, counted from 0
+ *  \param  pi_len      Returns the length of the frame
+ *
+ *  \return Pointer to the frame, NULL if it is not kept
+ */
+/*----------------------------------------------------------------------------*/
+const uint8_t * bench_radioFrameAt(uint32_t l_num, uint16_t * pi_len);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Let \ref bench_radio acknowledge a frame only after some
+ *          attempts which are not acknowledged
+ *
+ *  \param  c_num       Attempts of every frame answered by RADIO_TX_NOACK
+ */
+/*----------------------------------------------------------------------------*/
+void	bench_radioSetNoAcks(uint8_t c_num);
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Amount of frames passed to \ref bench_radio
+ */
+/*----------------------------------------------------------------------------*/
+uint32_t bench_radioFrames(void);
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,105 @@
+/*============================================================================*/
+/*! \file   bench_coap.c
+
+    \brief  Benchmark of the CoAP message serialization and parsing.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "emb6.h"
+#include "bench.h"
+#include "er-coap.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"coap"
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	const uint8_t				pc_token[] = { 0xde, 0xad, 0xbe, 0xef };
+static	const char					pc_payload[] =
+		"{\"temp\":21.5,\"hum\":48,\"bat\":2980}";
+static	uint8_t						pc_msg[COAP_MAX_PACKET_SIZE];
+/** The parser merges the path segments in place, every parse gets a fresh
+ *  copy of the message like a received packet in uip_buf */
+static	uint8_t						pc_rx[COAP_MAX_PACKET_SIZE];
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/* Request with a token, a path and a query, as sent by a client */
+static size_t _bench_request(coap_packet_t * pst_packet, uint16_t i_mid)
+{
+	coap_init_message(pst_packet, COAP_TYPE_CON, COAP_GET, i_mid);
+	coap_set_token(pst_packet, pc_token, sizeof(pc_token));
+	coap_set_header_uri_path(pst_packet, "sensors/env");
+	coap_set_header_uri_query(pst_packet, "unit=si");
+	return coap_serialize_message(pst_packet, pc_msg);
+}
+
+/* Response with an observe option and a JSON payload, as sent by a server */
+static size_t _bench_response(coap_packet_t * pst_packet, uint16_t i_mid)
+{
+	coap_init_message(pst_packet, COAP_TYPE_NON, CONTENT_2_05, i_mid);
+	coap_set_token(pst_packet, pc_token, sizeof(pc_token));
+	coap_set_header_content_format(pst_packet, APPLICATION_JSON);
+	coap_set_header_observe(pst_packet, i_mid);
+	coap_set_payload(pst_packet, pc_payload, sizeof(pc_payload) - 1);
+	return coap_serialize_message(pst_packet, pc_msg);
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	st_bench_t		st_bench;
+	coap_packet_t	st_packet;
+	coap_packet_t	st_parsed;
+	uint32_t		l_ops;
+	uint32_t		i;
+	size_t			x_reqLen = 0;
+	size_t			x_rspLen = 0;
+
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "serialize_request", l_ops);
+	for (i = 0; i < l_ops; i++)
+		x_reqLen = _bench_request(&st_packet, (uint16_t)i);
+	bench_stop(&st_bench);
+
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "parse_request", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		memcpy(pc_rx, pc_msg, x_reqLen);
+		if (coap_parse_message(&st_parsed, pc_rx, x_reqLen) != NO_ERROR)
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "serialize_response", l_ops);
+	for (i = 0; i < l_ops; i++)
+		x_rspLen = _bench_response(&st_packet, (uint16_t)i);
+	bench_stop(&st_bench);
+
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "parse_response", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		memcpy(pc_rx, pc_msg, x_rspLen);
+		if (coap_parse_message(&st_parsed, pc_rx, x_rspLen) != NO_ERROR)
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	bench_metric(BENCH_SUITE, "request_len", x_reqLen, "byte");
+	bench_metric(BENCH_SUITE, "response_len", x_rspLen, "byte");
+	return 0;
+}
@@ -0,0 +1,241 @@
+/*============================================================================*/
+/*! \file   bench_evproc.c
+
+    \brief  Benchmark of the event processing and of the idle loop.
+
+            The idle loop is measured twice: emb6_process(), which sleeps
+            until the next timer or event, and the former main loop, which
+            polled with a fixed delay of BENCH_OLD_DELAY microseconds.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#define		_GNU_SOURCE
+#include <stdio.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <time.h>
+#include <pthread.h>
+#include "emb6.h"
+#include "bench.h"
+#include "bsp.h"
+#include "evproc.h"
+#include "etimer.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"evproc"
+/** Event type used by the benchmark, not used by the rest of the stack */
+#define BENCH_EVENT							EVENT_TYPE_SLIP_POLL
+/** Deepest queue of the depth sweep, at most EVPROC_QUEUE_SIZE */
+#define BENCH_MAX_DEPTH						256
+
+/** Delay of the former main loop, the default of emb6_process() before */
+#define BENCH_OLD_DELAY						500
+/** Expirations per second of the timer keeping the idle loop busy, like the
+ *  stack timers do */
+#define BENCH_IDLE_RATE						100
+
+#if BENCH_MAX_DEPTH > EVPROC_QUEUE_SIZE
+#error "EVPROC_CONF_QUEUE_SIZE is too small for the depth sweep"
+#endif
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+/** Events delivered to the callback */
+static	volatile uint32_t			l_delivered;
+/** Amount of wake ups done by the waker thread */
+static	uint32_t					l_wakeups;
+/** Time of the last hal_wakeup() call */
+static	volatile uint64_t			ll_wakeNs;
+/** Set by the main thread when it consumed the last wake up */
+static	volatile uint32_t			l_woken;
+/** Timer expiring periodically during the idle window */
+static	struct etimer				st_idleTimer;
+/** End of the idle window */
+static	uint64_t					ll_idleEndNs;
+/** Leaves the main loop at the end of the idle window */
+static	jmp_buf						st_idleExit;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+static void _bench_callback(c_event_t c_event, p_data_t p_data)
+{
+	l_delivered++;
+}
+
+/* Restarts the idle timer until the idle window has elapsed */
+static void _bench_idleTimer(c_event_t c_event, p_data_t p_data)
+{
+	if (bench_getNs() >= ll_idleEndNs)
+		longjmp(st_idleExit, 1);
+	etimer_reset(&st_idleTimer);
+}
+
+/* CPU time used by the process in nanoseconds */
+static uint64_t _bench_cpuNs(void)
+{
+	struct timespec	st_ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &st_ts);
+	return (uint64_t)st_ts.tv_sec * 1000000000ULL + st_ts.tv_nsec;
+}
+
+/* Runs a main loop for a fixed window and reports its CPU usage. The former
+ * loop is used if c_old is set, emb6_process() otherwise */
+static void _bench_idle(const char * pc_metric, uint8_t c_old)
+{
+	uint64_t	ll_startNs;
+	uint64_t	ll_cpuNs;
+
+	ll_startNs = bench_getNs();
+	ll_idleEndNs = ll_startNs + (uint64_t)bench_ops(1000) * 1000000ULL;
+	ll_cpuNs = _bench_cpuNs();
+	etimer_set(&st_idleTimer, bsp_get(E_BSP_GET_TRES) / BENCH_IDLE_RATE,
+			   _bench_idleTimer);
+	if (setjmp(st_idleExit) == 0) {
+		if (c_old) {
+			while (1) {
+				evproc_nextEvent();
+				etimer_request_poll();
+				bsp_delay_us(BENCH_OLD_DELAY);
+			}
+		}
+		emb6_process(0);
+	}
+	etimer_stop(&st_idleTimer);
+	ll_cpuNs = _bench_cpuNs() - ll_cpuNs;
+	bench_metric(BENCH_SUITE, pc_metric,
+				 100.0 * ll_cpuNs / (bench_getNs() - ll_startNs), "%");
+}
+
+/* Wakes up the main thread in a loop, like an interrupt would */
+static void * _bench_waker(void * p_arg)
+{
+	uint32_t	i;
+
+	for (i = 0; i < l_wakeups; i++) {
+		/* Let the main thread fall asleep */
+		while (__atomic_load_n(&l_woken, __ATOMIC_ACQUIRE) != i)
+			;
+		usleep(50);
+		__atomic_store_n(&ll_wakeNs, bench_getNs(), __ATOMIC_RELEASE);
+		hal_wakeup();
+	}
+	return NULL;
+}
+
+/* Measures the latency from hal_wakeup() until the main loop notices it. The
+ * former loop only notices it after its fixed delay if c_old is set */
+static uint8_t _bench_wakeup(const char * pc_avg, const char * pc_max,
+							 uint8_t c_old)
+{
+	pthread_t	st_thread;
+	uint64_t	ll_sum = 0;
+	uint64_t	ll_max = 0;
+	uint64_t	ll_lat;
+	uint32_t	i;
+
+	l_wakeups = bench_ops(2000);
+	l_woken = 0;
+	ll_wakeNs = 0;
+	if (pthread_create(&st_thread, NULL, _bench_waker, NULL) != 0)
+		return 0;
+	for (i = 0; i < l_wakeups; i++) {
+		/* The sleep may end early, wait for the wake up of this round */
+		ll_lat = __atomic_load_n(&ll_wakeNs, __ATOMIC_ACQUIRE);
+		do {
+			if (c_old)
+				bsp_delay_us(BENCH_OLD_DELAY);
+			else
+				hal_sleepUntil(0);
+		} while (__atomic_load_n(&ll_wakeNs, __ATOMIC_ACQUIRE) == ll_lat);
+		ll_lat = bench_getNs() - __atomic_load_n(&ll_wakeNs, __ATOMIC_ACQUIRE);
+		ll_sum += ll_lat;
+		if (ll_lat > ll_max)
+			ll_max = ll_lat;
+		__atomic_store_n(&l_woken, i + 1, __ATOMIC_RELEASE);
+	}
+	pthread_join(st_thread, NULL);
+	bench_metric(BENCH_SUITE, pc_avg, (double)ll_sum / l_wakeups / 1000.0, "us");
+	bench_metric(BENCH_SUITE, pc_max, (double)ll_max / 1000.0, "us");
+	return 1;
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	st_bench_t	st_bench;
+	uint32_t	l_ops;
+	uint32_t	i;
+	uint32_t	j;
+	uint16_t	i_depth;
+	char		pc_case[16];
+
+	if (!hal_init())
+		return 1;
+	etimer_init();
+	evproc_regCallback(BENCH_EVENT, _bench_callback);
+
+	/* Post an event and dispatch it */
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "put_next", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		evproc_putEvent(E_EVPROC_TAIL, BENCH_EVENT, (p_data_t)(uintptr_t)i);
+		evproc_nextEvent();
+	}
+	bench_stop(&st_bench);
+
+	/* Fill the queue up to a depth, then dispatch all events. The amount of
+	 * events is the same for every depth, the cost is given per event */
+	for (i_depth = 1; i_depth <= BENCH_MAX_DEPTH; i_depth <<= 1) {
+		snprintf(pc_case, sizeof(pc_case), "depth_%u", i_depth);
+		l_ops = bench_ops(1000000 / i_depth);
+		bench_start(&st_bench, BENCH_SUITE, pc_case, l_ops * i_depth);
+		for (i = 0; i < l_ops; i++) {
+			for (j = 0; j < i_depth; j++)
+				evproc_putEvent(E_EVPROC_TAIL, BENCH_EVENT, (p_data_t)(uintptr_t)j);
+			while (evproc_pending())
+				evproc_nextEvent();
+		}
+		bench_stop(&st_bench);
+	}
+
+	/* Immediate execution of all subscribers */
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "exec", l_ops);
+	for (i = 0; i < l_ops; i++)
+		evproc_putEvent(E_EVPROC_EXEC, BENCH_EVENT, NULL);
+	bench_stop(&st_bench);
+
+	/* One turn of the main loop of emb6_process() without work */
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "idle_poll", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		evproc_nextEvent();
+		etimer_request_poll();
+		if (evproc_pending())
+			break;
+	}
+	bench_stop(&st_bench);
+
+	/* CPU usage of the main loop while idle */
+	_bench_idle("idle_cpu", 0);
+	_bench_idle("idle_cpu_old", 1);
+
+	/* Latency from hal_wakeup() in another thread until the main loop runs */
+	if (!_bench_wakeup("wakeup_latency_avg", "wakeup_latency_max", 0) ||
+		!_bench_wakeup("wakeup_latency_old_avg", "wakeup_latency_old_max", 1))
+		return 1;
+
+	return (l_delivered != 0) ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+/*============================================================================*/
+/*! \file   bench_forward.c
+
+    \brief  Benchmark of the forwarding path, from a received 802.15.4 frame
+            through the MAC, 6LoWPAN and IPv6 back to the radio.
+
+            Besides the time, the bytes copied between packetbuf and the
+            queuebufs are reported per forwarded datagram, for a datagram
+            in a single frame, for a fragmented one and for a fragmented
+            one sent by csma with a retransmission of every frame.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "emb6.h"
+#include "bench.h"
+#include "evproc.h"
+#include "etimer.h"
+#include "packetbuf.h"
+#include "queuebuf.h"
+#include "linkaddr.h"
+#include "tcpip.h"
+#include "uip-ds6.h"
+#include "uip-ds6-nbr.h"
+#include "uip-ds6-route.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"forward"
+/** UDP payload of the unfragmented packets */
+#define BENCH_PAYLOAD_LEN					48
+/** UDP payload of the fragmented packets */
+#define BENCH_FRAG_PAYLOAD_LEN				150
+/** Frames of a datagram kept for the previous hop */
+#define BENCH_FRAMES						4
+/** Longest time a case may take to send its frames */
+#define BENCH_TIMEOUT_NS					(60ULL * 1000000000ULL)
+
+#define BENCH_IP_BUF						((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define BENCH_UDP_BUF						((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	s_ns_t						st_netstack;
+/** Previous hop, sends the frames to this node */
+static	const uip_lladdr_t			st_prevLl = { { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x01 } };
+/** Next hop towards the destination */
+static	const uip_lladdr_t			st_nextLl = { { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02 } };
+/** Frames of the datagram sent by the previous hop */
+static	uint8_t						pc_frames[BENCH_FRAMES][BENCH_MAX_FRAME];
+static	uint16_t					pi_frameLens[BENCH_FRAMES];
+static	uint8_t						c_frames;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/* Neighbor and host route towards the destination */
+static uint8_t _bench_route(uip_ipaddr_t * pst_dest)
+{
+	uip_ipaddr_t	st_next;
+
+	uip_ip6addr(&st_next, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+	uip_ds6_set_addr_iid(&st_next, (uip_lladdr_t *)&st_nextLl);
+	if (uip_ds6_nbr_add(&st_next, &st_nextLl, 1, NBR_REACHABLE) == NULL)
+		return 0;
+	return uip_ds6_route_add(pst_dest, 128, &st_next) != NULL;
+}
+
+/* Frames of a UDP packet as the previous hop sends it to this node. They
+ * are compressed, fragmented and framed by this stack acting as the
+ * previous hop. */
+static uint8_t _bench_frame(uip_ipaddr_t * pst_dest, uint16_t i_payloadLen)
+{
+	linkaddr_t		st_self;
+	const uint8_t *	pc_sent;
+	uint32_t		l_frames;
+	uint16_t		i;
+
+	memset(uip_buf, 0, UIP_LLH_LEN + UIP_IPUDPH_LEN + i_payloadLen);
+	BENCH_IP_BUF->vtc = 0x60;
+	BENCH_IP_BUF->len[0] = (UIP_UDPH_LEN + i_payloadLen) >> 8;
+	BENCH_IP_BUF->len[1] = (UIP_UDPH_LEN + i_payloadLen) & 0xff;
+	BENCH_IP_BUF->proto = UIP_PROTO_UDP;
+	BENCH_IP_BUF->ttl = 64;
+	uip_ip6addr(&BENCH_IP_BUF->srcipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0x0101);
+	uip_ipaddr_copy(&BENCH_IP_BUF->destipaddr, pst_dest);
+	BENCH_UDP_BUF->srcport = UIP_HTONS(0xf0b1);
+	BENCH_UDP_BUF->destport = UIP_HTONS(0xf0b2);
+	BENCH_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + i_payloadLen);
+	for (i = 0; i < i_payloadLen; i++)
+		uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN + i] = (uint8_t)i;
+	BENCH_UDP_BUF->udpchksum = ~(uip_udpchksum());
+	uip_len = UIP_IPUDPH_LEN + i_payloadLen;
+
+	linkaddr_copy(&st_self, &linkaddr_node_addr);
+	linkaddr_copy(&linkaddr_node_addr, (linkaddr_t *)&st_prevLl);
+	l_frames = bench_radioFrames();
+	tcpip_output((uip_lladdr_t *)&st_self);
+	linkaddr_copy(&linkaddr_node_addr, &st_self);
+	uip_len = 0;
+
+	c_frames = bench_radioFrames() - l_frames;
+	if ((c_frames == 0) || (c_frames > BENCH_FRAMES))
+		return 0;
+	for (i = 0; i < c_frames; i++) {
+		pc_sent = bench_radioFrameAt(l_frames + i, &pi_frameLens[i]);
+		if (pc_sent == NULL)
+			return 0;
+		memcpy(pc_frames[i], pc_sent, pi_frameLens[i]);
+	}
+	return 1;
+}
+
+/* Forward the datagram of the previous hop several times. The events and
+ * timers are served until the MAC passed all frames to the radio. */
+static uint8_t _bench_forward(const char * pc_case, uint32_t l_ops,
+							  uint8_t c_noAcks)
+{
+	st_bench_t		st_bench;
+	char			pc_metric[64];
+	uint64_t		ll_deadline;
+	uint32_t		l_frames;
+	uint32_t		l_sent;
+	uint32_t		l_copied;
+	uint32_t		i;
+	uint8_t			j;
+
+	/* Every frame is forwarded after c_noAcks failed attempts */
+	l_sent = l_ops * c_frames * (c_noAcks + 1);
+	bench_radioSetNoAcks(c_noAcks);
+	ll_deadline = bench_getNs() + BENCH_TIMEOUT_NS;
+	l_frames = bench_radioFrames();
+	l_copied = queuebuf_copied_bytes();
+	bench_start(&st_bench, BENCH_SUITE, pc_case, l_ops);
+	for (i = 0; i < l_ops; i++) {
+		for (j = 0; j < c_frames; j++) {
+			packetbuf_clear();
+			packetbuf_copyfrom(pc_frames[j], pi_frameLens[j]);
+			st_netstack.lmac->input();
+		}
+		while (bench_radioFrames() - l_frames < (i + 1) * (l_sent / l_ops)) {
+			if (bench_getNs() > ll_deadline)
+				return 0;
+			evproc_nextEvent();
+			etimer_request_poll();
+		}
+	}
+	bench_stop(&st_bench);
+	bench_radioSetNoAcks(0);
+
+	/* Every received datagram must have been forwarded */
+	if (bench_radioFrames() - l_frames != l_sent)
+		return 0;
+	snprintf(pc_metric, sizeof(pc_metric), "%s_queuebuf_copied", pc_case);
+	bench_metric(BENCH_SUITE, pc_metric,
+			(double)(queuebuf_copied_bytes() - l_copied) / l_ops, "byte/datagram");
+	return 1;
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	uip_ipaddr_t	st_dest;
+	uint16_t		i_fwdLen;
+
+	if (!bench_netstackInit(&st_netstack))
+		return 1;
+	uip_ip6addr(&st_dest, 0xaaaa, 0, 0, 0, 0x0212, 0x4b00, 0, 0x0001);
+	if (!_bench_route(&st_dest))
+		return 1;
+
+	if (!_bench_frame(&st_dest, BENCH_PAYLOAD_LEN) || (c_frames != 1) ||
+		!_bench_forward("udp_48", bench_ops(200000), 0))
+		return 1;
+	bench_radioFrame(&i_fwdLen);
+	bench_metric(BENCH_SUITE, "frame_in_len", pi_frameLens[0], "byte");
+	bench_metric(BENCH_SUITE, "frame_out_len", i_fwdLen, "byte");
+
+	if (!_bench_frame(&st_dest, BENCH_FRAG_PAYLOAD_LEN) || (c_frames < 2) ||
+		!_bench_forward("udp_150_frag", bench_ops(50000), 0))
+		return 1;
+
+	/* csma queues the fragments and repeats every frame once */
+	st_netstack.hmac = &csma_driver;
+	st_netstack.hmac->init(&st_netstack);
+	if (!_bench_forward("udp_150_frag_retry", bench_ops(200), 1))
+		return 1;
+	return 0;
+}
@@ -0,0 +1,130 @@
+/*============================================================================*/
+/*! \file   bench_frame.c
+
+    \brief  Benchmark of the IEEE 802.15.4 frame creation and parsing.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "emb6.h"
+#include "bench.h"
+#include "packetbuf.h"
+#include "frame802154.h"
+#include "linkaddr.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"frame"
+/** Payload length of the frames, a typical compressed UDP packet */
+#define BENCH_PAYLOAD_LEN					80
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	uint8_t						pc_payload[BENCH_PAYLOAD_LEN];
+static	uint8_t						pc_frame[BENCH_MAX_FRAME];
+static	const linkaddr_t			st_peer = { { 0x00, 0x50, 0xc2, 0xff, 0xfe, 0xa8, 0x40, 0xd3 } };
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/* Header of a data frame with long addresses as the stack sends them */
+static void _bench_params(frame802154_t * pst_params)
+{
+	memset(pst_params, 0, sizeof(*pst_params));
+	pst_params->fcf.frame_type = FRAME802154_DATAFRAME;
+	pst_params->fcf.ack_required = 1;
+	pst_params->fcf.panid_compression = 1;
+	pst_params->fcf.frame_version = FRAME802154_IEEE802154_2006;
+	pst_params->fcf.dest_addr_mode = FRAME802154_LONGADDRMODE;
+	pst_params->fcf.src_addr_mode = FRAME802154_LONGADDRMODE;
+	pst_params->seq = 0x42;
+	pst_params->dest_pid = mac_phy_config.pan_id;
+	pst_params->src_pid = mac_phy_config.pan_id;
+	memcpy(pst_params->dest_addr, st_peer.u8, sizeof(st_peer.u8));
+	memcpy(pst_params->src_addr, mac_phy_config.mac_address, 8);
+	pst_params->payload = pc_payload;
+	pst_params->payload_len = sizeof(pc_payload);
+}
+
+/* Fill the packet buffer with the payload to send to the peer */
+static void _bench_packetbuf(void)
+{
+	packetbuf_clear();
+	packetbuf_copyfrom(pc_payload, sizeof(pc_payload));
+	packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_DATAFRAME);
+	packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, 1);
+	packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &st_peer);
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	st_bench_t		st_bench;
+	frame802154_t	st_params;
+	frame802154_t	st_frame;
+	uint32_t		l_ops;
+	uint32_t		i;
+	int				i_hdrLen = 0;
+	uint16_t		i_len;
+
+	for (i = 0; i < sizeof(pc_payload); i++)
+		pc_payload[i] = (uint8_t)i;
+	linkaddr_copy(&linkaddr_node_addr, (linkaddr_t *)mac_phy_config.mac_address);
+
+	/* Header only, directly on frame802154 */
+	_bench_params(&st_params);
+	l_ops = bench_ops(2000000);
+	bench_start(&st_bench, BENCH_SUITE, "create_hdr", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		st_params.seq = (uint8_t)i;
+		i_hdrLen = frame802154_create(&st_params, pc_frame);
+	}
+	bench_stop(&st_bench);
+	memcpy(pc_frame + i_hdrLen, pc_payload, sizeof(pc_payload));
+	i_len = i_hdrLen + sizeof(pc_payload);
+
+	l_ops = bench_ops(2000000);
+	bench_start(&st_bench, BENCH_SUITE, "parse_hdr", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (frame802154_parse(pc_frame, i_len, &st_frame) != i_hdrLen)
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	/* Through the framer and the packet buffer, as the MAC does */
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "framer_create", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		_bench_packetbuf();
+		if (framer_802154.create() < 0)
+			return 1;
+	}
+	bench_stop(&st_bench);
+	i_len = packetbuf_totlen();
+	memcpy(pc_frame, packetbuf_hdrptr(), i_len);
+
+	/* The parsed frame is addressed to the peer, parse it as the peer */
+	linkaddr_copy(&linkaddr_node_addr, &st_peer);
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "framer_parse", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		packetbuf_clear();
+		packetbuf_copyfrom(pc_frame, i_len);
+		if (framer_802154.parse() < 0)
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	bench_metric(BENCH_SUITE, "header_len", i_hdrLen, "byte");
+	return 0;
+}
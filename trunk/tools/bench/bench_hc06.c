@@ -0,0 +1,281 @@
+/*============================================================================*/
+/*! \file   bench_hc06.c
+
+    \brief  Benchmark of the 6LoWPAN HC06 header compression.
+
+            A corpus of typical IPv6 headers is compressed and uncompressed
+            in a loop. Every uncompressed header is checked against the
+            original one. Besides the time per packet the compressed and
+            uncompressed header lengths and their ratio are reported.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "emb6.h"
+#include "bench.h"
+#include "packetbuf.h"
+#include "linkaddr.h"
+#include "sicslowpan.h"
+#include "uip-ds6.h"
+
+#if !SICSLOWPAN_CONF_HC06_API
+#error "The benchmark requires SICSLOWPAN_CONF_HC06_API"
+#endif
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"hc06"
+/** Payload after the headers of every packet */
+#define BENCH_PAYLOAD_LEN					32
+/** Largest packet of the corpus */
+#define BENCH_PACKET_MAX					128
+
+/** Flags of the corpus entries */
+/** Source IID derived from the MAC address of this node */
+#define BENCH_SRC_MAC						0x01
+/** Destination IID derived from the MAC address of the peer */
+#define BENCH_DST_MAC						0x02
+/** RPL hop-by-hop option header before the upper layer header */
+#define BENCH_HBH							0x04
+
+#define BENCH_IP_BUF(p)						((struct uip_ip_hdr *)(p))
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Header of the corpus */
+typedef struct
+{
+	const char *	pc_name;
+	uint16_t		pi_src[8];
+	uint16_t		pi_dst[8];
+	uint8_t			c_flags;
+	uint8_t			c_proto;
+	uint8_t			c_ttl;
+	uint8_t			c_tc;
+	uint32_t		l_flow;
+	/** UDP ports, ICMPv6 type and code for ICMPv6 */
+	uint16_t		i_srcPort;
+	uint16_t		i_dstPort;
+}st_benchHdr_t;
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	s_ns_t						st_netstack;
+static	const linkaddr_t			st_peer = { { 0x00, 0x50, 0xc2, 0xff, 0xfe, 0xa8, 0x40, 0xd3 } };
+
+static	const st_benchHdr_t			gst_corpus[] = {
+	/* Link-local unicast, fully elided addresses and compressed ports */
+	{ "ll_udp",
+		{ 0xfe80 }, { 0xfe80 },
+		BENCH_SRC_MAC | BENCH_DST_MAC, UIP_PROTO_UDP, 64, 0, 0, 0xf0b1, 0xf0b2 },
+	{ "ll_icmp_echo",
+		{ 0xfe80 }, { 0xfe80 },
+		BENCH_SRC_MAC | BENCH_DST_MAC, UIP_PROTO_ICMP6, 64, 0, 0, 128 << 8, 0 },
+	/* Neighbor solicitation to a solicited-node multicast address */
+	{ "ll_icmp_ns",
+		{ 0xfe80 }, { 0xff02, 0, 0, 0, 0, 0x0001, 0xffa8, 0x40d3 },
+		BENCH_SRC_MAC, UIP_PROTO_ICMP6, 255, 0, 0, 135 << 8, 0 },
+	/* Global addresses of the context 0 prefix */
+	{ "ctx_coap",
+		{ 0xaaaa }, { 0xaaaa },
+		BENCH_SRC_MAC | BENCH_DST_MAC, UIP_PROTO_UDP, 64, 0, 0, 5683, 5683 },
+	{ "ctx_short_iid",
+		{ 0xaaaa, 0, 0, 0, 0, 0x00ff, 0xfe00, 0x0001 },
+		{ 0xaaaa, 0, 0, 0, 0, 0x00ff, 0xfe00, 0x0002 },
+		0, UIP_PROTO_UDP, 64, 0, 0, 0xf0b1, 5683 },
+	{ "ctx_inline_iid",
+		{ 0xaaaa, 0, 0, 0, 0x0212, 0x4b00, 0x0001, 0x0203 },
+		{ 0xaaaa, 0, 0, 0, 0x0212, 0x4b00, 0x0004, 0x0506 },
+		0, UIP_PROTO_UDP, 63, 0, 0, 49152, 5683 },
+	{ "ctx_tc_flow",
+		{ 0xaaaa }, { 0xaaaa },
+		BENCH_SRC_MAC | BENCH_DST_MAC, UIP_PROTO_UDP, 64, 0xb8, 0x12345, 5683, 5683 },
+	/* Global addresses without context, carried inline */
+	{ "global_udp",
+		{ 0x2001, 0x0db8, 0, 0, 0, 0, 0, 0x0001 },
+		{ 0x2001, 0x0db8, 0x0001, 0, 0, 0, 0, 0x0002 },
+		0, UIP_PROTO_UDP, 64, 0, 0, 49153, 5683 },
+	/* RPL DIO to all RPL nodes */
+	{ "mcast_rpl_dio",
+		{ 0xfe80 }, { 0xff02, 0, 0, 0, 0, 0, 0, 0x001a },
+		BENCH_SRC_MAC, UIP_PROTO_ICMP6, 255, 0, 0, (155 << 8) | 0x01, 0 },
+	{ "mcast_ff05",
+		{ 0xaaaa }, { 0xff05, 0, 0, 0, 0, 0, 0, 0x00fb },
+		BENCH_SRC_MAC, UIP_PROTO_UDP, 64, 0, 0, 5353, 5353 },
+	/* Data packet with the RPL option, as forwarded in a DODAG */
+	{ "rpl_hbh_udp",
+		{ 0xaaaa }, { 0xaaaa, 0, 0, 0, 0x0212, 0x4b00, 0x0001, 0x0203 },
+		BENCH_SRC_MAC | BENCH_HBH, UIP_PROTO_UDP, 64, 0, 0, 0xf0b1, 5683 },
+};
+
+#define BENCH_CORPUS_SIZE					(sizeof(gst_corpus) / sizeof(gst_corpus[0]))
+
+/** Packets built from the corpus */
+static	uint8_t						pc_packet[BENCH_PACKET_MAX];
+/** Compressed packets */
+static	uint8_t						pc_lowpan[BENCH_PACKET_MAX];
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+static void _bench_addr(uip_ipaddr_t * pst_addr, const uint16_t * pi_addr,
+						uint8_t c_mac, const linkaddr_t * pst_mac)
+{
+	uip_ip6addr(pst_addr, pi_addr[0], pi_addr[1], pi_addr[2], pi_addr[3],
+				pi_addr[4], pi_addr[5], pi_addr[6], pi_addr[7]);
+	if (c_mac)
+		uip_ds6_set_addr_iid(pst_addr, (uip_lladdr_t *)pst_mac);
+}
+
+/* Build the packet of a corpus entry in pc_packet, returns its length */
+static uint16_t _bench_packet(const st_benchHdr_t * pst_hdr)
+{
+	struct uip_ip_hdr *	pst_ip = BENCH_IP_BUF(pc_packet);
+	uint8_t *			pc_next = pc_packet + UIP_IPH_LEN;
+	uint16_t			i_len;
+	uint16_t			i;
+
+	memset(pc_packet, 0, sizeof(pc_packet));
+	pst_ip->vtc = 0x60 | (pst_hdr->c_tc >> 4);
+	pst_ip->tcflow = (uint8_t)(pst_hdr->c_tc << 4) | (uint8_t)(pst_hdr->l_flow >> 16);
+	pst_ip->flow = UIP_HTONS((uint16_t)pst_hdr->l_flow);
+	pst_ip->ttl = pst_hdr->c_ttl;
+	_bench_addr(&pst_ip->srcipaddr, pst_hdr->pi_src,
+				pst_hdr->c_flags & BENCH_SRC_MAC, &linkaddr_node_addr);
+	_bench_addr(&pst_ip->destipaddr, pst_hdr->pi_dst,
+				pst_hdr->c_flags & BENCH_DST_MAC, &st_peer);
+
+	if (pst_hdr->c_flags & BENCH_HBH) {
+		pst_ip->proto = UIP_PROTO_HBHO;
+		pc_next[0] = pst_hdr->c_proto;
+		pc_next[1] = 0;
+		/* RPL option: flags, instance and sender rank */
+		pc_next[2] = 0x63;
+		pc_next[3] = 4;
+		pc_next[4] = 0;
+		pc_next[5] = 0x1e;
+		pc_next[6] = 0x01;
+		pc_next[7] = 0x00;
+		pc_next += 8;
+	} else {
+		pst_ip->proto = pst_hdr->c_proto;
+	}
+
+	if (pst_hdr->c_proto == UIP_PROTO_UDP) {
+		struct uip_udp_hdr * pst_udp = (struct uip_udp_hdr *)pc_next;
+		pst_udp->srcport = UIP_HTONS(pst_hdr->i_srcPort);
+		pst_udp->destport = UIP_HTONS(pst_hdr->i_dstPort);
+		pst_udp->udplen = UIP_HTONS(UIP_UDPH_LEN + BENCH_PAYLOAD_LEN);
+		pst_udp->udpchksum = UIP_HTONS(0x1234);
+		pc_next += UIP_UDPH_LEN;
+	} else {
+		pc_next[0] = pst_hdr->i_srcPort >> 8;
+		pc_next[1] = (uint8_t)pst_hdr->i_srcPort;
+		pc_next[2] = 0x56;
+		pc_next[3] = 0x78;
+		pc_next += UIP_ICMPH_LEN;
+	}
+	for (i = 0; i < BENCH_PAYLOAD_LEN; i++)
+		*pc_next++ = (uint8_t)i;
+
+	i_len = pc_next - pc_packet;
+	pst_ip->len[0] = (i_len - UIP_IPH_LEN) >> 8;
+	pst_ip->len[1] = (uint8_t)(i_len - UIP_IPH_LEN);
+	return i_len;
+}
+
+/* Benchmark a corpus entry, returns 0 if the round trip fails */
+static uint8_t _bench_entry(const st_benchHdr_t * pst_hdr,
+							double * pd_compNs, double * pd_uncompNs,
+							uint32_t * pl_inBytes, uint32_t * pl_outBytes)
+{
+	st_bench_t			st_bench;
+	char				pc_case[48];
+	const linkaddr_t *	pst_dest = &st_peer;
+	uint8_t *			pc_hdr = NULL;
+	uint32_t			l_ops;
+	uint32_t			i;
+	uint16_t			i_len;
+	uint16_t			i_lowpanLen;
+	int					i_compLen = 0;
+	uint8_t				c_uncompLen = 0;
+	uint8_t				c_checkLen = 0;
+
+	i_len = _bench_packet(pst_hdr);
+	memcpy(uip_buf + UIP_LLH_LEN, pc_packet, i_len);
+	uip_len = i_len;
+	if (uip_is_addr_mcast(&BENCH_IP_BUF(pc_packet)->destipaddr))
+		pst_dest = &linkaddr_null;
+
+	packetbuf_clear();
+	l_ops = bench_ops(1000000);
+	snprintf(pc_case, sizeof(pc_case), "compress_%s", pst_hdr->pc_name);
+	bench_start(&st_bench, BENCH_SUITE, pc_case, l_ops);
+	for (i = 0; i < l_ops; i++)
+		i_compLen = sicslowpan_hc06_compress((linkaddr_t *)pst_dest, &c_uncompLen);
+	*pd_compNs += (double)bench_stop(&st_bench) / l_ops;
+
+	/* The compressed packet as it is received by the peer */
+	memcpy(pc_lowpan, packetbuf_dataptr(), i_compLen);
+	memcpy(pc_lowpan + i_compLen, pc_packet + c_uncompLen, i_len - c_uncompLen);
+	i_lowpanLen = i_compLen + i_len - c_uncompLen;
+	packetbuf_copyfrom(pc_lowpan, i_lowpanLen);
+	packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
+	packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, pst_dest);
+
+	l_ops = bench_ops(1000000);
+	snprintf(pc_case, sizeof(pc_case), "uncompress_%s", pst_hdr->pc_name);
+	bench_start(&st_bench, BENCH_SUITE, pc_case, l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (sicslowpan_hc06_uncompress(&pc_hdr, &c_checkLen) != i_compLen)
+			return 0;
+	}
+	*pd_uncompNs += (double)bench_stop(&st_bench) / l_ops;
+
+	if ((c_checkLen != c_uncompLen) || memcmp(pc_hdr, pc_packet, c_uncompLen))
+		return 0;
+
+	snprintf(pc_case, sizeof(pc_case), "ratio_%s", pst_hdr->pc_name);
+	bench_metric(BENCH_SUITE, pc_case, (double)i_compLen / c_uncompLen, "ratio");
+	*pl_inBytes += c_uncompLen;
+	*pl_outBytes += i_compLen;
+	return 1;
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	double		d_compNs = 0;
+	double		d_uncompNs = 0;
+	uint32_t	l_inBytes = 0;
+	uint32_t	l_outBytes = 0;
+	uint16_t	i;
+
+	if (!bench_netstackInit(&st_netstack))
+		return 1;
+
+	for (i = 0; i < BENCH_CORPUS_SIZE; i++) {
+		if (!_bench_entry(&gst_corpus[i], &d_compNs, &d_uncompNs,
+				&l_inBytes, &l_outBytes)) {
+			fprintf(stderr, "%s: round trip failed\n", gst_corpus[i].pc_name);
+			return 1;
+		}
+	}
+
+	/* Averages over the corpus, every entry weighted equally */
+	bench_metric(BENCH_SUITE, "compress_avg", d_compNs / BENCH_CORPUS_SIZE, "ns/packet");
+	bench_metric(BENCH_SUITE, "uncompress_avg", d_uncompNs / BENCH_CORPUS_SIZE, "ns/packet");
+	bench_metric(BENCH_SUITE, "ratio_corpus", (double)l_outBytes / l_inBytes, "ratio");
+	return 0;
+}
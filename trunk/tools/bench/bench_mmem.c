@@ -0,0 +1,144 @@
+/*============================================================================*/
+/*! \file   bench_mmem.c
+
+    \brief  Benchmark and self check of the slab backend of mmem.
+
+            The benchmark build selects MMEM_BACKEND_SLAB. Besides the
+            timing the program checks that blocks keep their contents, that
+            oversized requests fail instead of hanging and that the
+            statistics add up. It returns 1 if a check fails.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "emb6.h"
+#include "bench.h"
+#include "mmem.h"
+#include "random.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"mmem"
+/** Maximum amount of blocks allocated at the same time */
+#define BENCH_MAX_BLOCKS					64
+/** Largest block requested by the benchmark */
+#define BENCH_MAX_SIZE						256
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	struct	mmem				gst_block[BENCH_MAX_BLOCKS];
+static	uint8_t						pc_used[BENCH_MAX_BLOCKS];
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/* Fill a block with a pattern depending on its index */
+static void _bench_fill(uint16_t i_idx)
+{
+	memset(gst_block[i_idx].ptr, (uint8_t)(i_idx + 1), gst_block[i_idx].size);
+}
+
+/* Check the pattern of a block */
+static uint8_t _bench_check(uint16_t i_idx)
+{
+	uint8_t *	pc_data = gst_block[i_idx].ptr;
+	uint16_t	i;
+
+	for (i = 0; i < gst_block[i_idx].size; i++) {
+		if (pc_data[i] != (uint8_t)(i_idx + 1))
+			return 0;
+	}
+	return 1;
+}
+
+/* Allocate and free blocks of random sizes and check all blocks in use */
+static uint8_t _bench_random(uint32_t l_ops)
+{
+	uint32_t	i;
+	uint16_t	i_idx;
+
+	for (i = 0; i < l_ops; i++) {
+		i_idx = random_rand() % BENCH_MAX_BLOCKS;
+		if (pc_used[i_idx]) {
+			if (!_bench_check(i_idx))
+				return 0;
+			mmem_free(&gst_block[i_idx]);
+			pc_used[i_idx] = 0;
+		}
+		else if (mmem_alloc(&gst_block[i_idx],
+							 1 + random_rand() % BENCH_MAX_SIZE)) {
+			_bench_fill(i_idx);
+			pc_used[i_idx] = 1;
+		}
+	}
+	for (i_idx = 0; i_idx < BENCH_MAX_BLOCKS; i_idx++) {
+		if (pc_used[i_idx]) {
+			if (!_bench_check(i_idx))
+				return 0;
+			mmem_free(&gst_block[i_idx]);
+			pc_used[i_idx] = 0;
+		}
+	}
+	return 1;
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	st_bench_t			st_bench;
+	struct	mmem_stats	st_stats;
+	uint32_t			l_ops;
+	uint32_t			i;
+
+	mmem_init();
+
+	/* Requests beyond the largest size class fail, also on 16 bit ints */
+	if (mmem_alloc(&gst_block[0], 40000U) || mmem_alloc(&gst_block[0], ~0U)) {
+		printf("mmem: oversized block allocated\n");
+		return 1;
+	}
+	mmem_stats(&st_stats);
+	if (st_stats.failed != 2) {
+		printf("mmem: oversized blocks not counted as failed\n");
+		return 1;
+	}
+
+	/* Allocate and free the same block */
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "alloc_free", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		mmem_alloc(&gst_block[0], 48);
+		mmem_free(&gst_block[0]);
+	}
+	bench_stop(&st_bench);
+
+	/* Random sizes while other blocks are in use */
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "random", l_ops);
+	if (!_bench_random(l_ops)) {
+		printf("mmem: block contents overwritten\n");
+		return 1;
+	}
+	bench_stop(&st_bench);
+
+	/* All blocks are free again, the memory is either cached or unused */
+	mmem_stats(&st_stats);
+	if ((st_stats.requested != 0) || (st_stats.reserved != 0) ||
+		(st_stats.cached + st_stats.avail != MMEM_CONF_SIZE)) {
+		printf("mmem: statistics do not add up\n");
+		return 1;
+	}
+	bench_metric(BENCH_SUITE, "cached", st_stats.cached, "byte");
+
+	return 0;
+}
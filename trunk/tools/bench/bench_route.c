@@ -0,0 +1,137 @@
+/*============================================================================*/
+/*! \file   bench_route.c
+
+    \brief  Benchmark of the neighbor cache and routing table lookups.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "emb6.h"
+#include "bench.h"
+#include "uip-ds6.h"
+#include "uip-ds6-nbr.h"
+#include "uip-ds6-route.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"route"
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	s_ns_t						st_netstack;
+static	uip_ipaddr_t				gst_dest[UIP_DS6_ROUTE_NB];
+static	uip_ipaddr_t				gst_nbr[NBR_TABLE_MAX_NEIGHBORS];
+static	uip_lladdr_t				gst_nbrLl[NBR_TABLE_MAX_NEIGHBORS];
+static	uint16_t					i_nbrs;
+static	uint16_t					i_routes;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/* Fill the neighbor cache and the routing table. The tables may be smaller
+ * than the configured sizes, e.g. if the neighbor table evicts entries, so
+ * only the entries which are present afterwards are kept. */
+static void _bench_fill(void)
+{
+	uint16_t	i;
+
+	for (i = 0; i < NBR_TABLE_MAX_NEIGHBORS; i++) {
+		memset(&gst_nbrLl[i], 0, sizeof(gst_nbrLl[i]));
+		gst_nbrLl[i].addr[0] = 0x02;
+		gst_nbrLl[i].addr[sizeof(gst_nbrLl[i].addr) - 1] = (uint8_t)(i + 1);
+		uip_ip6addr(&gst_nbr[i], 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+		uip_ds6_set_addr_iid(&gst_nbr[i], &gst_nbrLl[i]);
+		uip_ds6_nbr_add(&gst_nbr[i], &gst_nbrLl[i], 1, NBR_REACHABLE);
+	}
+	for (i = 0; i < NBR_TABLE_MAX_NEIGHBORS; i++) {
+		if (uip_ds6_nbr_lookup(&gst_nbr[i]) != NULL) {
+			gst_nbr[i_nbrs] = gst_nbr[i];
+			gst_nbrLl[i_nbrs++] = gst_nbrLl[i];
+		}
+	}
+	if (i_nbrs == 0)
+		return;
+
+	for (i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+		uip_ip6addr(&gst_dest[i], 0xaaaa, 0, 0, 0, 0x0212, 0x4b00, 0, i + 1);
+		uip_ds6_route_add(&gst_dest[i], 128, &gst_nbr[i % i_nbrs]);
+	}
+	for (i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+		if (uip_ds6_route_lookup(&gst_dest[i]) != NULL)
+			gst_dest[i_routes++] = gst_dest[i];
+	}
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	st_bench_t		st_bench;
+	uip_ipaddr_t	st_miss;
+	uint32_t		l_ops;
+	uint32_t		i;
+
+	if (!bench_netstackInit(&st_netstack))
+		return 1;
+	_bench_fill();
+	if (i_routes == 0)
+		return 1;
+
+	/* Lookups of all routes in turn. The table moves a found route to
+	 * the front, so this is the worst case of a hit */
+	l_ops = bench_ops(2000000);
+	bench_start(&st_bench, BENCH_SUITE, "lookup_hit", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (uip_ds6_route_lookup(&gst_dest[i % i_routes]) == NULL)
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	/* A miss walks the whole table, like every packet to the default route */
+	uip_ip6addr(&st_miss, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 1);
+	l_ops = bench_ops(2000000);
+	bench_start(&st_bench, BENCH_SUITE, "lookup_miss", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (uip_ds6_route_lookup(&st_miss) != NULL)
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	l_ops = bench_ops(2000000);
+	bench_start(&st_bench, BENCH_SUITE, "nbr_lookup", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (uip_ds6_nbr_lookup(&gst_nbr[i % i_nbrs]) == NULL)
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	l_ops = bench_ops(2000000);
+	bench_start(&st_bench, BENCH_SUITE, "nbr_ll_lookup", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (uip_ds6_nbr_ll_lookup(&gst_nbrLl[i % i_nbrs]) == NULL)
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	/* Done for the destination of every received packet */
+	l_ops = bench_ops(2000000);
+	bench_start(&st_bench, BENCH_SUITE, "is_my_addr", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (uip_ds6_is_my_addr(&gst_dest[i % i_routes]))
+			return 1;
+	}
+	bench_stop(&st_bench);
+
+	bench_metric(BENCH_SUITE, "routes", i_routes, "route");
+	bench_metric(BENCH_SUITE, "neighbors", i_nbrs, "neighbor");
+	return 0;
+}
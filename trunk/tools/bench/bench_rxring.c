@@ -0,0 +1,176 @@
+/*============================================================================*/
+/*! \file   bench_rxring.c
+
+    \brief  Benchmark and self check of the receive ring of the radio
+            drivers.
+
+            The interrupt handler of a transceiver is replaced by calls of
+            the producer functions between the receive events. The program
+            checks overruns, duplicates, the wrap around of the indices and
+            the exchange of the descriptors, it returns 1 if a check fails.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "emb6.h"
+#include "bench.h"
+#include "packetbuf.h"
+#include "rxring.h"
+#include "random.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"rxring"
+/** Length of the frames received by the benchmark */
+#define BENCH_FRAME_LEN						100
+
+#if PACKETBUF_RX_SLOTS < RXRING_SIZE
+#error "PACKETBUF_CONF_RX_SLOTS is too small for the receive ring"
+#endif
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	st_rxring_t					st_ring;
+/** Sequence number of the next frame received */
+static	uint32_t					l_rxSeq;
+/** Sequence number of the next frame expected by the consumer */
+static	uint32_t					l_takeSeq;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/* Receive a frame carrying a sequence number, like the interrupt handler */
+static uint8_t _bench_receive(uint32_t l_seq)
+{
+	uint8_t *	pc_buf;
+
+	pc_buf = rxring_getBuf(&st_ring);
+	if (pc_buf == NULL)
+		return 0;
+	memset(pc_buf, (uint8_t)l_seq, BENCH_FRAME_LEN);
+	memcpy(pc_buf, &l_seq, sizeof(l_seq));
+	if (rxring_isDup(&st_ring, BENCH_FRAME_LEN))
+		return 0;
+	rxring_put(&st_ring, BENCH_FRAME_LEN, (uint8_t)l_seq, 0);
+	return 1;
+}
+
+/* Take the oldest frame into the packetbuf and check its contents */
+static uint8_t _bench_take(uint32_t l_seq)
+{
+	struct packetbuf_slot *	pst_prev = packetbuf_slot_current();
+	st_rxringEntry_t *		pst_entry;
+	uint8_t *				pc_data;
+	uint32_t				l_got;
+	uint16_t				i;
+
+	pst_entry = rxring_peek(&st_ring);
+	if ((pst_entry == NULL) || (rxring_take(&st_ring, BENCH_FRAME_LEN) != 0))
+		return 0;
+	/* The previously selected descriptor went into the ring */
+	if ((pst_entry->pst_slot != pst_prev) ||
+		(packetbuf_slot_current() == pst_prev))
+		return 0;
+	pc_data = packetbuf_dataptr();
+	memcpy(&l_got, pc_data, sizeof(l_got));
+	if ((l_got != l_seq) || (packetbuf_datalen() != BENCH_FRAME_LEN) ||
+		(packetbuf_attr(PACKETBUF_ATTR_LINK_QUALITY) != (uint8_t)l_seq))
+		return 0;
+	for (i = sizeof(l_seq); i < BENCH_FRAME_LEN; i++) {
+		if (pc_data[i] != (uint8_t)l_seq)
+			return 0;
+	}
+	return 1;
+}
+
+/* Check an empty ring, a full ring and duplicates */
+static uint8_t _bench_checkFull(void)
+{
+	uint8_t		i;
+
+	if (rxring_peek(&st_ring) != NULL)
+		return 0;
+	/* The same frame again is a duplicate */
+	if (!_bench_receive(l_rxSeq) || _bench_receive(l_rxSeq))
+		return 0;
+	l_rxSeq++;
+	for (i = 1; i < RXRING_SIZE; i++) {
+		if (!_bench_receive(l_rxSeq++))
+			return 0;
+	}
+	/* The ring is full now */
+	if (_bench_receive(l_rxSeq))
+		return 0;
+#if STATS_CONF_ENABLE
+	if ((st_ring.st_stats.l_dup != 1) || (st_ring.st_stats.l_overrun != 1))
+		return 0;
+#endif /* STATS_CONF_ENABLE */
+	for (i = 0; i < RXRING_SIZE; i++) {
+		if (!_bench_take(l_takeSeq++))
+			return 0;
+	}
+	return rxring_peek(&st_ring) == NULL;
+}
+
+/* Receive bursts of random length between the receive events, the indices
+ * wrap around several times */
+static uint8_t _bench_checkBursts(uint32_t l_frames)
+{
+	uint8_t		c_burst;
+	uint8_t		i;
+
+	while (l_takeSeq < l_frames) {
+		c_burst = 1 + random_rand() % RXRING_SIZE;
+		for (i = 0; i < c_burst; i++) {
+			if (!_bench_receive(l_rxSeq))
+				break;
+			l_rxSeq++;
+		}
+		while (l_takeSeq != l_rxSeq) {
+			if (!_bench_take(l_takeSeq++))
+				return 0;
+		}
+	}
+	return 1;
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	st_bench_t	st_bench;
+	uint32_t	l_ops;
+	uint32_t	i;
+
+	if (rxring_init(&st_ring, "rxring") != 0) {
+		printf("rxring: no descriptors for the ring\n");
+		return 1;
+	}
+
+	if (!_bench_checkFull() || !_bench_checkBursts(l_takeSeq + 10000)) {
+		printf("rxring: check failed at frame %lu\n", (unsigned long)l_takeSeq);
+		return 1;
+	}
+
+	/* Receive a frame and take it into the packetbuf */
+	l_ops = bench_ops(1000000);
+	bench_start(&st_bench, BENCH_SUITE, "put_take", l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (rxring_getBuf(&st_ring) == NULL)
+			return 1;
+		rxring_put(&st_ring, BENCH_FRAME_LEN, 0, 0);
+		rxring_take(&st_ring, BENCH_FRAME_LEN);
+	}
+	bench_stop(&st_bench);
+
+	return 0;
+}
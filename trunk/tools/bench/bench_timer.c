@@ -0,0 +1,140 @@
+/*============================================================================*/
+/*! \file   bench_timer.c
+
+    \brief  Benchmark of the event timers (timing wheel).
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "emb6.h"
+#include "bench.h"
+#include "bsp.h"
+#include "evproc.h"
+#include "etimer.h"
+#include "random.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define BENCH_SUITE							"timer"
+/** Maximum amount of timers pending in the background */
+#define BENCH_MAX_TIMERS					4096
+/** Timers expiring together in the fire case, fits into the event queue */
+#define BENCH_FIRE_TIMERS					16
+/** Ticks per second */
+#define BENCH_SECOND						bsp_get(E_BSP_GET_TRES)
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	struct	etimer				gst_background[BENCH_MAX_TIMERS];
+static	struct	etimer				gst_fire[BENCH_FIRE_TIMERS];
+static	struct	etimer				st_timer;
+static	uint32_t					l_fired;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+static void _bench_callback(c_event_t c_event, p_data_t p_data)
+{
+	l_fired++;
+}
+
+/* Random interval between one second and one hour */
+static clock_time_t _bench_interval(void)
+{
+	return BENCH_SECOND + (((clock_time_t)random_rand() << 8) % (3600UL * BENCH_SECOND));
+}
+
+/* Benchmark timer operations while a given amount of other timers pends */
+static void _bench_pending(uint16_t i_pending)
+{
+	st_bench_t	st_bench;
+	char		pc_case[32];
+	uint32_t	l_ops;
+	uint32_t	i;
+
+	for (i = 0; i < BENCH_MAX_TIMERS; i++)
+		etimer_stop(&gst_background[i]);
+	for (i = 0; i < i_pending; i++)
+		etimer_set(&gst_background[i], _bench_interval(), _bench_callback);
+
+	l_ops = bench_ops(1000000);
+	snprintf(pc_case, sizeof(pc_case), "set_stop_%u", i_pending);
+	bench_start(&st_bench, BENCH_SUITE, pc_case, l_ops);
+	for (i = 0; i < l_ops; i++) {
+		etimer_set(&st_timer, BENCH_SECOND + (i & 0xFFFF), _bench_callback);
+		etimer_stop(&st_timer);
+	}
+	bench_stop(&st_bench);
+
+	l_ops = bench_ops(1000000);
+	snprintf(pc_case, sizeof(pc_case), "restart_%u", i_pending);
+	etimer_set(&st_timer, 10 * BENCH_SECOND, _bench_callback);
+	bench_start(&st_bench, BENCH_SUITE, pc_case, l_ops);
+	for (i = 0; i < l_ops; i++)
+		etimer_restart(&st_timer);
+	bench_stop(&st_bench);
+	etimer_stop(&st_timer);
+
+	l_ops = bench_ops(1000000);
+	snprintf(pc_case, sizeof(pc_case), "next_expiration_%u", i_pending);
+	bench_start(&st_bench, BENCH_SUITE, pc_case, l_ops);
+	for (i = 0; i < l_ops; i++) {
+		if (etimer_next_expiration_time() == 1)
+			break;
+	}
+	bench_stop(&st_bench);
+
+	l_ops = bench_ops(1000000);
+	snprintf(pc_case, sizeof(pc_case), "poll_%u", i_pending);
+	bench_start(&st_bench, BENCH_SUITE, pc_case, l_ops);
+	for (i = 0; i < l_ops; i++)
+		etimer_request_poll();
+	bench_stop(&st_bench);
+}
+
+/*==============================================================================
+                                     main()
+==============================================================================*/
+int main(void)
+{
+	st_bench_t			st_bench;
+	st_etimerStats_t	st_stats;
+	uint32_t			l_ops;
+	uint32_t			i;
+	uint32_t			j;
+
+	if (!hal_init())
+		return 1;
+	random_init(1);
+	etimer_init();
+
+	_bench_pending(0);
+	_bench_pending(256);
+	_bench_pending(BENCH_MAX_TIMERS);
+
+	/* Expiration of timers which are due, including their events */
+	l_ops = bench_ops(100000);
+	bench_start(&st_bench, BENCH_SUITE, "fire_16", l_ops * BENCH_FIRE_TIMERS);
+	for (i = 0; i < l_ops; i++) {
+		for (j = 0; j < BENCH_FIRE_TIMERS; j++)
+			etimer_set(&gst_fire[j], 0, _bench_callback);
+		etimer_request_poll();
+		while (evproc_pending())
+			evproc_nextEvent();
+	}
+	bench_stop(&st_bench);
+
+	etimer_getStats(&st_stats);
+	bench_metric(BENCH_SUITE, "fired", st_stats.l_fired, "timer");
+	bench_metric(BENCH_SUITE, "saved_wakeups", st_stats.l_saved, "timer");
+
+	return (l_fired == l_ops * BENCH_FIRE_TIMERS) ? 0 : 1;
+}
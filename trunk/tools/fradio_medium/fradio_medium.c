@@ -0,0 +1,343 @@
+/*============================================================================*/
+/*! \file   fradio_medium.c
+
+    \brief  Shared radio medium simulator for the fake radio driver.
+
+            Any number of native emb6 processes built with
+            FRADIO_CONF_MEDIUM=1 attach to this process. A node sends its
+            frames to the medium, which delivers them to every node that has
+            a link from the transmitter in the topology file. Per link the
+            medium applies the packet loss, the RSSI and LQI reported to the
+            receiver and the propagation delay. A frame occupies the
+            receiver for its airtime, overlapping receptions collide and
+            are lost, and a node cannot receive while it transmits.
+
+            Build and run, it is also built with every target of the
+            native board:
+
+                gcc -O2 -I../../target/if/fake_radio -o fradio_medium \
+                    fradio_medium.c ../../target/if/fake_radio/fradio_topo.c
+                ./fradio_medium -t line.topo [-p port] [-s seed] [-v]
+
+            and start every node with FRADIO_NODE_ID=<id> in its environment.
+
+            The topology file and the link model are shared with the single
+            process simulation of the native target, see fradio_topo.h.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#define		_GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "fradio_medium.h"
+#include "fradio_topo.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Largest frame forwarded by the medium */
+#define MEDIUM_MAX_FRAME					256
+/** Maximum number of frames on the air at the same time */
+#define MEDIUM_MAX_PENDING					1024
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Node attached to the medium */
+typedef struct
+{
+	/** End of the current transmission of the node */
+	uint64_t						ll_txUntil;
+}st_node_t;
+
+/** Frame on the air towards one receiver */
+typedef struct
+{
+	uint8_t							c_used;
+	uint8_t							c_collided;
+	uint16_t						i_from;
+	uint16_t						i_to;
+	int8_t							c_rssi;
+	uint8_t							c_lqi;
+	uint64_t						ll_start;
+	uint64_t						ll_end;
+	uint16_t						i_len;
+	uint8_t							pc_data[MEDIUM_MAX_FRAME];
+}st_delivery_t;
+
+/** Statistics printed on exit */
+typedef struct
+{
+	uint32_t						l_tx;
+	uint32_t						l_rx;
+	uint32_t						l_lost;
+	uint32_t						l_collided;
+	uint32_t						l_overflow;
+}st_mediumStats_t;
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	st_node_t					gst_nodes[FRADIO_MEDIUM_MAX_NODES];
+static	st_delivery_t				gst_pending[MEDIUM_MAX_PENDING];
+static	st_mediumStats_t			gst_stats;
+/** Links between the nodes, node ids 1 .. FRADIO_MEDIUM_MAX_NODES - 1 */
+static	st_fradioTopo_t				gst_topo;
+static	int							i_sock = -1;
+static	uint16_t					i_port = FRADIO_MEDIUM_PORT;
+static	uint8_t						c_verbose = 0;
+static	volatile sig_atomic_t		c_stop = 0;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Monotonic time in microseconds */
+/*----------------------------------------------------------------------------*/
+static uint64_t _medium_now(void)
+{
+	struct	timespec	st_ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &st_ts);
+	return (uint64_t)st_ts.tv_sec * 1000000u + st_ts.tv_nsec / 1000u;
+} /* _medium_now() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Mark every frame on the air towards i_to which overlaps the
+ *          interval [ll_start, ll_end) as collided.
+ *
+ *  \return Number of overlapping frames
+ */
+/*----------------------------------------------------------------------------*/
+static int _medium_collide(uint16_t i_to, uint64_t ll_start, uint64_t ll_end)
+{
+	st_delivery_t *	pst_del;
+	int				i_num = 0;
+	int				i;
+
+	for (i = 0; i < MEDIUM_MAX_PENDING; i++) {
+		pst_del = &gst_pending[i];
+		if (pst_del->c_used && (pst_del->i_to == i_to) &&
+			(pst_del->ll_start < ll_end) && (ll_start < pst_del->ll_end)) {
+			pst_del->c_collided = 1;
+			i_num++;
+		}
+	}
+	return i_num;
+} /* _medium_collide() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Put a frame transmitted by i_from on the air
+ */
+/*----------------------------------------------------------------------------*/
+static void _medium_transmit(uint16_t i_from, const uint8_t * pc_data, uint16_t i_len)
+{
+	st_node_t *					pst_node = &gst_nodes[i_from];
+	const st_fradioLinks_t *	pst_links = fradio_topoLinks(&gst_topo, i_from);
+	const st_fradioLink_t *		pst_link;
+	st_delivery_t *				pst_del;
+	uint64_t					ll_now = _medium_now();
+	uint64_t					ll_air = fradio_topoAirtime(&gst_topo, i_len);
+	int							i_free = 0;
+	int							i;
+
+	gst_stats.l_tx++;
+	pst_node->ll_txUntil = ll_now + ll_air;
+	/* A transmitting node does not hear anything */
+	_medium_collide(i_from, ll_now, ll_now + ll_air);
+
+	for (i = 0; i < pst_links->i_numLinks; i++) {
+		pst_link = &pst_links->pst_links[i];
+		if (fradio_topoLost(&gst_topo, pst_link)) {
+			gst_stats.l_lost++;
+			continue;
+		}
+
+		while ((i_free < MEDIUM_MAX_PENDING) && gst_pending[i_free].c_used)
+			i_free++;
+		if (i_free == MEDIUM_MAX_PENDING) {
+			gst_stats.l_overflow++;
+			continue;
+		}
+
+		pst_del = &gst_pending[i_free];
+		pst_del->i_from = i_from;
+		pst_del->i_to = pst_link->i_to;
+		pst_del->c_rssi = pst_link->c_rssi;
+		pst_del->c_lqi = pst_link->c_lqi;
+		pst_del->ll_start = ll_now + pst_link->l_delay;
+		pst_del->ll_end = pst_del->ll_start + ll_air;
+		pst_del->i_len = i_len;
+		memcpy(pst_del->pc_data, pc_data, i_len);
+		pst_del->c_collided = 0;
+		if (_medium_collide(pst_del->i_to, pst_del->ll_start, pst_del->ll_end) ||
+			(pst_del->ll_start < gst_nodes[pst_del->i_to].ll_txUntil))
+			pst_del->c_collided = 1;
+		pst_del->c_used = 1;
+	}
+} /* _medium_transmit() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Hand every frame whose reception ended to its receiver
+ *
+ *  \return Time until the next reception ends in us, -1 if nothing is on
+ *          the air
+ */
+/*----------------------------------------------------------------------------*/
+static int64_t _medium_deliver(void)
+{
+	struct	sockaddr_in		st_addr;
+	st_fradioMediumHdr_t	st_hdr;
+	struct	iovec			pst_iov[2];
+	struct	msghdr			st_msg;
+	st_delivery_t *			pst_del;
+	uint64_t				ll_now = _medium_now();
+	int64_t					ll_next = -1;
+	int						i;
+
+	memset(&st_addr, 0, sizeof(st_addr));
+	st_addr.sin_family = AF_INET;
+	st_addr.sin_addr.s_addr = inet_addr(FRADIO_MEDIUM_IP);
+
+	for (i = 0; i < MEDIUM_MAX_PENDING; i++) {
+		pst_del = &gst_pending[i];
+		if (!pst_del->c_used)
+			continue;
+		if (pst_del->ll_end > ll_now) {
+			if ((ll_next < 0) || ((int64_t)(pst_del->ll_end - ll_now) < ll_next))
+				ll_next = pst_del->ll_end - ll_now;
+			continue;
+		}
+
+		pst_del->c_used = 0;
+		if (pst_del->c_collided) {
+			gst_stats.l_collided++;
+			continue;
+		}
+
+		st_hdr.i_node = htons(pst_del->i_from);
+		st_hdr.c_rssi = pst_del->c_rssi;
+		st_hdr.c_lqi = pst_del->c_lqi;
+		pst_iov[0].iov_base = &st_hdr;
+		pst_iov[0].iov_len = sizeof(st_hdr);
+		pst_iov[1].iov_base = pst_del->pc_data;
+		pst_iov[1].iov_len = pst_del->i_len;
+		st_addr.sin_port = htons(i_port + pst_del->i_to);
+		memset(&st_msg, 0, sizeof(st_msg));
+		st_msg.msg_name = &st_addr;
+		st_msg.msg_namelen = sizeof(st_addr);
+		st_msg.msg_iov = pst_iov;
+		st_msg.msg_iovlen = 2;
+		if (sendmsg(i_sock, &st_msg, MSG_DONTWAIT) >= 0)
+			gst_stats.l_rx++;
+		if (c_verbose)
+			printf("%u -> %u len %u rssi %d\n", pst_del->i_from, pst_del->i_to,
+					pst_del->i_len, pst_del->c_rssi);
+	}
+	return ll_next;
+} /* _medium_deliver() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Read all datagrams sent by the nodes */
+/*----------------------------------------------------------------------------*/
+static void _medium_receive(void)
+{
+	uint8_t					pc_buf[sizeof(st_fradioMediumHdr_t) + MEDIUM_MAX_FRAME];
+	st_fradioMediumHdr_t	st_hdr;
+	uint16_t				i_from;
+	ssize_t					l_len;
+
+	while ((l_len = recv(i_sock, pc_buf, sizeof(pc_buf), MSG_DONTWAIT)) > 0) {
+		if (l_len <= (ssize_t)sizeof(st_hdr))
+			continue;
+		memcpy(&st_hdr, pc_buf, sizeof(st_hdr));
+		i_from = ntohs(st_hdr.i_node);
+		if ((i_from == 0) || (i_from >= FRADIO_MEDIUM_MAX_NODES))
+			continue;
+		_medium_transmit(i_from, pc_buf + sizeof(st_hdr), l_len - sizeof(st_hdr));
+	}
+} /* _medium_receive() */
+
+/*----------------------------------------------------------------------------*/
+static void _medium_signal(int i_sig)
+{
+	c_stop = 1;
+} /* _medium_signal() */
+
+/*==============================================================================
+                                 MAIN FUNCTION
+==============================================================================*/
+int main(int argc, char ** argv)
+{
+	struct	sockaddr_in		st_addr;
+	struct	pollfd			st_pfd;
+	struct	timespec		st_timeout;
+	const char *			pc_topology = NULL;
+	uint32_t				l_seed = 1;
+	int64_t					ll_next;
+	int						i_opt;
+
+	while ((i_opt = getopt(argc, argv, "t:p:s:v")) != -1) {
+		switch (i_opt) {
+		case 't': pc_topology = optarg; break;
+		case 'p': i_port = atoi(optarg); break;
+		case 's': l_seed = strtoul(optarg, NULL, 0); break;
+		case 'v': c_verbose = 1; break;
+		default: pc_topology = NULL; optind = argc; break;
+		}
+	}
+	if (pc_topology == NULL) {
+		fprintf(stderr, "usage: %s -t topology [-p port] [-s seed] [-v]\n", argv[0]);
+		return 1;
+	}
+	if ((fradio_topoInit(&gst_topo, FRADIO_MEDIUM_MAX_NODES - 1, l_seed) != 0) ||
+		(fradio_topoLoad(&gst_topo, pc_topology) != 0))
+		return 1;
+
+	i_sock = socket(AF_INET, SOCK_DGRAM, 0);
+	memset(&st_addr, 0, sizeof(st_addr));
+	st_addr.sin_family = AF_INET;
+	st_addr.sin_addr.s_addr = inet_addr(FRADIO_MEDIUM_IP);
+	st_addr.sin_port = htons(i_port);
+	if ((i_sock < 0) || (bind(i_sock, (struct sockaddr *)&st_addr, sizeof(st_addr)) < 0)) {
+		fprintf(stderr, "cannot bind to port %u: %s\n", i_port, strerror(errno));
+		return 1;
+	}
+
+	signal(SIGINT, _medium_signal);
+	signal(SIGTERM, _medium_signal);
+	printf("medium listening on %s:%u, airtime %u us/byte\n",
+			FRADIO_MEDIUM_IP, i_port, gst_topo.l_airtime);
+
+	ll_next = -1;
+	while (!c_stop) {
+		st_pfd.fd = i_sock;
+		st_pfd.events = POLLIN;
+		st_timeout.tv_sec = ll_next / 1000000;
+		st_timeout.tv_nsec = (ll_next % 1000000) * 1000;
+		if (ppoll(&st_pfd, 1, (ll_next < 0) ? NULL : &st_timeout, NULL) > 0)
+			_medium_receive();
+		ll_next = _medium_deliver();
+	}
+
+	printf("tx %u rx %u lost %u collided %u overflow %u\n",
+			gst_stats.l_tx, gst_stats.l_rx, gst_stats.l_lost,
+			gst_stats.l_collided, gst_stats.l_overflow);
+	close(i_sock);
+	return 0;
+} /* main() */
@@ -0,0 +1,404 @@
+/*============================================================================*/
+/*! \file   log_decode.c
+
+    \brief  Decoder of the deferred log messages.
+
+            A program built with LOGGER_CONF_DEFERRED=1 writes its log
+            messages as lines of hex digits, see logger.h. The decoder
+            reads the console output of the program, turns these lines back
+            into text using the format strings from the program file and
+            copies every other line unchanged.
+
+            Build and run, it is also built with every target of the
+            native board:
+
+                gcc -O2 -I../../utils/inc -o log_decode log_decode.c
+                ./log_decode -e program.elf [console.log]
+
+            The console output is read from stdin if no file is given. The
+            program file has to be the one that wrote the messages, the
+            sizes of the arguments are taken from its type. Timestamps are
+            32 bit microseconds, they are unwrapped assuming at least one
+            message every 71 minutes.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "logger.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Longest console line */
+#define DECODE_MAX_LINE						1024
+/** Size of the header of a message */
+#define DECODE_HDR_SIZE						9
+/** Machine type of AVR in the ELF header */
+#define DECODE_EM_AVR						83
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Sizes of the types of the target in bytes */
+typedef struct
+{
+	uint8_t							c_int;
+	uint8_t							c_long;
+	uint8_t							c_ptr;
+	uint8_t							c_double;
+}st_types_t;
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+/** Contents of LOGGER_SECTION */
+static	char *						pc_dict = NULL;
+static	uint32_t					l_dictSize = 0;
+static	st_types_t					st_types;
+/** Unwrapped time of the last message in microseconds */
+static	uint64_t					ll_time = 0;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Read a little endian value of up to 8 bytes */
+/*----------------------------------------------------------------------------*/
+static uint64_t _decode_le(const uint8_t * pc_data, uint8_t c_size)
+{
+	uint64_t				ll_val = 0;
+
+	while (c_size-- > 0)
+		ll_val = (ll_val << 8) | pc_data[c_size];
+	return ll_val;
+} /* _decode_le() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Load LOGGER_SECTION and the sizes of the types from a little
+ *          endian ELF file
+ *
+ *  \return 0 if success, -1 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+static int _decode_loadElf(const char * pc_name)
+{
+	FILE *					pf_elf;
+	uint8_t *				pc_elf;
+	long					l_size;
+	uint8_t					c_64;
+	uint64_t				ll_shoff;
+	uint32_t				l_shentsize;
+	uint32_t				l_shnum;
+	uint32_t				l_shstrndx;
+	const uint8_t *			pc_sh;
+	const uint8_t *			pc_strtab;
+	uint64_t				ll_off;
+	uint64_t				ll_secSize;
+	uint32_t				i;
+
+	pf_elf = fopen(pc_name, "rb");
+	if (pf_elf == NULL) {
+		fprintf(stderr, "cannot open %s\n", pc_name);
+		return -1;
+	}
+	fseek(pf_elf, 0, SEEK_END);
+	l_size = ftell(pf_elf);
+	rewind(pf_elf);
+	pc_elf = malloc(l_size);
+	if ((pc_elf == NULL) || (fread(pc_elf, l_size, 1, pf_elf) != 1) ||
+		(l_size < 52) || (memcmp(pc_elf, "\177ELF", 4) != 0) || (pc_elf[5] != 1)) {
+		fprintf(stderr, "%s is not a little endian ELF file\n", pc_name);
+		fclose(pf_elf);
+		return -1;
+	}
+	fclose(pf_elf);
+
+	c_64 = (pc_elf[4] == 2);
+	if (c_64) {
+		ll_shoff = _decode_le(pc_elf + 0x28, 8);
+		l_shentsize = _decode_le(pc_elf + 0x3A, 2);
+		l_shnum = _decode_le(pc_elf + 0x3C, 2);
+		l_shstrndx = _decode_le(pc_elf + 0x3E, 2);
+	} else {
+		ll_shoff = _decode_le(pc_elf + 0x20, 4);
+		l_shentsize = _decode_le(pc_elf + 0x2E, 2);
+		l_shnum = _decode_le(pc_elf + 0x30, 2);
+		l_shstrndx = _decode_le(pc_elf + 0x32, 2);
+	}
+	if ((l_shstrndx >= l_shnum) ||
+		(ll_shoff + (uint64_t)l_shnum * l_shentsize > (uint64_t)l_size)) {
+		fprintf(stderr, "%s has no valid section table\n", pc_name);
+		return -1;
+	}
+
+	/* Offset of a section in the file and its size */
+#define DECODE_SEC_OFF(sh)	(c_64 ? _decode_le((sh) + 0x18, 8) : _decode_le((sh) + 0x10, 4))
+#define DECODE_SEC_SIZE(sh)	(c_64 ? _decode_le((sh) + 0x20, 8) : _decode_le((sh) + 0x14, 4))
+	pc_strtab = pc_elf + DECODE_SEC_OFF(pc_elf + ll_shoff + l_shstrndx * l_shentsize);
+	for (i = 0; i < l_shnum; i++) {
+		pc_sh = pc_elf + ll_shoff + i * l_shentsize;
+		if (strcmp((const char *)pc_strtab + _decode_le(pc_sh, 4), LOGGER_SECTION) != 0)
+			continue;
+		ll_off = DECODE_SEC_OFF(pc_sh);
+		ll_secSize = DECODE_SEC_SIZE(pc_sh);
+		if (ll_off + ll_secSize > (uint64_t)l_size)
+			break;
+		/* The zero at the end stops a broken offset */
+		pc_dict = calloc(1, ll_secSize + 1);
+		if (pc_dict == NULL)
+			break;
+		memcpy(pc_dict, pc_elf + ll_off, ll_secSize);
+		l_dictSize = ll_secSize;
+	}
+	if (pc_dict == NULL) {
+		fprintf(stderr, "%s has no section %s, was it built with "
+				"LOGGER_CONF_DEFERRED=1?\n", pc_name, LOGGER_SECTION);
+		return -1;
+	}
+
+	st_types.c_int = 4;
+	st_types.c_long = c_64 ? 8 : 4;
+	st_types.c_ptr = c_64 ? 8 : 4;
+	st_types.c_double = 8;
+	if (_decode_le(pc_elf + 0x12, 2) == DECODE_EM_AVR) {
+		st_types.c_int = 2;
+		st_types.c_ptr = 2;
+		st_types.c_double = 4;
+	}
+	free(pc_elf);
+	return 0;
+} /* _decode_loadElf() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Take an argument from a message
+ *
+ *  \return Pointer to the argument, NULL if the message is too short
+ */
+/*----------------------------------------------------------------------------*/
+static const uint8_t * _decode_take(const uint8_t ** ppc_arg,
+		const uint8_t * pc_end, uint8_t c_size)
+{
+	const uint8_t *			pc_arg = *ppc_arg;
+
+	if (pc_arg + c_size > pc_end)
+		return NULL;
+	*ppc_arg += c_size;
+	return pc_arg;
+} /* _decode_take() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Print a message */
+/*----------------------------------------------------------------------------*/
+static void _decode_message(const uint8_t * pc_rec, uint8_t c_len)
+{
+	const uint8_t *			pc_end = pc_rec + c_len;
+	const uint8_t *			pc_arg = pc_rec + DECODE_HDR_SIZE;
+	const uint8_t *			pc_val;
+	const char *			pc;
+	const char *			pc_spec;
+	char					pc_conv[32];
+	char *					pc_out;
+	uint32_t				l_time;
+	uint32_t				l_fmt;
+	uint8_t					c_size;
+	uint64_t				ll_val;
+	char					c_lenMod;
+	float					f_val;
+	double					d_val;
+
+	l_time = _decode_le(pc_rec + 1, 4);
+	l_fmt = _decode_le(pc_rec + 5, 4);
+	ll_time += (uint32_t)(l_time - (uint32_t)ll_time);
+	if (l_fmt >= l_dictSize) {
+		printf("<unknown message %u>\n", l_fmt);
+		return;
+	}
+
+	printf("%lu.%06lu", (unsigned long)(ll_time / 1000000u),
+			(unsigned long)(ll_time % 1000000u));
+	for (pc = pc_dict + l_fmt; *pc != '\0'; pc++) {
+		if ((*pc != '%') || (pc[1] == '%')) {
+			if (*pc == '%')
+				pc++;
+			putchar(*pc);
+			continue;
+		}
+
+		/* Rebuild the conversion for the host, with the sizes of the
+		 * target replaced by the largest type */
+		pc_spec = pc;
+		pc_out = pc_conv;
+		*pc_out++ = *pc++;
+		while ((*pc != '\0') && (strchr("-+ #0123456789.*", *pc) != NULL)) {
+			if (*pc == '*') {
+				if ((pc_val = _decode_take(&pc_arg, pc_end, st_types.c_int)) == NULL)
+					goto truncated;
+				ll_val = _decode_le(pc_val, st_types.c_int);
+				pc_out += snprintf(pc_out, 8, "%d", (st_types.c_int == 2) ?
+						(int)(int16_t)ll_val : (int)(int32_t)ll_val);
+			} else if (pc_out < pc_conv + sizeof(pc_conv) - 8) {
+				*pc_out++ = *pc;
+			}
+			pc++;
+		}
+		c_lenMod = 0;
+		/* "ll" becomes 'q' and "hh" becomes 'H' */
+		while ((*pc != '\0') && (strchr("hlLjzt", *pc) != NULL)) {
+			c_lenMod = (c_lenMod != *pc) ? *pc : ((*pc == 'l') ? 'q' : 'H');
+			pc++;
+		}
+		if (*pc == '\0')
+			break;
+
+		switch (*pc) {
+		case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+			if (c_lenMod == 'l')
+				c_size = st_types.c_long;
+			else if ((c_lenMod == 'q') || (c_lenMod == 'j'))
+				c_size = 8;
+			else if ((c_lenMod == 'z') || (c_lenMod == 't'))
+				c_size = st_types.c_ptr;
+			else
+				c_size = st_types.c_int;
+			if ((pc_val = _decode_take(&pc_arg, pc_end, c_size)) == NULL)
+				goto truncated;
+			ll_val = _decode_le(pc_val, c_size);
+			/* The value was promoted, cut it back to its own size */
+			if (c_lenMod == 'h')
+				c_size = 2;
+			else if (c_lenMod == 'H')
+				c_size = 1;
+			if (c_size < 8) {
+				ll_val &= (1ULL << (8 * c_size)) - 1;
+				if (((*pc == 'd') || (*pc == 'i')) && (ll_val >> (8 * c_size - 1)))
+					ll_val |= ~((1ULL << (8 * c_size)) - 1);
+			}
+			if (*pc == 'c') {
+				*pc_out++ = 'c';
+				*pc_out = '\0';
+				printf(pc_conv, (int)ll_val);
+			} else {
+				*pc_out++ = 'l';
+				*pc_out++ = 'l';
+				*pc_out++ = *pc;
+				*pc_out = '\0';
+				printf(pc_conv, (long long)ll_val);
+			}
+			break;
+		case 'p':
+			if ((pc_val = _decode_take(&pc_arg, pc_end, st_types.c_ptr)) == NULL)
+				goto truncated;
+			printf("0x%llx", (unsigned long long)_decode_le(pc_val, st_types.c_ptr));
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			if ((pc_val = _decode_take(&pc_arg, pc_end, st_types.c_double)) == NULL)
+				goto truncated;
+			if (st_types.c_double == 4) {
+				memcpy(&f_val, pc_val, 4);
+				d_val = f_val;
+			} else {
+				memcpy(&d_val, pc_val, 8);
+			}
+			*pc_out++ = *pc;
+			*pc_out = '\0';
+			printf(pc_conv, d_val);
+			break;
+		case 's':
+			pc_val = memchr(pc_arg, '\0', pc_end - pc_arg);
+			if (pc_val == NULL)
+				goto truncated;
+			*pc_out++ = 's';
+			*pc_out = '\0';
+			printf(pc_conv, (const char *)pc_arg);
+			pc_arg = pc_val + 1;
+			break;
+		case 'n':
+			break;
+		default:
+			/* Unknown conversion, print it as it is */
+			fwrite(pc_spec, 1, pc - pc_spec + 1, stdout);
+			break;
+		}
+	}
+	return;
+
+truncated:
+	printf("<cut>\n");
+} /* _decode_message() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Decode a line of hex digits
+ *
+ *  \return 0 if success, -1 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+static int _decode_line(const char * pc_hex)
+{
+	uint8_t					pc_rec[256];
+	unsigned int			i_byte;
+	int						i_len = 0;
+
+	while ((i_len < (int)sizeof(pc_rec)) && (sscanf(pc_hex, "%2x", &i_byte) == 1)) {
+		pc_rec[i_len++] = i_byte;
+		pc_hex += 2;
+	}
+	if ((i_len < DECODE_HDR_SIZE) || (pc_rec[0] != i_len))
+		return -1;
+	_decode_message(pc_rec, i_len);
+	return 0;
+} /* _decode_line() */
+
+/*==============================================================================
+                                 MAIN FUNCTION
+==============================================================================*/
+int main(int argc, char ** argv)
+{
+	char					pc_line[DECODE_MAX_LINE];
+	const char *			pc_elf = NULL;
+	FILE *					pf_in = stdin;
+	char *					pc_msg;
+	int						i_opt;
+
+	while ((i_opt = getopt(argc, argv, "e:")) != -1) {
+		switch (i_opt) {
+		case 'e': pc_elf = optarg; break;
+		default: pc_elf = NULL; optind = argc; break;
+		}
+	}
+	if ((pc_elf == NULL) || (argc - optind > 1)) {
+		fprintf(stderr, "usage: %s -e program.elf [console.log]\n", argv[0]);
+		return 1;
+	}
+	if (_decode_loadElf(pc_elf) != 0)
+		return 1;
+	if ((optind < argc) && ((pf_in = fopen(argv[optind], "r")) == NULL)) {
+		fprintf(stderr, "cannot open %s\n", argv[optind]);
+		return 1;
+	}
+
+	while (fgets(pc_line, sizeof(pc_line), pf_in) != NULL) {
+		/* The messages may follow other output on the same line */
+		if ((pc_msg = strstr(pc_line, LOGGER_LINE_PREFIX)) != NULL) {
+			fwrite(pc_line, 1, pc_msg - pc_line, stdout);
+			if (_decode_line(pc_msg + strlen(LOGGER_LINE_PREFIX)) != 0)
+				printf("<broken message>\n");
+		} else if ((pc_msg = strstr(pc_line, LOGGER_LOST_PREFIX)) != NULL) {
+			printf("<%s messages lost so far>\n",
+					strtok(pc_msg + strlen(LOGGER_LOST_PREFIX), "\r\n"));
+		} else {
+			fputs(pc_line, stdout);
+		}
+	}
+	if (pf_in != stdin)
+		fclose(pf_in);
+	return 0;
+} /* main() */
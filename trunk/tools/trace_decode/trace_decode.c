@@ -0,0 +1,257 @@
+/*============================================================================*/
+/*! \file   trace_decode.c
+
+    \brief  Decoder of the packet trace files written by the native target.
+
+            A node built with TRACE_CONF_ENABLE=1 and started with
+            EMB6_TRACE_FILE=<file> in its environment writes a record every
+            time a packet passes a layer of the netstack. The decoder
+            follows every packet through the layers and prints for every
+            pair of consecutive layers the number of packets, the minimum,
+            average and maximum latency and a log2 histogram of the
+            latencies, followed by the time a packet spent in the node.
+
+            Build and run, it is also built with every target of the
+            native board:
+
+                gcc -O2 -I../../utils/inc -o trace_decode trace_decode.c
+                ./trace_decode [-w window ms] trace-file...
+
+            Packet ids are only unique within a file and for a limited time.
+            A record more than the window after the previous record of the
+            same id starts a new packet.
+
+   \version 0.0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "trace.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Size of a record in the file */
+#define DECODE_REC_SIZE						8
+/** Number of histogram buckets, the last one takes everything above */
+#define DECODE_BUCKETS						24
+/** Default window of a packet in milliseconds */
+#define DECODE_DEF_WINDOW					1000
+/** Number of packet ids */
+#define DECODE_IDS							65536
+/** Points of a packet journey, a layer in a direction */
+#define DECODE_POINTS						(E_TRACE_LAYERS * 2)
+/** Index of the statistics of the time spent in the node */
+#define DECODE_TOTAL						(DECODE_POINTS * DECODE_POINTS)
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Last record of a packet id */
+typedef struct
+{
+	uint8_t							c_valid;
+	uint8_t							c_point;
+	uint32_t						l_first;
+	uint32_t						l_last;
+}st_packet_t;
+
+/** Latencies of a transition */
+typedef struct
+{
+	uint32_t						l_count;
+	uint32_t						l_min;
+	uint32_t						l_max;
+	uint64_t						ll_sum;
+	uint32_t						pl_hist[DECODE_BUCKETS];
+}st_latency_t;
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static	st_packet_t					gst_packets[DECODE_IDS];
+static	st_latency_t				gst_lat[DECODE_TOTAL + 1];
+static	uint32_t					l_window = DECODE_DEF_WINDOW * 1000u;
+static	uint32_t					l_records = 0;
+static	uint32_t					l_packets = 0;
+
+/*==============================================================================
+                                LOCAL CONSTANTS
+==============================================================================*/
+static	const char *				gpc_layer[E_TRACE_LAYERS] = {
+		"radio", "lmac", "hmac", "llsec", "hc", "tcpip", "uip", "app"
+};
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  Add a latency to the statistics of a transition */
+/*----------------------------------------------------------------------------*/
+static void _decode_add(st_latency_t * pst_lat, uint32_t l_us)
+{
+	int						i_bucket = 0;
+
+	while ((i_bucket < DECODE_BUCKETS - 1) && (l_us >> (i_bucket + 1)))
+		i_bucket++;
+	if ((pst_lat->l_count == 0) || (l_us < pst_lat->l_min))
+		pst_lat->l_min = l_us;
+	if (l_us > pst_lat->l_max)
+		pst_lat->l_max = l_us;
+	pst_lat->l_count++;
+	pst_lat->ll_sum += l_us;
+	pst_lat->pl_hist[i_bucket]++;
+} /* _decode_add() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Close a packet and account the time it spent in the node */
+/*----------------------------------------------------------------------------*/
+static void _decode_close(st_packet_t * pst_pkt)
+{
+	if (pst_pkt->c_valid) {
+		_decode_add(&gst_lat[DECODE_TOTAL], pst_pkt->l_last - pst_pkt->l_first);
+		l_packets++;
+	}
+	pst_pkt->c_valid = 0;
+} /* _decode_close() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Read a trace file
+ *
+ *  \return 0 if success, -1 otherwise
+ */
+/*----------------------------------------------------------------------------*/
+static int _decode_file(const char * pc_name)
+{
+	FILE *					pf_in;
+	uint8_t					pc_rec[DECODE_REC_SIZE];
+	st_packet_t *			pst_pkt;
+	uint32_t				l_time;
+	uint16_t				i_id;
+	uint8_t					c_point;
+	int32_t					l_delta;
+	uint32_t				i;
+
+	pf_in = fopen(pc_name, "rb");
+	if (pf_in == NULL) {
+		fprintf(stderr, "cannot open %s\n", pc_name);
+		return -1;
+	}
+	if ((fread(pc_rec, 8, 1, pf_in) != 1) ||
+		(memcmp(pc_rec, TRACE_FILE_MAGIC, 4) != 0) ||
+		((pc_rec[4] | (pc_rec[5] << 8)) != TRACE_FILE_VERSION) ||
+		((pc_rec[6] | (pc_rec[7] << 8)) != DECODE_REC_SIZE)) {
+		fprintf(stderr, "%s is not a trace file of version %u\n", pc_name,
+				TRACE_FILE_VERSION);
+		fclose(pf_in);
+		return -1;
+	}
+
+	/* Packet ids are allocated per node */
+	memset(gst_packets, 0, sizeof(gst_packets));
+	while (fread(pc_rec, DECODE_REC_SIZE, 1, pf_in) == 1) {
+		l_time = pc_rec[0] | (pc_rec[1] << 8) | (pc_rec[2] << 16) |
+				((uint32_t)pc_rec[3] << 24);
+		i_id = pc_rec[4] | (pc_rec[5] << 8);
+		if ((pc_rec[6] >= E_TRACE_LAYERS) || (pc_rec[7] > E_TRACE_TX))
+			continue;
+		c_point = pc_rec[6] * 2 + pc_rec[7];
+		l_records++;
+
+		pst_pkt = &gst_packets[i_id];
+		/* Records of interrupt handlers may be a little out of order */
+		l_delta = (int32_t)(l_time - pst_pkt->l_last);
+		if (pst_pkt->c_valid && (l_delta > (int32_t)l_window))
+			_decode_close(pst_pkt);
+		if (!pst_pkt->c_valid) {
+			pst_pkt->c_valid = 1;
+			pst_pkt->l_first = l_time;
+		} else {
+			_decode_add(&gst_lat[pst_pkt->c_point * DECODE_POINTS + c_point],
+					l_delta > 0 ? (uint32_t)l_delta : 0);
+		}
+		pst_pkt->c_point = c_point;
+		pst_pkt->l_last = l_time;
+	}
+	for (i = 0; i < DECODE_IDS; i++)
+		_decode_close(&gst_packets[i]);
+	fclose(pf_in);
+	return 0;
+} /* _decode_file() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Print the statistics and the histogram of a transition */
+/*----------------------------------------------------------------------------*/
+static void _decode_print(const char * pc_title, const st_latency_t * pst_lat)
+{
+	uint32_t				l_peak = 0;
+	int						i;
+	int						j;
+
+	printf("%-24s %8u %10u %10u %10u\n", pc_title, pst_lat->l_count,
+			pst_lat->l_min, (uint32_t)(pst_lat->ll_sum / pst_lat->l_count),
+			pst_lat->l_max);
+	for (i = 0; i < DECODE_BUCKETS; i++)
+		if (pst_lat->pl_hist[i] > l_peak)
+			l_peak = pst_lat->pl_hist[i];
+	for (i = 0; i < DECODE_BUCKETS; i++) {
+		if (pst_lat->pl_hist[i] == 0)
+			continue;
+		if (i == DECODE_BUCKETS - 1)
+			printf("    >= %8u us %8u ", 1u << i, pst_lat->pl_hist[i]);
+		else
+			printf("    < %9u us %8u ", 2u << i, pst_lat->pl_hist[i]);
+		for (j = 0; j < (int)((uint64_t)pst_lat->pl_hist[i] * 40 / l_peak); j++)
+			putchar('#');
+		putchar('\n');
+	}
+} /* _decode_print() */
+
+/*==============================================================================
+                                 MAIN FUNCTION
+==============================================================================*/
+int main(int argc, char ** argv)
+{
+	char					pc_title[64];
+	int						i_from;
+	int						i_to;
+	int						i_opt;
+
+	while ((i_opt = getopt(argc, argv, "w:")) != -1) {
+		switch (i_opt) {
+		case 'w': l_window = strtoul(optarg, NULL, 0) * 1000u; break;
+		default: optind = argc + 1; break;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "usage: %s [-w window ms] trace-file...\n", argv[0]);
+		return 1;
+	}
+	for (; optind < argc; optind++)
+		if (_decode_file(argv[optind]) != 0)
+			return 1;
+
+	printf("%u records, %u packets\n\n", l_records, l_packets);
+	printf("%-24s %8s %10s %10s %10s\n", "transition", "count",
+			"min us", "avg us", "max us");
+	for (i_from = 0; i_from < DECODE_POINTS; i_from++) {
+		for (i_to = 0; i_to < DECODE_POINTS; i_to++) {
+			if (gst_lat[i_from * DECODE_POINTS + i_to].l_count == 0)
+				continue;
+			snprintf(pc_title, sizeof(pc_title), "%s %s -> %s %s",
+					gpc_layer[i_from / 2], (i_from & 1) ? "tx" : "rx",
+					gpc_layer[i_to / 2], (i_to & 1) ? "tx" : "rx");
+			_decode_print(pc_title, &gst_lat[i_from * DECODE_POINTS + i_to]);
+		}
+	}
+	if (gst_lat[DECODE_TOTAL].l_count != 0)
+		_decode_print("in the node", &gst_lat[DECODE_TOTAL]);
+	return 0;
+} /* main() */
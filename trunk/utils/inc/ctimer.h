@@ -74,7 +74,7 @@
                         STRUCTURES AND OTHER TYPEDEFS
  =============================================================================*/
 struct ctimer {
-  struct 	ctimer 		*next;
+  struct 	ctimer 		*next; /**< Only used for timers set before ctimer_init() */
   struct 	etimer 		etimer;
 		  	void 			(*f)(void *);
 		  	void 			*ptr;
@@ -132,6 +132,17 @@ void ctimer_restart(struct ctimer *c);
 void ctimer_set(struct ctimer *c, clock_time_t t,
 		void (*f)(void *), void *ptr);
 
+/**
+ * \brief      Set the tolerated delay of a callback timer.
+ * \param c    A pointer to the callback timer.
+ * \param slack The time in ticks the expiration may be delayed.
+ *
+ *             ctimer_set() clears the slack, so it has to be set afterwards.
+ *
+ * \sa etimer_set_slack()
+ */
+void ctimer_set_slack(struct ctimer *c, clock_time_t slack);
+
 /**
  * \brief      Stop a pending callback timer.
  * \param c    A pointer to the pending callback timer.
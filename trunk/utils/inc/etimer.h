@@ -78,16 +78,56 @@
 
 #define TMR_ACTIVE				1
 #define TMR_NOT_ACTIVE			0
+#define TMR_FIRED				2	///< Expired, expiration event not handled yet
+
+/// Amount of slot bits per timing wheel level, at most 5 (32 slots)
+#ifdef ETIMER_CONF_WHEEL_BITS
+#define ETIMER_WHEEL_BITS		ETIMER_CONF_WHEEL_BITS
+#else
+#define ETIMER_WHEEL_BITS		5
+#endif
+
+/// Amount of timing wheel levels, the wheel covers 2^(BITS*LEVELS) ticks
+#ifdef ETIMER_CONF_WHEEL_LEVELS
+#define ETIMER_WHEEL_LEVELS		ETIMER_CONF_WHEEL_LEVELS
+#else
+#define ETIMER_WHEEL_LEVELS		4
+#endif
+
+#if (ETIMER_WHEEL_BITS < 1) || (ETIMER_WHEEL_BITS > 5)
+#error "ETIMER_WHEEL_BITS must be within 1..5"
+#endif
+#if (ETIMER_WHEEL_LEVELS < 1) || (ETIMER_WHEEL_BITS * ETIMER_WHEEL_LEVELS > 30)
+#error "ETIMER_WHEEL_LEVELS out of range"
+#endif
 
 /*=============================================================================
                         STRUCTURES AND OTHER TYPEDEFS
  =============================================================================*/
 struct etimer {
-	struct 	etimer 	*next; /**<  Pointer to the next etimer structure in list */
+	struct 	etimer 	*next; /**<  Pointer to the next etimer structure in the wheel slot */
+	struct 	etimer 	**pprev; /**<  Pointer to the link referencing this etimer, NULL if not linked */
 	struct 	timer 	timer; /**<  Structure to store start timestamp and interval.*/
+	pfn_callback_t	pfn_callback; /**<  Function to be called when the etimer expires */
+	uint16_t	slack; /**<  Tolerated delay of the expiration in ticks */
 	uint8_t	active;/**<  Flag indicating either etimer has expired or not*/
+	uint8_t	list; /**<  Index of the wheel slot or due list the etimer was linked to */
 };
 
+/** Statistics of the event timer library */
+typedef struct
+{
+	/** Expired timers */
+	uint32_t	l_fired;
+	/** Polls which delivered at least one expired timer */
+	uint32_t	l_batches;
+	/** Expirations handled together with another one in the same poll,
+	 *  i.e. wake-ups saved. Equals l_fired - l_batches */
+	uint32_t	l_saved;
+	/** Expirations postponed by their slack to join a common boundary */
+	uint32_t	l_deferred;
+} st_etimerStats_t;
+
 
 /**
  * \brief      Set an event timer.
@@ -97,8 +137,8 @@ struct etimer {
  *
  *             This function is used to set an event timer for a time
  *             sometime in the future. When the event timer expires,
- *             the event PROCESS_EVENT_TIMER will be posted to the
- *             process that called the etimer_set() function.
+ *             the event EVENT_TYPE_TIMER_EXP will be delivered to the
+ *             given callback function only.
  *
  */
 void etimer_set(struct etimer *et, clock_time_t interval, pfn_callback_t callback);
@@ -188,6 +228,28 @@ clock_time_t etimer_start_time(struct etimer *et);
  */
 CCIF int etimer_expired(struct etimer *et);
 
+/**
+ * \brief      Set the tolerated delay of an event timer.
+ * \param et   A pointer to the event timer.
+ * \param slack The time in ticks the expiration may be delayed, values
+ *             beyond 0xFFFF are limited.
+ *
+ *             An event timer with slack expires at the coarsest power of
+ *             two boundary between its expiration time and the expiration
+ *             time plus the slack. Timers with overlapping tolerance
+ *             windows therefore expire at the same tick and are handled
+ *             with a single wake-up. etimer_set() clears the slack, so it
+ *             has to be set afterwards. etimer_reset() and etimer_restart()
+ *             keep it, a pending timer is rescheduled immediately.
+ */
+void etimer_set_slack(struct etimer *et, clock_time_t slack);
+
+/**
+ * \brief      Get the statistics of the event timer library.
+ * \param pst_stats Pointer to the structure to fill.
+ */
+void etimer_getStats(st_etimerStats_t *pst_stats);
+
 /**
  * \brief      Stop a pending event timer.
  * \param et   A pointer to the pending event timer.
@@ -243,7 +305,10 @@ int etimer_pending(void);
  *	       returns 0.
  *
  *             This functions returns next expiration time of all
- *             pending event timers.
+ *             pending event timers. Timers further away than one
+ *             rotation of a timing wheel level are reported at the
+ *             time they are moved to a lower level, so the value may be
+ *             earlier than the actual expiration.
  */
 clock_time_t etimer_next_expiration_time(void);
 
@@ -71,16 +71,8 @@
 /*=============================================================================
                                  MACROS
  =============================================================================*/
-/// Defines all of the event that functions can operate
-#define EVENT_TYPES		{	EVENT_TYPE_TIMER_EXP, \
-							EVENT_TYPE_TCP_POLL, \
-							EVENT_TYPE_UDP_POLL, \
-							EVENT_TYPE_PCK_INPUT, \
-							EVENT_TYPE_ICMP6, \
-							EVENT_TYPE_TCPIP, \
-							EVENT_TYPE_SLIP_POLL, \
-							EVENT_TYPE_PCK_LL }
-
+/// Event types are numbered consecutively starting with 1, so that an event
+/// type can be used directly as an index in the registration table
 #define EVENT_TYPE_NONE			0x00	///< No event
 #define EVENT_TYPE_TIMER_EXP	0x01	///< Timer expired event
 #define EVENT_TYPE_TCP_POLL		0x02	///< TCP poll event
@@ -89,13 +81,42 @@
 #define EVENT_TYPE_ICMP6		0x05	///< New icmp6 packet event
 #define EVENT_TYPE_TCPIP		0x06	///< New tcpip event
 #define EVENT_TYPE_SLIP_POLL	0x07	///< Process slip handler
-#define OBLIG_EVENT_PRIOR		0x0a
-#define EVENT_TYPE_PCK_LL		0x0a	///< New low level packet received
+#define EVENT_TYPE_PCK_LL		0x08	///< New low level packet received
+#define EVENT_TYPE_TUN_POLL		0x09	///< Process packets of the host tun interface
 
 
-#define EVENT_TYPES_COUNT		8 		///< Counter of events in /ref EVENT_TYPES macro
+#define EVENT_TYPES_COUNT		9 		///< Counter of defined event types
 #define MAX_CALLBACK_COUNT		7		///< Maximal amount of callbacks in /ref st_funcRegList_t list
-#define EVPROC_QUEUE_SIZE		20		///< Maximal amount of events in /ref pst_evList queue
+
+/// Maximal amount of events per priority class, must be a power of two
+#ifdef EVPROC_CONF_QUEUE_SIZE
+#define EVPROC_QUEUE_SIZE		EVPROC_CONF_QUEUE_SIZE
+#else
+#define EVPROC_QUEUE_SIZE		16
+#endif
+
+/// Amount of buckets of the duplicate filter, must be a power of two. It
+/// grows with the queues, so a full queue rarely needs a scan on insert.
+#ifdef EVPROC_CONF_DUPFILTER_SIZE
+#define EVPROC_DUPFILTER_SIZE	EVPROC_CONF_DUPFILTER_SIZE
+#else
+#define EVPROC_DUPFILTER_SIZE	(2 * EVPROC_QUEUE_SIZE)
+#endif
+
+#if (EVPROC_QUEUE_SIZE & (EVPROC_QUEUE_SIZE - 1)) || (EVPROC_QUEUE_SIZE > 0x8000)
+#error "EVPROC_QUEUE_SIZE must be a power of two"
+#endif
+#if (EVPROC_DUPFILTER_SIZE & (EVPROC_DUPFILTER_SIZE - 1))
+#error "EVPROC_DUPFILTER_SIZE must be a power of two"
+#endif
+
+/// Index of a given event type in the registration table
+#define EVPROC_EVENT_IDX(ev)	((ev) - 1)
+
+/// Priority class of a given event type, see \ref en_evprocPrio_t
+#define EVPROC_EVENT_PRIO(ev)	(((ev) == EVENT_TYPE_PCK_LL) ? E_EVPROC_PRIO_RADIO : \
+								(((ev) == EVENT_TYPE_TIMER_EXP) ? E_EVPROC_PRIO_TIMER : \
+								E_EVPROC_PRIO_APP))
 /*=============================================================================
                                  ENUMS
  =============================================================================*/
@@ -121,6 +142,19 @@ typedef enum {
 	E_EVPROC_EXEC			///< Call all subscribed functions immediately
 }en_evprocAction_t;
 
+/*!
+ * \brief Priority classes of the events queue, highest priority first.
+ *
+ * Every class has its own queue. Events of a class are dispatched only
+ * when all classes with a higher priority are empty.
+ * */
+typedef enum {
+	E_EVPROC_PRIO_RADIO,	///< Received low level packets, never filtered
+	E_EVPROC_PRIO_TIMER,	///< Expired timers
+	E_EVPROC_PRIO_APP,		///< Stack and application events
+	E_EVPROC_PRIO_COUNT		///< Amount of priority classes
+}en_evprocPrio_t;
+
 /*=============================================================================
                         STRUCTURES AND OTHER TYPEDEFS
  =============================================================================*/
@@ -221,8 +255,11 @@ en_evprocResCode_t evproc_unregCallback(	c_event_t 		c_evenType, \
 /*!
 \brief   Process input event in accordance with an action type.
 
-		 The event process route works with FIFO buffer with an ability to add
-		 new elements not only in a head, but also in a tail of a queue.
+		 The event process route works with a FIFO ring buffer per priority
+		 class (see \ref en_evprocPrio_t) with an ability to add new elements
+		 not only in a head, but also in a tail of a queue. Both operations
+		 take constant time. Events which are not of the radio class and are
+		 already queued with the same data are silently dropped.
 
 \param  e_actType			Action type - what should be done with this event.
 							See \ref en_evprocAction_t
@@ -239,12 +276,39 @@ en_evprocResCode_t evproc_putEvent(	en_evprocAction_t 	e_actType, \
 										c_event_t 			c_eventType, \
 										p_data_t 			p_data);
 
+/*============================================================================*/
+/*!
+\brief   Process input event addressed to a single callback function.
+
+		 Works the same way as \ref evproc_putEvent, but when the event is
+		 dispatched only the given destination function is called instead
+		 of every callback registered for this type of an event. The
+		 destination function doesn't need to be registered.
+
+\param  e_actType			Action type - what should be done with this event.
+							See \ref en_evprocAction_t
+\param  c_eventType			Type of an event.
+\param	p_data				Pointer on the data linked with the event.
+\param	pfn_dest			Function to be called. If NULL the event is
+							delivered to all registered callbacks.
+
+\return	\ref E_END_OF_LIST		End of a queue has been reached.
+\return	\ref E_UNKNOWN_TYPE		Unknown type of an action.
+\return \ref E_SUCCESS			Event was executed or added to the queue.
+*/
+/*============================================================================*/
+en_evprocResCode_t evproc_putEventTo(	en_evprocAction_t 	e_actType, \
+										c_event_t 			c_eventType, \
+										p_data_t 			p_data, \
+										pfn_callback_t		pfn_dest);
+
 /*============================================================================*/
 /*!
 \brief   Take next event from the queue compare with a registration list and
 		call all of subscribers.
 
-		 This function takes event only from the head of a queue
+		 This function takes event only from the head of the non-empty queue
+		 with the highest priority.
 
 \return	\ref E_QUEUE_EMPTY		No events in the queue.
 \return	\ref E_UNKNOWN_TYPE		Input type of an event was not found in the
@@ -254,6 +318,15 @@ en_evprocResCode_t evproc_putEvent(	en_evprocAction_t 	e_actType, \
 /*============================================================================*/
 en_evprocResCode_t evproc_nextEvent(void);
 
+/*============================================================================*/
+/*!
+\brief   Check if there are any events in the queues.
+
+\return	1 if at least one event is queued, 0 otherwise.
+*/
+/*============================================================================*/
+uint8_t evproc_pending(void);
+
 
 
 #endif /* EVPROC_H_ */
@@ -39,24 +39,92 @@
  */
 /**
  * \file
- *         A brief description the file
+ *         Logging macros. By default the messages are printed immediately.
+ *
+ *         With LOGGER_CONF_DEFERRED=1 a message is only stored as the id of
+ *         its format string, a timestamp and the raw arguments in a ring,
+ *         see logger.c. The format strings are kept in the LOGGER_SECTION
+ *         section of the program and are never read at run time except
+ *         to find the types of the arguments. The stack writes the
+ *         pending messages in the main loop when it is idle as lines of
+ *         hex digits starting with LOGGER_LINE_PREFIX, which
+ *         tools/log_decode turns back into text using the program file.
+ *         LOG_RAW() still prints immediately.
  */
 #ifndef LOGGER_H_
 #define LOGGER_H_
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #ifndef LOGGER_SUBSYSTEM
 	#define LOGGER_SUBSYSTEM "unknown"
 #endif
 
+#ifdef LOGGER_CONF_DEFERRED
+#define LOGGER_DEFERRED			LOGGER_CONF_DEFERRED
+#else
+#define LOGGER_DEFERRED			0
+#endif
+
+/** Size of the ring of deferred messages in bytes, a power of two */
+#ifdef LOGGER_CONF_RING_SIZE
+#define LOGGER_RING_SIZE		LOGGER_CONF_RING_SIZE
+#else
+#define LOGGER_RING_SIZE		512
+#endif
+
+/** Largest deferred message in bytes, longer strings are cut */
+#define LOGGER_MAX_RECORD		64
+
+/** Deferred messages written per call of logger_flush() from the main loop */
+#define LOGGER_FLUSH_RECORDS	4
+
+/** Section of the format strings of deferred messages */
+#define LOGGER_SECTION			"emb6_logstr"
+
+/** Start of the output lines of deferred messages */
+#define LOGGER_LINE_PREFIX		"#L:"
+/** Start of the output line with the number of lost messages */
+#define LOGGER_LOST_PREFIX		"#L!"
+
+#if LOGGER_DEFERRED
+#define LOGGER_PUT(tag, msg, ...)	do { if (LOGGER_ENABLE) { \
+		static const char pc_logFmt[] __attribute__((section(LOGGER_SECTION))) = \
+			" | " tag " | " LOGGER_SUBSYSTEM " | " msg "\r\n"; \
+		logger_put(pc_logFmt, ##__VA_ARGS__); } } while (0)
+
+#define LOG_OK(msg, ...)    	LOGGER_PUT("  ok", msg, ##__VA_ARGS__)
+#define LOG_ERR(msg, ...)   	LOGGER_PUT(" err", msg, ##__VA_ARGS__)
+#define LOG_INFO(msg, ...)  	LOGGER_PUT("info", msg, ##__VA_ARGS__)
+#define LOG_WARN(msg, ...)  	LOGGER_PUT("warn", msg, ##__VA_ARGS__)
+#define LOG_FAIL(msg, ...)  	LOGGER_PUT("fail", msg, ##__VA_ARGS__)
+#define LOG_DBG(msg, ...)   	LOGGER_PUT(" dbg", msg, ##__VA_ARGS__)
+#else
 #define LOG_OK(msg, ...)    	do { if (LOGGER_ENABLE) printf("%lu |   ok | %5s | " msg "\r\n",bsp_getSec(), LOGGER_SUBSYSTEM, ##__VA_ARGS__); }while (0)
 #define LOG_ERR(msg, ...)   	do { if (LOGGER_ENABLE) printf("%lu |  err | %5s | " msg "\r\n",bsp_getSec(), LOGGER_SUBSYSTEM, ##__VA_ARGS__); }while (0)
 #define LOG_INFO(msg, ...)  	do { if (LOGGER_ENABLE) printf("%lu | info | %5s | " msg "\r\n",bsp_getSec(), LOGGER_SUBSYSTEM, ##__VA_ARGS__); }while (0)
 #define LOG_WARN(msg, ...)  	do { if (LOGGER_ENABLE) printf("%lu | warn | %5s | " msg "\r\n",bsp_getSec(), LOGGER_SUBSYSTEM, ##__VA_ARGS__); }while (0)
 #define LOG_FAIL(msg, ...)  	do { if (LOGGER_ENABLE) printf("%lu | fail | %5s | " msg "\r\n",bsp_getSec(), LOGGER_SUBSYSTEM, ##__VA_ARGS__); }while (0)
 #define LOG_DBG(msg, ...)   	do { if (LOGGER_ENABLE) printf("%lu |  dbg | %5s | " msg "\r\n",bsp_getSec(), LOGGER_SUBSYSTEM, ##__VA_ARGS__); }while (0)
+#endif /* LOGGER_DEFERRED */
 #define	LOG_RAW(...)			do { if (LOGGER_ENABLE) printf(__VA_ARGS__);}while (0)
 
+/**
+ * Store a deferred message. May be called from interrupt handlers. The
+ * message is dropped and counted if the ring is full.
+ *
+ * \param pc_fmt	Format string in LOGGER_SECTION
+ */
+void logger_put(const char * pc_fmt, ...);
+
+/**
+ * Write deferred messages to stdout. Has to be called from the main loop.
+ *
+ * \param i_max		Maximum number of messages to write
+ * \return			1 if messages are left in the ring, 0 otherwise
+ */
+uint8_t logger_flush(uint16_t i_max);
+
 #endif /* LOGGER_H_ */
@@ -91,16 +91,30 @@ MEMB(connections, struct connection, 16);
  */
 #define MEMB(name, structure, num) \
         static char CC_CONCAT(name,_memb_count)[num]; \
+        static unsigned short CC_CONCAT(name,_memb_next)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_count), \
-                                          (void *)CC_CONCAT(name,_memb_mem)}
+                                          (void *)CC_CONCAT(name,_memb_mem), \
+                                          CC_CONCAT(name,_memb_next)}
 
+/*
+ * Free blocks are kept in a list of block indexes stored in next[], so
+ * allocation and deallocation never scan the pool. Indexes are stored
+ * incremented by one, so a zero initialized pool is a valid empty list
+ * and blocks from fresh on are free without being linked.
+ */
 struct memb {
   unsigned short size;
   unsigned short num;
   char *count;
   void *mem;
+  unsigned short *next;     /**< Next free block (+1) for every free block */
+  unsigned short free_head; /**< First free block (+1), 0 if the list is empty */
+  unsigned short fresh;     /**< First block which was never allocated */
+  unsigned short used;      /**< Allocated blocks */
+  unsigned short used_max;  /**< High-water mark of allocated blocks */
+  unsigned short failed;    /**< Failed allocations */
 };
 
 /**
@@ -135,6 +149,22 @@ int memb_inmemb(struct memb *m, void *ptr);
 
 int  memb_numfree(struct memb *m);
 
+/**
+ * Get the maximal amount of blocks which were allocated at the same time
+ * since memb_init().
+ *
+ * \param m A memory block previously declared with MEMB().
+ */
+int  memb_maxused(struct memb *m);
+
+/**
+ * Get the amount of allocations which failed because the memory block
+ * was exhausted since memb_init().
+ *
+ * \param m A memory block previously declared with MEMB().
+ */
+int  memb_numfailed(struct memb *m);
+
 /** @} */
 /** @} */
 /** @} */
@@ -78,10 +78,28 @@
  */
 #define MMEM_PTR(m) (struct mmem *)(m)->ptr
 
+/** Backend compacting the memory on every mmem_free() (default). Memory
+    stays free from fragmentation, freeing costs O(allocated bytes). */
+#define MMEM_BACKEND_COMPACT 0
+/** Backend using power of two size classes without compaction. Allocation
+    and deallocation take bounded time and blocks never move. Select it by
+    setting MMEM_CONF_BACKEND. */
+#define MMEM_BACKEND_SLAB    1
+
 struct mmem {
   struct mmem *next;
   unsigned int size;
   void *ptr;
+  unsigned char cls;  /**< Size class of the block, used by the slab backend */
+};
+
+/** Usage and fragmentation statistics of the managed memory */
+struct mmem_stats {
+  unsigned int requested; /**< Bytes requested by current allocations */
+  unsigned int reserved;  /**< Bytes reserved for current allocations */
+  unsigned int cached;    /**< Bytes in free blocks kept for reuse */
+  unsigned int avail;     /**< Bytes never handed out */
+  unsigned int failed;    /**< Failed allocations */
 };
 
 /* XXX: tagga minne med "interrupt usage", vilke g�r att man �r
@@ -90,6 +108,7 @@ struct mmem {
 int  mmem_alloc(struct mmem *m, unsigned int size);
 void mmem_free(struct mmem *);
 void mmem_init(void);
+void mmem_stats(struct mmem_stats *s);
 
 #endif /* MMEM_H_ */
 
@@ -67,6 +67,26 @@
 #define PACKETBUF_SIZE 128
 #endif
 
+/**
+ * \brief      The amount of packet descriptors, a forwarding node can
+ *             hold further packets while the current one is processed
+ */
+#ifdef PACKETBUF_CONF_SLOTS
+#define PACKETBUF_SLOTS PACKETBUF_CONF_SLOTS
+#else
+#define PACKETBUF_SLOTS 1
+#endif
+
+/**
+ * \brief      The amount of further packet descriptors reserved for the
+ *             receive ring of a radio driver, see rxring.h
+ */
+#ifdef PACKETBUF_CONF_RX_SLOTS
+#define PACKETBUF_RX_SLOTS PACKETBUF_CONF_RX_SLOTS
+#else
+#define PACKETBUF_RX_SLOTS 0
+#endif
+
 /**
  * \brief      The size of the packetbuf header, in bytes
  */
@@ -102,6 +122,17 @@ void packetbuf_clear(void);
  */
 void packetbuf_clear_hdr(void);
 
+/**
+ * \brief      Get the generation of the packet in the packetbuf
+ * \return     A number that changes whenever the packetbuf is
+ *             cleared or another descriptor is selected
+ *
+ *             A layer that left a packet in the packetbuf can tell
+ *             from an unchanged generation that the packet is still
+ *             there, e.g. for a retransmission without a copy.
+ */
+uint16_t packetbuf_generation(void);
+
 void packetbuf_hdr_remove(int bytes);
 
 /**
@@ -318,6 +349,103 @@ int packetbuf_hdralloc(int size);
  */
 int packetbuf_hdrreduce(int size);
 
+/**
+ * \brief      A packet descriptor holding header room, payload and
+ *             attributes of one packet
+ *
+ *             All packetbuf functions operate on the current
+ *             descriptor. Further descriptors can be handed between
+ *             layers by pointer instead of copying the packet.
+ */
+struct packetbuf_slot;
+
+/**
+ * \brief      Allocate a free packet descriptor
+ * \return     The descriptor or NULL if all descriptors are in use
+ *
+ *             The descriptor is not selected, its content is cleared
+ *             when it gets selected.
+ */
+struct packetbuf_slot *packetbuf_slot_alloc(void);
+
+/**
+ * \brief      Return a packet descriptor to the pool
+ * \param s    The descriptor, the current one can not be freed
+ */
+void packetbuf_slot_free(struct packetbuf_slot *s);
+
+/**
+ * \brief      Get the current packet descriptor
+ */
+struct packetbuf_slot *packetbuf_slot_current(void);
+
+/**
+ * \brief      Make a descriptor the current one
+ * \param s    The descriptor to select
+ * \return     The previously selected descriptor, it stays allocated
+ *             and has to be selected or freed again by the caller
+ */
+struct packetbuf_slot *packetbuf_slot_select(struct packetbuf_slot *s);
+
+/**
+ * \brief      Take the packet in the current descriptor without copying
+ * \return     The current descriptor or NULL if no free descriptor is
+ *             left, in this case the packet has to be copied instead
+ *
+ *             A free descriptor becomes the current one, so the stack
+ *             can receive or build further packets while the returned
+ *             one is held, e.g. in a transmission queue.
+ */
+struct packetbuf_slot *packetbuf_slot_detach(void);
+
+/**
+ * \brief      Keep the packet in the current descriptor for a later
+ *             transmission without copying it
+ * \return     The descriptor or NULL if the packet has a header, refers
+ *             to external data or no free descriptor is left, in this
+ *             case the packet has to be copied instead
+ *
+ *             The descriptor stays current. When the packetbuf is
+ *             cleared or another descriptor is selected, a free
+ *             descriptor takes its place and the held packet is kept
+ *             until packetbuf_slot_release().
+ */
+struct packetbuf_slot *packetbuf_slot_hold(void);
+
+/**
+ * \brief      Make a held packet the current one again
+ * \param s    The descriptor returned by packetbuf_slot_hold()
+ * \param len  The length of the packet when it was held
+ *
+ *             The previous packet in the packetbuf is dropped. The
+ *             header added by the lower layers is removed, the caller
+ *             restores the attributes.
+ */
+void packetbuf_slot_restore(struct packetbuf_slot *s, uint16_t len);
+
+/**
+ * \brief      Stop holding a packet
+ * \param s    The descriptor returned by packetbuf_slot_hold()
+ */
+void packetbuf_slot_release(struct packetbuf_slot *s);
+
+/**
+ * \brief      Get the data area of a descriptor that is not selected
+ * \param s    The descriptor
+ * \return     Pointer to the PACKETBUF_SIZE bytes where the data of
+ *             the descriptor starts once it is selected and cleared
+ *
+ *             A radio driver receives a frame directly into a
+ *             descriptor and selects it afterwards, so the frame is
+ *             never copied.
+ */
+uint8_t *packetbuf_slot_dataptr(struct packetbuf_slot *s);
+
+/**
+ * \brief      Get the amount of free packet descriptors
+ */
+int packetbuf_slot_numfree(void);
+
 /* Packet attributes stuff below: */
 
 typedef uint16_t packetbuf_attr_t;
@@ -429,8 +557,8 @@ enum {
 
 #if PACKETBUF_CONF_ATTRS_INLINE
 
-extern struct packetbuf_attr packetbuf_attrs[];
-extern struct packetbuf_addr packetbuf_addrs[];
+extern struct packetbuf_attr *packetbuf_attrs;
+extern struct packetbuf_addr *packetbuf_addrs;
 
 static int               packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val);
 static packetbuf_attr_t    packetbuf_attr(uint8_t type);
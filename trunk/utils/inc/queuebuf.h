@@ -82,6 +82,16 @@
   #define WITH_SWAP 0
 #endif /* QUEUEBUFRAM_CONF_NUM */
 
+/* QUEUEBUF_SLOTS is the number of queuebufs which keep their packet in
+   a packetbuf descriptor instead of a copy, see packetbuf_slot_hold().
+   They are used while descriptors are free, a forwarding node raises
+   PACKETBUF_CONF_SLOTS for them. */
+#ifdef QUEUEBUF_CONF_SLOTS
+#define QUEUEBUF_SLOTS QUEUEBUF_CONF_SLOTS
+#else
+#define QUEUEBUF_SLOTS (PACKETBUF_SLOTS - 1)
+#endif
+
 #ifdef QUEUEBUF_CONF_DEBUG
 #define QUEUEBUF_DEBUG QUEUEBUF_CONF_DEBUG
 #else /* QUEUEBUF_CONF_DEBUG */
@@ -104,6 +114,9 @@ void queuebuf_update_from_packetbuf(struct queuebuf *b);
 void queuebuf_to_packetbuf(struct queuebuf *b);
 void queuebuf_free(struct queuebuf *b);
 
+/* Bytes copied between packetbuf and queuebufs since startup */
+uint32_t queuebuf_copied_bytes(void);
+
 void *queuebuf_dataptr(struct queuebuf *b);
 int queuebuf_datalen(struct queuebuf *b);
 
@@ -0,0 +1,239 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * \addtogroup utils
+ * @{
+ */
+/**
+ * \defgroup rxring Receive ring
+ *
+ * Lock-free ring of received frames shared by the radio drivers. Every
+ * entry owns a packet descriptor of the packetbuf, reserved with
+ * PACKETBUF_CONF_RX_SLOTS. The interrupt handler of the transceiver reads
+ * a frame with a single burst transfer directly into the data area of the
+ * next free entry, so a BSP can do the transfer by DMA. The receive event
+ * selects the descriptor of the oldest entry as the current packetbuf and
+ * gives the previously selected descriptor to the entry in exchange, the
+ * MAC parses the frame where it was received.
+ *
+ * The interrupt handler is the only writer of the tail, the receive event
+ * the only writer of the head, so neither needs to lock the other out. A
+ * frame that finds the ring full is dropped and counted as an overrun.
+ *
+ * @{
+ */
+/*!
+    \file   rxring.h
+
+  \version  0.1
+*/
+/*============================================================================*/
+#ifndef RXRING_H_
+#define RXRING_H_
+
+
+/*=============================================================================
+                                 INCLUDES
+ =============================================================================*/
+#include <stdint.h>
+#include "packetbuf.h"
+#include "stats.h"
+
+
+/*=============================================================================
+                                 MACROS
+ =============================================================================*/
+/// Number of entries of a ring, must be a power of two
+#ifdef RXRING_CONF_SIZE
+#define RXRING_SIZE				RXRING_CONF_SIZE
+#else
+#define RXRING_SIZE				4
+#endif
+
+#if (RXRING_SIZE & (RXRING_SIZE - 1)) || (RXRING_SIZE > 0x80)
+#error "RXRING_SIZE must be a power of two"
+#endif
+
+/// Bytes received into an entry, the longest frame and the LQI byte
+#define RXRING_FRAME_SIZE		128
+
+/*=============================================================================
+                        STRUCTURES AND OTHER TYPEDEFS
+ =============================================================================*/
+/*!
+ * \brief Received frame
+ * */
+typedef struct {
+	struct packetbuf_slot *		pst_slot;	///< Descriptor holding the frame
+	uint8_t						c_len;		///< Length of the frame
+	uint8_t						c_lqi;		///< Link quality
+	uint8_t						c_rssi;		///< Signal strength
+}st_rxringEntry_t;
+
+/*!
+ * \brief Counters of a ring
+ * */
+typedef struct {
+	uint32_t					l_rx;		///< Frames put into the ring
+	uint32_t					l_overrun;	///< Frames dropped, the ring was full
+	uint32_t					l_dup;		///< Frames dropped as duplicates
+}st_rxringStats_t;
+
+/*!
+ * \brief Receive ring
+ * */
+typedef struct {
+	st_rxringEntry_t			pst_entry[RXRING_SIZE];
+	/// Index of the oldest frame, only written by the consumer
+	volatile uint8_t			c_head;
+	/// Index of the next free entry, only written by the producer
+	volatile uint8_t			c_tail;
+	st_rxringStats_t			st_stats;
+#if STATS_CONF_ENABLE
+	st_statsGroup_t				st_group;
+#endif
+}st_rxring_t;
+
+/*==============================================================================
+                          FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/*!
+	\brief  Initialize a ring and reserve a packet descriptor for every entry
+
+	\param  pst_ring	Ring
+	\param  pc_name		Name of the statistics group of the ring
+
+	\return 0 if success, -1 if not enough descriptors are reserved with
+			PACKETBUF_CONF_RX_SLOTS, the ring has less entries in that case
+*/
+/*============================================================================*/
+int8_t rxring_init(st_rxring_t * pst_ring, const char * pc_name);
+
+/*============================================================================*/
+/*!
+	\brief  Get the buffer of the next free entry, called by the producer
+
+			The frame is read into the buffer and added to the ring with
+			\ref rxring_put(). The buffer stays free until then, so the
+			producer may also abandon it.
+
+	\param  pst_ring	Ring
+
+	\return Buffer of \ref RXRING_FRAME_SIZE bytes, NULL if the ring is
+			full, the frame is counted as an overrun then
+*/
+/*============================================================================*/
+uint8_t * rxring_getBuf(st_rxring_t * pst_ring);
+
+/*============================================================================*/
+/*!
+	\brief  Check whether the frame in the free entry is already queued
+
+			Transceivers deliver a frame twice if the acknowledgement got
+			lost, the check only compares frames of the same length.
+
+	\param  pst_ring	Ring
+	\param  c_len		Length of the frame in the free entry
+
+	\return 1 if a queued frame is identical, the frame is counted as a
+			duplicate then, 0 otherwise
+*/
+/*============================================================================*/
+uint8_t rxring_isDup(st_rxring_t * pst_ring, uint8_t c_len);
+
+/*============================================================================*/
+/*!
+	\brief  Add the frame in the free entry to the ring, called by the
+			producer after \ref rxring_getBuf()
+
+	\param  pst_ring	Ring
+	\param  c_len		Length of the frame
+	\param  c_lqi		Link quality
+	\param  c_rssi		Signal strength
+*/
+/*============================================================================*/
+void rxring_put(st_rxring_t * pst_ring, uint8_t c_len, uint8_t c_lqi,
+		uint8_t c_rssi);
+
+/*============================================================================*/
+/*!
+	\brief  Get the oldest frame, called by the consumer
+
+	\param  pst_ring	Ring
+
+	\return Entry of the oldest frame, NULL if the ring is empty
+*/
+/*============================================================================*/
+st_rxringEntry_t * rxring_peek(st_rxring_t * pst_ring);
+
+/*============================================================================*/
+/*!
+	\brief  Make the oldest frame the content of the packetbuf and remove
+			it from the ring, called by the consumer
+
+			The descriptor of the entry becomes the current one and the
+			previously selected descriptor takes its place in the ring.
+			The packetbuf is cleared, holds the frame as data and the
+			signal strength and link quality as attributes.
+
+	\param  pst_ring	Ring
+	\param  c_len		Length of the data, the frame without the checksum
+
+	\return 0 if success, -1 if the ring is empty
+*/
+/*============================================================================*/
+int8_t rxring_take(st_rxring_t * pst_ring, uint8_t c_len);
+
+/*============================================================================*/
+/*!
+	\brief  Remove the oldest frame from the ring without using it, called
+			by the consumer
+
+	\param  pst_ring	Ring
+*/
+/*============================================================================*/
+void rxring_drop(st_rxring_t * pst_ring);
+
+#endif /* RXRING_H_ */
+
+/** @} */
+/** @} */
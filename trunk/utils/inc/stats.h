@@ -0,0 +1,226 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * \addtogroup utils
+ * @{
+ */
+/**
+ * \defgroup stats Statistics registry
+ *
+ * Registry of the statistics counters of all layers. A module keeps its
+ * counters in a structure of its own and increments them directly, so a
+ * counter costs a single increment in the hot path. At initialization the
+ * module registers the structure as a group, with a table giving the name,
+ * offset and type of every counter.
+ *
+ * The registry writes all groups as a compact binary snapshot with a fixed
+ * layout, e.g. for the CoAP resource status/stats or the SLIP command
+ * "?T". The schema, a text with one line per counter, describes the
+ * layout. A snapshot starts with the version, a hash of the schema and the
+ * uptime in seconds, followed by the counters in the order of the schema,
+ * all in little endian byte order. Counters wider than 32 bits are cut to
+ * 32 bits, a histogram is \ref STATS_HIST_BUCKETS 16 bit buckets.
+ *
+ * Statistics are enabled with STATS_CONF_ENABLE.
+ *
+ * @{
+ */
+/*!
+    \file   stats.h
+
+  \version  0.1
+*/
+/*============================================================================*/
+#ifndef STATS_H_
+#define STATS_H_
+
+
+/*=============================================================================
+                                 INCLUDES
+ =============================================================================*/
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*=============================================================================
+                                 MACROS
+ =============================================================================*/
+/// Version of the snapshot format
+#define STATS_VERSION			1
+
+/// Size of the snapshot header
+#define STATS_HDR_SIZE			7
+
+/// Number of buckets of a histogram. Bucket 0 counts the value 0, bucket n
+/// the values from 2^(n-1) to 2^n - 1, the last bucket everything above.
+#define STATS_HIST_BUCKETS		8
+
+/// Counter of a group, the type is taken from the size of the member
+#define STATS_COUNTER(type, member)	\
+	{ #member, offsetof(type, member), sizeof(((type *)0)->member) }
+
+/// Histogram of a group, the member is a \ref st_statsHist_t
+#define STATS_HISTOGRAM(type, member)	\
+	{ #member, offsetof(type, member), E_STATS_HIST }
+
+#if STATS_CONF_ENABLE
+/// Increment a counter
+#define STATS_INC(counter)		do { (counter)++; } while (0)
+/// Add a value to a counter
+#define STATS_ADD(counter, n)	do { (counter) += (n); } while (0)
+/// Add a value to a histogram
+#define STATS_HIST(hist, value)	stats_histAdd(&(hist), (value))
+#else
+#define STATS_INC(counter)		do { } while (0)
+#define STATS_ADD(counter, n)	do { } while (0)
+#define STATS_HIST(hist, value)	do { } while (0)
+#endif /* STATS_CONF_ENABLE */
+
+/*=============================================================================
+                                 ENUMS
+ =============================================================================*/
+/*!
+ * \brief Types of the entries of a group
+ * */
+typedef enum {
+	E_STATS_U8 = 1,			///< 8 bit counter
+	E_STATS_U16 = 2,		///< 16 bit counter
+	E_STATS_U32 = 4,		///< 32 bit counter
+	E_STATS_U64 = 8,		///< 64 bit counter, exported as 32 bit
+	E_STATS_HIST = 0x80		///< Histogram, see \ref st_statsHist_t
+}en_statsType_t;
+
+/*=============================================================================
+                        STRUCTURES AND OTHER TYPEDEFS
+ =============================================================================*/
+/*!
+ * \brief Log2 histogram
+ * */
+typedef struct {
+	uint16_t	pi_bucket[STATS_HIST_BUCKETS];
+}st_statsHist_t;
+
+/*!
+ * \brief Entry of a group, use \ref STATS_COUNTER() or \ref STATS_HISTOGRAM()
+ * */
+typedef struct {
+	const char *	pc_name;	///< Name of the entry
+	uint16_t		i_offset;	///< Offset in the structure of the group
+	uint8_t			c_type;		///< Type, see \ref en_statsType_t
+}st_statsEntry_t;
+
+/*!
+ * \brief Group of counters, usually the statistics of a module
+ * */
+typedef struct st_statsGroup {
+	struct st_statsGroup *		pst_next;	///< Next group, used by the registry
+	const char *				pc_name;	///< Name of the group
+	const st_statsEntry_t *		pst_entry;	///< Entries
+	uint8_t						c_num;		///< Number of entries
+	const void *				p_data;		///< Structure with the counters
+}st_statsGroup_t;
+
+/*==============================================================================
+                          GLOBAL VARIABLE DECLARATIONS
+==============================================================================*/
+/// Entries of a memory pool, p_data of the group is the struct memb
+extern const st_statsEntry_t stats_membEntry[];
+/// Number of entries of a memory pool
+#define STATS_MEMB_ENTRIES		3
+
+/*==============================================================================
+                          FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/*!
+	\brief  Register a group. Registering a group again has no effect.
+*/
+/*============================================================================*/
+void stats_register(st_statsGroup_t * pst_group);
+
+/*============================================================================*/
+/*!
+	\brief  Add a value to a histogram
+*/
+/*============================================================================*/
+void stats_histAdd(st_statsHist_t * pst_hist, uint32_t l_value);
+
+/*============================================================================*/
+/*!
+	\brief  Size of a snapshot in bytes
+*/
+/*============================================================================*/
+uint16_t stats_size(void);
+
+/*============================================================================*/
+/*!
+	\brief  Write a part of a snapshot. The layout is fixed, so a snapshot
+			can be sent in blocks. The counters are read when the block is
+			written.
+
+	\param  pc_buf			Buffer
+	\param	i_len			Size of the buffer
+	\param	l_offset		Offset of the part in the snapshot
+
+	\return	Number of bytes written, 0 at the end of the snapshot
+*/
+/*============================================================================*/
+uint16_t stats_snapshot(uint8_t * pc_buf, uint16_t i_len, uint32_t l_offset);
+
+/*============================================================================*/
+/*!
+	\brief  Write a part of the schema. The schema starts with a line with
+			the version and the hash, followed by a line
+			"<group>.<entry> <type>" per entry, type being u8, u16, u32 or
+			hist.
+
+	\param  pc_buf			Buffer
+	\param	i_len			Size of the buffer
+	\param	l_offset		Offset of the part in the schema
+
+	\return	Number of bytes written, 0 at the end of the schema
+*/
+/*============================================================================*/
+uint16_t stats_schema(char * pc_buf, uint16_t i_len, uint32_t l_offset);
+
+#endif /* STATS_H_ */
+/** @} */
+/** @} */
@@ -0,0 +1,223 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * \addtogroup utils
+ * @{
+ */
+/**
+ * \defgroup trace Packet tracing
+ *
+ * Binary tracing of the packets through the layers of the netstack. Every
+ * layer records when a packet passes its input or send function. A record
+ * is 8 bytes with a microsecond timestamp, a packet id and the layer, so it
+ * is cheap enough to stay enabled in production builds. The records are
+ * kept in a ring and read out with \ref trace_read(), e.g. by the native
+ * target which writes them to a file for tools/trace_decode.
+ *
+ * A packet gets its id when it is received by the radio or when it is sent
+ * by the IP layer. The id is kept while the packet is processed, so a
+ * forwarded packet keeps the id it was received with.
+ *
+ * Tracing is enabled with TRACE_CONF_ENABLE. This header has to be
+ * included after emb6_conf.h, the tracing macros are empty otherwise.
+ *
+ * @{
+ */
+/*!
+    \file   trace.h
+
+  \version  0.1
+*/
+/*============================================================================*/
+#ifndef TRACE_H_
+#define TRACE_H_
+
+
+/*=============================================================================
+                                 INCLUDES
+ =============================================================================*/
+#include <stdint.h>
+
+
+/*=============================================================================
+                                 MACROS
+ =============================================================================*/
+/// Number of records of the ring, must be a power of two
+#ifdef TRACE_CONF_RECORDS
+#define TRACE_RECORDS			TRACE_CONF_RECORDS
+#else
+#define TRACE_RECORDS			256
+#endif
+
+#if (TRACE_RECORDS & (TRACE_RECORDS - 1)) || (TRACE_RECORDS > 0x8000)
+#error "TRACE_RECORDS must be a power of two"
+#endif
+
+/// Magic number at the start of a trace file
+#define TRACE_FILE_MAGIC		"ETRC"
+/// Version of the trace file format
+#define TRACE_FILE_VERSION		1
+
+#if TRACE_CONF_ENABLE
+/// Record that the current packet enters a layer on its way up
+#define TRACE_RX(layer)			trace_put(trace_curPacket, (layer), E_TRACE_RX)
+/// Record that the current packet enters a layer on its way down
+#define TRACE_TX(layer)			trace_put(trace_curPacket, (layer), E_TRACE_TX)
+/// Record a given packet, for interrupt handlers
+#define TRACE_PUT(id, layer, dir)	trace_put((id), (layer), (dir))
+/// Make a packet the current packet, 0 if there is none
+#define TRACE_SET_PACKET(id)	do { trace_curPacket = (id); } while (0)
+/// Id of the current packet
+#define TRACE_GET_PACKET()		trace_curPacket
+/// Make a new packet the current packet
+#define TRACE_NEW_PACKET()		do { trace_curPacket = trace_newPacket(); } while (0)
+#else
+#define TRACE_RX(layer)			do { } while (0)
+#define TRACE_TX(layer)			do { } while (0)
+#define TRACE_PUT(id, layer, dir)	do { } while (0)
+#define TRACE_SET_PACKET(id)	do { } while (0)
+#define TRACE_GET_PACKET()		0
+#define TRACE_NEW_PACKET()		do { } while (0)
+#endif /* TRACE_CONF_ENABLE */
+
+/*=============================================================================
+                                 ENUMS
+ =============================================================================*/
+/*!
+ * \brief Layers of the netstack, from the bottom to the top
+ * */
+typedef enum {
+	E_TRACE_RADIO,			///< Radio driver (s_ns_t::inif)
+	E_TRACE_LMAC,			///< Low MAC (s_ns_t::lmac)
+	E_TRACE_HMAC,			///< High MAC (s_ns_t::hmac)
+	E_TRACE_LLSEC,			///< Link layer security (s_ns_t::llsec)
+	E_TRACE_HC,				///< Header compression (s_ns_t::hc)
+	E_TRACE_TCPIP,			///< tcpip_input() and tcpip_output()
+	E_TRACE_UIP,			///< IP processing in uip_process()
+	E_TRACE_APP,			///< UDP or TCP application callback
+	E_TRACE_LAYERS			///< Amount of layers
+}en_traceLayer_t;
+
+/*!
+ * \brief Direction of a packet
+ * */
+typedef enum {
+	E_TRACE_RX,				///< Received packet on its way up
+	E_TRACE_TX				///< Sent packet on its way down
+}en_traceDir_t;
+
+/*=============================================================================
+                        STRUCTURES AND OTHER TYPEDEFS
+ =============================================================================*/
+/*!
+ * \brief Trace record. A trace file starts with \ref TRACE_FILE_MAGIC, the
+ *        version and the record size as two bytes each, followed by the
+ *        records with all fields in little endian byte order.
+ * */
+typedef struct {
+	uint32_t	l_time;		///< Timestamp in microseconds, wraps around
+	uint16_t	i_packet;	///< Packet id, never 0
+	uint8_t		c_layer;	///< Layer, see \ref en_traceLayer_t
+	uint8_t		c_dir;		///< Direction, see \ref en_traceDir_t
+}st_traceRec_t;
+
+/*==============================================================================
+                          GLOBAL VARIABLE DECLARATIONS
+==============================================================================*/
+/// Id of the packet processed by the main loop, 0 if there is none
+extern uint16_t trace_curPacket;
+
+/*==============================================================================
+                          FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/*!
+	\brief  Clear the ring
+*/
+/*============================================================================*/
+void trace_init(void);
+
+/*============================================================================*/
+/*!
+	\brief  Allocate an id for a new packet. May be called from interrupt
+			handlers.
+
+	\return	Packet id, never 0
+*/
+/*============================================================================*/
+uint16_t trace_newPacket(void);
+
+/*============================================================================*/
+/*!
+	\brief  Add a record to the ring. May be called from interrupt handlers,
+			a slot is reserved without locking. If the ring is full the
+			oldest record is overwritten.
+
+	\param  i_packet		Packet id, nothing is recorded for 0
+	\param	c_layer			Layer, see \ref en_traceLayer_t
+	\param	c_dir			Direction, see \ref en_traceDir_t
+*/
+/*============================================================================*/
+void trace_put(uint16_t i_packet, uint8_t c_layer, uint8_t c_dir);
+
+/*============================================================================*/
+/*!
+	\brief  Take the oldest records out of the ring. Has to be called from
+			the main loop.
+
+	\param  pst_rec			Buffer for the records
+	\param	i_max			Size of the buffer in records
+
+	\return	Number of records copied to the buffer
+*/
+/*============================================================================*/
+uint16_t trace_read(st_traceRec_t * pst_rec, uint16_t i_max);
+
+/*============================================================================*/
+/*!
+	\brief  Number of records overwritten before they were read
+*/
+/*============================================================================*/
+uint32_t trace_lost(void);
+
+#endif /* TRACE_H_ */
+/** @} */
+/** @} */
@@ -68,6 +68,8 @@
 #include "timer.h"
 #include "clist.h"
 
+#include <stddef.h>
+
 /*==============================================================================
                              LOCAL MACROS
 ==============================================================================*/
@@ -77,9 +79,14 @@
 #endif
 #include	"logger.h"
 
+/** Get the callback timer containing a given event timer */
+#define		CTIMER_FROM_ETIMER(pst_et)	\
+			((struct ctimer *)((char *)(pst_et) - offsetof(struct ctimer, etimer)))
+
 /*==============================================================================
                             LOCAL VARIABLES
 ==============================================================================*/
+/** Callback timers set before the library was initialized */
 LIST(gp_ctimList);
 static 	char 		gc_init = 0;
 
@@ -89,25 +96,25 @@ void ctimer_refresh(c_event_t event, void * data);
                              LOCAL FUNCTIONS
 ==============================================================================*/
 /**
- * \brief      Refresh a callback timer list
+ * \brief      Handle the expiration of the event timer of a callback timer
  * \param event    	New event
- * \param data    	Pointer to the data
+ * \param data    	Pointer to the expired event timer
+ *
+ *             The callback timer is resolved directly from its event timer.
+ *             The callback is skipped if the timer was stopped or set again
+ *             after the expiration event was queued.
  *
  * \sa ctimer_refresh()
  */
 void ctimer_refresh(c_event_t event, void * data)
 {
-	struct ctimer *pst_cTim;
-	for(pst_cTim = list_head(gp_ctimList); \
-		pst_cTim != NULL; \
-		pst_cTim = pst_cTim->next) {
-	  if(&pst_cTim->etimer == data) {
-		  list_remove(gp_ctimList, pst_cTim);
-		  if(pst_cTim->f != NULL) {
-			  pst_cTim->f(pst_cTim->ptr);
-		  }
-		  break;
-	  }
+	struct ctimer *pst_cTim = CTIMER_FROM_ETIMER(data);
+
+	if (pst_cTim->etimer.active != TMR_FIRED)
+		return;
+	pst_cTim->etimer.active = TMR_NOT_ACTIVE;
+	if(pst_cTim->f != NULL) {
+		pst_cTim->f(pst_cTim->ptr);
 	}
 }
 /*==============================================================================
@@ -122,11 +129,13 @@ void ctimer_init(void)
 		return;
 	etimer_init();
 	struct ctimer *c;
-	list_init(gp_ctimList);
-	for(c = list_head(gp_ctimList); c != NULL; c = c->next) {
+	uint16_t slack;
+	gc_init = 1;
+	while((c = list_pop(gp_ctimList)) != NULL) {
+		slack = c->etimer.slack;
 		etimer_set(&c->etimer, c->etimer.timer.interval, ctimer_refresh);
+		etimer_set_slack(&c->etimer, slack);
 	}
-	gc_init = 1;
 }
 /*============================================================================*/
 /*  ctimer_set()                                                     */
@@ -141,9 +150,9 @@ void ctimer_set(struct ctimer *c, clock_time_t t,
 		etimer_set(&c->etimer, t, ctimer_refresh);
 	} else {
 		c->etimer.timer.interval = t;
+		c->etimer.slack = 0;
+		list_add(gp_ctimList, c);
 	}
-
-	list_add(gp_ctimList, c);
 }
 /*============================================================================*/
 /*  ctimer_reset()                                                     */
@@ -153,9 +162,6 @@ void ctimer_reset(struct ctimer *c)
   if(gc_init) {
     etimer_reset(&c->etimer);
   }
-
-  list_remove(gp_ctimList, c);
-  list_add(gp_ctimList, c);
 }
 /*============================================================================*/
 /*  ctimer_restart()                                                     */
@@ -165,9 +171,13 @@ void ctimer_restart(struct ctimer *c)
   if(gc_init) {
     etimer_restart(&c->etimer);
   }
-
-  list_remove(gp_ctimList, c);
-  list_add(gp_ctimList, c);
+}
+/*============================================================================*/
+/*  ctimer_set_slack()                                                     */
+/*============================================================================*/
+void ctimer_set_slack(struct ctimer *c, clock_time_t slack)
+{
+  etimer_set_slack(&c->etimer, slack);
 }
 /*============================================================================*/
 /*  ctimer_stop()                                                     */
@@ -178,9 +188,10 @@ void ctimer_stop(struct ctimer *pst_stopTim)
 		etimer_stop(&pst_stopTim->etimer);
 	} else {
 		pst_stopTim->etimer.next = NULL;
+		pst_stopTim->etimer.pprev = NULL;
 		pst_stopTim->etimer.active = TMR_NOT_ACTIVE;
+		list_remove(gp_ctimList, pst_stopTim);
 	}
-	list_remove(gp_ctimList, pst_stopTim);
 }
 /*============================================================================*/
 /*  ctimer_expired()                                                     */
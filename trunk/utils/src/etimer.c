@@ -62,7 +62,6 @@
 ==============================================================================*/
 
 #include "etimer.h"
-#include "clist.h"
 
 #include "emb6_conf.h"
 #include "emb6.h"
@@ -78,18 +77,262 @@
 #endif
 #include	"logger.h"
 
+/** Wraparound safe comparison of two timestamps */
+#define		ETIMER_LT(a,b)		((signed long)((a)-(b)) < 0)
+
+/** Amount of slots per wheel level */
+#define		ETIMER_WHEEL_SLOTS	(1 << ETIMER_WHEEL_BITS)
+#define		ETIMER_WHEEL_MASK	(ETIMER_WHEEL_SLOTS - 1)
+/** Amount of ticks covered by the wheel levels up to the given level */
+#define		ETIMER_WHEEL_SPAN(lvl)	\
+			((clock_time_t)1 << (ETIMER_WHEEL_BITS * ((lvl) + 1)))
+/** Shift of the slot index of a given level */
+#define		ETIMER_WHEEL_SHIFT(lvl)	(ETIMER_WHEEL_BITS * (lvl))
+/** List index of the due list, wheel slots are numbered before it */
+#define		ETIMER_LIST_DUE		(ETIMER_WHEEL_LEVELS * ETIMER_WHEEL_SLOTS)
+
 /*==============================================================================
                             LOCAL VARIABLES
 ==============================================================================*/
-static 			clock_time_t 	l_nextExp = 0;
-LIST(gp_etimList);
+/** Hierarchical timing wheel. Level 0 holds timers expiring within the next
+ *  ETIMER_WHEEL_SLOTS ticks, every higher level covers ETIMER_WHEEL_SLOTS times
+ *  the range of the previous one. Each slot is an unsorted list. */
+static 	struct 	etimer	*gpst_wheel[ETIMER_WHEEL_LEVELS][ETIMER_WHEEL_SLOTS];
+/** Bitmaps of the non-empty slots of every level */
+static 	uint32_t		gl_wheelMap[ETIMER_WHEEL_LEVELS];
+/** Timers which are due and get their event with the next poll */
+static 	struct 	etimer	*gpst_due = NULL;
+/** Last tick processed by the wheel */
+static 	clock_time_t	gl_wheelNow = 0;
+/** Statistics of expired timers */
+static 	st_etimerStats_t	gst_stats;
 static 	char 		gc_init = 0;
 /*==============================================================================
                              LOCAL FUNCTIONS
 ==============================================================================*/
 /*============================================================================*/
 /*!
-*   \brief   Add timer to the timer list
+*   \brief   Insert a timer at the front of a timer list
+*
+*	\param		ppst_head		Pointer to the head of the list
+*	\param		pst_timer		Pointer to a timer to be inserted
+*	\retval		none
+*/
+/*============================================================================*/
+static void _etimer_link(struct etimer **ppst_head, struct etimer *pst_timer)
+{
+	pst_timer->next = *ppst_head;
+	if (pst_timer->next != NULL)
+		pst_timer->next->pprev = &pst_timer->next;
+	pst_timer->pprev = ppst_head;
+	*ppst_head = pst_timer;
+	if (ppst_head == &gpst_due)
+		pst_timer->list = ETIMER_LIST_DUE;
+	else
+		pst_timer->list = ppst_head - &gpst_wheel[0][0];
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Remove a timer from the list it is linked to
+*
+*			 If the timer was the last one of a wheel slot the slot is marked
+*			 as empty.
+*
+*	\param		pst_timer		Pointer to a timer to be removed
+*	\retval		none
+*/
+/*============================================================================*/
+static void _etimer_unlink(struct etimer *pst_timer)
+{
+	struct etimer 	**ppst_slot = &gpst_wheel[0][0];
+	uint16_t		i_idx;
+
+	*pst_timer->pprev = pst_timer->next;
+	if (pst_timer->next != NULL) {
+		pst_timer->next->pprev = pst_timer->pprev;
+	}
+	else if ((pst_timer->pprev >= ppst_slot) && \
+			 (pst_timer->pprev < ppst_slot + ETIMER_WHEEL_LEVELS * ETIMER_WHEEL_SLOTS) && \
+			 (*pst_timer->pprev == NULL)) {
+		// The slot became empty
+		i_idx = pst_timer->pprev - ppst_slot;
+		gl_wheelMap[i_idx >> ETIMER_WHEEL_BITS] &= ~(1UL << (i_idx & ETIMER_WHEEL_MASK));
+	}
+	pst_timer->next = NULL;
+	pst_timer->pprev = NULL;
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Check if a timer is linked to the wheel or the due list
+*
+*			 The link fields of a timer which was never set may hold any
+*			 value, so they are not dereferenced. Instead the list the timer
+*			 was linked to last is searched for it.
+*
+*	\param		pst_timer		Pointer to a timer
+*	\retval		1 if linked, 0 otherwise
+*/
+/*============================================================================*/
+static uint8_t _etimer_isLinked(struct etimer *pst_timer)
+{
+	struct etimer	*pst_tTim;
+
+	if (pst_timer->list == ETIMER_LIST_DUE)
+		pst_tTim = gpst_due;
+	else if (pst_timer->list < ETIMER_LIST_DUE)
+		pst_tTim = (&gpst_wheel[0][0])[pst_timer->list];
+	else
+		return 0;
+
+	for (; pst_tTim != NULL; pst_tTim = pst_tTim->next) {
+		if (pst_tTim == pst_timer)
+			return 1;
+	}
+	return 0;
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Get the expiration time of a timer including its slack
+*
+*			 The expiration is delayed to the coarsest power of two boundary
+*			 which is not later than the expiration time plus the slack, so
+*			 timers with overlapping tolerance windows expire at the same tick.
+*
+*	\param		pst_timer		Pointer to a timer
+*	\retval		Expiration time to be used for scheduling
+*/
+/*============================================================================*/
+static clock_time_t _etimer_coalescedExp(struct etimer *pst_timer)
+{
+	clock_time_t	l_exp = etimer_expiration_time(pst_timer);
+	clock_time_t	l_limit;
+	clock_time_t	l_mask;
+	clock_time_t	l_bit = 1;
+
+	if (pst_timer->slack == 0)
+		return l_exp;
+	l_limit = l_exp + pst_timer->slack;
+	// Highest bit which differs between expiration and limit
+	for (l_mask = l_exp ^ l_limit; l_mask > 1; l_mask >>= 1)
+		l_bit <<= 1;
+	return l_limit & ~(l_bit - 1);
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Put a timer into the wheel slot matching its expiration time
+*
+*			 Timers which are due already are put to the due list. Timers
+*			 beyond the range of the wheel are put to the last slot of the
+*			 highest level and rescheduled when this slot is processed.
+*
+*	\param		pst_timer		Pointer to a timer to be scheduled
+*	\retval		none
+*/
+/*============================================================================*/
+static void _etimer_schedule(struct etimer *pst_timer)
+{
+	clock_time_t	l_exp = _etimer_coalescedExp(pst_timer);
+	clock_time_t	l_delta = l_exp - gl_wheelNow;
+	uint8_t			c_lvl;
+	uint8_t			c_slot;
+
+	if ((signed long)l_delta <= 0) {
+		_etimer_link(&gpst_due, pst_timer);
+		return;
+	}
+
+	for (c_lvl = 0; c_lvl < ETIMER_WHEEL_LEVELS - 1; c_lvl++) {
+		if (l_delta < ETIMER_WHEEL_SPAN(c_lvl))
+			break;
+	}
+	if (l_delta >= ETIMER_WHEEL_SPAN(c_lvl))
+		l_exp = gl_wheelNow + ETIMER_WHEEL_SPAN(c_lvl) - 1;
+
+	c_slot = (l_exp >> ETIMER_WHEEL_SHIFT(c_lvl)) & ETIMER_WHEEL_MASK;
+	_etimer_link(&gpst_wheel[c_lvl][c_slot], pst_timer);
+	gl_wheelMap[c_lvl] |= (1UL << c_slot);
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Find the next tick at which the wheel has to process a slot
+*
+*			 This is either the expiration of a level 0 slot or the time a
+*			 slot of a higher level has to be moved to the lower levels.
+*
+*	\param		pl_tick		Pointer to store the found tick
+*	\retval		1 if a non-empty slot exists, 0 otherwise
+*/
+/*============================================================================*/
+static uint8_t _etimer_nextTick(clock_time_t *pl_tick)
+{
+	clock_time_t	l_base;
+	clock_time_t	l_tick;
+	clock_time_t	l_bestOff = 0;
+	uint8_t			c_found = 0;
+	uint8_t			c_lvl;
+	uint8_t			c_k;
+
+	for (c_lvl = 0; c_lvl < ETIMER_WHEEL_LEVELS; c_lvl++) {
+		if (gl_wheelMap[c_lvl] == 0)
+			continue;
+		// Search the next non-empty slot after the current one of this level
+		l_base = gl_wheelNow >> ETIMER_WHEEL_SHIFT(c_lvl);
+		for (c_k = 1; c_k <= ETIMER_WHEEL_SLOTS; c_k++) {
+			if (gl_wheelMap[c_lvl] & (1UL << ((l_base + c_k) & ETIMER_WHEEL_MASK)))
+				break;
+		}
+		l_tick = (l_base + c_k) << ETIMER_WHEEL_SHIFT(c_lvl);
+		if (!c_found || ((l_tick - gl_wheelNow) < l_bestOff)) {
+			l_bestOff = l_tick - gl_wheelNow;
+			*pl_tick = l_tick;
+			c_found = 1;
+		}
+	}
+	return c_found;
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Process the wheel at tick gl_wheelNow
+*
+*			 Slots of higher levels reaching their time are rescheduled to the
+*			 lower levels, afterwards the timers of the current level 0 slot
+*			 are moved to the due list.
+*
+*	\retval		none
+*/
+/*============================================================================*/
+static void _etimer_processTick(void)
+{
+	struct	etimer	*	pst_tTim;
+	uint8_t				c_lvl;
+	uint8_t				c_slot;
+
+	for (c_lvl = 1; c_lvl < ETIMER_WHEEL_LEVELS; c_lvl++) {
+		if (gl_wheelNow & (((clock_time_t)1 << ETIMER_WHEEL_SHIFT(c_lvl)) - 1))
+			break;
+		c_slot = (gl_wheelNow >> ETIMER_WHEEL_SHIFT(c_lvl)) & ETIMER_WHEEL_MASK;
+		while ((pst_tTim = gpst_wheel[c_lvl][c_slot]) != NULL) {
+			_etimer_unlink(pst_tTim);
+			_etimer_schedule(pst_tTim);
+		}
+	}
+
+	c_slot = gl_wheelNow & ETIMER_WHEEL_MASK;
+	while ((pst_tTim = gpst_wheel[0][c_slot]) != NULL) {
+		_etimer_unlink(pst_tTim);
+		_etimer_link(&gpst_due, pst_tTim);
+	}
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Add timer to the timing wheel
 *
 *	\param		pst_timer		Pointer to a timer to be added
 *	\retval		none
@@ -97,22 +340,30 @@ static 	char 		gc_init = 0;
 /*============================================================================*/
 static void _etimer_addTimer(struct etimer *pst_timer)
 {
-	list_remove(gp_etimList, pst_timer);
-	list_add(gp_etimList, pst_timer);
+	if (_etimer_isLinked(pst_timer))
+		_etimer_unlink(pst_timer);
+	// An empty wheel can be moved to the current time without processing
+	if (!etimer_pending())
+		gl_wheelNow = bsp_getTick();
+	_etimer_schedule(pst_timer);
 	pst_timer->active = TMR_ACTIVE;
 }
 
 void etimer_print_list(void)
 {
 	struct etimer * st_temp;
-	uint8_t j=0;
-	LOG_INFO("%s\n\r","timer list");
-	for (st_temp = list_head(gp_etimList); \
-		st_temp != NULL; \
-		st_temp = list_item_next(st_temp), j++) {
-		LOG_RAW("%d | %p : %p : %lu : %lu\n\r",j,st_temp,st_temp->next,st_temp->timer.start,st_temp->timer.interval);
+	uint8_t c_lvl;
+	uint8_t c_slot;
+	LOG_INFO("%s\n\r","timer wheel");
+	for (c_lvl = 0; c_lvl < ETIMER_WHEEL_LEVELS; c_lvl++) {
+		for (c_slot = 0; c_slot < ETIMER_WHEEL_SLOTS; c_slot++) {
+			for (st_temp = gpst_wheel[c_lvl][c_slot]; \
+				st_temp != NULL; \
+				st_temp = st_temp->next) {
+				LOG_RAW("%d:%d | %p : %lu : %lu\n\r",c_lvl,c_slot,st_temp,st_temp->timer.start,st_temp->timer.interval);
+			}
+		}
 	}
-
 }
 /*==============================================================================
                              API FUNCTIONS
@@ -124,7 +375,8 @@ void etimer_init(void)
 {
 	if (gc_init)
 		return;
-	list_init(gp_etimList);
+	if (!etimer_pending())
+		gl_wheelNow = bsp_getTick();
 	gc_init = 1;
 } /* etimer_init */
 
@@ -133,30 +385,37 @@ void etimer_init(void)
 /*============================================================================*/
 void etimer_request_poll(void)
 {
-	struct	etimer 	*	pst_tTim = list_head(gp_etimList);
-	struct	etimer	*	pst_nTim = NULL; ///! Next timer
-	if (pst_tTim == NULL)
-		return;
+	struct	etimer 	*	pst_tTim;
+	clock_time_t		l_now = bsp_getTick();
+	clock_time_t		l_tick;
+	uint8_t				c_batch = 0;
+
 	// Importamt to remember that all of the etimer structure are stored in
 	// the different modules, that means that etimer library just manages linking
 	// between them.
-	// Until we will not point to the NULL keep searching through the list
-	while(pst_tTim != NULL) {
-		pst_nTim = list_item_next(pst_tTim);
-		// We take one by one timer and check if it is expired
-		if(timer_expired(&(pst_tTim->timer))) {
-			LOG_INFO("delete %p from list\n\r",pst_tTim);
-//			etimer_print_list();
-			// Store pointer to a next timer, to check all timers in a list
-			// Generate timer expired event
-			evproc_putEvent(E_EVPROC_TAIL,EVENT_TYPE_TIMER_EXP,pst_tTim);
-			// Remove matched timer from the list
-			list_remove(gp_etimList, pst_tTim);
-			// Change active flag
-			pst_tTim->active = TMR_NOT_ACTIVE;
-		} /* if */
-		pst_tTim = pst_nTim;
-	} /* while */
+	// Only the slots reached since the last poll are processed, empty slots
+	// are skipped using the bitmaps.
+	while (_etimer_nextTick(&l_tick) && !ETIMER_LT(l_now, l_tick)) {
+		gl_wheelNow = l_tick;
+		_etimer_processTick();
+	}
+	gl_wheelNow = l_now;
+
+	while ((pst_tTim = gpst_due) != NULL) {
+		LOG_INFO("delete %p from list\n\r",pst_tTim);
+		_etimer_unlink(pst_tTim);
+		pst_tTim->active = TMR_FIRED;
+		gst_stats.l_fired++;
+		if (c_batch)
+			gst_stats.l_saved++;
+		c_batch = 1;
+		if (_etimer_coalescedExp(pst_tTim) != etimer_expiration_time(pst_tTim))
+			gst_stats.l_deferred++;
+		// Generate timer expired event
+		evproc_putEventTo(E_EVPROC_TAIL,EVENT_TYPE_TIMER_EXP,pst_tTim,pst_tTim->pfn_callback);
+	}
+	if (c_batch)
+		gst_stats.l_batches++;
 } /* etimer_request_poll() */
 
 /*============================================================================*/
@@ -165,8 +424,9 @@ void etimer_request_poll(void)
 void etimer_set(struct etimer *pst_et, clock_time_t l_interval, pfn_callback_t pfn_callback)
 {
 	timer_set(&pst_et->timer, l_interval);
+	pst_et->pfn_callback = pfn_callback;
+	pst_et->slack = 0;
 	_etimer_addTimer(pst_et);
-	evproc_regCallback(EVENT_TYPE_TIMER_EXP, pfn_callback);
 	LOG_INFO("add new timer %p\n\r",pst_et);
 //	etimer_print_list();
 }/* etimer_set() */
@@ -198,14 +458,38 @@ etimer_restart(struct etimer *pst_et)
 void etimer_adjust(struct etimer *pst_et, int32_t l_timediff)
 {
 	pst_et->timer.start += l_timediff;
+	if (_etimer_isLinked(pst_et)) {
+		_etimer_unlink(pst_et);
+		_etimer_schedule(pst_et);
+	}
 }/* etimer_adjust() */
 
+/*============================================================================*/
+/*  etimer_set_slack()                               			                  */
+/*============================================================================*/
+void etimer_set_slack(struct etimer *pst_et, clock_time_t l_slack)
+{
+	pst_et->slack = (l_slack > 0xFFFF) ? 0xFFFF : (uint16_t)l_slack;
+	if (_etimer_isLinked(pst_et)) {
+		_etimer_unlink(pst_et);
+		_etimer_schedule(pst_et);
+	}
+}/* etimer_set_slack() */
+
+/*============================================================================*/
+/*  etimer_getStats()                               			                  */
+/*============================================================================*/
+void etimer_getStats(st_etimerStats_t *pst_stats)
+{
+	*pst_stats = gst_stats;
+}/* etimer_getStats() */
+
 /*============================================================================*/
 /*  etimer_expired()                               			                      */
 /*============================================================================*/
 int etimer_expired(struct etimer *pst_et)
 {
-  return ( pst_et->active == TMR_NOT_ACTIVE );
+  return ( pst_et->active != TMR_ACTIVE );
 }
 /*============================================================================*/
 /*  etimer_expiration_time()                               			                      */
@@ -228,7 +512,15 @@ clock_time_t etimer_start_time(struct etimer *pst_et)
 /*============================================================================*/
 int etimer_pending(void)
 {
-  return gp_etimList != NULL;
+	uint8_t c_lvl;
+
+	if (gpst_due != NULL)
+		return 1;
+	for (c_lvl = 0; c_lvl < ETIMER_WHEEL_LEVELS; c_lvl++) {
+		if (gl_wheelMap[c_lvl] != 0)
+			return 1;
+	}
+	return 0;
 }/* etimer_pending() */
 
 /*============================================================================*/
@@ -236,7 +528,13 @@ int etimer_pending(void)
 /*============================================================================*/
 clock_time_t etimer_next_expiration_time(void)
 {
-  return etimer_pending() ? l_nextExp : 0;
+	clock_time_t l_tick;
+
+	if (gpst_due != NULL)
+		return gl_wheelNow;
+	if (_etimer_nextTick(&l_tick))
+		return l_tick;
+	return 0;
 } /* etimer_next_expiration_time() */
 
 /*============================================================================*/
@@ -244,7 +542,8 @@ clock_time_t etimer_next_expiration_time(void)
 /*============================================================================*/
 void etimer_stop(struct etimer *pst_et)
 {
-	list_remove(gp_etimList, pst_et);
+	if (_etimer_isLinked(pst_et))
+		_etimer_unlink(pst_et);
 	pst_et->active = TMR_NOT_ACTIVE;
 } /* etimer_stop() */
 
@@ -253,36 +552,7 @@ void etimer_stop(struct etimer *pst_et)
 /*============================================================================*/
 clock_time_t etimer_nextEvent(void)
 {
-  struct    etimer  *   pst_tTim = list_head(gp_etimList);
-  struct    etimer  *   pst_nTim = NULL; ///! Next timer
-  clock_time_t  ct_expTime;
-  clock_time_t  ct_nextExpTime = 0;
-
-  if ( list_length(gp_etimList) == 0 ) /* no items in list */
-    return TMR_NOT_ACTIVE;
-  else /* search timer with next expiration time */
-  {
-    while(pst_tTim != NULL)
-    {
-      pst_nTim = list_item_next(pst_tTim); /* get next element in list */
-
-      if (pst_tTim->active == TMR_ACTIVE) /* timer enabled? */
-      {
-        ct_expTime = pst_tTim->timer.start + pst_tTim->timer.interval; /* get timer expiration time */
-
-        if ( ct_nextExpTime == 0)
-          ct_nextExpTime = ct_expTime;
-        else
-        {
-          if (ct_expTime < ct_nextExpTime) /* save next expiration time */
-            ct_nextExpTime = ct_expTime;
-        }
-      } /* timer enabled? */
-
-      pst_tTim = pst_nTim;
-    }
-      return (ct_nextExpTime);
-  }
+	return etimer_next_expiration_time();
 } /* etimer_nextEvent() */
 
 /** @} */
@@ -88,7 +88,6 @@
  * \brief Type of a structure to store every callback for particular event.
  * */
 typedef struct {
-	c_event_t		c_event; ///< Event type
 	pfn_callback_t 	pfn_callbList[MAX_CALLBACK_COUNT]; ///< List of a callback functions
 }st_funcReg_t;
 
@@ -99,28 +98,46 @@ typedef struct {
  * */
 typedef struct {
 	p_data_t			p_data;  ///< Pointer to a data to be transfered
+	pfn_callback_t		pfn_dest; ///< Destination function, NULL for all subscribers
 	c_event_t			c_event; ///< Event type
 }st_eventDisc_t;
 
+/*!
+ * \struct st_evQueue_t
+ *
+ * \brief Ring buffer of events of one priority class
+ * */
+typedef struct {
+	st_eventDisc_t		pst_ev[EVPROC_QUEUE_SIZE]; ///< Events storage
+	uint16_t			i_head;  ///< Index of the next event to be dispatched
+	uint16_t			i_count; ///< Amount of queued events
+}st_evQueue_t;
+
 /*==============================================================================
                             LOCAL VARIABLES
 ==============================================================================*/
-/*! Array of functions linked with every defined event */
+/*! Array of functions linked with every defined event, indexed by
+ *  \ref EVPROC_EVENT_IDX */
 static	st_funcReg_t	pst_regList[EVENT_TYPES_COUNT];
 
-/*!  Queue of events linked with a data which is associated with this event */
-static st_eventDisc_t	pst_evList[EVPROC_QUEUE_SIZE];
+/*!  Queues of events linked with a data, one per priority class */
+static st_evQueue_t		pst_evQueue[E_EVPROC_PRIO_COUNT];
+
+/*!  Counting hash filter of queued events, see \ref _evproc_lookupEvent */
+static uint16_t			pi_dupFilter[EVPROC_DUPFILTER_SIZE];
 
 /*! Flag to detects initialization status of a evproc library */
 static uint8_t c_isInit = 0;
-
-/*!  Queue size. Should be not more than  \ref EVPROC_QUEUE_SIZE */
-static uint8_t	c_queueSize = 0;
 /*==============================================================================
                              LOCAL PROTOTYPES
 ==============================================================================*/
 static	void 				_evproc_init(void);
-static	en_evprocResCode_t	_evproc_pushEvent(c_event_t c_event_type, p_data_t data);
+static	en_evprocResCode_t	_evproc_pushEvent(c_event_t c_event_type, p_data_t data,
+												pfn_callback_t pfn_dest);
+static	uint16_t			_evproc_hash(c_event_t c_eventType, p_data_t p_data);
+static	uint8_t				_evproc_lookupEvent(st_evQueue_t * pst_queue,
+												c_event_t c_eventType,
+												p_data_t p_data);
 /*==============================================================================
                              LOCAL FUNCTIONS
 ==============================================================================*/
@@ -135,20 +152,14 @@ static	en_evprocResCode_t	_evproc_pushEvent(c_event_t c_event_type, p_data_t dat
 void _evproc_init(void)
 {
 	uint8_t	i,j;
-	// Initialize variable by predefined event types macro
-	uint8_t pc_eventTypes[EVENT_TYPES_COUNT] = EVENT_TYPES;
 
-	// Nullify event queue
-	for (i = 0;i < EVPROC_QUEUE_SIZE; i++) {
-		pst_evList[i].c_event = EVENT_TYPE_NONE;
-		pst_evList[i].p_data = NULL;
-	}
+	// Nullify event queues and duplicate filter
+	memset(pst_evQueue, 0, sizeof(pst_evQueue));
+	memset(pi_dupFilter, 0, sizeof(pi_dupFilter));
 
 	// Assign every callback for every event by NULL pointer
 	for(i=0; i<EVENT_TYPES_COUNT; i++)
 	{
-		// Set "i" event from the list by the one from eventTypes array
-		pst_regList[i].c_event = pc_eventTypes[i];
 		for(j=0;j<MAX_CALLBACK_COUNT;j++)
 		{
 			// Assign "j" callback from the list to NULL pointer
@@ -164,56 +175,93 @@ void _evproc_init(void)
 /*!
 	\brief	Process input event
 
-            Call registered on input event callback functions one-by-one
+            Call the destination function or, if no destination was given,
+            registered on input event callback functions one-by-one
 
 	\param	c_event_type		Type of event on which we want to register callback
-	\param	callback		Pointer on the function which should be called
-							whenever c_event_type was generated
+	\param	p_data			Data linked with the event
+	\param	pfn_dest		Destination function or NULL
 
 	\retval	E_UNKNOWN_TYPE		Unknown event type
 	\retval	E_SUCCESS			All callbacks has been called
 
 */
 /*============================================================================*/
-en_evprocResCode_t	_evproc_pushEvent(c_event_t c_eventType, p_data_t p_data)
+en_evprocResCode_t	_evproc_pushEvent(c_event_t c_eventType, p_data_t p_data,
+										pfn_callback_t pfn_dest)
 {
-	uint8_t i,j;
-	// Search for a given event type and try to add given function pointer
-	// to the end of a registration list
-	for(i=0; i<EVENT_TYPES_COUNT; i++)
+	uint8_t j;
+	st_funcReg_t * pst_reg;
+
+	if (pfn_dest != NULL) {
+		pfn_dest(c_eventType, p_data);
+		return E_SUCCESS;
+	}
+
+	if ((c_eventType == EVENT_TYPE_NONE) || (c_eventType > EVENT_TYPES_COUNT)) {
+		LOG_ERR("unknown type (0x%04X)\n\r", c_eventType);
+		return E_UNKNOWN_TYPE;
+	}
+
+	// Event type has been found, now call registered callbacks until the
+	// end of a list, marked with a NULL pointer, has been reached
+	pst_reg = &pst_regList[EVPROC_EVENT_IDX(c_eventType)];
+	for (j = 0; (j < MAX_CALLBACK_COUNT) && (pst_reg->pfn_callbList[j] != NULL); j++)
 	{
-		// Find given c_eventType in registered list. If no event matches
-		// then generate error code
-		if(pst_regList[i].c_event == c_eventType)
-		{
-			// Event type has been found, now search for registered callbacks
-			for (j = 0; j < MAX_CALLBACK_COUNT; j++)
-			{
-				// If points to a NULL pointer the end of a list has been reached
-				if (pst_regList[i].pfn_callbList[j] == NULL)
-					return E_SUCCESS;
-				// In every other cases callback should be called
-				else {
-					pst_regList[i].pfn_callbList[j](c_eventType, p_data);
-				}
-			} /* for */
-			return E_SUCCESS;
-		} /* if */
+		pst_reg->pfn_callbList[j](c_eventType, p_data);
 	} /* for */
+	return E_SUCCESS;
+}
+
+/*============================================================================*/
+/*!
+	\brief	Calculate a bucket of the duplicate filter for an event
+
+	\param	c_eventType		Type of an event
+	\param	p_data			Data linked with an event
+
+	\return	index in \ref pi_dupFilter
+*/
+/*============================================================================*/
+static uint16_t _evproc_hash(c_event_t c_eventType, p_data_t p_data)
+{
+	uint32_t l_key = (uint32_t)(uintptr_t)p_data ^ ((uint32_t)c_eventType << 24);
 
-	LOG_ERR("unknown type (0x%04X)\n\r", c_eventType);
-	return E_UNKNOWN_TYPE;
+	// Multiplicative hashing, the upper bits depend on all bits of the key,
+	// so aligned pointers as well as small integers are spread evenly
+	l_key *= 0x9E3779B1u;
+	return (uint16_t)((l_key >> 16) & (EVPROC_DUPFILTER_SIZE - 1));
 }
 
-uint8_t	_evproc_lookupEvent(c_event_t c_eventType,p_data_t 	p_data)
+/*============================================================================*/
+/*!
+	\brief	Check if an event is already in a queue
+
+			A zero counter in the duplicate filter guarantees the event is not
+			queued, so the queue has to be scanned only on a filter hit.
+
+	\param	pst_queue		Queue of the priority class of an event
+	\param	c_eventType		Type of an event
+	\param	p_data			Data linked with an event
+
+	\return	1 if the same event is already queued, 0 otherwise
+*/
+/*============================================================================*/
+static uint8_t _evproc_lookupEvent(st_evQueue_t * pst_queue,
+									c_event_t c_eventType,
+									p_data_t p_data)
 {
-	uint8_t i;
-	if (c_queueSize != 0) {
-		for (i=0; i<c_queueSize;i++) {
-			if ((pst_evList[i].c_event == c_eventType) && \
-				(pst_evList[i].p_data == p_data))
-				return 1;
-		}
+	uint16_t i;
+	uint16_t i_idx;
+
+	if (pi_dupFilter[_evproc_hash(c_eventType, p_data)] == 0)
+		return 0;
+
+	for (i = 0; i < pst_queue->i_count; i++) {
+		i_idx = (pst_queue->i_head + i) & (EVPROC_QUEUE_SIZE - 1);
+		if ((pst_queue->pst_ev[i_idx].c_event == c_eventType) && \
+			(pst_queue->pst_ev[i_idx].p_data == p_data))
+			return 1;
 	}
 	return 0;
 }
@@ -228,7 +276,8 @@ uint8_t	_evproc_lookupEvent(c_event_t c_eventType,p_data_t 	p_data)
 /*============================================================================*/
 en_evprocResCode_t evproc_regCallback(c_event_t c_eventType, pfn_callback_t pfn_callback)
 {
-	uint8_t i,j;
+	uint8_t j;
+	st_funcReg_t * pst_reg;
 
 	// If event process wasn't initialized before do it now.
 	if (!c_isInit)
@@ -240,46 +289,38 @@ en_evprocResCode_t evproc_regCallback(c_event_t c_eventType, pfn_callback_t pfn_
 		return E_INVALID_PARAM;
 	} /* if */
 
-	// Search for a given event type and try to add given function pointer
-	// to the end of a registration list
-	for(i=0; i<EVENT_TYPES_COUNT; i++)
+	if ((c_eventType == EVENT_TYPE_NONE) || (c_eventType > EVENT_TYPES_COUNT)) {
+		LOG_ERR("unknown event type (0x%02X)\n\r", c_eventType);
+		return E_UNKNOWN_TYPE;
+	}
+
+	// Try to add given function pointer to the end of a registration list
+	pst_reg = &pst_regList[EVPROC_EVENT_IDX(c_eventType)];
+	for(j=0; j<MAX_CALLBACK_COUNT; j++)
 	{
-		// Find given c_eventType in registered list. If no event matches
-		// then generate error code
-		if(pst_regList[i].c_event == c_eventType)
-		{
-			// Event type has been found, now search for registered callbacks
-			for(j=0; j<MAX_CALLBACK_COUNT; j++)
-			{
-				// If "j" callback from registration list points to NULL
-				// it means that end of a list has been reached.
-				if(pst_regList[i].pfn_callbList[j] == NULL) {
-					// Given function pointer for a given event type has been added
-					LOG_INFO("new callback for (%d) event with callback %p\n\r", c_eventType, pfn_callback);
-					pst_regList[i].pfn_callbList[j] = pfn_callback;
-					return E_SUCCESS;
-				} /* if */
-
-				// If "j" callback is equal to a given function pointer
-				// it means that this function for a given event has been
-				// registered yet.
-				if(pst_regList[i].pfn_callbList[j] == pfn_callback) {
-					LOG_ERR(" (%d) already registered\n\r",c_eventType);
-					return E_FUNC_IN_LIST;
-				} /* if */
-
-			} /* for */
-
-			// If end of the registration list has been reached and
-			// c_callbI index are equal to a maximum allowed callbacks
-			// generate an error.
-			LOG_ERR("limit is reached (%d)\n\r", MAX_CALLBACK_COUNT);
-			return E_END_OF_LIST;
+		// If "j" callback from registration list points to NULL
+		// it means that end of a list has been reached.
+		if(pst_reg->pfn_callbList[j] == NULL) {
+			// Given function pointer for a given event type has been added
+			LOG_INFO("new callback for (%d) event with callback %p\n\r", c_eventType, pfn_callback);
+			pst_reg->pfn_callbList[j] = pfn_callback;
+			return E_SUCCESS;
+		} /* if */
+
+		// If "j" callback is equal to a given function pointer
+		// it means that this function for a given event has been
+		// registered yet.
+		if(pst_reg->pfn_callbList[j] == pfn_callback) {
+			LOG_ERR(" (%d) already registered\n\r",c_eventType);
+			return E_FUNC_IN_LIST;
 		} /* if */
 	} /* for */
 
-	LOG_ERR("unknown event type (0x%02X)\n\r", c_eventType);
-	return E_UNKNOWN_TYPE;
+	// If end of the registration list has been reached and
+	// c_callbI index are equal to a maximum allowed callbacks
+	// generate an error.
+	LOG_ERR("limit is reached (%d)\n\r", MAX_CALLBACK_COUNT);
+	return E_END_OF_LIST;
 }
 
 /*============================================================================*/
@@ -287,35 +328,30 @@ en_evprocResCode_t evproc_regCallback(c_event_t c_eventType, pfn_callback_t pfn_
 /*============================================================================*/
 en_evprocResCode_t evproc_unregCallback(c_event_t c_eventType, pfn_callback_t pfn_callback)
 {
-	uint8_t i,j;
+	uint8_t j;
+	st_funcReg_t * pst_reg;
 
-	// Search for a given event type and try to add given function pointer
-	// to the end of a registration list
-	for(i=0; i<EVENT_TYPES_COUNT; i++)
+	if ((c_eventType == EVENT_TYPE_NONE) || (c_eventType > EVENT_TYPES_COUNT)) {
+		LOG_ERR(" unknown event type (0x%04X)\n\r", c_eventType);
+		return E_UNKNOWN_TYPE;
+	}
+
+	pst_reg = &pst_regList[EVPROC_EVENT_IDX(c_eventType)];
+	for(j=0; j<MAX_CALLBACK_COUNT; j++)
 	{
-		// Find given c_eventType in registered list. If no event matches
-		// then generate error code
-		if(pst_regList[i].c_event == c_eventType)
-		{
-			// Event type has been found, now search for registered callbacks
-			for(j=0; j<MAX_CALLBACK_COUNT; j++)
-			{
-				// If "j" callback is equal to a given function pointer
-				// it means that this function for a given event has been
-				// found.
-				if(pst_regList[i].pfn_callbList[j] == pfn_callback) {
-					pst_regList[i].pfn_callbList[j] = NULL;
-					return E_SUCCESS;
-				} /* if */
-			} /* for */
-
-			LOG_ERR("%s\n\r","function wasn't registered");
-			return E_NO_SUCH_FUNC;
+		// If "j" callback is equal to a given function pointer
+		// it means that this function for a given event has been
+		// found. Shift the rest of a list to keep it NULL terminated.
+		if(pst_reg->pfn_callbList[j] == pfn_callback) {
+			for(; j<(MAX_CALLBACK_COUNT - 1); j++)
+				pst_reg->pfn_callbList[j] = pst_reg->pfn_callbList[j + 1];
+			pst_reg->pfn_callbList[MAX_CALLBACK_COUNT - 1] = NULL;
+			return E_SUCCESS;
 		} /* if */
 	} /* for */
 
-	LOG_ERR(" unknown event type (0x%04X)\n\r", c_eventType);
-	return E_UNKNOWN_TYPE;
+	LOG_ERR("%s\n\r","function wasn't registered");
+	return E_NO_SUCH_FUNC;
 }
 
 /*============================================================================*/
@@ -325,64 +361,72 @@ en_evprocResCode_t evproc_putEvent(		en_evprocAction_t 	e_actType, \
 										c_event_t 			c_eventType, \
 										p_data_t 			p_data)
 {
-	int8_t i;
-	bsp_enterCritical();
-	switch (e_actType)
-	{
-		case  E_EVPROC_HEAD:
-			if (c_queueSize == EVPROC_QUEUE_SIZE) {
-			//	printf("Not enogh space in a queue\n\r");
-				bsp_exitCritical();
-				return E_END_OF_LIST;
-			}
-			if ((c_eventType < OBLIG_EVENT_PRIOR) && (_evproc_lookupEvent(c_eventType,p_data))) {
-				// Event has low priority and already in a queue
-			}
-			else {
-				LOG_INFO("head %d : %p\n\r",c_eventType,p_data);
-				pst_evList[c_queueSize].c_event = c_eventType;
-				pst_evList[c_queueSize].p_data = p_data;
-				c_queueSize++;
-			}
-			bsp_exitCritical();
-			break;
-		case  E_EVPROC_TAIL:
-			if (c_queueSize == EVPROC_QUEUE_SIZE) {
-			//	printf("Not enough space in a queue\n\r");
-				bsp_exitCritical();
-				return E_END_OF_LIST;
-			}
-			if ((c_eventType < OBLIG_EVENT_PRIOR) && (_evproc_lookupEvent(c_eventType,p_data))) {
-				// Event has low priority and already in a queue
-			}
-			else {
-
-				for (i=c_queueSize; i > 0; i--) {
-					pst_evList[i].c_event = pst_evList[i - 1].c_event;
-					pst_evList[i].p_data = pst_evList[i - 1].p_data;
-					//memcpy((&pst_evList + i),(&pst_evList + (i-1)),sizeof(st_eventDisc_t));
-				}
-				LOG_INFO("tail %d : %p\n\r",c_eventType,p_data);
-				pst_evList[0].c_event = c_eventType;
-				pst_evList[0].p_data = p_data;
-				c_queueSize++;
-			}
-			bsp_exitCritical();
-			break;
-		case  E_EVPROC_EXEC:
-			LOG_INFO("Execute event %d\n\r",c_eventType);
-			bsp_exitCritical();
-			if (!_evproc_pushEvent(c_eventType,p_data)) {
-				return E_UNKNOWN_TYPE;
-			}
-			break;
-		default:
-			LOG_INFO("%s","Not known\n\r");
-			bsp_exitCritical();
+	return evproc_putEventTo(e_actType, c_eventType, p_data, NULL);
+} /* evproc_putEvent() */
+
+/*============================================================================*/
+/*  evproc_putEventTo()    				                                     */
+/*============================================================================*/
+en_evprocResCode_t evproc_putEventTo(	en_evprocAction_t 	e_actType, \
+										c_event_t 			c_eventType, \
+										p_data_t 			p_data, \
+										pfn_callback_t		pfn_dest)
+{
+	en_evprocPrio_t	e_prio;
+	st_evQueue_t *	pst_queue;
+	uint16_t		i_idx;
+
+	if (e_actType == E_EVPROC_EXEC) {
+		LOG_INFO("Execute event %d\n\r",c_eventType);
+		if (!_evproc_pushEvent(c_eventType,p_data,pfn_dest)) {
 			return E_UNKNOWN_TYPE;
+		}
+		return E_SUCCESS;
+	}
+
+	if ((e_actType != E_EVPROC_HEAD) && (e_actType != E_EVPROC_TAIL)) {
+		LOG_INFO("%s","Not known\n\r");
+		return E_UNKNOWN_TYPE;
+	}
+
+	e_prio = EVPROC_EVENT_PRIO(c_eventType);
+	pst_queue = &pst_evQueue[e_prio];
+
+	bsp_enterCritical();
+	if (pst_queue->i_count == EVPROC_QUEUE_SIZE) {
+		bsp_exitCritical();
+		return E_END_OF_LIST;
+	}
+
+	if ((e_prio != E_EVPROC_PRIO_RADIO) && \
+		(_evproc_lookupEvent(pst_queue, c_eventType, p_data))) {
+		// Event has low priority and already in a queue
+		bsp_exitCritical();
+		return E_SUCCESS;
+	}
+
+	if (e_actType == E_EVPROC_HEAD) {
+		LOG_INFO("head %d : %p\n\r",c_eventType,p_data);
+		pst_queue->i_head = (pst_queue->i_head - 1) & (EVPROC_QUEUE_SIZE - 1);
+		i_idx = pst_queue->i_head;
 	}
+	else {
+		LOG_INFO("tail %d : %p\n\r",c_eventType,p_data);
+		i_idx = (pst_queue->i_head + pst_queue->i_count) & (EVPROC_QUEUE_SIZE - 1);
+	}
+	pst_queue->pst_ev[i_idx].c_event = c_eventType;
+	pst_queue->pst_ev[i_idx].p_data = p_data;
+	pst_queue->pst_ev[i_idx].pfn_dest = pfn_dest;
+	pst_queue->i_count++;
+
+	if (e_prio != E_EVPROC_PRIO_RADIO)
+		pi_dupFilter[_evproc_hash(c_eventType, p_data)]++;
+	bsp_exitCritical();
+
+	// Event may be posted from an interrupt while main loop is sleeping
+	bsp_wakeup();
 	return E_SUCCESS;
-} /* evproc_putEvent() */
+} /* evproc_putEventTo() */
 
 
 /*============================================================================*/
@@ -390,25 +434,54 @@ en_evprocResCode_t evproc_putEvent(		en_evprocAction_t 	e_actType, \
 /*============================================================================*/
 en_evprocResCode_t evproc_nextEvent(void)
 {
-	st_eventDisc_t nextEvent = {NULL,0};
+	st_eventDisc_t nextEvent = {NULL,NULL,0};
+	st_evQueue_t * pst_queue = NULL;
 	uint8_t i;
-	if (c_queueSize > 0) {
-		bsp_enterCritical();
-		LOG_INFO("%s\n\r","Event queue");
-		for (i=0; i<c_queueSize;i++)
-			LOG_RAW("%d | ev = %d : %p\n\r",i,pst_evList[i].c_event,pst_evList[i].p_data);
-		nextEvent.c_event = pst_evList[c_queueSize-1].c_event;
-		nextEvent.p_data = pst_evList[c_queueSize-1].p_data;
-		pst_evList[c_queueSize-1].c_event = 0;
-		pst_evList[c_queueSize-1].p_data = NULL;
-		c_queueSize--;
-		bsp_exitCritical();
-		if (!_evproc_pushEvent(nextEvent.c_event,nextEvent.p_data)) {
-			return E_UNKNOWN_TYPE;
+
+	bsp_enterCritical();
+	// Take the first non-empty queue with the highest priority
+	for (i = 0; i < E_EVPROC_PRIO_COUNT; i++) {
+		if (pst_evQueue[i].i_count > 0) {
+			pst_queue = &pst_evQueue[i];
+			break;
 		}
-		return E_SUCCESS;
 	}
-	return E_QUEUE_EMPTY;
+
+	if (pst_queue == NULL) {
+		bsp_exitCritical();
+		return E_QUEUE_EMPTY;
+	}
+
+	nextEvent = pst_queue->pst_ev[pst_queue->i_head];
+	pst_queue->pst_ev[pst_queue->i_head].c_event = EVENT_TYPE_NONE;
+	pst_queue->pst_ev[pst_queue->i_head].p_data = NULL;
+	pst_queue->pst_ev[pst_queue->i_head].pfn_dest = NULL;
+	pst_queue->i_head = (pst_queue->i_head + 1) & (EVPROC_QUEUE_SIZE - 1);
+	pst_queue->i_count--;
+
+	if (i != E_EVPROC_PRIO_RADIO)
+		pi_dupFilter[_evproc_hash(nextEvent.c_event, nextEvent.p_data)]--;
+	bsp_exitCritical();
+
+	LOG_INFO("next ev = %d : %p\n\r",nextEvent.c_event,nextEvent.p_data);
+	if (!_evproc_pushEvent(nextEvent.c_event,nextEvent.p_data,nextEvent.pfn_dest)) {
+		return E_UNKNOWN_TYPE;
+	}
+	return E_SUCCESS;
 } /* evproc_nextEvent() */
 
+/*============================================================================*/
+/*  evproc_pending()    				                                     */
+/*============================================================================*/
+uint8_t evproc_pending(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < E_EVPROC_PRIO_COUNT; i++) {
+		if (pst_evQueue[i].i_count > 0)
+			return 1;
+	}
+	return 0;
+} /* evproc_pending() */
+
 /** @} */
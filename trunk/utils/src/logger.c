@@ -0,0 +1,264 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ *   \addtogroup utils
+ *   @{
+*/
+/*!
+    \file   logger.c
+
+    \brief  Deferred logging. A message is stored in a ring as
+
+            length (1 byte), timestamp in microseconds (4 bytes),
+            offset of the format string in LOGGER_SECTION (4 bytes),
+            arguments
+
+            The arguments keep the size and byte order they have on the
+            target, strings are copied with their terminating zero. The
+            decoder finds the sizes from the format string and the type of
+            the program file.
+
+  \version  0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                             INCLUDE FILES
+==============================================================================*/
+#include "emb6.h"
+#include "emb6_conf.h"
+
+#include "bsp.h"
+#include "logger.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#if LOGGER_DEFERRED
+/*==============================================================================
+                             LOCAL MACROS
+==============================================================================*/
+#define LOGGER_MASK				(LOGGER_RING_SIZE - 1)
+/// Size of the header of a message
+#define LOGGER_HDR_SIZE			9
+
+#if (LOGGER_RING_SIZE & LOGGER_MASK) || (LOGGER_RING_SIZE > 0x8000)
+#error "LOGGER_RING_SIZE must be a power of two"
+#endif
+
+/*==============================================================================
+                             LOCAL VARIABLES
+==============================================================================*/
+/// Stored messages
+static uint8_t					gpc_logRing[LOGGER_RING_SIZE];
+/// Index of the next byte to write, runs freely
+static volatile uint16_t		i_logHead;
+/// Index of the next byte to read, runs freely
+static volatile uint16_t		i_logTail;
+/// Messages dropped because the ring was full
+static volatile uint32_t		l_logLost;
+/// Number of lost messages already reported
+static uint32_t					l_logReported;
+
+/// Start of the format strings, provided by the linker
+extern const char				__start_emb6_logstr[];
+
+/*==============================================================================
+                             LOCAL FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/*  _logger_arg()                                                             */
+/*============================================================================*/
+static uint8_t _logger_arg(uint8_t * pc_rec, uint8_t c_len, const void * p_arg,
+		uint8_t c_size)
+{
+	if (c_len + c_size > LOGGER_MAX_RECORD)
+		return c_len;
+	memcpy(pc_rec + c_len, p_arg, c_size);
+	return c_len + c_size;
+} /* _logger_arg() */
+
+/*==============================================================================
+                             API FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/*  logger_put()                                                              */
+/*============================================================================*/
+void logger_put(const char * pc_fmt, ...)
+{
+	uint8_t			pc_rec[LOGGER_MAX_RECORD];
+	uint8_t			c_len = LOGGER_HDR_SIZE;
+	uint32_t		l_val;
+	uint16_t		i_free;
+	uint16_t		i_idx;
+	uint16_t		i_part;
+	const char *	pc;
+	char			c_lenMod;
+	va_list			args;
+
+	l_val = (uint32_t)bsp_getTimeUs();
+	memcpy(&pc_rec[1], &l_val, 4);
+	l_val = (uint32_t)(pc_fmt - __start_emb6_logstr);
+	memcpy(&pc_rec[5], &l_val, 4);
+
+	/* Only the types of the arguments are taken from the format */
+	va_start(args, pc_fmt);
+	for (pc = pc_fmt; *pc != '\0'; pc++) {
+		if (*pc != '%')
+			continue;
+		if (*++pc == '%')
+			continue;
+		while ((*pc != '\0') && (strchr("-+ #0", *pc) != NULL))
+			pc++;
+		for (; ((*pc >= '0') && (*pc <= '9')) || (*pc == '.') || (*pc == '*'); pc++) {
+			if (*pc == '*') {
+				int		i_arg = va_arg(args, int);
+				c_len = _logger_arg(pc_rec, c_len, &i_arg, sizeof(i_arg));
+			}
+		}
+		c_lenMod = 0;
+		while ((*pc != '\0') && (strchr("hlLjzt", *pc) != NULL)) {
+			/* "ll" is stored as 'q' */
+			c_lenMod = ((c_lenMod == 'l') && (*pc == 'l')) ? 'q' : *pc;
+			pc++;
+		}
+		if (*pc == '\0')
+			break;
+		switch (*pc) {
+		case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+			if (c_lenMod == 'l') {
+				long	l_arg = va_arg(args, long);
+				c_len = _logger_arg(pc_rec, c_len, &l_arg, sizeof(l_arg));
+			} else if ((c_lenMod == 'q') || (c_lenMod == 'j')) {
+				long long	ll_arg = va_arg(args, long long);
+				c_len = _logger_arg(pc_rec, c_len, &ll_arg, sizeof(ll_arg));
+			} else if ((c_lenMod == 'z') || (c_lenMod == 't')) {
+				size_t	z_arg = va_arg(args, size_t);
+				c_len = _logger_arg(pc_rec, c_len, &z_arg, sizeof(z_arg));
+			} else {
+				int		i_arg = va_arg(args, int);
+				c_len = _logger_arg(pc_rec, c_len, &i_arg, sizeof(i_arg));
+			}
+			break;
+		case 'p': {
+				void *	p_arg = va_arg(args, void *);
+				c_len = _logger_arg(pc_rec, c_len, &p_arg, sizeof(p_arg));
+			}
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+				double	d_arg = (c_lenMod == 'L') ?
+						(double)va_arg(args, long double) : va_arg(args, double);
+				c_len = _logger_arg(pc_rec, c_len, &d_arg, sizeof(d_arg));
+			}
+			break;
+		case 's': {
+				const char *	pc_arg = va_arg(args, const char *);
+				if (pc_arg == NULL)
+					pc_arg = "(null)";
+				/* Cut strings which do not fit, keeping the zero */
+				while ((c_len < LOGGER_MAX_RECORD - 1) && (*pc_arg != '\0'))
+					pc_rec[c_len++] = *pc_arg++;
+				if (c_len < LOGGER_MAX_RECORD)
+					pc_rec[c_len++] = '\0';
+			}
+			break;
+		case 'n':
+			(void)va_arg(args, void *);
+			break;
+		default:
+			break;
+		}
+	}
+	va_end(args);
+	pc_rec[0] = c_len;
+
+	/* Producers may interrupt each other, the copy is done atomically */
+	bsp_enterCritical();
+	i_free = LOGGER_RING_SIZE - (uint16_t)(i_logHead - i_logTail);
+	if (i_free < c_len) {
+		l_logLost++;
+	} else {
+		i_idx = i_logHead & LOGGER_MASK;
+		i_part = LOGGER_RING_SIZE - i_idx;
+		if (i_part > c_len)
+			i_part = c_len;
+		memcpy(&gpc_logRing[i_idx], pc_rec, i_part);
+		memcpy(gpc_logRing, pc_rec + i_part, c_len - i_part);
+		i_logHead += c_len;
+	}
+	bsp_exitCritical();
+} /* logger_put() */
+
+/*============================================================================*/
+/*  logger_flush()                                                            */
+/*============================================================================*/
+uint8_t logger_flush(uint16_t i_max)
+{
+	char		pc_line[sizeof(LOGGER_LINE_PREFIX) + 2 * LOGGER_MAX_RECORD];
+	char *		pc_out;
+	uint8_t		c_len;
+	uint8_t		c_byte;
+	uint8_t		i;
+
+	if (l_logLost != l_logReported) {
+		l_logReported = l_logLost;
+		printf(LOGGER_LOST_PREFIX "%lu\r\n", (unsigned long)l_logReported);
+	}
+	while ((i_max-- > 0) && (i_logTail != i_logHead)) {
+		c_len = gpc_logRing[i_logTail & LOGGER_MASK];
+		strcpy(pc_line, LOGGER_LINE_PREFIX);
+		pc_out = pc_line + sizeof(LOGGER_LINE_PREFIX) - 1;
+		for (i = 0; i < c_len; i++) {
+			c_byte = gpc_logRing[(i_logTail + i) & LOGGER_MASK];
+			*pc_out++ = "0123456789abcdef"[c_byte >> 4];
+			*pc_out++ = "0123456789abcdef"[c_byte & 0x0F];
+		}
+		*pc_out = '\0';
+		/* The space is given back after the message was copied */
+		i_logTail += c_len;
+		printf("%s\r\n", pc_line);
+	}
+	return i_logTail != i_logHead;
+} /* logger_flush() */
+
+#endif /* LOGGER_DEFERRED */
+/** @} */
@@ -52,51 +52,68 @@ memb_init(struct memb *m)
 {
   memset(m->count, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+  m->free_head = 0;
+  m->fresh = 0;
+  m->used = 0;
+  m->used_max = 0;
+  m->failed = 0;
 }
 /*---------------------------------------------------------------------------*/
 void *
 memb_alloc(struct memb *m)
 {
-  int i;
+  unsigned short i;
 
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      /* If this block was unused, we increase the reference count to
-	 indicate that it now is used and return a pointer to the
-	 memory block. */
-      ++(m->count[i]);
-      return (void *)((char *)m->mem + (i * m->size));
-    }
+  if(m->free_head != 0) {
+    /* Take the first block of the free list. */
+    i = m->free_head - 1;
+    m->free_head = m->next[i];
+  } else if(m->fresh < m->num) {
+    /* Take a block which was never used before. */
+    i = m->fresh++;
+  } else {
+    /* No free block was found, so we return NULL to indicate failure to
+       allocate block. */
+    ++(m->failed);
+    return NULL;
   }
 
-  /* No free block was found, so we return NULL to indicate failure to
-     allocate block. */
-  return NULL;
+  /* We increase the reference count to indicate that the block now is
+     used and return a pointer to the memory block. */
+  ++(m->count[i]);
+  if(++(m->used) > m->used_max) {
+    m->used_max = m->used;
+  }
+  return (void *)((char *)m->mem + (i * m->size));
 }
 /*---------------------------------------------------------------------------*/
 char
 memb_free(struct memb *m, void *ptr)
 {
-  int i;
-  char *ptr2;
+  unsigned int offset;
+  unsigned short i;
+
+  /* Find the block to which the pointer "ptr" points to. */
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  i = offset / m->size;
 
-  /* Walk through the list of blocks and try to find the block to
-     which the pointer "ptr" points to. */
-  ptr2 = (char *)m->mem;
-  for(i = 0; i < m->num; ++i) {
-    
-    if(ptr2 == (char *)ptr) {
-      /* We've found to block to which "ptr" points so we decrease the
-	 reference count and return the new value of it. */
-      if(m->count[i] > 0) {
-	/* Make sure that we don't deallocate free memory. */
-	--(m->count[i]);
-      }
-      return m->count[i];
+  /* Make sure that we don't deallocate free memory. */
+  if(m->count[i] > 0) {
+    --(m->count[i]);
+    if(m->count[i] == 0) {
+      /* Put the block to the front of the free list. */
+      m->next[i] = m->free_head;
+      m->free_head = i + 1;
+      --(m->used);
     }
-    ptr2 += m->size;
   }
-  return -1;
+  return m->count[i];
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -109,16 +126,19 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
-  int i;
-  int num_free = 0;
-
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      ++num_free;
-    }
-  }
-
-  return num_free;
+  return m->num - m->used;
+}
+/*---------------------------------------------------------------------------*/
+int
+memb_maxused(struct memb *m)
+{
+  return m->used_max;
+}
+/*---------------------------------------------------------------------------*/
+int
+memb_numfailed(struct memb *m)
+{
+  return m->failed;
 }
 
 /** @} */
@@ -44,6 +44,7 @@
  */
 
 
+#include "emb6_conf.h"
 #include "mmem.h"
 #include "clist.h"
 //#include "lib_conf.h"
@@ -55,10 +56,58 @@
 #define MMEM_SIZE 4096
 #endif
 
+#ifdef MMEM_CONF_BACKEND
+#define MMEM_BACKEND MMEM_CONF_BACKEND
+#else
+#define MMEM_BACKEND MMEM_BACKEND_COMPACT
+#endif
+
+#if MMEM_BACKEND == MMEM_BACKEND_SLAB
+/* Smallest block is 2^MMEM_SLAB_MIN_SHIFT bytes, it has to hold a pointer
+   for the free list. */
+#define MMEM_SLAB_MIN_SHIFT 3
+/* Amount of size classes, the largest block is 2^(MIN_SHIFT + CLASSES - 1). */
+#define MMEM_SLAB_CLASSES   14
+#endif /* MMEM_BACKEND */
+
+static struct mmem_stats stats;
+
+#if MMEM_BACKEND == MMEM_BACKEND_COMPACT
 LIST(mmemlist);
 unsigned int avail_memory;
 static char memory[MMEM_SIZE];
+#elif MMEM_BACKEND == MMEM_BACKEND_SLAB
+/* Memory is carved into power of two blocks from the bottom, freed blocks
+   are kept in a free list per size class and never merged. */
+static union {
+  char c[MMEM_SIZE];
+  void *align;
+} memory;
+static unsigned int slab_top;
+static void *slab_free[MMEM_SLAB_CLASSES];
+#else
+#error "Unknown MMEM_BACKEND"
+#endif /* MMEM_BACKEND */
 
+#if MMEM_BACKEND == MMEM_BACKEND_SLAB
+/*---------------------------------------------------------------------------*/
+/* Get the size of the blocks of a size class. The largest class exceeds a
+   16 bit int. */
+#define SLAB_BLOCK(cls) (1UL << ((cls) + MMEM_SLAB_MIN_SHIFT))
+/*---------------------------------------------------------------------------*/
+/* Get the smallest size class which holds the given amount of bytes,
+   MMEM_SLAB_CLASSES if the size exceeds the largest class. */
+static unsigned char
+slab_class(unsigned int size)
+{
+  unsigned char cls = 0;
+
+  while(cls < MMEM_SLAB_CLASSES && SLAB_BLOCK(cls) < size) {
+    ++cls;
+  }
+  return cls;
+}
+#endif /* MMEM_BACKEND */
 /*---------------------------------------------------------------------------*/
 /**
  * \brief      Allocate a managed memory block
@@ -82,8 +131,10 @@ static char memory[MMEM_SIZE];
 int
 mmem_alloc(struct mmem *m, unsigned int size)
 {
+#if MMEM_BACKEND == MMEM_BACKEND_COMPACT
   /* Check if we have enough memory left for this allocation. */
   if(avail_memory < size) {
+    ++stats.failed;
     return 0;
   }
 
@@ -100,6 +151,54 @@ mmem_alloc(struct mmem *m, unsigned int size)
 
   /* Decrease the amount of available memory. */
   avail_memory -= size;
+  stats.requested += size;
+  stats.reserved += size;
+  stats.avail = avail_memory;
+#else /* MMEM_BACKEND */
+  unsigned char cls = slab_class(size);
+  unsigned char i;
+  unsigned long block;
+
+  if(cls >= MMEM_SLAB_CLASSES) {
+    ++stats.failed;
+    return 0;
+  }
+  block = SLAB_BLOCK(cls);
+
+  if(slab_free[cls] != NULL) {
+    /* Reuse a free block of the same size class. */
+    m->ptr = slab_free[cls];
+    slab_free[cls] = *(void **)m->ptr;
+    stats.cached -= block;
+  } else if(MMEM_SIZE - slab_top >= block) {
+    /* Carve a new block from the unused memory. */
+    m->ptr = &memory.c[slab_top];
+    slab_top += block;
+    stats.avail -= block;
+  } else {
+    /* Fall back to a free block of a larger size class. */
+    for(i = cls + 1; i < MMEM_SLAB_CLASSES; ++i) {
+      if(slab_free[i] != NULL) {
+        break;
+      }
+    }
+    if(i == MMEM_SLAB_CLASSES) {
+      ++stats.failed;
+      return 0;
+    }
+    cls = i;
+    block = SLAB_BLOCK(cls);
+    m->ptr = slab_free[cls];
+    slab_free[cls] = *(void **)m->ptr;
+    stats.cached -= block;
+  }
+
+  m->next = NULL;
+  m->size = size;
+  m->cls = cls;
+  stats.requested += size;
+  stats.reserved += block;
+#endif /* MMEM_BACKEND */
 
   /* Return non-zero to indicate that we were able to allocate
      memory. */
@@ -118,6 +217,7 @@ mmem_alloc(struct mmem *m, unsigned int size)
 void
 mmem_free(struct mmem *m)
 {
+#if MMEM_BACKEND == MMEM_BACKEND_COMPACT
   struct mmem *n;
 
   if(m->next != NULL) {
@@ -134,9 +234,22 @@ mmem_free(struct mmem *m)
   }
 
   avail_memory += m->size;
+  stats.requested -= m->size;
+  stats.reserved -= m->size;
+  stats.avail = avail_memory;
 
   /* Remove the memory block from the list. */
   list_remove(mmemlist, m);
+#else /* MMEM_BACKEND */
+  unsigned long block = SLAB_BLOCK(m->cls);
+
+  /* Put the block to the front of the free list of its size class. */
+  *(void **)m->ptr = slab_free[m->cls];
+  slab_free[m->cls] = m->ptr;
+  stats.requested -= m->size;
+  stats.reserved -= block;
+  stats.cached += block;
+#endif /* MMEM_BACKEND */
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -151,8 +264,30 @@ mmem_free(struct mmem *m)
 void
 mmem_init(void)
 {
+#if MMEM_BACKEND == MMEM_BACKEND_COMPACT
   list_init(mmemlist);
   avail_memory = MMEM_SIZE;
+#else /* MMEM_BACKEND */
+  slab_top = 0;
+  memset(slab_free, 0, sizeof(slab_free));
+#endif /* MMEM_BACKEND */
+  memset(&stats, 0, sizeof(stats));
+  stats.avail = MMEM_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get the usage and fragmentation statistics
+ * \param s    A pointer to the structure to fill
+ *
+ *             reserved - requested is the internal fragmentation,
+ *             cached is memory kept in free blocks which can only be
+ *             reused for blocks of the same or a smaller size class.
+ *
+ */
+void
+mmem_stats(struct mmem_stats *s)
+{
+  *s = stats;
 }
 /*---------------------------------------------------------------------------*/
 
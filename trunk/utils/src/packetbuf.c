@@ -51,21 +51,37 @@
 
 #include "linkaddr.h"
 
-struct packetbuf_attr packetbuf_attrs[PACKETBUF_NUM_ATTRS];
-struct packetbuf_addr packetbuf_addrs[PACKETBUF_NUM_ADDRS];
-
-
-static uint16_t buflen, bufptr;
-static uint8_t hdrptr;
-
-/* The declarations below ensure that the packet buffer is aligned on
+/* A packet descriptor: header room, payload and attributes. The
+   declarations below ensure that the packet buffer is aligned on
    an even 32-bit boundary. On some platforms (most notably the
    msp430 or OpenRISC), having a potentially misaligned packet buffer may lead to
    problems when accessing words. */
-static uint32_t packetbuf_aligned[(PACKETBUF_SIZE + PACKETBUF_HDR_SIZE + 3) / 4];
-static uint8_t *packetbuf = (uint8_t *)packetbuf_aligned;
+struct packetbuf_slot {
+  uint32_t aligned[(PACKETBUF_SIZE + PACKETBUF_HDR_SIZE + 3) / 4];
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  uint8_t *dataptr;
+  uint16_t buflen, bufptr;
+  uint8_t hdrptr;
+  uint8_t used;
+  /* Kept by a queue, see packetbuf_slot_hold() */
+  uint8_t held;
+};
+
+#define NUM_SLOTS (PACKETBUF_SLOTS + PACKETBUF_RX_SLOTS)
+
+static struct packetbuf_slot slots[NUM_SLOTS];
 
-static uint8_t *packetbufptr;
+/* The descriptor the packetbuf_*() functions operate on. */
+static struct packetbuf_slot *cur = &slots[0];
+
+/* Changes with every packet written to the packetbuf */
+static uint16_t generation;
+
+struct packetbuf_attr *packetbuf_attrs = slots[0].attrs;
+struct packetbuf_addr *packetbuf_addrs = slots[0].addrs;
+
+#define packetbuf ((uint8_t *)cur->aligned)
 
 #define DEBUG DEBUG_NONE
 #if DEBUG
@@ -75,21 +91,193 @@ static uint8_t *packetbufptr;
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+static struct packetbuf_slot *
+find_free(void)
+{
+  int i;
+
+  for(i = 0; i < NUM_SLOTS; ++i) {
+    if(!slots[i].used && &slots[i] != cur) {
+      return &slots[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+select_slot(struct packetbuf_slot *s)
+{
+  /* The previous descriptor is handed to the caller */
+  cur->used = 1;
+  cur = s;
+  cur->used = 1;
+  ++generation;
+  packetbuf_attrs = cur->attrs;
+  packetbuf_addrs = cur->addrs;
+  if(cur->dataptr == NULL) {
+    /* Never used before */
+    packetbuf_clear();
+  }
+}
+/*---------------------------------------------------------------------------*/
+struct packetbuf_slot *
+packetbuf_slot_alloc(void)
+{
+  struct packetbuf_slot *s = find_free();
+
+  /* A held current descriptor needs a free one to make way for the
+     next packet */
+  if((s != NULL) && cur->held && (packetbuf_slot_numfree() < 2)) {
+    return NULL;
+  }
+  if(s != NULL) {
+    s->used = 1;
+    s->dataptr = NULL;
+  }
+  return s;
+}
+/*---------------------------------------------------------------------------*/
+/* The held current descriptor makes way for a free one */
+static void
+leave_held(void)
+{
+  struct packetbuf_slot *s = find_free();
+
+  s->dataptr = NULL;
+  select_slot(s);
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_slot_free(struct packetbuf_slot *s)
+{
+  if(s != cur) {
+    s->used = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+struct packetbuf_slot *
+packetbuf_slot_current(void)
+{
+  return cur;
+}
+/*---------------------------------------------------------------------------*/
+struct packetbuf_slot *
+packetbuf_slot_select(struct packetbuf_slot *s)
+{
+  struct packetbuf_slot *prev = cur;
+
+  if(prev->held) {
+    /* The held packet stays, the caller gets a free descriptor */
+    prev = find_free();
+    prev->used = 1;
+    prev->dataptr = NULL;
+  }
+  select_slot(s);
+  return prev;
+}
+/*---------------------------------------------------------------------------*/
+struct packetbuf_slot *
+packetbuf_slot_detach(void)
+{
+  struct packetbuf_slot *s = cur;
+  struct packetbuf_slot *next;
+
+  if(cur->held) {
+    return NULL;
+  }
+  next = packetbuf_slot_alloc();
+  if(next == NULL) {
+    return NULL;
+  }
+  select_slot(next);
+  return s;
+}
+/*---------------------------------------------------------------------------*/
+struct packetbuf_slot *
+packetbuf_slot_hold(void)
+{
+  /* The data must start the descriptor to be restored from it alone */
+  if(cur->held || packetbuf_is_reference() ||
+     (cur->hdrptr != PACKETBUF_HDR_SIZE) || (cur->bufptr != 0) ||
+     (packetbuf_slot_numfree() == 0)) {
+    return NULL;
+  }
+  cur->held = 1;
+  return cur;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_slot_restore(struct packetbuf_slot *s, uint16_t len)
+{
+  if(s != cur) {
+    /* The packet in the packetbuf is replaced */
+    if(!cur->held) {
+      cur->used = 0;
+    }
+    cur = s;
+    packetbuf_attrs = cur->attrs;
+    packetbuf_addrs = cur->addrs;
+    ++generation;
+  }
+  cur->hdrptr = PACKETBUF_HDR_SIZE;
+  cur->bufptr = 0;
+  cur->buflen = len;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_slot_release(struct packetbuf_slot *s)
+{
+  s->held = 0;
+  if(s != cur) {
+    s->used = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint8_t *
+packetbuf_slot_dataptr(struct packetbuf_slot *s)
+{
+  return &((uint8_t *)s->aligned)[PACKETBUF_HDR_SIZE];
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_slot_numfree(void)
+{
+  int i;
+  int num_free = 0;
+
+  for(i = 0; i < NUM_SLOTS; ++i) {
+    if(!slots[i].used && &slots[i] != cur) {
+      ++num_free;
+    }
+  }
+  return num_free;
+}
 /*---------------------------------------------------------------------------*/
 void
 packetbuf_clear(void)
 {
-  buflen = bufptr = 0;
-  hdrptr = PACKETBUF_HDR_SIZE;
+  if(cur->held) {
+    leave_held();
+  }
+  cur->buflen = cur->bufptr = 0;
+  cur->hdrptr = PACKETBUF_HDR_SIZE;
 
-  packetbufptr = &packetbuf[PACKETBUF_HDR_SIZE];
+  cur->dataptr = &packetbuf[PACKETBUF_HDR_SIZE];
   packetbuf_attr_clear();
+  ++generation;
 }
 /*---------------------------------------------------------------------------*/
 void
 packetbuf_clear_hdr(void)
 {
-  hdrptr = PACKETBUF_HDR_SIZE;
+  cur->hdrptr = PACKETBUF_HDR_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+packetbuf_generation(void)
+{
+  return generation;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -99,8 +287,8 @@ packetbuf_copyfrom(const void *from, uint16_t len)
 
   packetbuf_clear();
   l = len > PACKETBUF_SIZE? PACKETBUF_SIZE: len;
-  memcpy(packetbufptr, from, l);
-  buflen = l;
+  memcpy(cur->dataptr, from, l);
+  cur->buflen = l;
   return l;
 }
 /*---------------------------------------------------------------------------*/
@@ -112,13 +300,13 @@ packetbuf_compact(void)
   if(packetbuf_is_reference()) {
     memcpy(&packetbuf[PACKETBUF_HDR_SIZE], packetbuf_reference_ptr(),
 	   packetbuf_datalen());
-  } else if (bufptr > 0) {
+  } else if (cur->bufptr > 0) {
     len = packetbuf_datalen() + PACKETBUF_HDR_SIZE;
     for(i = PACKETBUF_HDR_SIZE; i < len; i++) {
-      packetbuf[i] = packetbuf[bufptr + i];
+      packetbuf[i] = packetbuf[cur->bufptr + i];
     }
 
-    bufptr = 0;
+    cur->bufptr = 0;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -129,14 +317,14 @@ packetbuf_copyto_hdr(uint8_t *to)
   {
     int i;
     PRINTF("packetbuf_write_hdr: header:\n");
-    for(i = hdrptr; i < PACKETBUF_HDR_SIZE; ++i) {
+    for(i = cur->hdrptr; i < PACKETBUF_HDR_SIZE; ++i) {
       PRINTF("0x%02x, ", packetbuf[i]);
     }
     PRINTF("\n");
   }
 #endif /* DEBUG_LEVEL */
-  memcpy(to, packetbuf + hdrptr, PACKETBUF_HDR_SIZE - hdrptr);
-  return PACKETBUF_HDR_SIZE - hdrptr;
+  memcpy(to, packetbuf + cur->hdrptr, PACKETBUF_HDR_SIZE - cur->hdrptr);
+  return PACKETBUF_HDR_SIZE - cur->hdrptr;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -149,33 +337,33 @@ packetbuf_copyto(void *to)
     char *bufferptr = buffer;
     
     bufferptr[0] = 0;
-    for(i = hdrptr; i < PACKETBUF_HDR_SIZE; ++i) {
+    for(i = cur->hdrptr; i < PACKETBUF_HDR_SIZE; ++i) {
       bufferptr += sprintf(bufferptr, "0x%02x, ", packetbuf[i]);
     }
     PRINTF("packetbuf_write: header: %s\n", buffer);
     bufferptr = buffer;
     bufferptr[0] = 0;
-    for(i = bufptr; i < buflen + bufptr; ++i) {
-      bufferptr += sprintf(bufferptr, "0x%02x, ", packetbufptr[i]);
+    for(i = cur->bufptr; i < cur->buflen + cur->bufptr; ++i) {
+      bufferptr += sprintf(bufferptr, "0x%02x, ", cur->dataptr[i]);
     }
     PRINTF("packetbuf_write: data: %s\n", buffer);
   }
 #endif /* DEBUG_LEVEL */
-  if(PACKETBUF_HDR_SIZE - hdrptr + buflen > PACKETBUF_SIZE) {
+  if(PACKETBUF_HDR_SIZE - cur->hdrptr + cur->buflen > PACKETBUF_SIZE) {
     /* Too large packet */
     return 0;
   }
-  memcpy(to, packetbuf + hdrptr, PACKETBUF_HDR_SIZE - hdrptr);
-  memcpy((uint8_t *)to + PACKETBUF_HDR_SIZE - hdrptr, packetbufptr + bufptr,
-	 buflen);
-  return PACKETBUF_HDR_SIZE - hdrptr + buflen;
+  memcpy(to, packetbuf + cur->hdrptr, PACKETBUF_HDR_SIZE - cur->hdrptr);
+  memcpy((uint8_t *)to + PACKETBUF_HDR_SIZE - cur->hdrptr, cur->dataptr + cur->bufptr,
+	 cur->buflen);
+  return PACKETBUF_HDR_SIZE - cur->hdrptr + cur->buflen;
 }
 /*---------------------------------------------------------------------------*/
 int
 packetbuf_hdralloc(int size)
 {
-  if(hdrptr >= size && packetbuf_totlen() + size <= PACKETBUF_SIZE) {
-    hdrptr -= size;
+  if(cur->hdrptr >= size && packetbuf_totlen() + size <= PACKETBUF_SIZE) {
+    cur->hdrptr -= size;
     return 1;
   }
   return 0;
@@ -184,18 +372,18 @@ packetbuf_hdralloc(int size)
 void
 packetbuf_hdr_remove(int size)
 {
-  hdrptr += size;
+  cur->hdrptr += size;
 }
 /*---------------------------------------------------------------------------*/
 int
 packetbuf_hdrreduce(int size)
 {
-  if(buflen < size) {
+  if(cur->buflen < size) {
     return 0;
   }
 
-  bufptr += size;
-  buflen -= size;
+  cur->bufptr += size;
+  cur->buflen -= size;
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -203,45 +391,45 @@ void
 packetbuf_set_datalen(uint16_t len)
 {
   PRINTF("packetbuf_set_len: len %d\n", len);
-  buflen = len;
+  cur->buflen = len;
 }
 /*---------------------------------------------------------------------------*/
 void *
 packetbuf_dataptr(void)
 {
-  return (void *)(&packetbuf[bufptr + PACKETBUF_HDR_SIZE]);
+  return (void *)(&packetbuf[cur->bufptr + PACKETBUF_HDR_SIZE]);
 }
 /*---------------------------------------------------------------------------*/
 void *
 packetbuf_hdrptr(void)
 {
-  return (void *)(&packetbuf[hdrptr]);
+  return (void *)(&packetbuf[cur->hdrptr]);
 }
 /*---------------------------------------------------------------------------*/
 void
 packetbuf_reference(void *ptr, uint16_t len)
 {
   packetbuf_clear();
-  packetbufptr = ptr;
-  buflen = len;
+  cur->dataptr = ptr;
+  cur->buflen = len;
 }
 /*---------------------------------------------------------------------------*/
 int
 packetbuf_is_reference(void)
 {
-  return packetbufptr != &packetbuf[PACKETBUF_HDR_SIZE];
+  return cur->dataptr != &packetbuf[PACKETBUF_HDR_SIZE];
 }
 /*---------------------------------------------------------------------------*/
 void *
 packetbuf_reference_ptr(void)
 {
-  return packetbufptr;
+  return cur->dataptr;
 }
 /*---------------------------------------------------------------------------*/
 uint16_t
 packetbuf_datalen(void)
 {
-  return buflen;
+  return cur->buflen;
 }
 /*---------------------------------------------------------------------------*/
 uint8_t
@@ -249,13 +437,13 @@ packetbuf_hdrlen(void)
 {
 	uint8_t hdrlen;
 
-	hdrlen = PACKETBUF_HDR_SIZE - hdrptr;
+	hdrlen = PACKETBUF_HDR_SIZE - cur->hdrptr;
 	if(hdrlen) {
 		/* outbound packet */
 		return hdrlen;
 	} else {
 		/* inbound packet */
-		return bufptr;
+		return cur->bufptr;
 	}
 }
 /*---------------------------------------------------------------------------*/
@@ -281,16 +469,16 @@ void
 packetbuf_attr_copyto(struct packetbuf_attr *attrs,
 		    struct packetbuf_addr *addrs)
 {
-  memcpy(attrs, packetbuf_attrs, sizeof(packetbuf_attrs));
-  memcpy(addrs, packetbuf_addrs, sizeof(packetbuf_addrs));
+  memcpy(attrs, packetbuf_attrs, sizeof(cur->attrs));
+  memcpy(addrs, packetbuf_addrs, sizeof(cur->addrs));
 }
 /*---------------------------------------------------------------------------*/
 void
 packetbuf_attr_copyfrom(struct packetbuf_attr *attrs,
 		      struct packetbuf_addr *addrs)
 {
-  memcpy(packetbuf_attrs, attrs, sizeof(packetbuf_attrs));
-  memcpy(packetbuf_addrs, addrs, sizeof(packetbuf_addrs));
+  memcpy(packetbuf_attrs, attrs, sizeof(cur->attrs));
+  memcpy(packetbuf_addrs, addrs, sizeof(cur->addrs));
 }
 /*---------------------------------------------------------------------------*/
 #if !PACKETBUF_CONF_ATTRS_INLINE
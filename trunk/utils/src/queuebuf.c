@@ -46,6 +46,7 @@
 #include "packetbuf.h"
 #include "queuebuf.h"
 #include "memb.h"
+#include "stats.h"
 #if WITH_SWAP
 #include "cfs/cfs.h"
 #endif
@@ -93,9 +94,32 @@ struct queuebuf_ref {
   uint8_t hdrlen;
 };
 
+#if QUEUEBUF_SLOTS
+/* A queuebuf keeping its packet in a packetbuf descriptor. Only the
+   attributes are copied, the lower layers change them in place. */
+struct queuebuf_slot {
+  struct packetbuf_slot *slot;
+  uint16_t len;
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+};
+#endif /* QUEUEBUF_SLOTS */
+
 MEMB(bufmem, struct queuebuf, QUEUEBUF_NUM);
 MEMB(refbufmem, struct queuebuf_ref, QUEUEBUF_REF_NUM);
 MEMB(buframmem, struct queuebuf_data, QUEUEBUFRAM_NUM);
+#if QUEUEBUF_SLOTS
+MEMB(slotbufmem, struct queuebuf_slot, QUEUEBUF_SLOTS);
+#endif /* QUEUEBUF_SLOTS */
+
+#if STATS_CONF_ENABLE
+static st_statsGroup_t bufmem_stats = {
+  NULL, "mem.queuebuf", stats_membEntry, STATS_MEMB_ENTRIES, &bufmem
+};
+static st_statsGroup_t buframmem_stats = {
+  NULL, "mem.queuebufram", stats_membEntry, STATS_MEMB_ENTRIES, &buframmem
+};
+#endif /* STATS_CONF_ENABLE */
 
 #if WITH_SWAP
 
@@ -150,6 +174,62 @@ LIST(queuebuf_list);
 uint8_t queuebuf_len, queuebuf_ref_len, queuebuf_max_len;
 #endif /* QUEUEBUF_STATS */
 
+/* Bytes copied between packetbuf and queuebufs */
+static uint32_t copied_bytes;
+
+/* The queuebuf whose data packetbuf still holds, from the generation of
+   packetbuf it was left there */
+static struct queuebuf *in_packetbuf;
+static uint16_t in_packetbuf_generation;
+
+/*---------------------------------------------------------------------------*/
+/* Remember a queuebuf whose data equals the packetbuf. This is only the
+   case if the packetbuf holds no header, queuebufs keep the header and
+   the data in one piece. */
+static void
+set_in_packetbuf(struct queuebuf *b)
+{
+  if(!packetbuf_is_reference() && (packetbuf_hdrlen() == 0) &&
+     (packetbuf_dataptr() == packetbuf_slot_dataptr(packetbuf_slot_current()))) {
+    in_packetbuf = b;
+    in_packetbuf_generation = packetbuf_generation();
+  } else if(in_packetbuf == b) {
+    in_packetbuf = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Whether the packetbuf still holds the data of a queuebuf, the lower
+   layers only added a header in front of it since */
+static int
+is_in_packetbuf(struct queuebuf *b, uint16_t len)
+{
+  return (b == in_packetbuf) &&
+         (packetbuf_generation() == in_packetbuf_generation) &&
+         (packetbuf_dataptr() == packetbuf_slot_dataptr(packetbuf_slot_current())) &&
+         (packetbuf_datalen() == len);
+}
+/*---------------------------------------------------------------------------*/
+#if QUEUEBUF_SLOTS
+/* Hold the packetbuf instead of copying it, if a descriptor is free */
+static struct queuebuf_slot *
+new_slotbuf(void)
+{
+  struct queuebuf_slot *sbuf = memb_alloc(&slotbufmem);
+
+  if(sbuf != NULL) {
+    sbuf->slot = packetbuf_slot_hold();
+    if(sbuf->slot == NULL) {
+      memb_free(&slotbufmem, sbuf);
+      return NULL;
+    }
+    sbuf->len = packetbuf_datalen();
+    packetbuf_attr_copyto(sbuf->attrs, sbuf->addrs);
+    copied_bytes += sizeof(sbuf->attrs) + sizeof(sbuf->addrs);
+  }
+  return sbuf;
+}
+#endif /* QUEUEBUF_SLOTS */
+/*---------------------------------------------------------------------------*/
 #if WITH_SWAP
 /*---------------------------------------------------------------------------*/
 static void
@@ -305,6 +385,13 @@ queuebuf_init(void)
   memb_init(&buframmem);
   memb_init(&bufmem);
   memb_init(&refbufmem);
+#if QUEUEBUF_SLOTS
+  memb_init(&slotbufmem);
+#endif /* QUEUEBUF_SLOTS */
+#if STATS_CONF_ENABLE
+  stats_register(&bufmem_stats);
+  stats_register(&buframmem_stats);
+#endif /* STATS_CONF_ENABLE */
 #if QUEUEBUF_STATS
   queuebuf_max_len = QUEUEBUF_NUM;
 #endif /* QUEUEBUF_STATS */
@@ -331,6 +418,12 @@ queuebuf_new_from_packetbuf(void)
   struct queuebuf *buf;
   struct queuebuf_ref *rbuf;
 
+#if QUEUEBUF_SLOTS
+  buf = (struct queuebuf *)new_slotbuf();
+  if(buf != NULL) {
+    return buf;
+  }
+#endif /* QUEUEBUF_SLOTS */
   if(packetbuf_is_reference()) {
     rbuf = memb_alloc(&refbufmem);
     if(rbuf != NULL) {
@@ -340,6 +433,7 @@ queuebuf_new_from_packetbuf(void)
       rbuf->len = packetbuf_datalen();
       rbuf->ref = packetbuf_reference_ptr();
       rbuf->hdrlen = packetbuf_copyto_hdr(rbuf->hdr);
+      copied_bytes += rbuf->hdrlen;
     } else {
       PRINTF("queuebuf_new_from_packetbuf: could not allocate a reference queuebuf\n");
     }
@@ -377,6 +471,9 @@ queuebuf_new_from_packetbuf(void)
 
       buframptr->len = packetbuf_copyto(buframptr->data);
       packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+      copied_bytes += buframptr->len + sizeof(buframptr->attrs) +
+                      sizeof(buframptr->addrs);
+      set_in_packetbuf(buf);
 
 #if WITH_SWAP
       if(buf->location == IN_CFS) {
@@ -409,8 +506,20 @@ queuebuf_new_from_packetbuf(void)
 void
 queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 {
-  struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
+  struct queuebuf_data *buframptr;
+#if QUEUEBUF_SLOTS
+  struct queuebuf_slot *sbuf;
+
+  if(memb_inmemb(&slotbufmem, buf)) {
+    sbuf = (struct queuebuf_slot *)buf;
+    packetbuf_attr_copyto(sbuf->attrs, sbuf->addrs);
+    copied_bytes += sizeof(sbuf->attrs) + sizeof(sbuf->addrs);
+    return;
+  }
+#endif /* QUEUEBUF_SLOTS */
+  buframptr = queuebuf_load_to_ram(buf);
   packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+  copied_bytes += sizeof(buframptr->attrs) + sizeof(buframptr->addrs);
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
@@ -421,9 +530,32 @@ queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 void
 queuebuf_update_from_packetbuf(struct queuebuf *buf)
 {
-  struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
+  struct queuebuf_data *buframptr;
+#if QUEUEBUF_SLOTS
+  struct queuebuf_slot *sbuf;
+
+  if(memb_inmemb(&slotbufmem, buf)) {
+    sbuf = (struct queuebuf_slot *)buf;
+    packetbuf_attr_copyto(sbuf->attrs, sbuf->addrs);
+    if(packetbuf_slot_current() != sbuf->slot) {
+      sbuf->len = packetbuf_copyto(packetbuf_slot_dataptr(sbuf->slot));
+    } else {
+      /* Changed in place, the header is moved in front of the data */
+      packetbuf_compact();
+      sbuf->len = packetbuf_totlen();
+      memmove(packetbuf_slot_dataptr(sbuf->slot), packetbuf_hdrptr(), sbuf->len);
+      packetbuf_slot_restore(sbuf->slot, sbuf->len);
+    }
+    copied_bytes += sbuf->len + sizeof(sbuf->attrs) + sizeof(sbuf->addrs);
+    return;
+  }
+#endif /* QUEUEBUF_SLOTS */
+  buframptr = queuebuf_load_to_ram(buf);
   packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
   buframptr->len = packetbuf_copyto(buframptr->data);
+  copied_bytes += buframptr->len + sizeof(buframptr->attrs) +
+                  sizeof(buframptr->addrs);
+  set_in_packetbuf(buf);
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
@@ -434,6 +566,16 @@ queuebuf_update_from_packetbuf(struct queuebuf *buf)
 void
 queuebuf_free(struct queuebuf *buf)
 {
+  if(in_packetbuf == buf) {
+    in_packetbuf = NULL;
+  }
+#if QUEUEBUF_SLOTS
+  if(memb_inmemb(&slotbufmem, buf)) {
+    packetbuf_slot_release(((struct queuebuf_slot *)buf)->slot);
+    memb_free(&slotbufmem, buf);
+    return;
+  }
+#endif /* QUEUEBUF_SLOTS */
   if(memb_inmemb(&bufmem, buf)) {
 #if WITH_SWAP
     if(buf->location == IN_RAM) {
@@ -464,16 +606,39 @@ void
 queuebuf_to_packetbuf(struct queuebuf *b)
 {
   struct queuebuf_ref *r;
+#if QUEUEBUF_SLOTS
+  struct queuebuf_slot *sbuf;
+
+  if(memb_inmemb(&slotbufmem, b)) {
+    sbuf = (struct queuebuf_slot *)b;
+    packetbuf_slot_restore(sbuf->slot, sbuf->len);
+    packetbuf_attr_copyfrom(sbuf->attrs, sbuf->addrs);
+    copied_bytes += sizeof(sbuf->attrs) + sizeof(sbuf->addrs);
+    return;
+  }
+#endif /* QUEUEBUF_SLOTS */
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+    if(is_in_packetbuf(b, buframptr->len)) {
+      /* A retransmission, only the header and the attributes the lower
+         layers changed are restored */
+      packetbuf_clear_hdr();
+      packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
+      copied_bytes += sizeof(buframptr->attrs) + sizeof(buframptr->addrs);
+      return;
+    }
     packetbuf_copyfrom(buframptr->data, buframptr->len);
     packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
+    copied_bytes += buframptr->len + sizeof(buframptr->attrs) +
+                    sizeof(buframptr->addrs);
+    set_in_packetbuf(b);
   } else if(memb_inmemb(&refbufmem, b)) {
     r = (struct queuebuf_ref *)b;
     packetbuf_clear();
     packetbuf_copyfrom(r->ref, r->len);
     packetbuf_hdralloc(r->hdrlen);
     memcpy(packetbuf_hdrptr(), r->hdr, r->hdrlen);
+    copied_bytes += r->len + r->hdrlen;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -482,6 +647,11 @@ queuebuf_dataptr(struct queuebuf *b)
 {
   struct queuebuf_ref *r;
 
+#if QUEUEBUF_SLOTS
+  if(memb_inmemb(&slotbufmem, b)) {
+    return packetbuf_slot_dataptr(((struct queuebuf_slot *)b)->slot);
+  }
+#endif /* QUEUEBUF_SLOTS */
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
     return buframptr->data;
@@ -495,24 +665,48 @@ queuebuf_dataptr(struct queuebuf *b)
 int
 queuebuf_datalen(struct queuebuf *b)
 {
-  struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+  struct queuebuf_data *buframptr;
+#if QUEUEBUF_SLOTS
+  if(memb_inmemb(&slotbufmem, b)) {
+    return ((struct queuebuf_slot *)b)->len;
+  }
+#endif /* QUEUEBUF_SLOTS */
+  buframptr = queuebuf_load_to_ram(b);
   return buframptr->len;
 }
 /*---------------------------------------------------------------------------*/
 linkaddr_t *
 queuebuf_addr(struct queuebuf *b, uint8_t type)
 {
-  struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+  struct queuebuf_data *buframptr;
+#if QUEUEBUF_SLOTS
+  if(memb_inmemb(&slotbufmem, b)) {
+    return &((struct queuebuf_slot *)b)->addrs[type - PACKETBUF_ADDR_FIRST].addr;
+  }
+#endif /* QUEUEBUF_SLOTS */
+  buframptr = queuebuf_load_to_ram(b);
   return &buframptr->addrs[type - PACKETBUF_ADDR_FIRST].addr;
 }
 /*---------------------------------------------------------------------------*/
 packetbuf_attr_t
 queuebuf_attr(struct queuebuf *b, uint8_t type)
 {
-  struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+  struct queuebuf_data *buframptr;
+#if QUEUEBUF_SLOTS
+  if(memb_inmemb(&slotbufmem, b)) {
+    return ((struct queuebuf_slot *)b)->attrs[type].val;
+  }
+#endif /* QUEUEBUF_SLOTS */
+  buframptr = queuebuf_load_to_ram(b);
   return buframptr->attrs[type].val;
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+queuebuf_copied_bytes(void)
+{
+  return copied_bytes;
+}
+/*---------------------------------------------------------------------------*/
 void
 queuebuf_debug_print(void)
 {
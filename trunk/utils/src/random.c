@@ -38,21 +38,26 @@
 
 #include "random.h"
 
-#include <stdlib.h>
+#include <stdint.h>
+
+/* The state is kept here instead of using rand() of the C library, so that
+   a sequence only depends on the seed. This makes runs reproducible, and
+   every node of a simulation has its own sequence. */
+static uint32_t state = 1;
 
 /*---------------------------------------------------------------------------*/
 void
 random_init(unsigned short seed)
 {
-  srand(seed);
+  /* Spread the seed over the whole state */
+  state = ((uint32_t)seed << 16) ^ seed ^ 0x5bd1e995UL;
 }
 /*---------------------------------------------------------------------------*/
 unsigned short
 random_rand(void)
 {
-/* In gcc int rand() uses RAND_MAX and long random() uses RANDOM_MAX=0x7FFFFFFF */
-/* RAND_MAX varies depending on the architecture */
-
-  return (unsigned short)rand();
+  /* Linear congruential generator, the upper bits have the longest period */
+  state = state * 1664525UL + 1013904223UL;
+  return (unsigned short)(state >> 16);
 }
 /*---------------------------------------------------------------------------*/
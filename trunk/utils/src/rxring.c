@@ -0,0 +1,223 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ *   \addtogroup rxring Receive ring
+ *   @{
+*/
+/*!
+    \file   rxring.c
+
+    \brief  Lock-free ring of received frames shared by the radio drivers.
+
+  \version  0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                             INCLUDE FILES
+==============================================================================*/
+#include "emb6.h"
+#include "emb6_conf.h"
+
+#include "packetbuf.h"
+#include "rxring.h"
+#include "stats.h"
+
+#include <string.h>
+
+/*==============================================================================
+                             MACROS
+==============================================================================*/
+#define RXRING_MASK				(RXRING_SIZE - 1)
+
+/** Keeps the compiler from moving accesses to an entry across the update of
+ *  an index. Producer and consumer run on the same core, the producer in an
+ *  interrupt, so no fence instruction is needed. */
+#define RXRING_BARRIER()		__asm__ __volatile__("" ::: "memory")
+
+#if PACKETBUF_SIZE < RXRING_FRAME_SIZE
+#error "PACKETBUF_SIZE is too small for the receive ring"
+#endif
+
+/*==============================================================================
+                             GLOBAL CONSTANTS
+==============================================================================*/
+#if STATS_CONF_ENABLE
+static const st_statsEntry_t gst_rxringEntry[] = {
+	STATS_COUNTER(st_rxringStats_t, l_rx),
+	STATS_COUNTER(st_rxringStats_t, l_overrun),
+	STATS_COUNTER(st_rxringStats_t, l_dup),
+};
+#endif /* STATS_CONF_ENABLE */
+
+/*==============================================================================
+                             API FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/*  rxring_init()                                                             */
+/*============================================================================*/
+int8_t rxring_init(st_rxring_t * pst_ring, const char * pc_name)
+{
+	int8_t		c_ret = 0;
+	uint8_t		i;
+
+	memset(pst_ring, 0, sizeof(st_rxring_t));
+	for (i = 0; i < RXRING_SIZE; i++) {
+		pst_ring->pst_entry[i].pst_slot = packetbuf_slot_alloc();
+		if (pst_ring->pst_entry[i].pst_slot == NULL)
+			c_ret = -1;
+	}
+
+#if STATS_CONF_ENABLE
+	pst_ring->st_group.pc_name = pc_name;
+	pst_ring->st_group.pst_entry = gst_rxringEntry;
+	pst_ring->st_group.c_num = sizeof(gst_rxringEntry) / sizeof(gst_rxringEntry[0]);
+	pst_ring->st_group.p_data = &pst_ring->st_stats;
+	stats_register(&pst_ring->st_group);
+#else
+	(void)pc_name;
+#endif /* STATS_CONF_ENABLE */
+	return c_ret;
+} /* rxring_init() */
+
+/*============================================================================*/
+/*  rxring_getBuf()                                                           */
+/*============================================================================*/
+uint8_t * rxring_getBuf(st_rxring_t * pst_ring)
+{
+	st_rxringEntry_t *	pst_entry;
+
+	pst_entry = &pst_ring->pst_entry[pst_ring->c_tail & RXRING_MASK];
+	if (((uint8_t)(pst_ring->c_tail - pst_ring->c_head) == RXRING_SIZE) ||
+		(pst_entry->pst_slot == NULL)) {
+		STATS_INC(pst_ring->st_stats.l_overrun);
+		return NULL;
+	}
+	return packetbuf_slot_dataptr(pst_entry->pst_slot);
+} /* rxring_getBuf() */
+
+/*============================================================================*/
+/*  rxring_isDup()                                                            */
+/*============================================================================*/
+uint8_t rxring_isDup(st_rxring_t * pst_ring, uint8_t c_len)
+{
+	st_rxringEntry_t *	pst_entry;
+	uint8_t *			pc_frame;
+	uint8_t				c_idx;
+
+	pc_frame = packetbuf_slot_dataptr(
+			pst_ring->pst_entry[pst_ring->c_tail & RXRING_MASK].pst_slot);
+	for (c_idx = pst_ring->c_head; c_idx != pst_ring->c_tail; c_idx++) {
+		pst_entry = &pst_ring->pst_entry[c_idx & RXRING_MASK];
+		if ((pst_entry->c_len == c_len) &&
+			(memcmp(packetbuf_slot_dataptr(pst_entry->pst_slot), pc_frame, c_len) == 0)) {
+			STATS_INC(pst_ring->st_stats.l_dup);
+			return 1;
+		}
+	}
+	return 0;
+} /* rxring_isDup() */
+
+/*============================================================================*/
+/*  rxring_put()                                                              */
+/*============================================================================*/
+void rxring_put(st_rxring_t * pst_ring, uint8_t c_len, uint8_t c_lqi,
+		uint8_t c_rssi)
+{
+	st_rxringEntry_t *	pst_entry;
+
+	pst_entry = &pst_ring->pst_entry[pst_ring->c_tail & RXRING_MASK];
+	pst_entry->c_len = c_len;
+	pst_entry->c_lqi = c_lqi;
+	pst_entry->c_rssi = c_rssi;
+	STATS_INC(pst_ring->st_stats.l_rx);
+	/* The entry is complete before the consumer can see it */
+	RXRING_BARRIER();
+	pst_ring->c_tail++;
+} /* rxring_put() */
+
+/*============================================================================*/
+/*  rxring_peek()                                                             */
+/*============================================================================*/
+st_rxringEntry_t * rxring_peek(st_rxring_t * pst_ring)
+{
+	if (pst_ring->c_head == pst_ring->c_tail)
+		return NULL;
+	/* The entry is read after the tail which published it */
+	RXRING_BARRIER();
+	return &pst_ring->pst_entry[pst_ring->c_head & RXRING_MASK];
+} /* rxring_peek() */
+
+/*============================================================================*/
+/*  rxring_take()                                                             */
+/*============================================================================*/
+int8_t rxring_take(st_rxring_t * pst_ring, uint8_t c_len)
+{
+	st_rxringEntry_t *	pst_entry;
+
+	pst_entry = rxring_peek(pst_ring);
+	if (pst_entry == NULL)
+		return -1;
+
+	/* Exchange the descriptors, the frame stays where it was received */
+	pst_entry->pst_slot = packetbuf_slot_select(pst_entry->pst_slot);
+	packetbuf_clear();
+	packetbuf_set_datalen(c_len);
+	packetbuf_set_attr(PACKETBUF_ATTR_RSSI, pst_entry->c_rssi);
+	packetbuf_set_attr(PACKETBUF_ATTR_LINK_QUALITY, pst_entry->c_lqi);
+	/* The entry is released after the descriptors were exchanged */
+	RXRING_BARRIER();
+	pst_ring->c_head++;
+	return 0;
+} /* rxring_take() */
+
+/*============================================================================*/
+/*  rxring_drop()                                                             */
+/*============================================================================*/
+void rxring_drop(st_rxring_t * pst_ring)
+{
+	if (pst_ring->c_head != pst_ring->c_tail) {
+		RXRING_BARRIER();
+		pst_ring->c_head++;
+	}
+} /* rxring_drop() */
+
+/** @} */
@@ -0,0 +1,287 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ *   \addtogroup stats Statistics registry
+ *   @{
+*/
+/*!
+    \file   stats.c
+
+    \brief  Registry of the statistics counters of all layers.
+
+  \version  0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                             INCLUDE FILES
+==============================================================================*/
+#include "emb6.h"
+#include "emb6_conf.h"
+
+#include "bsp.h"
+#include "clist.h"
+#include "memb.h"
+#include "stats.h"
+
+#include <stdio.h>
+
+#if STATS_CONF_ENABLE
+/*==============================================================================
+                             STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/// Writes a window of a byte stream
+typedef struct {
+	uint8_t *	pc_buf;		///< Buffer of the window
+	uint16_t	i_len;		///< Size of the window
+	uint16_t	i_written;	///< Bytes written to the window
+	uint32_t	l_offset;	///< Start of the window in the stream
+	uint32_t	l_pos;		///< Position in the stream
+}st_statsWriter_t;
+
+/*==============================================================================
+                             LOCAL VARIABLES
+==============================================================================*/
+LIST(gst_statsGroups);
+/// Hash of the schema
+static uint16_t					i_statsHash;
+
+/*==============================================================================
+                             GLOBAL CONSTANTS
+==============================================================================*/
+const st_statsEntry_t stats_membEntry[STATS_MEMB_ENTRIES] = {
+	STATS_COUNTER(struct memb, used),
+	STATS_COUNTER(struct memb, used_max),
+	STATS_COUNTER(struct memb, failed),
+};
+
+/*==============================================================================
+                             LOCAL FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/*  _stats_putByte()                                                          */
+/*============================================================================*/
+static void _stats_putByte(st_statsWriter_t * pst_wr, uint8_t c_byte)
+{
+	if ((pst_wr->l_pos >= pst_wr->l_offset) && (pst_wr->i_written < pst_wr->i_len))
+		pst_wr->pc_buf[pst_wr->i_written++] = c_byte;
+	pst_wr->l_pos++;
+} /* _stats_putByte() */
+
+/*============================================================================*/
+/*  _stats_putLe()                                                            */
+/*============================================================================*/
+static void _stats_putLe(st_statsWriter_t * pst_wr, uint32_t l_val, uint8_t c_size)
+{
+	/* Skip the whole value if it is before the window */
+	if (pst_wr->l_pos + c_size <= pst_wr->l_offset) {
+		pst_wr->l_pos += c_size;
+		return;
+	}
+	while (c_size-- > 0) {
+		_stats_putByte(pst_wr, l_val & 0xFF);
+		l_val >>= 8;
+	}
+} /* _stats_putLe() */
+
+/*============================================================================*/
+/*  _stats_putStr()                                                           */
+/*============================================================================*/
+static void _stats_putStr(st_statsWriter_t * pst_wr, const char * pc_str)
+{
+	while (*pc_str != '\0')
+		_stats_putByte(pst_wr, *pc_str++);
+} /* _stats_putStr() */
+
+/*============================================================================*/
+/*  _stats_hash()                                                             */
+/*============================================================================*/
+static uint32_t _stats_hash(uint32_t l_hash, const char * pc_str)
+{
+	/* FNV-1a */
+	while (*pc_str != '\0') {
+		l_hash ^= (uint8_t)*pc_str++;
+		l_hash *= 16777619UL;
+	}
+	return l_hash;
+} /* _stats_hash() */
+
+/*============================================================================*/
+/*  _stats_typeName()                                                         */
+/*============================================================================*/
+static const char * _stats_typeName(uint8_t c_type)
+{
+	switch (c_type) {
+	case E_STATS_U8:	return "u8";
+	case E_STATS_U16:	return "u16";
+	case E_STATS_HIST:	return "hist";
+	default:			return "u32";
+	}
+} /* _stats_typeName() */
+
+/*==============================================================================
+                             API FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/*  stats_register()                                                          */
+/*============================================================================*/
+void stats_register(st_statsGroup_t * pst_group)
+{
+	st_statsGroup_t *	pst_grp;
+	uint32_t			l_hash = 2166136261UL;
+	uint8_t				i;
+
+	/* list_add() removes the group first if it was already registered */
+	list_add(gst_statsGroups, pst_group);
+
+	for (pst_grp = list_head(gst_statsGroups); pst_grp != NULL; pst_grp = pst_grp->pst_next) {
+		for (i = 0; i < pst_grp->c_num; i++) {
+			l_hash = _stats_hash(l_hash, pst_grp->pc_name);
+			l_hash = _stats_hash(l_hash, pst_grp->pst_entry[i].pc_name);
+			l_hash = _stats_hash(l_hash, _stats_typeName(pst_grp->pst_entry[i].c_type));
+		}
+	}
+	i_statsHash = (uint16_t)(l_hash ^ (l_hash >> 16));
+} /* stats_register() */
+
+/*============================================================================*/
+/*  stats_histAdd()                                                           */
+/*============================================================================*/
+void stats_histAdd(st_statsHist_t * pst_hist, uint32_t l_value)
+{
+	uint8_t		c_bucket = 0;
+
+	while ((l_value != 0) && (c_bucket < STATS_HIST_BUCKETS - 1)) {
+		l_value >>= 1;
+		c_bucket++;
+	}
+	if (pst_hist->pi_bucket[c_bucket] != 0xFFFF)
+		pst_hist->pi_bucket[c_bucket]++;
+} /* stats_histAdd() */
+
+/*============================================================================*/
+/*  stats_size()                                                              */
+/*============================================================================*/
+uint16_t stats_size(void)
+{
+	st_statsGroup_t *	pst_grp;
+	uint16_t			i_size = STATS_HDR_SIZE;
+	uint8_t				i;
+
+	for (pst_grp = list_head(gst_statsGroups); pst_grp != NULL; pst_grp = pst_grp->pst_next) {
+		for (i = 0; i < pst_grp->c_num; i++) {
+			switch (pst_grp->pst_entry[i].c_type) {
+			case E_STATS_HIST:	i_size += STATS_HIST_BUCKETS * 2; break;
+			case E_STATS_U64:	i_size += 4; break;
+			default:			i_size += pst_grp->pst_entry[i].c_type; break;
+			}
+		}
+	}
+	return i_size;
+} /* stats_size() */
+
+/*============================================================================*/
+/*  stats_snapshot()                                                          */
+/*============================================================================*/
+uint16_t stats_snapshot(uint8_t * pc_buf, uint16_t i_len, uint32_t l_offset)
+{
+	st_statsWriter_t	st_wr = { pc_buf, i_len, 0, l_offset, 0 };
+	st_statsGroup_t *	pst_grp;
+	const uint8_t *		pc_val;
+	uint8_t				i;
+	uint8_t				j;
+
+	_stats_putByte(&st_wr, STATS_VERSION);
+	_stats_putLe(&st_wr, i_statsHash, 2);
+	_stats_putLe(&st_wr, bsp_getSec(), 4);
+	for (pst_grp = list_head(gst_statsGroups); pst_grp != NULL; pst_grp = pst_grp->pst_next) {
+		for (i = 0; (i < pst_grp->c_num) && (st_wr.i_written < i_len); i++) {
+			pc_val = (const uint8_t *)pst_grp->p_data + pst_grp->pst_entry[i].i_offset;
+			switch (pst_grp->pst_entry[i].c_type) {
+			case E_STATS_U8:
+				_stats_putLe(&st_wr, *pc_val, 1);
+				break;
+			case E_STATS_U16:
+				_stats_putLe(&st_wr, *(const uint16_t *)pc_val, 2);
+				break;
+			case E_STATS_U32:
+				_stats_putLe(&st_wr, *(const uint32_t *)pc_val, 4);
+				break;
+			case E_STATS_U64:
+				_stats_putLe(&st_wr, (uint32_t)*(const uint64_t *)pc_val, 4);
+				break;
+			case E_STATS_HIST:
+				for (j = 0; j < STATS_HIST_BUCKETS; j++)
+					_stats_putLe(&st_wr, ((const st_statsHist_t *)pc_val)->pi_bucket[j], 2);
+				break;
+			}
+		}
+	}
+	return st_wr.i_written;
+} /* stats_snapshot() */
+
+/*============================================================================*/
+/*  stats_schema()                                                            */
+/*============================================================================*/
+uint16_t stats_schema(char * pc_buf, uint16_t i_len, uint32_t l_offset)
+{
+	st_statsWriter_t	st_wr = { (uint8_t *)pc_buf, i_len, 0, l_offset, 0 };
+	st_statsGroup_t *	pst_grp;
+	char				pc_line[16];
+	uint8_t				i;
+
+	snprintf(pc_line, sizeof(pc_line), "v%u %04x\n", STATS_VERSION, i_statsHash);
+	_stats_putStr(&st_wr, pc_line);
+	for (pst_grp = list_head(gst_statsGroups); pst_grp != NULL; pst_grp = pst_grp->pst_next) {
+		for (i = 0; (i < pst_grp->c_num) && (st_wr.i_written < i_len); i++) {
+			_stats_putStr(&st_wr, pst_grp->pc_name);
+			_stats_putByte(&st_wr, '.');
+			_stats_putStr(&st_wr, pst_grp->pst_entry[i].pc_name);
+			_stats_putByte(&st_wr, ' ');
+			_stats_putStr(&st_wr, _stats_typeName(pst_grp->pst_entry[i].c_type));
+			_stats_putByte(&st_wr, '\n');
+		}
+	}
+	return st_wr.i_written;
+} /* stats_schema() */
+
+#endif /* STATS_CONF_ENABLE */
+/** @} */
@@ -0,0 +1,186 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ *   \addtogroup trace Packet tracing
+ *   @{
+*/
+/*!
+    \file   trace.c
+
+    \brief  Lock-free ring of trace records.
+
+  \version  0.1
+*/
+/*============================================================================*/
+
+/*==============================================================================
+                             INCLUDE FILES
+==============================================================================*/
+#include "emb6.h"
+#include "emb6_conf.h"
+
+#include "bsp.h"
+#include "trace.h"
+
+#if TRACE_CONF_ENABLE
+/*==============================================================================
+                             LOCAL MACROS
+==============================================================================*/
+#define TRACE_MASK				(TRACE_RECORDS - 1)
+
+/* Interrupt handlers may interrupt a record in progress, so indexes are
+ * taken with an atomic increment where the CPU has one. Otherwise the
+ * increment is done with the interrupts disabled. */
+#if defined(__GCC_ATOMIC_SHORT_LOCK_FREE) && (__GCC_ATOMIC_SHORT_LOCK_FREE == 2)
+#define TRACE_FETCH_INC(p)		__atomic_fetch_add((p), 1, __ATOMIC_RELAXED)
+#else
+#define TRACE_FETCH_INC(p)		_trace_fetchInc(p)
+#endif
+
+/*==============================================================================
+                             LOCAL VARIABLES
+==============================================================================*/
+/// Records, the slot of a record is its index modulo TRACE_RECORDS
+static st_traceRec_t			gst_traceRing[TRACE_RECORDS];
+/// Index of the next record to write, runs freely
+static volatile uint16_t		i_traceHead;
+/// Index of the next record to read
+static uint16_t					i_traceTail;
+/// Last packet id
+static volatile uint16_t		i_tracePacket;
+/// Records overwritten before they were read
+static uint32_t					l_traceLost;
+
+/*==============================================================================
+                             GLOBAL VARIABLES
+==============================================================================*/
+uint16_t						trace_curPacket;
+
+/*==============================================================================
+                             LOCAL FUNCTIONS
+==============================================================================*/
+#if !defined(__GCC_ATOMIC_SHORT_LOCK_FREE) || (__GCC_ATOMIC_SHORT_LOCK_FREE != 2)
+static uint16_t _trace_fetchInc(volatile uint16_t * pi_val)
+{
+	uint16_t	i_old;
+
+	bsp_enterCritical();
+	i_old = (*pi_val)++;
+	bsp_exitCritical();
+	return i_old;
+}
+#endif
+
+/*==============================================================================
+                             API FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/*  trace_init()                                                              */
+/*============================================================================*/
+void trace_init(void)
+{
+	i_traceHead = 0;
+	i_traceTail = 0;
+	l_traceLost = 0;
+	trace_curPacket = 0;
+} /* trace_init() */
+
+/*============================================================================*/
+/*  trace_newPacket()                                                         */
+/*============================================================================*/
+uint16_t trace_newPacket(void)
+{
+	uint16_t	i_id;
+
+	do {
+		i_id = TRACE_FETCH_INC(&i_tracePacket) + 1;
+	} while (i_id == 0);
+	return i_id;
+} /* trace_newPacket() */
+
+/*============================================================================*/
+/*  trace_put()                                                               */
+/*============================================================================*/
+void trace_put(uint16_t i_packet, uint8_t c_layer, uint8_t c_dir)
+{
+	st_traceRec_t *	pst_rec;
+
+	if (i_packet == 0)
+		return;
+	pst_rec = &gst_traceRing[TRACE_FETCH_INC(&i_traceHead) & TRACE_MASK];
+	pst_rec->l_time = (uint32_t)bsp_getTimeUs();
+	pst_rec->i_packet = i_packet;
+	pst_rec->c_layer = c_layer;
+	pst_rec->c_dir = c_dir;
+} /* trace_put() */
+
+/*============================================================================*/
+/*  trace_read()                                                              */
+/*============================================================================*/
+uint16_t trace_read(st_traceRec_t * pst_rec, uint16_t i_max)
+{
+	uint16_t	i_avail = (uint16_t)(i_traceHead - i_traceTail);
+	uint16_t	i;
+
+	if (i_avail > TRACE_RECORDS) {
+		/* The writers went round, only the newest records are left */
+		l_traceLost += i_avail - TRACE_RECORDS;
+		i_traceTail += i_avail - TRACE_RECORDS;
+		i_avail = TRACE_RECORDS;
+	}
+	if (i_avail > i_max)
+		i_avail = i_max;
+	for (i = 0; i < i_avail; i++)
+		pst_rec[i] = gst_traceRing[(i_traceTail + i) & TRACE_MASK];
+	i_traceTail += i_avail;
+	return i_avail;
+} /* trace_read() */
+
+/*============================================================================*/
+/*  trace_lost()                                                              */
+/*============================================================================*/
+uint32_t trace_lost(void)
+{
+	return l_traceLost;
+} /* trace_lost() */
+
+#endif /* TRACE_CONF_ENABLE */
+/** @} */